@@ -32,6 +32,45 @@ typedef struct {
      * Number of incoming retransmissions. For CoAP/TCP it's always 0.
      */
     uint32_t incoming_retransmissions_count;
+
+    /**
+     * Number of datagrams successfully handed over to the socket layer. For
+     * CoAP/TCP it's always 0.
+     */
+    uint32_t outgoing_datagrams_count;
+
+    /**
+     * Number of send operations performed on the socket, i.e. calls to
+     * avs_net_socket_send() and to the batch send handler (see
+     * @ref avs_coap_udp_ctx_set_batch_send_handler ). For CoAP/TCP it's
+     * always 0.
+     */
+    uint32_t outgoing_send_calls_count;
+
+    /**
+     * State of the adaptive retransmission timeout estimator. See
+     * @ref avs_coap_udp_ctx_set_rtt_estimation . All fields are zero if the
+     * estimator is disabled. For CoAP/TCP they are always zero.
+     */
+    struct {
+        /** Current RTO, used instead of ACK_TIMEOUT for new exchanges. */
+        avs_time_duration_t rto;
+        /**
+         * Smoothed RTT of exchanges confirmed without retransmissions; zero
+         * until the first such exchange.
+         */
+        avs_time_duration_t strong_srtt;
+        /** RTO derived from strong_srtt and its variance. */
+        avs_time_duration_t strong_rto;
+        /**
+         * Smoothed RTT of exchanges confirmed after one or two
+         * retransmissions, measured since the initial transmission; zero
+         * until the first such exchange.
+         */
+        avs_time_duration_t weak_srtt;
+        /** RTO derived from weak_srtt and its variance. */
+        avs_time_duration_t weak_rto;
+    } rtt_estimator;
 } avs_coap_stats_t;
 
 typedef struct avs_coap_request_header {
@@ -176,6 +215,41 @@ avs_time_duration_t avs_coap_get_exchange_max_time(avs_coap_ctx_t *ctx);
 void avs_coap_set_exchange_max_time(avs_coap_ctx_t *ctx,
                                     const avs_time_duration_t time);
 
+/**
+ * Incoming packets drain limit getter.
+ *
+ * @param ctx CoAP context to operate on.
+ *
+ * @returns Limit set with @ref avs_coap_set_incoming_packets_drain_limit .
+ */
+size_t avs_coap_get_incoming_packets_drain_limit(avs_coap_ctx_t *ctx);
+
+/**
+ * Sets the number of packets that a single call to
+ * @ref avs_coap_async_handle_incoming_packet or
+ * @ref avs_coap_streaming_handle_incoming_packet keeps receiving for.
+ *
+ * By default (@p limit equal to 0), these functions return as soon as the
+ * socket reports that it has no more buffered data. Datagrams queued by the
+ * operating system are not considered buffered, so for plain UDP sockets this
+ * means that only a single packet is handled per call, and each subsequent one
+ * requires another call, usually after another poll() on the socket.
+ *
+ * If @p limit is nonzero, receiving continues (with zero timeout) until either
+ * there is no more data to receive immediately, or at least @p limit packets
+ * have been handled. This allows handling bursts of incoming packets in a
+ * single call, at the cost of one additional, unsuccessful receive operation
+ * per call.
+ *
+ * Data buffered in the socket layer (e.g. multiple records decrypted from a
+ * single TLS read) is always handled, regardless of this setting.
+ *
+ * @param ctx   CoAP context to operate on.
+ * @param limit Number of packets to drain per call, or 0 to disable draining.
+ */
+void avs_coap_set_incoming_packets_drain_limit(avs_coap_ctx_t *ctx,
+                                               size_t limit);
+
 /**
  * <c>avs_error_t</c> category for values of type @ref avs_coap_error_t.
  */
@@ -535,6 +535,39 @@ int avs_coap_options_get_block(const avs_coap_options_t *opts,
  */
 int avs_coap_options_skip_it(avs_coap_option_iterator_t *inout_it);
 
+/**
+ * Iterates over all CoAP options from @p opts in the order in which they are
+ * stored (i.e. sorted by option number), yielding their numbers and pointers to
+ * their values. Values are not copied - they point directly into the buffer
+ * held by @p opts and stay valid for as long as @p opts is not modified.
+ *
+ * @param[in]    opts              CoAP options to operate on.
+ * @param[inout] it                Option iterator object that holds iteration
+ *                                 state. When starting the iteration, it MUST
+ *                                 be set with
+ *                                 @ref AVS_COAP_OPTION_ITERATOR_EMPTY . Points
+ *                                 to the next CoAP option after successful
+ *                                 call.
+ * @param[out]   out_option_number Number of the option.
+ * @param[out]   out_value         Set to point to the option value. Note that
+ *                                 it is NOT zero-terminated.
+ * @param[out]   out_value_size    Size of the option value.
+ *
+ * NOTE: The iterator state MUST NOT be changed by user code during the
+ * iteration, and the same iterator MUST NOT be passed to other
+ * avs_coap_options_get_*_it functions. Doing so causes the behavior of this
+ * function to be undefined.
+ *
+ * @returns @li 0 on success,
+ *          @li AVS_COAP_OPTION_MISSING when there are no more options to
+ *              retrieve.
+ */
+int avs_coap_options_view_next_it(const avs_coap_options_t *opts,
+                                  avs_coap_option_iterator_t *it,
+                                  uint32_t *out_option_number,
+                                  const void **out_value,
+                                  size_t *out_value_size);
+
 /**
  * Iterates over CoAP options from @p opts that match given @p option_number ,
  * yielding their values as opaque byte arrays.
@@ -185,6 +185,106 @@ avs_coap_udp_ctx_create(avs_sched_t *sched,
 int avs_coap_udp_ctx_set_forced_incoming_mtu(avs_coap_ctx_t *ctx,
                                              size_t forced_incoming_mtu);
 
+/**
+ * Enables or disables adaptive retransmission timeouts on a CoAP/UDP context.
+ *
+ * When enabled, round-trip times of confirmed exchanges are measured and fed
+ * to an estimator based on CoCoA (draft-ietf-core-cocoa). The resulting RTO is
+ * used instead of ACK_TIMEOUT when starting new exchanges (ACK_RANDOM_FACTOR
+ * still applies), and retransmission timeouts grow by a factor of 3, 2 or 1.5
+ * depending on the RTO, instead of being always doubled. When no measurements
+ * are made for a while, the RTO gradually returns towards ACK_TIMEOUT.
+ *
+ * The current state of the estimator is reported by @ref avs_coap_get_stats .
+ *
+ * Enabling the estimator resets it, so that the RTO is initially equal to
+ * ACK_TIMEOUT. It is disabled by default.
+ *
+ * @param ctx     CoAP/UDP context to operate on.
+ * @param enabled Whether the adaptive RTO shall be used.
+ *
+ * @returns 0 on success, or -1 if @p ctx is not a CoAP/UDP context created
+ *          by @ref avs_coap_udp_ctx_create.
+ */
+int avs_coap_udp_ctx_set_rtt_estimation(avs_coap_ctx_t *ctx, bool enabled);
+
+/** Single outgoing datagram, see @ref avs_coap_udp_batch_send_t . */
+typedef struct {
+    const void *data;
+    size_t size;
+} avs_coap_udp_datagram_t;
+
+/**
+ * Sends multiple datagrams at once, e.g. using sendmmsg() on the system socket
+ * underlying @p socket .
+ *
+ * @param socket       Socket of the CoAP/UDP context.
+ * @param datagrams    Datagrams to send, in order.
+ * @param count        Number of elements in @p datagrams .
+ * @param out_sent     Shall be set to the number of datagrams, counting from
+ *                     the beginning of @p datagrams , that have been sent.
+ * @param handler_arg  Opaque argument passed to
+ *                     @ref avs_coap_udp_ctx_set_batch_send_handler .
+ *
+ * @returns AVS_OK if all datagrams have been sent, or an error otherwise. In
+ *          the latter case, datagrams not accounted for in <c>*out_sent</c>
+ *          are sent one by one using avs_net_socket_send(), so returning an
+ *          error with <c>*out_sent == 0</c> is a valid way of declining to
+ *          handle a batch.
+ */
+typedef avs_error_t avs_coap_udp_batch_send_t(
+        avs_net_socket_t *socket,
+        const avs_coap_udp_datagram_t *datagrams,
+        size_t count,
+        size_t *out_sent,
+        void *handler_arg);
+
+/**
+ * Sets a handler used to send multiple outgoing datagrams at once.
+ *
+ * If a handler is set, datagrams sent by the context during a single run of
+ * its retransmission job (e.g. resumed messages held due to NSTART, and all
+ * retransmissions that are due), as well as between
+ * @ref avs_coap_udp_ctx_begin_batch and @ref avs_coap_udp_ctx_end_batch
+ * calls, are collected and passed to @p handler in chunks. Without a handler,
+ * all datagrams are sent immediately using avs_net_socket_send().
+ *
+ * NOTE: The handler receives serialized CoAP messages, not what is actually
+ * put on the wire by @p socket , so it SHOULD only be used with sockets that
+ * send the data as-is, e.g. ones without (D)TLS. If a Confirmable message
+ * cannot be sent, its exchange fails as usual; failures of other batched
+ * messages are only logged.
+ *
+ * @param ctx         CoAP/UDP context to operate on.
+ * @param handler     Batch send handler, or NULL to disable batching.
+ * @param handler_arg Opaque argument to pass to @p handler .
+ *
+ * @returns 0 on success, or -1 if @p ctx is not a CoAP/UDP context created
+ *          by @ref avs_coap_udp_ctx_create.
+ */
+int avs_coap_udp_ctx_set_batch_send_handler(avs_coap_ctx_t *ctx,
+                                            avs_coap_udp_batch_send_t *handler,
+                                            void *handler_arg);
+
+/**
+ * Starts collecting outgoing datagrams, so that they can be sent at once by
+ * @ref avs_coap_udp_ctx_end_batch . Calls may be nested. Has no effect if no
+ * batch send handler is set.
+ *
+ * @returns 0 on success, or -1 if @p ctx is not a CoAP/UDP context created
+ *          by @ref avs_coap_udp_ctx_create.
+ */
+int avs_coap_udp_ctx_begin_batch(avs_coap_ctx_t *ctx);
+
+/**
+ * Ends a batch started with @ref avs_coap_udp_ctx_begin_batch . When the
+ * outermost batch ends, all collected datagrams are sent.
+ *
+ * @returns 0 on success, or -1 if @p ctx is not a CoAP/UDP context created
+ *          by @ref avs_coap_udp_ctx_create or there is no batch in progress.
+ */
+int avs_coap_udp_ctx_end_batch(avs_coap_ctx_t *ctx);
+
 /**
  * Sets CoAP/UDP context transmission params.
  *
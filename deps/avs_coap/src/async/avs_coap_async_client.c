@@ -301,6 +301,8 @@ static void cleanup_exchange(avs_coap_ctx_t *ctx,
                "exchange must be detached");
     AVS_ASSERT(request_state.state != AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT,
                "cleanup_exchange must not be used for intermediate responses");
+    _avs_coap_exchange_index_remove(
+            &_avs_coap_get_base(ctx)->client_exchange_index, exchange);
 
     size_t response_payload_offset =
             final_msg ? get_response_payload_offset(final_msg) : 0;
@@ -715,8 +717,9 @@ client_exchange_send_all(avs_coap_ctx_t *ctx,
 
     if (*exchange_ptr_ptr) {
         if (avs_is_err(err)) {
-            cleanup_exchange(ctx, AVS_LIST_DETACH(*exchange_ptr_ptr), NULL,
-                             failure_state(err));
+            cleanup_exchange(ctx,
+                             _avs_coap_exchange_list_detach(*exchange_ptr_ptr),
+                             NULL, failure_state(err));
         } else {
             avs_coap_exchange_cancel(ctx, (**exchange_ptr_ptr)->id);
         }
@@ -749,9 +752,11 @@ client_exchange_start(avs_coap_ctx_t *ctx,
            && !_avs_coap_client_exchange_request_sent(*insert_ptr)) {
         AVS_LIST_ADVANCE_PTR(&insert_ptr);
     }
-    AVS_LIST_INSERT(insert_ptr, *exchange_ptr);
+    _avs_coap_exchange_list_insert(insert_ptr, *exchange_ptr);
     assert(*insert_ptr == *exchange_ptr);
     (*exchange_ptr)->id = _avs_coap_generate_exchange_id(ctx);
+    _avs_coap_exchange_index_insert(
+            &_avs_coap_get_base(ctx)->client_exchange_index, *exchange_ptr);
 
     avs_error_t err = AVS_OK;
     if ((*exchange_ptr)->by_type.client.handle_response) {
@@ -929,8 +934,8 @@ on_request_delivery_finished(avs_coap_ctx_t *ctx,
 
     assert(!exchange_ptr || *exchange_ptr);
     if (exchange_ptr) {
-        cleanup_exchange(ctx, AVS_LIST_DETACH(exchange_ptr), response,
-                         request_state);
+        cleanup_exchange(ctx, _avs_coap_exchange_list_detach(exchange_ptr),
+                         response, request_state);
     }
 
     return AVS_COAP_RESPONSE_ACCEPTED;
@@ -1061,7 +1066,12 @@ avs_error_t avs_coap_client_send_async_request(
                 // Not using _avs_coap_client_exchange_cleanup() or
                 // cleanup_exchange(), because this function's docs say that
                 // response_handler is not called on error.
-                AVS_LIST_DELETE(exchange_ptr);
+                _avs_coap_exchange_index_remove(
+                        &_avs_coap_get_base(ctx)->client_exchange_index,
+                        *exchange_ptr);
+                AVS_LIST(avs_coap_exchange_t) detached =
+                        _avs_coap_exchange_list_detach(exchange_ptr);
+                AVS_LIST_DELETE(&detached);
             }
         }
         return err;
@@ -1080,6 +1090,8 @@ void _avs_coap_client_exchange_cleanup(avs_coap_ctx_t *ctx,
                                   exchange),
                "exchange must be detached");
     assert(avs_coap_code_is_request(exchange->code));
+    _avs_coap_exchange_index_remove(
+            &_avs_coap_get_base(ctx)->client_exchange_index, exchange);
 
     if (_avs_coap_client_exchange_request_sent(exchange)) {
         ctx->vtable->abort_delivery(ctx, AVS_COAP_EXCHANGE_CLIENT_REQUEST,
@@ -331,8 +331,8 @@ send_result_handler(avs_coap_ctx_t *ctx,
 
     // make sure we won't call the handler again during exchange cleanup
     (*exchange_ptr)->by_type.server.delivery_handler = NULL;
-    _avs_coap_server_exchange_cleanup(ctx, AVS_LIST_DETACH(exchange_ptr),
-                                      fail_err);
+    _avs_coap_server_exchange_cleanup(
+            ctx, _avs_coap_exchange_list_detach(exchange_ptr), fail_err);
 
     return AVS_COAP_RESPONSE_ACCEPTED;
 }
@@ -393,8 +393,8 @@ server_exchange_send_next_chunk(avs_coap_ctx_t *ctx,
     exchange_ptr = _avs_coap_find_server_exchange_ptr_by_id(ctx, id);
 
     if (exchange_ptr && is_exchange_done(*exchange_ptr)) {
-        _avs_coap_server_exchange_cleanup(ctx, AVS_LIST_DETACH(exchange_ptr),
-                                          AVS_OK);
+        _avs_coap_server_exchange_cleanup(
+                ctx, _avs_coap_exchange_list_detach(exchange_ptr), AVS_OK);
     }
     return err;
 }
@@ -412,7 +412,8 @@ _avs_coap_async_server_abort_timedout_exchanges(avs_coap_ctx_t *ctx) {
             AVS_UINT64_AS_STRING(coap_base->server_exchanges->id.value));
 
         _avs_coap_server_exchange_cleanup(
-                ctx, AVS_LIST_DETACH(&coap_base->server_exchanges),
+                ctx,
+                _avs_coap_exchange_list_detach(&coap_base->server_exchanges),
                 _avs_coap_err(AVS_COAP_ERR_TIMEOUT));
     }
 
@@ -435,7 +436,7 @@ insert_server_exchange(avs_coap_ctx_t *ctx, avs_coap_exchange_t *new_exchange) {
         }
     }
 
-    AVS_LIST_INSERT(insert_ptr, new_exchange);
+    _avs_coap_exchange_list_insert(insert_ptr, new_exchange);
     _avs_coap_reschedule_retry_or_request_expired_job(
             ctx, coap_base->server_exchanges->by_type.server.exchange_deadline);
 
@@ -447,7 +448,8 @@ refresh_exchange(avs_coap_ctx_t *ctx,
                  AVS_LIST(avs_coap_exchange_t) *exchange_ptr) {
     (*exchange_ptr)->by_type.server.exchange_deadline =
             get_exchange_deadline(ctx);
-    return insert_server_exchange(ctx, AVS_LIST_DETACH(exchange_ptr));
+    return insert_server_exchange(ctx,
+                                  _avs_coap_exchange_list_detach(exchange_ptr));
 }
 
 avs_coap_exchange_id_t avs_coap_server_accept_async_request(
@@ -499,6 +501,9 @@ avs_coap_exchange_id_t avs_coap_server_accept_async_request(
 
     ctx->exchange_id = id;
     insert_server_exchange(ctx->coap_ctx, response_exchange);
+    _avs_coap_exchange_index_insert(
+            &_avs_coap_get_base(ctx->coap_ctx)->server_exchange_index,
+            response_exchange);
 
     return ctx->exchange_id;
 }
@@ -593,8 +598,14 @@ avs_coap_server_setup_async_response(avs_coap_request_ctx_t *ctx,
     //
     // Deleting the old exchange only if we're sure we have a new copy seems
     // the most robust solution.
-    AVS_LIST_DELETE(response_exchange_ptr);
+    avs_coap_hash_index_t *index =
+            &_avs_coap_get_base(coap_ctx)->server_exchange_index;
+    AVS_LIST(avs_coap_exchange_t) old_exchange =
+            _avs_coap_exchange_list_detach(response_exchange_ptr);
+    _avs_coap_exchange_index_remove(index, old_exchange);
+    AVS_LIST_DELETE(&old_exchange);
     insert_server_exchange(coap_ctx, new_exchange);
+    _avs_coap_exchange_index_insert(index, new_exchange);
 
     ctx->response_setup = true;
     return AVS_OK;
@@ -941,8 +952,8 @@ static void cleanup_exchange_by_id(avs_coap_ctx_t *ctx,
     AVS_LIST(avs_coap_exchange_t) *exchange_ptr =
             _avs_coap_find_server_exchange_ptr_by_id(ctx, exchange_id);
     if (exchange_ptr) {
-        _avs_coap_server_exchange_cleanup(ctx, AVS_LIST_DETACH(exchange_ptr),
-                                          err);
+        _avs_coap_server_exchange_cleanup(
+                ctx, _avs_coap_exchange_list_detach(exchange_ptr), err);
     }
 }
 
@@ -1192,13 +1203,17 @@ avs_error_t _avs_coap_async_incoming_packet_handle_and_exhaust_socket(
                                    })))) {
         return err;
     }
+    size_t packets_handled = 0;
     while (avs_is_ok(err)) {
         err = _avs_coap_async_incoming_packet_simple_handle_single(
                 ctx, in_buffer, in_buffer_size, on_new_request,
                 on_new_request_arg);
-        if (avs_is_ok(err) && _avs_coap_socket_definitely_exhausted(ctx)) {
-            // We can conclusively say that the socket is already exhausted,
-            // so no need to try receiving more packets.
+        if (avs_is_ok(err)
+                && _avs_coap_incoming_packets_exhausted(ctx,
+                                                        ++packets_handled)) {
+            // We can conclusively say that the socket is already exhausted
+            // (or the drain limit has been reached), so no need to try
+            // receiving more packets.
             break;
         }
     }
@@ -1239,6 +1254,8 @@ void _avs_coap_server_exchange_cleanup(avs_coap_ctx_t *ctx,
     AVS_ASSERT(!AVS_LIST_FIND_PTR(&coap_base->server_exchanges, exchange),
                "exchange must be detached");
     assert(avs_coap_code_is_response(exchange->code));
+    _avs_coap_exchange_index_remove(&coap_base->server_exchange_index,
+                                    exchange);
 
     avs_coap_server_exchange_data_t *server = &exchange->by_type.server;
 
@@ -1361,7 +1378,9 @@ avs_coap_notify_async(avs_coap_ctx_t *ctx,
 
     avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
 
-    AVS_LIST_INSERT(&coap_base->server_exchanges, exchange);
+    _avs_coap_exchange_list_insert(&coap_base->server_exchanges, exchange);
+    _avs_coap_exchange_index_insert(&coap_base->server_exchange_index,
+                                    exchange);
 
     if (reliability_hint == AVS_COAP_NOTIFY_PREFER_NON_CONFIRMABLE) {
         cancel_notification_on_error(ctx, observe_id, response_header->code);
@@ -1378,7 +1397,10 @@ avs_coap_notify_async(avs_coap_ctx_t *ctx,
         if (exchange_ptr) {
             // Not using _avs_coap_server_exchange_cleanup(), because this
             // function's docs say that delivery_handler is not called on error.
-            AVS_LIST_DELETE(exchange_ptr);
+            _avs_coap_exchange_index_remove(&coap_base->server_exchange_index,
+                                            *exchange_ptr);
+            exchange = _avs_coap_exchange_list_detach(exchange_ptr);
+            AVS_LIST_DELETE(&exchange);
         }
         return err;
     }
@@ -236,7 +236,7 @@ avs_error_t _avs_coap_async_incoming_packet_simple_handle_single(
  * until there is no more data to be received on the socket.
  *
  * The stop condition is checked either using
- * @ref _avs_coap_socket_definitely_exhausted (the loop stops if that function
+ * @ref _avs_coap_incoming_packets_exhausted (the loop stops if that function
  * returns true) or by waiting for the socket receive operation to time out
  * (while the receive timeout is set to zero).
  *
@@ -34,6 +34,15 @@ typedef struct avs_coap_exchange {
     /** Unique ID used to identify an exchange in user code. */
     avs_coap_exchange_id_t id;
 
+    /**
+     * Link that points to this exchange while it is stored in a list - either
+     * the list head, or the next pointer of the preceding element. Allows
+     * detaching the exchange without walking the list. Maintained by
+     * @ref _avs_coap_exchange_list_insert and
+     * @ref _avs_coap_exchange_list_detach .
+     */
+    struct avs_coap_exchange **list_link;
+
     /** User-defined handler used to provide payload for sent message. */
     avs_coap_payload_writer_t *write_payload;
     void *write_payload_arg;
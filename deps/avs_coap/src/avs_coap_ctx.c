@@ -61,7 +61,10 @@ void avs_coap_ctx_cleanup(avs_coap_ctx_t **ctx) {
         while (coap_base->observes) {
             avs_coap_observe_cancel(*ctx, coap_base->observes->id);
         }
+        _avs_coap_hash_index_cleanup(&coap_base->observe_index);
 #endif // WITH_AVS_COAP_OBSERVE
+        _avs_coap_hash_index_cleanup(&coap_base->client_exchange_index);
+        _avs_coap_hash_index_cleanup(&coap_base->server_exchange_index);
 #ifdef WITH_AVS_COAP_STREAMING_API
         _avs_coap_stream_cleanup(&coap_base->coap_stream);
 #endif // WITH_AVS_COAP_STREAMING_API
@@ -95,9 +98,60 @@ avs_error_t _avs_coap_ctx_generate_token(avs_crypto_prng_ctx_t *prng_ctx,
     return AVS_OK;
 }
 
+static uint32_t hash_exchange_id(avs_coap_exchange_id_t id) {
+    return _avs_coap_hash_u64(id.value);
+}
+
+static bool exchange_id_matches(const void *exchange, const void *id) {
+    return avs_coap_exchange_id_equal(
+            ((const avs_coap_exchange_t *) exchange)->id,
+            *(const avs_coap_exchange_id_t *) id);
+}
+
+void _avs_coap_exchange_index_insert(avs_coap_hash_index_t *index,
+                                     avs_coap_exchange_t *exchange) {
+    assert(avs_coap_exchange_id_valid(exchange->id));
+    _avs_coap_hash_index_insert(index, hash_exchange_id(exchange->id),
+                                exchange);
+}
+
+void _avs_coap_exchange_index_remove(avs_coap_hash_index_t *index,
+                                     const avs_coap_exchange_t *exchange) {
+    _avs_coap_hash_index_remove(index, hash_exchange_id(exchange->id),
+                                exchange);
+}
+
+void _avs_coap_exchange_list_insert(
+        AVS_LIST(avs_coap_exchange_t) *insert_ptr,
+        AVS_LIST(avs_coap_exchange_t) exchange) {
+    assert(!AVS_LIST_NEXT(exchange));
+    AVS_LIST_INSERT(insert_ptr, exchange);
+    exchange->list_link = insert_ptr;
+    if (AVS_LIST_NEXT(exchange)) {
+        AVS_LIST_NEXT(exchange)->list_link = &AVS_LIST_NEXT(exchange);
+    }
+}
+
+AVS_LIST(avs_coap_exchange_t)
+_avs_coap_exchange_list_detach(AVS_LIST(avs_coap_exchange_t) *exchange_ptr) {
+    AVS_LIST(avs_coap_exchange_t) exchange = AVS_LIST_DETACH(exchange_ptr);
+    if (*exchange_ptr) {
+        (*exchange_ptr)->list_link = exchange_ptr;
+    }
+    exchange->list_link = NULL;
+    return exchange;
+}
+
 AVS_LIST(avs_coap_exchange_t) *
 _avs_coap_find_exchange_ptr_by_id(AVS_LIST(avs_coap_exchange_t) *list_ptr,
+                                  const avs_coap_hash_index_t *index,
                                   avs_coap_exchange_id_t id) {
+    void *exchange;
+    if (!_avs_coap_hash_index_find(index, hash_exchange_id(id),
+                                   exchange_id_matches, &id, &exchange)) {
+        return exchange ? ((avs_coap_exchange_t *) exchange)->list_link : NULL;
+    }
+
     AVS_LIST(avs_coap_exchange_t) *it;
     AVS_LIST_FOREACH_PTR(it, list_ptr) {
         if (avs_coap_exchange_id_equal(id, (*it)->id)) {
@@ -107,6 +161,20 @@ _avs_coap_find_exchange_ptr_by_id(AVS_LIST(avs_coap_exchange_t) *list_ptr,
     return NULL;
 }
 
+AVS_LIST(avs_coap_exchange_t)
+_avs_coap_find_exchange_in_index(AVS_LIST(avs_coap_exchange_t) list,
+                                 const avs_coap_hash_index_t *index,
+                                 avs_coap_exchange_id_t id) {
+    void *exchange;
+    if (!_avs_coap_hash_index_find(index, hash_exchange_id(id),
+                                   exchange_id_matches, &id, &exchange)) {
+        return (AVS_LIST(avs_coap_exchange_t)) exchange;
+    }
+    AVS_LIST(avs_coap_exchange_t) *exchange_ptr =
+            _avs_coap_find_exchange_ptr_by_id(&list, index, id);
+    return exchange_ptr ? *exchange_ptr : NULL;
+}
+
 void avs_coap_exchange_cancel(avs_coap_ctx_t *ctx, avs_coap_exchange_id_t id) {
     if (!avs_coap_exchange_id_valid(id)) {
         return;
@@ -116,15 +184,15 @@ void avs_coap_exchange_cancel(avs_coap_ctx_t *ctx, avs_coap_exchange_id_t id) {
 
     exchange_ptr = _avs_coap_find_client_exchange_ptr_by_id(ctx, id);
     if (exchange_ptr) {
-        _avs_coap_client_exchange_cleanup(ctx, AVS_LIST_DETACH(exchange_ptr),
-                                          AVS_OK);
+        _avs_coap_client_exchange_cleanup(
+                ctx, _avs_coap_exchange_list_detach(exchange_ptr), AVS_OK);
         return;
     }
 
     exchange_ptr = _avs_coap_find_server_exchange_ptr_by_id(ctx, id);
     if (exchange_ptr) {
         _avs_coap_server_exchange_cleanup(
-                ctx, AVS_LIST_DETACH(exchange_ptr),
+                ctx, _avs_coap_exchange_list_detach(exchange_ptr),
                 _avs_coap_err(AVS_COAP_ERR_EXCHANGE_CANCELED));
     }
 }
@@ -256,7 +324,8 @@ _avs_coap_retry_or_request_expired_job(avs_coap_ctx_t *ctx) {
                                                            &exchange_ptr_copy);
         if (avs_is_err(err) && exchange_ptr_copy) {
             _avs_coap_client_exchange_cleanup(
-                    ctx, AVS_LIST_DETACH(exchange_ptr_copy), err);
+                    ctx, _avs_coap_exchange_list_detach(exchange_ptr_copy),
+                    err);
             exchange_ptr_copy = NULL;
         }
         if (exchange_ptr_copy) {
@@ -328,6 +397,15 @@ void avs_coap_set_exchange_max_time(avs_coap_ctx_t *ctx,
     base->max_exchange_update_time = time;
 }
 
+size_t avs_coap_get_incoming_packets_drain_limit(avs_coap_ctx_t *ctx) {
+    return _avs_coap_get_base(ctx)->incoming_packets_drain_limit;
+}
+
+void avs_coap_set_incoming_packets_drain_limit(avs_coap_ctx_t *ctx,
+                                               size_t limit) {
+    _avs_coap_get_base(ctx)->incoming_packets_drain_limit = limit;
+}
+
 #ifdef WITH_AVS_COAP_BLOCK
 static avs_error_t get_payload_chunk_size(avs_coap_ctx_t *ctx,
                                           uint8_t code,
@@ -421,6 +499,18 @@ bool _avs_coap_socket_definitely_exhausted(avs_coap_ctx_t *ctx) {
            && !has_buffered_data.flag;
 }
 
+bool _avs_coap_incoming_packets_exhausted(avs_coap_ctx_t *ctx,
+                                          size_t packets_handled) {
+    if (!_avs_coap_socket_definitely_exhausted(ctx)) {
+        return false;
+    }
+    // The socket layer may not know about data queued in the OS (this is
+    // always the case for plain UDP sockets), so if draining is enabled, keep
+    // receiving until the receive operation times out or the limit is reached.
+    return packets_handled >= _avs_coap_get_base(ctx)
+                                      ->incoming_packets_drain_limit;
+}
+
 avs_coap_stats_t avs_coap_get_stats(avs_coap_ctx_t *ctx) {
     if (ctx->vtable->get_stats) {
         return ctx->vtable->get_stats(ctx);
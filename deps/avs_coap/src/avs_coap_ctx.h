@@ -28,6 +28,8 @@
 
 #include "async/avs_coap_async_server.h"
 
+#include "avs_coap_hash_index.h"
+
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
 static inline avs_error_t _avs_coap_err(avs_coap_error_t error) {
@@ -64,15 +66,24 @@ struct avs_coap_base {
      */
     AVS_LIST(struct avs_coap_exchange) client_exchanges;
 
+    /** Elements of @ref client_exchanges, indexed by exchange ID. */
+    avs_coap_hash_index_t client_exchange_index;
+
     /**
      * All unfinished asynchronous request exchanges initiated by remote CoAP
      * client (incoming requests/outgoing responses).
      */
     AVS_LIST(struct avs_coap_exchange) server_exchanges;
 
+    /** Elements of @ref server_exchanges, indexed by exchange ID. */
+    avs_coap_hash_index_t server_exchange_index;
+
 #ifdef WITH_AVS_COAP_OBSERVE
     /** Active observations. */
     AVS_LIST(avs_coap_observe_t) observes;
+
+    /** Elements of @ref observes, indexed by token. */
+    avs_coap_hash_index_t observe_index;
 #endif // WITH_AVS_COAP_OBSERVE
 
     /** PRNG context. */
@@ -92,6 +103,14 @@ struct avs_coap_base {
     /* Maximum allowed time between the CoAP exchange updates */
     avs_time_duration_t max_exchange_update_time;
 
+    /**
+     * Number of packets a single call to a handle_incoming_packet function
+     * keeps receiving for, even if the socket does not report any buffered
+     * data. 0 disables draining. See
+     * @ref avs_coap_set_incoming_packets_drain_limit .
+     */
+    size_t incoming_packets_drain_limit;
+
     /**
      * Scheduler job used to detect cases where the remote host lost interest
      * in a block-wise request before it completed, or to handle any
@@ -142,7 +161,13 @@ static inline void _avs_coap_base_init(avs_coap_base_t *base,
                                        avs_crypto_prng_ctx_t *prng_ctx) {
     base->last_exchange_id = AVS_COAP_EXCHANGE_ID_INVALID;
     base->client_exchanges = NULL;
+    base->client_exchange_index = (avs_coap_hash_index_t) { 0 };
     base->server_exchanges = NULL;
+    base->server_exchange_index = (avs_coap_hash_index_t) { 0 };
+#ifdef WITH_AVS_COAP_OBSERVE
+    base->observes = NULL;
+    base->observe_index = (avs_coap_hash_index_t) { 0 };
+#endif // WITH_AVS_COAP_OBSERVE
     base->prng_ctx = prng_ctx;
     base->socket = NULL;
     base->in_buffer = in_buffer;
@@ -181,60 +206,91 @@ _avs_coap_generate_exchange_id(avs_coap_ctx_t *ctx) {
     return coap_base->last_exchange_id;
 }
 
+/**
+ * Adds @p exchange, which MUST have its ID already assigned, to @p index.
+ * Needs to be called whenever a new exchange is added to the corresponding
+ * list. Moving an exchange within the list does not require updating the
+ * index.
+ */
+void _avs_coap_exchange_index_insert(avs_coap_hash_index_t *index,
+                                     struct avs_coap_exchange *exchange);
+
+/**
+ * Removes @p exchange from @p index. Needs to be called whenever an exchange is
+ * permanently removed from the corresponding list.
+ */
+void _avs_coap_exchange_index_remove(avs_coap_hash_index_t *index,
+                                     const struct avs_coap_exchange *exchange);
+
+/**
+ * Inserts @p exchange into an exchange list at @p insert_ptr, like
+ * AVS_LIST_INSERT() does. Exchange lists MUST only be modified using this
+ * function and @ref _avs_coap_exchange_list_detach , so that the link pointing
+ * to each exchange is known without walking the list.
+ */
+void _avs_coap_exchange_list_insert(
+        AVS_LIST(struct avs_coap_exchange) *insert_ptr,
+        AVS_LIST(struct avs_coap_exchange) exchange);
+
+/**
+ * Detaches the exchange pointed to by @p exchange_ptr from its list, like
+ * AVS_LIST_DETACH() does.
+ */
+AVS_LIST(struct avs_coap_exchange)
+_avs_coap_exchange_list_detach(AVS_LIST(struct avs_coap_exchange) *exchange_ptr);
+
+/**
+ * Returns the link that points to the exchange with a given @p id, or NULL if
+ * there is none. Runs in constant time, unless @p index is degraded.
+ */
 AVS_LIST(struct avs_coap_exchange) *
 _avs_coap_find_exchange_ptr_by_id(AVS_LIST(struct avs_coap_exchange) *list_ptr,
+                                  const avs_coap_hash_index_t *index,
                                   avs_coap_exchange_id_t id);
 
-AVS_LIST(struct avs_coap_exchange) *_avs_coap_find_exchange_ptr_by_token(
-        AVS_LIST(struct avs_coap_exchange) *list_ptr,
-        const avs_coap_token_t *token);
+AVS_LIST(struct avs_coap_exchange)
+_avs_coap_find_exchange_in_index(AVS_LIST(struct avs_coap_exchange) list,
+                                 const avs_coap_hash_index_t *index,
+                                 avs_coap_exchange_id_t id);
 
 static inline AVS_LIST(struct avs_coap_exchange) *
 _avs_coap_find_client_exchange_ptr_by_id(avs_coap_ctx_t *ctx,
                                          avs_coap_exchange_id_t id) {
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
     return _avs_coap_find_exchange_ptr_by_id(
-            &_avs_coap_get_base(ctx)->client_exchanges, id);
+            &coap_base->client_exchanges, &coap_base->client_exchange_index,
+            id);
 }
 
 static inline AVS_LIST(struct avs_coap_exchange) *
 _avs_coap_find_server_exchange_ptr_by_id(avs_coap_ctx_t *ctx,
                                          avs_coap_exchange_id_t id) {
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
     return _avs_coap_find_exchange_ptr_by_id(
-            &_avs_coap_get_base(ctx)->server_exchanges, id);
+            &coap_base->server_exchanges, &coap_base->server_exchange_index,
+            id);
 }
 
 static inline AVS_LIST(struct avs_coap_exchange)
 _avs_coap_find_client_exchange_by_id(avs_coap_ctx_t *ctx,
                                      avs_coap_exchange_id_t id) {
-    AVS_LIST(struct avs_coap_exchange) *ptr =
-            _avs_coap_find_client_exchange_ptr_by_id(ctx, id);
-    if (ptr) {
-        return *ptr;
-    }
-    return NULL;
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
+    return _avs_coap_find_exchange_in_index(
+            coap_base->client_exchanges, &coap_base->client_exchange_index, id);
 }
 
 static inline AVS_LIST(struct avs_coap_exchange)
 _avs_coap_find_server_exchange_by_id(avs_coap_ctx_t *ctx,
                                      avs_coap_exchange_id_t id) {
-    AVS_LIST(struct avs_coap_exchange) *ptr =
-            _avs_coap_find_server_exchange_ptr_by_id(ctx, id);
-    if (ptr) {
-        return *ptr;
-    }
-    return NULL;
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
+    return _avs_coap_find_exchange_in_index(
+            coap_base->server_exchanges, &coap_base->server_exchange_index, id);
 }
 
 #ifdef WITH_AVS_COAP_OBSERVE
 static inline bool _avs_coap_is_observe(avs_coap_ctx_t *ctx,
                                         const avs_coap_token_t *token) {
-    AVS_LIST(avs_coap_observe_t) it;
-    AVS_LIST_FOREACH(it, _avs_coap_get_base(ctx)->observes) {
-        if (avs_coap_token_equal(&it->id.token, token)) {
-            return true;
-        }
-    }
-    return false;
+    return _avs_coap_observe_find_by_token(ctx, token) != NULL;
 }
 #endif // WITH_AVS_COAP_OBSERVE
 
@@ -341,6 +341,19 @@ typedef struct avs_coap_ctx_vtable {
  */
 bool _avs_coap_socket_definitely_exhausted(avs_coap_ctx_t *ctx);
 
+/**
+ * Checks whether a loop that receives incoming packets until the socket is
+ * exhausted may stop after having handled @p packets_handled packets.
+ *
+ * Returns false if @ref _avs_coap_socket_definitely_exhausted does, or if
+ * fewer packets than configured with
+ * @ref avs_coap_set_incoming_packets_drain_limit have been handled so far -
+ * in which case the loop shall continue until the receive operation (with
+ * zero timeout) times out.
+ */
+bool _avs_coap_incoming_packets_exhausted(avs_coap_ctx_t *ctx,
+                                          size_t packets_handled);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif // AVS_COAP_SRC_CTX_VTABLE_H
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2017-2023 AVSystem <avsystem@avsystem.com>
+ * AVSystem CoAP library
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avs_coap_init.h>
+
+#include <assert.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_memory.h>
+
+#define MODULE_NAME coap
+#include <avs_coap_x_log_config.h>
+
+#include "avs_coap_hash_index.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#define MIN_CAPACITY 16
+
+// Address of this variable marks slots of removed elements, so that probe
+// sequences passing through them are not broken
+static char REMOVED_MARKER;
+#define REMOVED ((void *) &REMOVED_MARKER)
+
+uint32_t _avs_coap_hash_bytes(const void *data, size_t size) {
+    // 32-bit FNV-1a
+    const uint8_t *bytes = (const uint8_t *) data;
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+uint32_t _avs_coap_hash_u64(uint64_t value) {
+    // finalizer of MurmurHash3
+    value ^= value >> 33;
+    value *= UINT64_C(0xff51afd7ed558ccd);
+    value ^= value >> 33;
+    value *= UINT64_C(0xc4ceb9fe1a85ec53);
+    value ^= value >> 33;
+    return (uint32_t) value;
+}
+
+static void place_element(avs_coap_hash_index_t *index,
+                          uint32_t hash,
+                          void *element) {
+    assert(index->capacity);
+    const size_t mask = index->capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        avs_coap_hash_index_slot_t *slot = &index->slots[i];
+        if (!slot->element || slot->element == REMOVED) {
+            if (!slot->element) {
+                ++index->used;
+            }
+            slot->hash = hash;
+            slot->element = element;
+            ++index->count;
+            return;
+        }
+    }
+}
+
+static int rehash(avs_coap_hash_index_t *index, size_t new_capacity) {
+    avs_coap_hash_index_slot_t *new_slots = (avs_coap_hash_index_slot_t *)
+            avs_calloc(new_capacity, sizeof(*new_slots));
+    if (!new_slots) {
+        return -1;
+    }
+    avs_coap_hash_index_slot_t *old_slots = index->slots;
+    const size_t old_capacity = index->capacity;
+    index->slots = new_slots;
+    index->capacity = new_capacity;
+    index->count = 0;
+    index->used = 0;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_slots[i].element && old_slots[i].element != REMOVED) {
+            place_element(index, old_slots[i].hash, old_slots[i].element);
+        }
+    }
+    avs_free(old_slots);
+    return 0;
+}
+
+static int reserve_slot(avs_coap_hash_index_t *index) {
+    // keep the load factor, including removed markers, at most 3/4
+    if (4 * (index->used + 1) <= 3 * index->capacity) {
+        return 0;
+    }
+    size_t new_capacity = index->capacity ? index->capacity : MIN_CAPACITY;
+    // if most of the used slots are removed markers, rehashing into a table of
+    // the same size is enough to get rid of them
+    while (2 * (index->count + 1) > new_capacity) {
+        new_capacity *= 2;
+    }
+    return rehash(index, new_capacity);
+}
+
+int _avs_coap_hash_index_find_next(const avs_coap_hash_index_t *index,
+                                   uint32_t hash,
+                                   avs_coap_hash_index_match_t *match,
+                                   const void *key,
+                                   size_t *inout_cursor,
+                                   void **out_element) {
+    if (index->degraded) {
+        return -1;
+    }
+    *out_element = NULL;
+    if (!index->count) {
+        return 0;
+    }
+    const size_t mask = index->capacity - 1;
+    // *inout_cursor is the number of slots in the probe sequence that have
+    // already been visited
+    for (size_t offset = *inout_cursor; offset < index->capacity; ++offset) {
+        const avs_coap_hash_index_slot_t *slot =
+                &index->slots[(hash + offset) & mask];
+        if (!slot->element) {
+            break;
+        }
+        if (slot->element != REMOVED && slot->hash == hash
+                && match(slot->element, key)) {
+            *inout_cursor = offset + 1;
+            *out_element = slot->element;
+            return 0;
+        }
+    }
+    *inout_cursor = index->capacity;
+    return 0;
+}
+
+int _avs_coap_hash_index_find(const avs_coap_hash_index_t *index,
+                              uint32_t hash,
+                              avs_coap_hash_index_match_t *match,
+                              const void *key,
+                              void **out_element) {
+    size_t cursor = 0;
+    return _avs_coap_hash_index_find_next(index, hash, match, key, &cursor,
+                                          out_element);
+}
+
+void _avs_coap_hash_index_insert(avs_coap_hash_index_t *index,
+                                 uint32_t hash,
+                                 void *element) {
+    assert(element && element != REMOVED);
+    if (index->degraded) {
+        return;
+    }
+    if (reserve_slot(index)) {
+        LOG(WARNING, _("out of memory, falling back to linear lookups"));
+        _avs_coap_hash_index_cleanup(index);
+        index->degraded = true;
+        return;
+    }
+    place_element(index, hash, element);
+}
+
+void _avs_coap_hash_index_remove(avs_coap_hash_index_t *index,
+                                 uint32_t hash,
+                                 const void *element) {
+    if (index->degraded || !index->count) {
+        return;
+    }
+    const size_t mask = index->capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        avs_coap_hash_index_slot_t *slot = &index->slots[i];
+        if (!slot->element) {
+            return;
+        }
+        if (slot->element == element) {
+            slot->element = REMOVED;
+            if (!--index->count) {
+                // no live elements, so all removed markers can be dropped
+                memset(index->slots, 0,
+                       index->capacity * sizeof(*index->slots));
+                index->used = 0;
+            }
+            return;
+        }
+    }
+}
+
+void _avs_coap_hash_index_cleanup(avs_coap_hash_index_t *index) {
+    avs_free(index->slots);
+    *index = (avs_coap_hash_index_t) { 0 };
+}
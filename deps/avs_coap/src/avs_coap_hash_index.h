@@ -0,0 +1,99 @@
+/*
+ * Copyright 2017-2023 AVSystem <avsystem@avsystem.com>
+ * AVSystem CoAP library
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef AVS_COAP_SRC_HASH_INDEX_H
+#define AVS_COAP_SRC_HASH_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+typedef struct {
+    uint32_t hash;
+    // NULL for empty slots
+    void *element;
+} avs_coap_hash_index_slot_t;
+
+/**
+ * Open-addressing (linear probing) hash table of pointers to elements stored
+ * elsewhere, usually in an AVS_LIST. The index does not own the elements and
+ * does not know anything about their keys - the caller provides a hash of the
+ * key on each operation, and a predicate to compare keys on lookups.
+ *
+ * If memory allocation fails when growing the table, the index switches to a
+ * degraded state, in which it no longer tracks anything, and lookups report
+ * that the caller shall fall back to a linear search.
+ */
+typedef struct {
+    avs_coap_hash_index_slot_t *slots;
+    // Always zero or a power of two
+    size_t capacity;
+    // Number of live elements
+    size_t count;
+    // Number of live elements and removed markers
+    size_t used;
+    bool degraded;
+} avs_coap_hash_index_t;
+
+typedef bool avs_coap_hash_index_match_t(const void *element, const void *key);
+
+uint32_t _avs_coap_hash_bytes(const void *data, size_t size);
+
+uint32_t _avs_coap_hash_u64(uint64_t value);
+
+/**
+ * Looks up an element for which @p match returns true.
+ *
+ * @returns 0 on success, in which case @p out_element is set to the element
+ *          found or NULL if there is none, or -1 if the index is degraded and
+ *          the caller needs to perform a linear search instead.
+ */
+int _avs_coap_hash_index_find(const avs_coap_hash_index_t *index,
+                              uint32_t hash,
+                              avs_coap_hash_index_match_t *match,
+                              const void *key,
+                              void **out_element);
+
+/**
+ * Iterates over all elements for which @p match returns true, in unspecified
+ * order. @p inout_cursor MUST be set to 0 before the first call and left
+ * intact between calls. The index MUST NOT be modified during the iteration.
+ *
+ * @returns Same as @ref _avs_coap_hash_index_find ; @p out_element is set to
+ *          NULL once there are no more matching elements.
+ */
+int _avs_coap_hash_index_find_next(const avs_coap_hash_index_t *index,
+                                   uint32_t hash,
+                                   avs_coap_hash_index_match_t *match,
+                                   const void *key,
+                                   size_t *inout_cursor,
+                                   void **out_element);
+
+/**
+ * Adds @p element to the index. The element MUST NOT be already present.
+ */
+void _avs_coap_hash_index_insert(avs_coap_hash_index_t *index,
+                                 uint32_t hash,
+                                 void *element);
+
+/**
+ * Removes @p element from the index, if present. Elements are compared by
+ * address. @p hash MUST be the same as the one passed when inserting.
+ */
+void _avs_coap_hash_index_remove(avs_coap_hash_index_t *index,
+                                 uint32_t hash,
+                                 const void *element);
+
+void _avs_coap_hash_index_cleanup(avs_coap_hash_index_t *index);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif // AVS_COAP_SRC_HASH_INDEX_H
@@ -59,10 +59,41 @@ create_observe(avs_coap_observe_id_t id,
     return observe;
 }
 
+static uint32_t hash_token(const avs_coap_token_t *token) {
+    return _avs_coap_hash_bytes(token->bytes, token->size);
+}
+
+static bool observe_token_matches(const void *element, const void *token) {
+    const avs_coap_observe_t *observe = (const avs_coap_observe_t *) element;
+    return avs_coap_token_equal(&observe->id.token,
+                                (const avs_coap_token_t *) token);
+}
+
+static void insert_observe(avs_coap_ctx_t *ctx,
+                           AVS_LIST(avs_coap_observe_t) observe) {
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
+    AVS_LIST_INSERT(&coap_base->observes, observe);
+    observe->list_link = &coap_base->observes;
+    if (AVS_LIST_NEXT(observe)) {
+        AVS_LIST_NEXT(observe)->list_link = &AVS_LIST_NEXT(observe);
+    }
+    _avs_coap_hash_index_insert(&coap_base->observe_index,
+                                hash_token(&observe->id.token), observe);
+}
+
 static AVS_LIST(avs_coap_observe_t) *
 find_observe_ptr_by_id(avs_coap_ctx_t *ctx, const avs_coap_observe_id_t *id) {
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
+    void *observe;
+    if (!_avs_coap_hash_index_find(&coap_base->observe_index,
+                                   hash_token(&id->token),
+                                   observe_token_matches, &id->token,
+                                   &observe)) {
+        return observe ? ((avs_coap_observe_t *) observe)->list_link : NULL;
+    }
+
     AVS_LIST(avs_coap_observe_t) *observe_ptr;
-    AVS_LIST_FOREACH_PTR(observe_ptr, &_avs_coap_get_base(ctx)->observes) {
+    AVS_LIST_FOREACH_PTR(observe_ptr, &coap_base->observes) {
         if (avs_coap_token_equal(&(*observe_ptr)->id.token, &id->token)) {
             return observe_ptr;
         }
@@ -101,16 +132,31 @@ avs_coap_observe_start(avs_coap_ctx_t *ctx,
 
     LOG(DEBUG, _("Observe start: ") "%s", AVS_COAP_TOKEN_HEX(&id.token));
 
-    AVS_LIST_INSERT(&_avs_coap_get_base(ctx)->observes, observe);
+    insert_observe(ctx, observe);
     return AVS_OK;
 }
 
 static avs_coap_observe_t *find_observe_by_id(avs_coap_ctx_t *ctx,
                                               const avs_coap_observe_id_t *id) {
+    void *observe;
+    if (!_avs_coap_hash_index_find(&_avs_coap_get_base(ctx)->observe_index,
+                                   hash_token(&id->token),
+                                   observe_token_matches, &id->token,
+                                   &observe)) {
+        return (avs_coap_observe_t *) observe;
+    }
     AVS_LIST(avs_coap_observe_t) *observe_ptr = find_observe_ptr_by_id(ctx, id);
     return observe_ptr ? *observe_ptr : NULL;
 }
 
+avs_coap_observe_t *_avs_coap_observe_find_by_token(
+        avs_coap_ctx_t *ctx, const avs_coap_token_t *token) {
+    const avs_coap_observe_id_t id = {
+        .token = *token
+    };
+    return find_observe_by_id(ctx, &id);
+}
+
 avs_error_t
 _avs_coap_observe_setup_notify(avs_coap_ctx_t *ctx,
                                const avs_coap_observe_id_t *id,
@@ -147,6 +193,11 @@ avs_error_t avs_coap_observe_cancel(avs_coap_ctx_t *ctx,
     LOG(DEBUG, _("Observe cancel: ") "%s", AVS_COAP_TOKEN_HEX(&id.token));
 
     avs_coap_observe_t *observe = AVS_LIST_DETACH(observe_ptr);
+    if (*observe_ptr) {
+        (*observe_ptr)->list_link = observe_ptr;
+    }
+    _avs_coap_hash_index_remove(&_avs_coap_get_base(ctx)->observe_index,
+                                hash_token(&observe->id.token), observe);
     if (observe->cancel_handler) {
         observe->cancel_handler(id, observe->cancel_handler_arg);
     }
@@ -271,7 +322,7 @@ avs_coap_observe_restore(avs_coap_ctx_t *ctx,
     }
     LOG(DEBUG, _("Observe (restored) start: ") "%s",
         AVS_COAP_TOKEN_HEX(&id.token));
-    AVS_LIST_INSERT(&coap_base->observes, observe);
+    insert_observe(ctx, observe);
 
     return AVS_OK;
 }
@@ -14,10 +14,17 @@
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
-typedef struct {
+typedef struct avs_coap_observe {
     /** An ID (CoAP token) that uniquely identifies an observation. */
     avs_coap_observe_id_t id;
 
+    /**
+     * Link that points to this observation in the list of observations -
+     * either the list head, or the next pointer of the preceding element.
+     * Allows detaching the observation without walking the list.
+     */
+    struct avs_coap_observe **list_link;
+
     /** Function to call when the observation is canceled. */
     avs_coap_observe_cancel_handler_t *cancel_handler;
     void *cancel_handler_arg;
@@ -49,6 +56,13 @@ typedef struct {
     uint32_t observe_option_value;
 } avs_coap_observe_notify_t;
 
+/**
+ * Returns the active observation identified by @p token, or NULL if there is
+ * none.
+ */
+avs_coap_observe_t *_avs_coap_observe_find_by_token(
+        avs_coap_ctx_t *ctx, const avs_coap_token_t *token);
+
 avs_error_t
 _avs_coap_observe_setup_notify(avs_coap_ctx_t *ctx,
                                const avs_coap_observe_id_t *id,
@@ -806,6 +806,30 @@ int avs_coap_options_skip_it(avs_coap_option_iterator_t *inout_it) {
     return -1;
 }
 
+int avs_coap_options_view_next_it(const avs_coap_options_t *opts,
+                                  avs_coap_option_iterator_t *it,
+                                  uint32_t *out_option_number,
+                                  const void **out_value,
+                                  size_t *out_value_size) {
+    if (!it->opts) {
+        // TODO: const_cast; maybe const_iterator could be nice?
+        *it = _avs_coap_optit_begin((avs_coap_options_t *) (intptr_t) opts);
+    } else {
+        assert(it->opts == opts);
+    }
+
+    if (_avs_coap_optit_end(it)) {
+        return AVS_COAP_OPTION_MISSING;
+    }
+
+    const avs_coap_option_t *opt = _avs_coap_optit_current(it);
+    *out_option_number = _avs_coap_optit_number(it);
+    *out_value = _avs_coap_option_value(opt);
+    *out_value_size = _avs_coap_option_content_length(opt);
+    _avs_coap_optit_next(it);
+    return 0;
+}
+
 int avs_coap_options_get_bytes_it(const avs_coap_options_t *opts,
                                   uint16_t option_number,
                                   avs_coap_option_iterator_t *it,
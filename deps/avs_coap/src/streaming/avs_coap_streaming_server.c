@@ -698,6 +698,7 @@ static avs_error_t handle_incoming_packet_with_acquired_in_buffer(
         size_t acquired_in_buffer_size,
         avs_coap_streaming_request_handler_t *handle_request,
         void *handler_arg) {
+    size_t packets_handled = 0;
     while (true) {
         avs_coap_streaming_request_ctx_t streaming_req_ctx = {
             .vtable = &_AVS_COAP_STREAMING_REQUEST_CTX_VTABLE,
@@ -766,9 +767,11 @@ static avs_error_t handle_incoming_packet_with_acquired_in_buffer(
             return streaming_req_ctx.err;
         }
 
-        if (_avs_coap_socket_definitely_exhausted(coap_ctx)) {
-            // We can conclusively say that the socket is already exhausted,
-            // so no need to try receiving more packets.
+        if (_avs_coap_incoming_packets_exhausted(coap_ctx,
+                                                 ++packets_handled)) {
+            // We can conclusively say that the socket is already exhausted
+            // (or the drain limit has been reached), so no need to try
+            // receiving more packets.
             return AVS_OK;
         }
         // Otherwise we loop again to make sure the socket is exhausted.
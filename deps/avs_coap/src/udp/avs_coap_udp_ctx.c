@@ -13,6 +13,7 @@
 
 #    include <assert.h>
 #    include <inttypes.h>
+#    include <string.h>
 
 #    include <avsystem/commons/avs_errno.h>
 #    include <avsystem/commons/avs_shared_buffer.h>
@@ -36,6 +37,7 @@
 #    include "avs_coap_common_utils.h"
 #    include "avs_coap_ctx.h"
 #    include "options/avs_coap_options.h"
+#    include "udp/avs_coap_udp_rtt.h"
 #    include "udp/avs_coap_udp_tx_params.h"
 
 VISIBILITY_SOURCE_BEGIN
@@ -53,17 +55,19 @@ void _avs_unit_mock_constructor_avs_coap_udp_initial_retry_state(void) {
 /**
  * Owning wrapper around an unconfirmed outgoing CoAP/UDP message.
  *
- * List of CoAP/UDP exchanges is kept sorted by (hold, next_retransmit) tuple:
+ * Unconfirmed messages are kept in two binary min-heaps, both ordered by
+ * (next_retransmit, seq) tuple:
  *
- * - up to NSTART first entries are "not held", i.e. are currently being
+ * - up to NSTART entries are "not held", i.e. are currently being
  *   retransmitted,
  *
  * - if more than NSTART exchanges were created, the rest is "held",
  *   i.e. not transmitted at all to honor NSTART defined by RFC7252.
  *
  * Whenever an exchange is retransmitted, next_retransmit is updated to the
- * time of a next retransmission, and the exchange entry moved to appropriate
- * place in the exchange list to keep described ordering.
+ * time of a next retransmission, and the entry is moved to appropriate place
+ * in its heap to keep described ordering. Additionally, all entries are
+ * indexed by message ID and by token, to match incoming messages quickly.
  */
 typedef struct {
     /** Handler to call when context is done with the message */
@@ -79,6 +83,21 @@ typedef struct {
     /** Time at which this packet has to be retransmitted next time. */
     avs_time_monotonic_t next_retransmit;
 
+    /**
+     * Time at which this packet was sent for the first time, used for RTT
+     * measurements. Invalid while the message is held.
+     */
+    avs_time_monotonic_t first_sent;
+
+    /**
+     * Sequence number assigned whenever the entry is put into a heap, so that
+     * entries with equal next_retransmit are handled in FIFO order.
+     */
+    uint64_t seq;
+
+    /** Position of the entry in its heap. */
+    size_t heap_index;
+
     /** CoAP message view. Points to @ref avs_coap_udp_exchange_t#packet . */
     avs_coap_udp_msg_t msg;
 
@@ -89,6 +108,29 @@ typedef struct {
     uint8_t packet[];
 } avs_coap_udp_unconfirmed_msg_t;
 
+typedef struct {
+    avs_coap_udp_unconfirmed_msg_t **entries;
+    size_t size;
+} avs_coap_udp_unconfirmed_heap_t;
+
+/** Maximum number of datagrams passed to a single batch send handler call */
+#    define BATCH_CHUNK_SIZE 16
+
+/** Copy of an outgoing datagram, collected while batching is in progress. */
+typedef struct {
+    /**
+     * True if the datagram is a CON or NON message that belongs to an exchange
+     * aborted before the batch was flushed. Such datagrams are not sent.
+     */
+    bool canceled;
+    avs_coap_udp_type_t type;
+    uint8_t code;
+    avs_coap_token_t token;
+    uint16_t msg_id;
+    size_t size;
+    uint8_t data[];
+} avs_coap_udp_batched_datagram_t;
+
 #    ifdef WITH_AVS_COAP_OBSERVE
 typedef struct {
     uint16_t msg_id;
@@ -183,13 +225,41 @@ typedef struct {
 
     avs_coap_base_t base;
 
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed_messages;
+    /** Unconfirmed messages that are currently being retransmitted. */
+    avs_coap_udp_unconfirmed_heap_t started_messages;
+    /** Unconfirmed messages held due to NSTART. */
+    avs_coap_udp_unconfirmed_heap_t held_messages;
+    /**
+     * Capacity of both heaps. Never less than the number of allocated
+     * unconfirmed messages, so that moving messages between heaps does not
+     * require any allocations.
+     */
+    size_t unconfirmed_capacity;
+    size_t unconfirmed_allocated;
+    uint64_t last_unconfirmed_seq;
+    avs_coap_hash_index_t unconfirmed_by_msg_id;
+    avs_coap_hash_index_t unconfirmed_by_token;
 
     avs_net_socket_t *socket;
     size_t last_mtu;
     size_t forced_incoming_mtu;
     avs_coap_udp_tx_params_t tx_params;
 
+    /** If true, ACK_TIMEOUT is replaced with the RTO estimated by CoCoA. */
+    bool rtt_estimation_enabled;
+    avs_coap_udp_rtt_estimator_t rtt_estimator;
+
+    avs_coap_udp_batch_send_t *batch_send_handler;
+    void *batch_send_handler_arg;
+    /**
+     * Nesting level of batches. Outgoing datagrams are collected in batch
+     * instead of being sent immediately if it is non-zero and
+     * batch_send_handler is set.
+     */
+    unsigned batch_depth;
+    AVS_LIST(avs_coap_udp_batched_datagram_t) batch;
+    AVS_LIST(avs_coap_udp_batched_datagram_t) *batch_append_ptr;
+
     avs_coap_stats_t stats;
 
     uint16_t last_msg_id;
@@ -280,33 +350,16 @@ static uint16_t generate_id(avs_coap_udp_ctx_t *ctx) {
     return ctx->last_msg_id++;
 }
 
-static size_t current_nstart(const avs_coap_udp_ctx_t *ctx) {
-    size_t started = 0;
-
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) msg;
-    AVS_LIST_FOREACH(msg, ctx->unconfirmed_messages) {
-        if (!msg->hold) {
-            ++started;
-        } else {
-            break;
-        }
-    }
+static size_t unconfirmed_count(const avs_coap_udp_ctx_t *ctx) {
+    return ctx->started_messages.size + ctx->held_messages.size;
+}
 
-    return started;
+static size_t current_nstart(const avs_coap_udp_ctx_t *ctx) {
+    return ctx->started_messages.size;
 }
 
 static size_t effective_nstart(const avs_coap_udp_ctx_t *ctx) {
-    // equivalent to:
-    // AVS_MIN(ctx->tx_params.nstart, AVS_LIST_SIZE(ctx->unconfirmed_messages))
-    size_t result = 0;
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) msg;
-    AVS_LIST_FOREACH(msg, ctx->unconfirmed_messages) {
-        ++result;
-        if (result >= ctx->tx_params.nstart) {
-            break;
-        }
-    }
-    return result;
+    return AVS_MIN(ctx->tx_params.nstart, unconfirmed_count(ctx));
 }
 
 static void log_udp_msg_summary(const char *info,
@@ -396,6 +449,48 @@ static void try_cache_response(avs_coap_udp_ctx_t *ctx,
                                             res, &ctx->tx_params);
 }
 
+static avs_error_t
+send_datagram(avs_coap_udp_ctx_t *ctx, const void *data, size_t size) {
+    ++ctx->stats.outgoing_send_calls_count;
+    avs_error_t err = avs_net_socket_send(ctx->base.socket, data, size);
+    if (avs_is_err(err)) {
+        LOG(DEBUG, _("send failed: ") "%s", AVS_COAP_STRERROR(err));
+    } else {
+        ++ctx->stats.outgoing_datagrams_count;
+    }
+    return err;
+}
+
+static bool is_batching(const avs_coap_udp_ctx_t *ctx) {
+    return ctx->batch_depth > 0 && ctx->batch_send_handler;
+}
+
+static int add_to_batch(avs_coap_udp_ctx_t *ctx,
+                        const avs_coap_udp_msg_t *msg,
+                        const void *msg_buf,
+                        size_t msg_size) {
+    AVS_LIST(avs_coap_udp_batched_datagram_t) datagram =
+            (AVS_LIST(avs_coap_udp_batched_datagram_t)) AVS_LIST_NEW_BUFFER(
+                    sizeof(avs_coap_udp_batched_datagram_t) + msg_size);
+    if (!datagram) {
+        LOG(DEBUG, _("out of memory, sending datagram without batching"));
+        return -1;
+    }
+    datagram->type = _avs_coap_udp_header_get_type(&msg->header);
+    datagram->code = msg->header.code;
+    datagram->token = msg->token;
+    datagram->msg_id = _avs_coap_udp_header_get_id(&msg->header);
+    datagram->size = msg_size;
+    memcpy(datagram->data, msg_buf, msg_size);
+
+    if (!ctx->batch) {
+        ctx->batch_append_ptr = &ctx->batch;
+    }
+    AVS_LIST_INSERT(ctx->batch_append_ptr, datagram);
+    AVS_LIST_ADVANCE_PTR(&ctx->batch_append_ptr);
+    return 0;
+}
+
 static avs_error_t coap_udp_send_serialized_msg(avs_coap_udp_ctx_t *ctx,
                                                 const avs_coap_udp_msg_t *msg,
                                                 const void *msg_buf,
@@ -404,11 +499,39 @@ static avs_error_t coap_udp_send_serialized_msg(avs_coap_udp_ctx_t *ctx,
 
     try_cache_response(ctx, msg);
 
-    avs_error_t err = avs_net_socket_send(ctx->base.socket, msg_buf, msg_size);
-    if (avs_is_err(err)) {
-        LOG(DEBUG, _("send failed: ") "%s", AVS_COAP_STRERROR(err));
+    if (is_batching(ctx) && !add_to_batch(ctx, msg, msg_buf, msg_size)) {
+        return AVS_OK;
     }
-    return err;
+    return send_datagram(ctx, msg_buf, msg_size);
+}
+
+/**
+ * @returns Transmission params to use for a new exchange: the configured ones,
+ *          with ACK_TIMEOUT replaced by the estimated RTO if RTT estimation is
+ *          enabled.
+ */
+static avs_coap_udp_tx_params_t effective_tx_params(avs_coap_udp_ctx_t *ctx) {
+    avs_coap_udp_tx_params_t tx_params = ctx->tx_params;
+    if (ctx->rtt_estimation_enabled) {
+        tx_params.ack_timeout =
+                _avs_coap_udp_rtt_get_rto(&ctx->rtt_estimator,
+                                          ctx->tx_params.ack_timeout,
+                                          avs_time_monotonic_now());
+    }
+    return tx_params;
+}
+
+static void
+update_rtt_estimate(avs_coap_udp_ctx_t *ctx,
+                    const avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
+    if (!ctx->rtt_estimation_enabled || unconfirmed->hold) {
+        return;
+    }
+    const avs_time_monotonic_t now = avs_time_monotonic_now();
+    _avs_coap_udp_rtt_update(&ctx->rtt_estimator,
+                             avs_time_monotonic_diff(now,
+                                                     unconfirmed->first_sent),
+                             unconfirmed->retry_state.retry_count, now);
 }
 
 static avs_time_monotonic_t get_first_retransmit_time(avs_coap_udp_ctx_t *ctx) {
@@ -416,58 +539,200 @@ static avs_time_monotonic_t get_first_retransmit_time(avs_coap_udp_ctx_t *ctx) {
         .retry_count = 0,
         .recv_timeout = AVS_TIME_DURATION_ZERO
     };
+    const avs_coap_udp_tx_params_t tx_params = effective_tx_params(ctx);
     if (avs_is_err(_avs_coap_udp_initial_retry_state(
-                &ctx->tx_params, ctx->base.prng_ctx, &initial_state))) {
+                &tx_params, ctx->base.prng_ctx, &initial_state))) {
         return AVS_TIME_MONOTONIC_INVALID;
     }
     return avs_time_monotonic_add(avs_time_monotonic_now(),
                                   initial_state.recv_timeout);
 }
 
-static AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *
-find_unconfirmed_insert_ptr(avs_coap_udp_ctx_t *ctx,
-                            const avs_coap_udp_unconfirmed_msg_t *new_elem) {
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *list_ptr = (AVS_LIST(
-            avs_coap_udp_unconfirmed_msg_t) *) &ctx->unconfirmed_messages;
+static bool
+unconfirmed_before(const avs_coap_udp_unconfirmed_msg_t *a,
+                   const avs_coap_udp_unconfirmed_msg_t *b) {
+    if (a->hold != b->hold) {
+        return !a->hold;
+    }
+    if (avs_time_monotonic_before(a->next_retransmit, b->next_retransmit)) {
+        return true;
+    }
+    if (avs_time_monotonic_before(b->next_retransmit, a->next_retransmit)) {
+        return false;
+    }
+    return a->seq < b->seq;
+}
 
-    AVS_LIST_ITERATE_PTR(list_ptr) {
-        if (!new_elem->hold && (*list_ptr)->hold) {
-            return list_ptr;
-        } else if (new_elem->hold == (*list_ptr)->hold
-                   && avs_time_monotonic_before(new_elem->next_retransmit,
-                                                (*list_ptr)->next_retransmit)) {
-            return list_ptr;
+static void heap_set(avs_coap_udp_unconfirmed_heap_t *heap,
+                     size_t index,
+                     avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
+    heap->entries[index] = unconfirmed;
+    unconfirmed->heap_index = index;
+}
+
+static void heap_sift_up(avs_coap_udp_unconfirmed_heap_t *heap, size_t index) {
+    avs_coap_udp_unconfirmed_msg_t *unconfirmed = heap->entries[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!unconfirmed_before(unconfirmed, heap->entries[parent])) {
+            break;
         }
+        heap_set(heap, index, heap->entries[parent]);
+        index = parent;
     }
+    heap_set(heap, index, unconfirmed);
+}
 
-    assert(list_ptr);
-    assert(*list_ptr == NULL);
-    return list_ptr;
+static void heap_sift_down(avs_coap_udp_unconfirmed_heap_t *heap,
+                           size_t index) {
+    avs_coap_udp_unconfirmed_msg_t *unconfirmed = heap->entries[index];
+    while (2 * index + 1 < heap->size) {
+        size_t child = 2 * index + 1;
+        if (child + 1 < heap->size
+                && unconfirmed_before(heap->entries[child + 1],
+                                      heap->entries[child])) {
+            ++child;
+        }
+        if (!unconfirmed_before(heap->entries[child], unconfirmed)) {
+            break;
+        }
+        heap_set(heap, index, heap->entries[child]);
+        index = child;
+    }
+    heap_set(heap, index, unconfirmed);
 }
 
-static AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *
-find_first_held_unconfirmed_ptr(avs_coap_udp_ctx_t *ctx) {
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr;
+static avs_coap_udp_unconfirmed_heap_t *
+unconfirmed_heap(avs_coap_udp_ctx_t *ctx,
+                 const avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
+    return unconfirmed->hold ? &ctx->held_messages : &ctx->started_messages;
+}
 
-    AVS_LIST_FOREACH_PTR(unconfirmed_ptr, &ctx->unconfirmed_messages) {
-        if ((*unconfirmed_ptr)->hold) {
-            return unconfirmed_ptr;
-        }
+static inline bool
+is_unconfirmed_enqueued(avs_coap_udp_ctx_t *ctx,
+                        const avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
+    avs_coap_udp_unconfirmed_heap_t *heap = unconfirmed_heap(ctx, unconfirmed);
+    return unconfirmed->heap_index < heap->size
+           && heap->entries[unconfirmed->heap_index] == unconfirmed;
+}
+
+static void heap_push(avs_coap_udp_ctx_t *ctx,
+                      avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
+    avs_coap_udp_unconfirmed_heap_t *heap = unconfirmed_heap(ctx, unconfirmed);
+    assert(heap->size < ctx->unconfirmed_capacity);
+    unconfirmed->seq = ++ctx->last_unconfirmed_seq;
+    heap_set(heap, heap->size++, unconfirmed);
+    heap_sift_up(heap, unconfirmed->heap_index);
+}
+
+static void heap_remove(avs_coap_udp_ctx_t *ctx,
+                        avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
+    AVS_ASSERT(is_unconfirmed_enqueued(ctx, unconfirmed),
+               "unconfirmed_msg must be enqueued");
+    avs_coap_udp_unconfirmed_heap_t *heap = unconfirmed_heap(ctx, unconfirmed);
+    avs_coap_udp_unconfirmed_msg_t *last = heap->entries[--heap->size];
+    if (last != unconfirmed) {
+        heap_set(heap, unconfirmed->heap_index, last);
+        heap_sift_up(heap, last->heap_index);
+        heap_sift_down(heap, last->heap_index);
     }
+}
+
+static uint32_t hash_msg_id(uint16_t msg_id) {
+    return _avs_coap_hash_u64(msg_id);
+}
+
+static uint32_t hash_token(const avs_coap_token_t *token) {
+    return _avs_coap_hash_bytes(token->bytes, token->size);
+}
+
+static void insert_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                               avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
+    heap_push(ctx, unconfirmed);
+    _avs_coap_hash_index_insert(
+            &ctx->unconfirmed_by_msg_id,
+            hash_msg_id(_avs_coap_udp_header_get_id(&unconfirmed->msg.header)),
+            unconfirmed);
+    _avs_coap_hash_index_insert(&ctx->unconfirmed_by_token,
+                                hash_token(&unconfirmed->msg.token),
+                                unconfirmed);
+}
+
+static void detach_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                               avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
+    heap_remove(ctx, unconfirmed);
+    _avs_coap_hash_index_remove(
+            &ctx->unconfirmed_by_msg_id,
+            hash_msg_id(_avs_coap_udp_header_get_id(&unconfirmed->msg.header)),
+            unconfirmed);
+    _avs_coap_hash_index_remove(&ctx->unconfirmed_by_token,
+                                hash_token(&unconfirmed->msg.token),
+                                unconfirmed);
+}
 
+/**
+ * Moves an enqueued message to the place appropriate for the new
+ * @p next_retransmit value.
+ */
+static void
+reschedule_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                       avs_coap_udp_unconfirmed_msg_t *unconfirmed,
+                       avs_time_monotonic_t next_retransmit) {
+    heap_remove(ctx, unconfirmed);
+    unconfirmed->next_retransmit = next_retransmit;
+    heap_push(ctx, unconfirmed);
+}
+
+static avs_coap_udp_unconfirmed_msg_t *
+first_unconfirmed(avs_coap_udp_ctx_t *ctx) {
+    if (ctx->started_messages.size) {
+        return ctx->started_messages.entries[0];
+    } else if (ctx->held_messages.size) {
+        return ctx->held_messages.entries[0];
+    }
     return NULL;
 }
 
+static avs_error_t reserve_unconfirmed(avs_coap_udp_ctx_t *ctx) {
+    if (ctx->unconfirmed_allocated < ctx->unconfirmed_capacity) {
+        return AVS_OK;
+    }
+    const size_t new_capacity =
+            ctx->unconfirmed_capacity ? 2 * ctx->unconfirmed_capacity : 4;
+    avs_coap_udp_unconfirmed_msg_t **entries;
+    if (!(entries = (avs_coap_udp_unconfirmed_msg_t **) avs_realloc(
+                  ctx->started_messages.entries,
+                  new_capacity * sizeof(*entries)))) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    ctx->started_messages.entries = entries;
+    if (!(entries = (avs_coap_udp_unconfirmed_msg_t **) avs_realloc(
+                  ctx->held_messages.entries,
+                  new_capacity * sizeof(*entries)))) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    ctx->held_messages.entries = entries;
+    ctx->unconfirmed_capacity = new_capacity;
+    return AVS_OK;
+}
+
+static void
+delete_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                   AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr) {
+    assert(ctx->unconfirmed_allocated > 0);
+    --ctx->unconfirmed_allocated;
+    AVS_LIST_DELETE(unconfirmed_ptr);
+}
+
 static void reschedule_retransmission_job(avs_coap_udp_ctx_t *ctx) {
-    if (ctx->unconfirmed_messages) {
+    avs_coap_udp_unconfirmed_msg_t *first = first_unconfirmed(ctx);
+    if (first) {
         avs_time_monotonic_t target_time;
         if (current_nstart(ctx) < effective_nstart(ctx)) {
             // There are requests we need to send ASAP
             target_time = avs_time_monotonic_now();
         } else {
-            target_time = ((avs_coap_udp_unconfirmed_msg_t *)
-                                   ctx->unconfirmed_messages)
-                                  ->next_retransmit;
+            target_time = first->next_retransmit;
         }
         _avs_coap_reschedule_retry_or_request_expired_job(
                 (avs_coap_ctx_t *) ctx, target_time);
@@ -532,9 +797,7 @@ static inline const char *send_result_string(avs_coap_send_result_t result) {
 }
 
 static void resume_next_unconfirmed(avs_coap_udp_ctx_t *ctx) {
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr =
-            find_first_held_unconfirmed_ptr(ctx);
-    if (!unconfirmed_ptr) {
+    if (!ctx->held_messages.size) {
         return;
     }
 
@@ -551,14 +814,20 @@ static void resume_next_unconfirmed(avs_coap_udp_ctx_t *ctx) {
 
         // Detach held messages so that they can't get unheld in the send result
         // handler
-        AVS_LIST(avs_coap_udp_unconfirmed_msg_t) held_messages =
-                *unconfirmed_ptr;
-        *unconfirmed_ptr = NULL;
+        AVS_LIST(avs_coap_udp_unconfirmed_msg_t) held_messages = NULL;
+        AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *append_ptr = &held_messages;
+        while (ctx->held_messages.size) {
+            avs_coap_udp_unconfirmed_msg_t *unconfirmed =
+                    ctx->held_messages.entries[0];
+            detach_unconfirmed(ctx, unconfirmed);
+            AVS_LIST_INSERT(append_ptr, unconfirmed);
+            AVS_LIST_ADVANCE_PTR(&append_ptr);
+        }
 
         while (held_messages) {
             // Do not use fail_unconfirmed - it indirectly calls this function
-            // again, which may result in
-            // AVS_LIST_SIZE(ctx->unconfirmed_messages) recursive calls .
+            // again, which may result in as many recursive calls as there are
+            // unconfirmed messages.
             //
             // Note: this loop may be infinite in the most degenerate case
             // where get_first_retransmit_time returns an invalid time **just
@@ -570,14 +839,15 @@ static void resume_next_unconfirmed(avs_coap_udp_ctx_t *ctx) {
             (void) call_send_result_handler(
                     ctx, unconfirmed, NULL, AVS_COAP_SEND_RESULT_FAIL,
                     _avs_coap_err(AVS_COAP_ERR_TIME_INVALID));
-            AVS_LIST_DELETE(&unconfirmed);
+            delete_unconfirmed(ctx, &unconfirmed);
         }
 
         return;
     }
 
     AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed =
-            AVS_LIST_DETACH(unconfirmed_ptr);
+            ctx->held_messages.entries[0];
+    detach_unconfirmed(ctx, unconfirmed);
     unconfirmed->hold = false;
     unconfirmed->next_retransmit = next_retransmit;
 
@@ -591,11 +861,10 @@ static void resume_next_unconfirmed(avs_coap_udp_ctx_t *ctx) {
     if (avs_is_err(send_err)) {
         (void) call_send_result_handler(ctx, unconfirmed, NULL,
                                         AVS_COAP_SEND_RESULT_FAIL, send_err);
-        AVS_LIST_DELETE(&unconfirmed);
+        delete_unconfirmed(ctx, &unconfirmed);
     } else {
-        // the msg may need to be retransmitted before other started ones
-        AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed),
-                        unconfirmed);
+        unconfirmed->first_sent = avs_time_monotonic_now();
+        insert_unconfirmed(ctx, unconfirmed);
     }
 }
 
@@ -606,7 +875,7 @@ static void resume_unconfirmed_messages(avs_coap_udp_ctx_t *ctx) {
     }
 
     const size_t resumed_msgs = current_nstart(ctx);
-    const size_t all_msgs = AVS_LIST_SIZE(ctx->unconfirmed_messages);
+    const size_t all_msgs = unconfirmed_count(ctx);
     const size_t held_msgs = all_msgs - resumed_msgs;
 
     const size_t msgs_to_resume =
@@ -641,7 +910,7 @@ static void try_cleanup_unconfirmed(avs_coap_udp_ctx_t *ctx,
                                     avs_error_t fail_err) {
     assert(ctx);
     assert(unconfirmed);
-    AVS_ASSERT(!AVS_LIST_FIND_PTR(&ctx->unconfirmed_messages, unconfirmed),
+    AVS_ASSERT(!is_unconfirmed_enqueued(ctx, unconfirmed),
                "unconfirmed must be detached");
     LOG(DEBUG, _("msg ") "%s" _(": ") "%s",
         AVS_COAP_TOKEN_HEX(&unconfirmed->msg.token),
@@ -653,11 +922,10 @@ static void try_cleanup_unconfirmed(avs_coap_udp_ctx_t *ctx,
 
     if (response && result == AVS_COAP_SEND_RESULT_OK
             && handler_result != AVS_COAP_RESPONSE_ACCEPTED) {
-        AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed),
-                        unconfirmed);
+        insert_unconfirmed(ctx, unconfirmed);
     } else {
         reschedule_retransmission_job(ctx);
-        AVS_LIST_DELETE(&unconfirmed);
+        delete_unconfirmed(ctx, &unconfirmed);
     }
 }
 
@@ -673,42 +941,97 @@ static avs_coap_udp_exchange_direction_t direction_from_code(uint8_t code) {
                    : AVS_COAP_UDP_EXCHANGE_SERVER_NOTIFICATION;
 }
 
-static AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *
-find_unconfirmed_ptr(avs_coap_udp_ctx_t *ctx,
-                     avs_coap_udp_exchange_direction_t direction,
-                     const avs_coap_token_t *token,
-                     const uint16_t *id) {
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *list_ptr =
-            &ctx->unconfirmed_messages;
-
-    AVS_LIST_ITERATE_PTR(list_ptr) {
-        const avs_coap_udp_msg_t *msg = &(*list_ptr)->msg;
-        if ((direction == AVS_COAP_UDP_EXCHANGE_ANY
-             || direction == direction_from_code(msg->header.code))
-                && (!token || avs_coap_token_equal(&msg->token, token))
-                && (!id || _avs_coap_udp_header_get_id(&msg->header) == *id)) {
-            return list_ptr;
+typedef struct {
+    avs_coap_udp_exchange_direction_t direction;
+    const avs_coap_token_t *token;
+    const uint16_t *id;
+} avs_coap_udp_unconfirmed_key_t;
+
+static bool unconfirmed_matches(const void *unconfirmed, const void *key_) {
+    const avs_coap_udp_msg_t *msg =
+            &((const avs_coap_udp_unconfirmed_msg_t *) unconfirmed)->msg;
+    const avs_coap_udp_unconfirmed_key_t *key =
+            (const avs_coap_udp_unconfirmed_key_t *) key_;
+    return (key->direction == AVS_COAP_UDP_EXCHANGE_ANY
+            || key->direction == direction_from_code(msg->header.code))
+           && (!key->token || avs_coap_token_equal(&msg->token, key->token))
+           && (!key->id
+               || _avs_coap_udp_header_get_id(&msg->header) == *key->id);
+}
+
+static avs_coap_udp_unconfirmed_msg_t *
+find_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                 avs_coap_udp_exchange_direction_t direction,
+                 const avs_coap_token_t *token,
+                 const uint16_t *id) {
+    const avs_coap_udp_unconfirmed_key_t key = {
+        .direction = direction,
+        .token = token,
+        .id = id
+    };
+    const avs_coap_hash_index_t *index;
+    uint32_t hash;
+    if (id) {
+        index = &ctx->unconfirmed_by_msg_id;
+        hash = hash_msg_id(*id);
+    } else {
+        assert(token);
+        index = &ctx->unconfirmed_by_token;
+        hash = hash_token(token);
+    }
+
+    // If more than one message matches (e.g. multiple notifications for the
+    // same observation), return the one that is first in retransmission order.
+    avs_coap_udp_unconfirmed_msg_t *result = NULL;
+    size_t cursor = 0;
+    void *candidate;
+    int find_result;
+    while (!(find_result = _avs_coap_hash_index_find_next(
+                     index, hash, unconfirmed_matches, &key, &cursor,
+                     &candidate))
+           && candidate) {
+        if (!result
+                || unconfirmed_before(
+                           (avs_coap_udp_unconfirmed_msg_t *) candidate,
+                           result)) {
+            result = (avs_coap_udp_unconfirmed_msg_t *) candidate;
         }
     }
 
-    return NULL;
+    if (find_result) {
+        // index is not usable due to an earlier allocation failure
+        const avs_coap_udp_unconfirmed_heap_t *heaps[] = {
+            &ctx->started_messages, &ctx->held_messages
+        };
+        for (size_t i = 0; i < AVS_ARRAY_SIZE(heaps); ++i) {
+            for (size_t j = 0; j < heaps[i]->size; ++j) {
+                avs_coap_udp_unconfirmed_msg_t *entry = heaps[i]->entries[j];
+                if (unconfirmed_matches(entry, &key)
+                        && (!result || unconfirmed_before(entry, result))) {
+                    result = entry;
+                }
+            }
+        }
+    }
+
+    return result;
 }
 
-static inline AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *
-find_unconfirmed_ptr_by_token(avs_coap_udp_ctx_t *ctx,
-                              avs_coap_udp_exchange_direction_t direction,
-                              const avs_coap_token_t *token) {
-    return find_unconfirmed_ptr(ctx, direction, token, NULL);
+static inline avs_coap_udp_unconfirmed_msg_t *
+find_unconfirmed_by_token(avs_coap_udp_ctx_t *ctx,
+                          avs_coap_udp_exchange_direction_t direction,
+                          const avs_coap_token_t *token) {
+    return find_unconfirmed(ctx, direction, token, NULL);
 }
 
-static inline AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *
-find_unconfirmed_ptr_by_msg_id(avs_coap_udp_ctx_t *ctx, uint16_t msg_id) {
-    return find_unconfirmed_ptr(ctx, AVS_COAP_UDP_EXCHANGE_ANY, NULL, &msg_id);
+static inline avs_coap_udp_unconfirmed_msg_t *
+find_unconfirmed_by_msg_id(avs_coap_udp_ctx_t *ctx, uint16_t msg_id) {
+    return find_unconfirmed(ctx, AVS_COAP_UDP_EXCHANGE_ANY, NULL, &msg_id);
 }
 
-static inline AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *
-find_unconfirmed_ptr_by_response(avs_coap_udp_ctx_t *ctx,
-                                 const avs_coap_udp_msg_t *msg) {
+static inline avs_coap_udp_unconfirmed_msg_t *
+find_unconfirmed_by_response(avs_coap_udp_ctx_t *ctx,
+                             const avs_coap_udp_msg_t *msg) {
     assert(avs_coap_code_is_response(msg->header.code));
 
     uint16_t id = _avs_coap_udp_header_get_id(&msg->header);
@@ -716,11 +1039,11 @@ find_unconfirmed_ptr_by_response(avs_coap_udp_ctx_t *ctx,
     switch (_avs_coap_udp_header_get_type(&msg->header)) {
     case AVS_COAP_UDP_TYPE_CONFIRMABLE:
     case AVS_COAP_UDP_TYPE_NON_CONFIRMABLE:
-        return find_unconfirmed_ptr_by_token(
+        return find_unconfirmed_by_token(
                 ctx, AVS_COAP_UDP_EXCHANGE_CLIENT_REQUEST, &msg->token);
     case AVS_COAP_UDP_TYPE_ACKNOWLEDGEMENT:
-        return find_unconfirmed_ptr(ctx, AVS_COAP_UDP_EXCHANGE_CLIENT_REQUEST,
-                                    &msg->token, &id);
+        return find_unconfirmed(ctx, AVS_COAP_UDP_EXCHANGE_CLIENT_REQUEST,
+                                &msg->token, &id);
     case AVS_COAP_UDP_TYPE_RESET:
         // this should be detected at packet validation
         AVS_UNREACHABLE("According to RFC7252 Reset MUST be empty");
@@ -733,45 +1056,147 @@ static avs_coap_udp_unconfirmed_msg_t *
 detach_unconfirmed_by_token(avs_coap_udp_ctx_t *ctx,
                             avs_coap_udp_exchange_direction_t direction,
                             const avs_coap_token_t *token) {
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *msg_ptr =
-            find_unconfirmed_ptr_by_token(ctx, direction, token);
+    avs_coap_udp_unconfirmed_msg_t *msg =
+            find_unconfirmed_by_token(ctx, direction, token);
 
-    if (msg_ptr) {
-        return AVS_LIST_DETACH(msg_ptr);
+    if (msg) {
+        detach_unconfirmed(ctx, msg);
     }
-    return NULL;
+    return msg;
 }
 
-static void
-confirm_unconfirmed(avs_coap_udp_ctx_t *ctx,
-                    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *msg_ptr,
-                    const avs_coap_udp_msg_t *response) {
+static void confirm_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                                avs_coap_udp_unconfirmed_msg_t *msg,
+                                const avs_coap_udp_msg_t *response) {
     assert(ctx);
-    assert(msg_ptr);
-    assert(*msg_ptr);
-    AVS_ASSERT(AVS_LIST_FIND_PTR(&ctx->unconfirmed_messages, *msg_ptr),
-               "unconfirmed_msg must be enqueued");
+    assert(msg);
 
-    avs_coap_udp_unconfirmed_msg_t *msg = AVS_LIST_DETACH(msg_ptr);
+    detach_unconfirmed(ctx, msg);
     try_cleanup_unconfirmed(ctx, msg, response, AVS_COAP_SEND_RESULT_OK,
                             AVS_OK);
 }
 
 static void fail_unconfirmed(avs_coap_udp_ctx_t *ctx,
-                             AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *msg_ptr,
+                             avs_coap_udp_unconfirmed_msg_t *msg,
                              const avs_coap_udp_msg_t *truncated_msg,
                              avs_error_t err) {
     assert(ctx);
-    assert(msg_ptr);
-    assert(*msg_ptr);
-    AVS_ASSERT(AVS_LIST_FIND_PTR(&ctx->unconfirmed_messages, *msg_ptr),
-               "unconfirmed_msg must be enqueued");
+    assert(msg);
 
-    avs_coap_udp_unconfirmed_msg_t *msg = AVS_LIST_DETACH(msg_ptr);
+    detach_unconfirmed(ctx, msg);
     try_cleanup_unconfirmed(ctx, msg, truncated_msg, AVS_COAP_SEND_RESULT_FAIL,
                             err);
 }
 
+static void fail_batched_datagram(
+        avs_coap_udp_ctx_t *ctx,
+        const avs_coap_udp_batched_datagram_t *datagram,
+        avs_error_t err) {
+    avs_coap_udp_unconfirmed_msg_t *unconfirmed =
+            datagram->type == AVS_COAP_UDP_TYPE_CONFIRMABLE
+                    ? find_unconfirmed_by_msg_id(ctx, datagram->msg_id)
+                    : NULL;
+    if (unconfirmed && !unconfirmed->hold) {
+        fail_unconfirmed(ctx, unconfirmed, NULL, err);
+    } else {
+        LOG(DEBUG,
+            _("could not send batched msg (ID ") "%#04" PRIx16 _(")"),
+            datagram->msg_id);
+    }
+}
+
+static bool
+batched_datagram_canceled(avs_coap_udp_ctx_t *ctx,
+                          const avs_coap_udp_batched_datagram_t *datagram) {
+    // a Confirmable message is also gone if its exchange has been cleaned up
+    // in any other way, e.g. failed due to an earlier send error
+    return datagram->canceled
+           || (datagram->type == AVS_COAP_UDP_TYPE_CONFIRMABLE
+               && !find_unconfirmed_by_msg_id(ctx, datagram->msg_id));
+}
+
+/**
+ * Sends all datagrams collected in the batch: in chunks through
+ * batch_send_handler, and then one by one through the socket if the handler
+ * did not manage to send them. Datagrams of exchanges aborted in the meantime
+ * are dropped.
+ *
+ * Errors are reported to the send result handlers of the affected
+ * Confirmable messages. Failures to send other messages are only logged.
+ */
+static void flush_batch(avs_coap_udp_ctx_t *ctx) {
+    // handlers called here may send more messages, so the batch is detached
+    // first to make them go to a new one
+    AVS_LIST(avs_coap_udp_batched_datagram_t) batch = ctx->batch;
+    ctx->batch = NULL;
+    ctx->batch_append_ptr = NULL;
+
+    while (batch) {
+        avs_coap_udp_datagram_t datagrams[BATCH_CHUNK_SIZE];
+        size_t count = 0;
+        AVS_LIST(avs_coap_udp_batched_datagram_t) *it_ptr = &batch;
+        while (*it_ptr && count < AVS_ARRAY_SIZE(datagrams)) {
+            if (batched_datagram_canceled(ctx, *it_ptr)) {
+                LOG(DEBUG,
+                    _("exchange of batched msg (ID ") "%#04" PRIx16 _(
+                            ") aborted, not sending"),
+                    (*it_ptr)->msg_id);
+                AVS_LIST_DELETE(it_ptr);
+            } else {
+                datagrams[count++] = (avs_coap_udp_datagram_t) {
+                    .data = (*it_ptr)->data,
+                    .size = (*it_ptr)->size
+                };
+                AVS_LIST_ADVANCE_PTR(&it_ptr);
+            }
+        }
+        if (!count) {
+            break;
+        }
+
+        size_t sent = 0;
+        if (ctx->batch_send_handler) {
+            ++ctx->stats.outgoing_send_calls_count;
+            avs_error_t err =
+                    ctx->batch_send_handler(ctx->base.socket, datagrams, count,
+                                            &sent, ctx->batch_send_handler_arg);
+            sent = AVS_MIN(sent, count);
+            ctx->stats.outgoing_datagrams_count += (uint32_t) sent;
+            if (avs_is_err(err)) {
+                LOG(DEBUG,
+                    _("batched send failed after ") "%u/%u" _(
+                            " datagrams: ") "%s" _(
+                            ", falling back to single sends"),
+                    (unsigned) sent, (unsigned) count, AVS_COAP_STRERROR(err));
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            AVS_LIST(avs_coap_udp_batched_datagram_t) datagram =
+                    AVS_LIST_DETACH(&batch);
+            if (i >= sent) {
+                avs_error_t err =
+                        send_datagram(ctx, datagram->data, datagram->size);
+                if (avs_is_err(err)) {
+                    fail_batched_datagram(ctx, datagram, err);
+                }
+            }
+            AVS_LIST_DELETE(&datagram);
+        }
+    }
+}
+
+static void begin_batch(avs_coap_udp_ctx_t *ctx) {
+    ++ctx->batch_depth;
+}
+
+static void end_batch(avs_coap_udp_ctx_t *ctx) {
+    assert(ctx->batch_depth > 0);
+    if (!--ctx->batch_depth) {
+        flush_batch(ctx);
+    }
+}
+
 static avs_coap_udp_exchange_direction_t
 udp_direction(avs_coap_exchange_direction_t direction) {
     switch (direction) {
@@ -784,12 +1209,36 @@ udp_direction(avs_coap_exchange_direction_t direction) {
     return AVS_COAP_UDP_EXCHANGE_ANY;
 }
 
+/**
+ * Marks datagrams of an aborted exchange that are waiting in the batch, so that
+ * they are not sent when the batch is flushed.
+ */
+static void
+cancel_batched_datagrams(avs_coap_udp_ctx_t *ctx,
+                         avs_coap_udp_exchange_direction_t direction,
+                         const avs_coap_token_t *token) {
+    AVS_LIST(avs_coap_udp_batched_datagram_t) datagram;
+    AVS_LIST_FOREACH(datagram, ctx->batch) {
+        // ACK and Reset messages are replies to the peer's messages, even if
+        // they share a token with an exchange
+        if ((datagram->type == AVS_COAP_UDP_TYPE_CONFIRMABLE
+                    || datagram->type == AVS_COAP_UDP_TYPE_NON_CONFIRMABLE)
+                && direction_from_code(datagram->code) == direction
+                && avs_coap_token_equal(&datagram->token, token)) {
+            datagram->canceled = true;
+        }
+    }
+}
+
 static void coap_udp_abort_delivery(avs_coap_ctx_t *ctx_,
                                     avs_coap_exchange_direction_t direction,
                                     const avs_coap_token_t *token,
                                     avs_coap_send_result_t result,
                                     avs_error_t fail_err) {
     avs_coap_udp_ctx_t *ctx = (avs_coap_udp_ctx_t *) ctx_;
+    if (result != AVS_COAP_SEND_RESULT_OK) {
+        cancel_batched_datagrams(ctx, udp_direction(direction), token);
+    }
     AVS_LIST(avs_coap_udp_unconfirmed_msg_t) msg =
             detach_unconfirmed_by_token(ctx, udp_direction(direction), token);
     if (!msg) {
@@ -810,7 +1259,7 @@ static void coap_udp_ignore_current_request(avs_coap_ctx_t *ctx_,
 
 static void
 retransmit_next_message_without_reschedule(avs_coap_udp_ctx_t *ctx) {
-    avs_coap_udp_unconfirmed_msg_t *unconfirmed = ctx->unconfirmed_messages;
+    avs_coap_udp_unconfirmed_msg_t *unconfirmed = first_unconfirmed(ctx);
     if (!unconfirmed
             || avs_time_monotonic_before(avs_time_monotonic_now(),
                                          unconfirmed->next_retransmit)) {
@@ -825,13 +1274,13 @@ retransmit_next_message_without_reschedule(avs_coap_udp_ctx_t *ctx) {
             AVS_COAP_TOKEN_HEX(&unconfirmed->msg.token));
 
         // retransmission_job is rescheduled by fail_unconfirmed()
-        fail_unconfirmed(ctx, &ctx->unconfirmed_messages, NULL,
+        fail_unconfirmed(ctx, unconfirmed, NULL,
                          _avs_coap_err(AVS_COAP_ERR_TIMEOUT));
         return;
     }
 
     if (_avs_coap_udp_update_retry_state(&unconfirmed->retry_state)) {
-        fail_unconfirmed(ctx, &ctx->unconfirmed_messages, NULL,
+        fail_unconfirmed(ctx, unconfirmed, NULL,
                          _avs_coap_err(AVS_COAP_ERR_TIME_INVALID));
         return;
     }
@@ -844,7 +1293,7 @@ retransmit_next_message_without_reschedule(avs_coap_udp_ctx_t *ctx) {
                                                    unconfirmed->packet,
                                                    unconfirmed->packet_size);
     if (avs_is_err(err)) {
-        fail_unconfirmed(ctx, &ctx->unconfirmed_messages, NULL, err);
+        fail_unconfirmed(ctx, unconfirmed, NULL, err);
         return;
     }
     ++ctx->stats.outgoing_retransmissions_count;
@@ -857,28 +1306,44 @@ retransmit_next_message_without_reschedule(avs_coap_udp_ctx_t *ctx) {
             _("unable to schedule message retransmission: next_retransmit time "
               "invalid; either the monotonic clock malfunctioned or UDP tx "
               "params are too large to handle"));
-        fail_unconfirmed(ctx, &ctx->unconfirmed_messages, NULL,
+        fail_unconfirmed(ctx, unconfirmed, NULL,
                          _avs_coap_err(AVS_COAP_ERR_TIME_INVALID));
         return;
     }
 
-    unconfirmed->next_retransmit = next_retransmit;
-    unconfirmed = AVS_LIST_DETACH(&ctx->unconfirmed_messages);
-    AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed), unconfirmed);
+    reschedule_unconfirmed(ctx, unconfirmed, next_retransmit);
+}
+
+static bool is_retransmission_due(avs_coap_udp_ctx_t *ctx) {
+    avs_coap_udp_unconfirmed_msg_t *unconfirmed = first_unconfirmed(ctx);
+    return unconfirmed && !unconfirmed->hold
+           && !avs_time_monotonic_before(avs_time_monotonic_now(),
+                                         unconfirmed->next_retransmit);
 }
 
 static avs_time_monotonic_t coap_udp_on_timeout(avs_coap_ctx_t *ctx_) {
     avs_coap_udp_ctx_t *ctx = (avs_coap_udp_ctx_t *) ctx_;
+    begin_batch(ctx);
     resume_unconfirmed_messages(ctx);
     retransmit_next_message_without_reschedule(ctx);
+    if (is_batching(ctx)) {
+        // send all retransmissions that are due in a single batch; each
+        // message is either rescheduled or failed, so it is enough to loop
+        // as many times as there are started messages
+        for (size_t i = ctx->started_messages.size;
+             i > 0 && is_retransmission_due(ctx);
+             --i) {
+            retransmit_next_message_without_reschedule(ctx);
+        }
+    }
+    end_batch(ctx);
 
-    if (ctx->unconfirmed_messages) {
-        avs_coap_udp_unconfirmed_msg_t *unconfirmed = ctx->unconfirmed_messages;
-
+    avs_coap_udp_unconfirmed_msg_t *unconfirmed = first_unconfirmed(ctx);
+    if (unconfirmed) {
         LOG(DEBUG, _("next UDP retransmission: ") "%s",
             AVS_TIME_DURATION_AS_STRING(
                     unconfirmed->next_retransmit.since_monotonic_epoch));
-        return ctx->unconfirmed_messages->next_retransmit;
+        return unconfirmed->next_retransmit;
     } else {
         return AVS_TIME_MONOTONIC_INVALID;
     }
@@ -893,9 +1358,7 @@ enqueue_unconfirmed(avs_coap_udp_ctx_t *ctx,
     // do not send the message unless there is no other one waiting to be sent
     // that is held for longer than this one
     assert(ctx->tx_params.nstart > 0);
-    unconfirmed->hold =
-            (AVS_LIST_NTH(ctx->unconfirmed_messages, ctx->tx_params.nstart - 1)
-             != NULL);
+    unconfirmed->hold = (unconfirmed_count(ctx) >= ctx->tx_params.nstart);
 
     // use current time for all held jobs to not cause accidental reordering
     // due to ACK_RANDOM_FACTOR
@@ -924,9 +1387,10 @@ enqueue_unconfirmed(avs_coap_udp_ctx_t *ctx,
         if (avs_is_err(err)) {
             return err;
         }
+        unconfirmed->first_sent = avs_time_monotonic_now();
     }
 
-    AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed), unconfirmed);
+    insert_unconfirmed(ctx, unconfirmed);
     reschedule_retransmission_job(ctx);
     return AVS_OK;
 }
@@ -939,6 +1403,11 @@ static avs_error_t create_unconfirmed(
         void *send_result_handler_arg) {
     const size_t msg_size = _avs_coap_udp_msg_size(msg);
 
+    avs_error_t err = reserve_unconfirmed(ctx);
+    if (avs_is_err(err)) {
+        return err;
+    }
+
     AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed_msg =
             (AVS_LIST(avs_coap_udp_unconfirmed_msg_t)) AVS_LIST_NEW_BUFFER(
                     sizeof(avs_coap_udp_unconfirmed_msg_t) + msg_size);
@@ -949,18 +1418,22 @@ static avs_error_t create_unconfirmed(
     *unconfirmed_msg = (avs_coap_udp_unconfirmed_msg_t) {
         .send_result_handler = send_result_handler,
         .send_result_handler_arg = send_result_handler_arg,
+        .first_sent = AVS_TIME_MONOTONIC_INVALID,
         .packet_size = msg_size
     };
 
-    avs_error_t err;
-
+    const avs_coap_udp_tx_params_t tx_params = effective_tx_params(ctx);
     if (avs_is_err((err = _avs_coap_udp_initial_retry_state(
-                            &ctx->tx_params, ctx->base.prng_ctx,
+                            &tx_params, ctx->base.prng_ctx,
                             &unconfirmed_msg->retry_state)))) {
         LOG(ERROR, _("PRNG failed"));
         AVS_LIST_CLEAR(&unconfirmed_msg);
         return err;
     }
+    if (ctx->rtt_estimation_enabled) {
+        unconfirmed_msg->retry_state.backoff_factor =
+                _avs_coap_udp_rtt_backoff_factor(tx_params.ack_timeout);
+    }
 
     if (avs_is_err((err = _avs_coap_udp_msg_copy(msg, &unconfirmed_msg->msg,
                                                  unconfirmed_msg->packet,
@@ -971,6 +1444,7 @@ static avs_error_t create_unconfirmed(
         return err;
     }
 
+    ++ctx->unconfirmed_allocated;
     *out_unconfirmed_msg = unconfirmed_msg;
     return AVS_OK;
 }
@@ -1095,7 +1569,7 @@ coap_udp_send_message(avs_coap_ctx_t *ctx_,
         if (avs_is_err(err)) {
             // don't call try_cleanup_unconfirmed to avoid calling user-defined
             // handler
-            AVS_LIST_DELETE(&unconfirmed);
+            delete_unconfirmed(ctx, &unconfirmed);
         }
     } else {
         assert(type != AVS_COAP_UDP_TYPE_CONFIRMABLE);
@@ -1225,9 +1699,9 @@ static avs_error_t send_reset(avs_coap_udp_ctx_t *ctx, uint16_t msg_id) {
 
 static avs_error_t handle_response(avs_coap_udp_ctx_t *ctx,
                                    const avs_coap_udp_msg_t *msg) {
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr =
-            find_unconfirmed_ptr_by_response(ctx, msg);
-    if (!unconfirmed_ptr) {
+    avs_coap_udp_unconfirmed_msg_t *unconfirmed =
+            find_unconfirmed_by_response(ctx, msg);
+    if (!unconfirmed) {
         bool is_confirmable = (_avs_coap_udp_header_get_type(&msg->header)
                                == AVS_COAP_UDP_TYPE_CONFIRMABLE);
         LOG(DEBUG,
@@ -1247,7 +1721,7 @@ static avs_error_t handle_response(avs_coap_udp_ctx_t *ctx,
                 send_separate_ack(ctx,
                                   _avs_coap_udp_header_get_id(&msg->header));
         if (avs_is_err(err)) {
-            fail_unconfirmed(ctx, unconfirmed_ptr, NULL, err);
+            fail_unconfirmed(ctx, unconfirmed, NULL, err);
             return err;
         }
         break;
@@ -1263,6 +1737,7 @@ static avs_error_t handle_response(avs_coap_udp_ctx_t *ctx,
 
     case AVS_COAP_UDP_TYPE_ACKNOWLEDGEMENT:
         // Piggybacked Response
+        update_rtt_estimate(ctx, unconfirmed);
         break;
 
     case AVS_COAP_UDP_TYPE_RESET:
@@ -1271,47 +1746,41 @@ static avs_error_t handle_response(avs_coap_udp_ctx_t *ctx,
         return _avs_coap_err(AVS_COAP_ERR_ASSERT_FAILED);
     }
 
-    confirm_unconfirmed(ctx, unconfirmed_ptr, msg);
+    confirm_unconfirmed(ctx, unconfirmed, msg);
     return AVS_OK;
 }
 
-static void
-ack_request(avs_coap_udp_ctx_t *ctx,
-            AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr) {
+static void ack_request(avs_coap_udp_ctx_t *ctx,
+                        avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
     assert(ctx);
-    assert(unconfirmed_ptr);
-    assert(*unconfirmed_ptr);
+    assert(unconfirmed);
 
     // Wait EXCHANGE_LIFETIME for the actual response
     avs_time_monotonic_t next_retransmit = avs_time_monotonic_add(
             avs_time_monotonic_now(),
             avs_coap_udp_exchange_lifetime(&ctx->tx_params));
 
-    if (!avs_time_monotonic_valid((*unconfirmed_ptr)->next_retransmit)) {
+    if (!avs_time_monotonic_valid(unconfirmed->next_retransmit)) {
         LOG(ERROR,
             _("unable to schedule msg retransmission: next_retransmit time "
               "invalid; either the monotonic clock malfunctioned or UDP tx "
               "params are too large to handle"));
-        fail_unconfirmed(ctx, unconfirmed_ptr, NULL,
+        fail_unconfirmed(ctx, unconfirmed, NULL,
                          _avs_coap_err(AVS_COAP_ERR_TIME_INVALID));
         return;
     }
 
-    avs_coap_udp_unconfirmed_msg_t *unconfirmed =
-            AVS_LIST_DETACH(unconfirmed_ptr);
     // disable further retransmissions
     unconfirmed->retry_state.retry_count = UINT_MAX;
-    unconfirmed->next_retransmit = next_retransmit;
-
-    AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed), unconfirmed);
+    reschedule_unconfirmed(ctx, unconfirmed, next_retransmit);
     reschedule_retransmission_job(ctx);
 }
 
 static avs_error_t handle_empty(avs_coap_udp_ctx_t *ctx,
                                 const avs_coap_udp_msg_t *msg) {
     uint16_t msg_id = _avs_coap_udp_header_get_id(&msg->header);
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr =
-            find_unconfirmed_ptr_by_msg_id(ctx, msg_id);
+    avs_coap_udp_unconfirmed_msg_t *unconfirmed =
+            find_unconfirmed_by_msg_id(ctx, msg_id);
 
     switch (_avs_coap_udp_header_get_type(&msg->header)) {
     case AVS_COAP_UDP_TYPE_CONFIRMABLE:
@@ -1322,13 +1791,14 @@ static avs_error_t handle_empty(avs_coap_udp_ctx_t *ctx,
 
     case AVS_COAP_UDP_TYPE_ACKNOWLEDGEMENT:
         // Separate ACK
-        if (unconfirmed_ptr) {
-            if (avs_coap_code_is_request((*unconfirmed_ptr)->msg.header.code)) {
+        if (unconfirmed) {
+            update_rtt_estimate(ctx, unconfirmed);
+            if (avs_coap_code_is_request(unconfirmed->msg.header.code)) {
                 // we still need to wait for a response
-                ack_request(ctx, unconfirmed_ptr);
+                ack_request(ctx, unconfirmed);
             } else {
                 // Separate ACK to Separate Response sent by us
-                confirm_unconfirmed(ctx, unconfirmed_ptr, NULL);
+                confirm_unconfirmed(ctx, unconfirmed, NULL);
             }
             return AVS_OK;
         } else {
@@ -1340,9 +1810,9 @@ static avs_error_t handle_empty(avs_coap_udp_ctx_t *ctx,
         }
 
     case AVS_COAP_UDP_TYPE_RESET: {
-        if (unconfirmed_ptr) {
+        if (unconfirmed) {
             // Reset response to our CON request
-            fail_unconfirmed(ctx, unconfirmed_ptr, NULL,
+            fail_unconfirmed(ctx, unconfirmed, NULL,
                              _avs_coap_err(AVS_COAP_ERR_UDP_RESET_RECEIVED));
         }
 
@@ -1428,10 +1898,10 @@ static void handle_truncated_response(avs_coap_udp_ctx_t *ctx,
     assert(avs_coap_code_is_response(truncated_msg->header.code));
     // Truncated response: notify the owner about failure. The handler will
     // be able to detect that truncation happened by inspecting socket errno
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr =
-            find_unconfirmed_ptr_by_response(ctx, truncated_msg);
-    if (unconfirmed_ptr) {
-        fail_unconfirmed(ctx, unconfirmed_ptr, truncated_msg,
+    avs_coap_udp_unconfirmed_msg_t *unconfirmed =
+            find_unconfirmed_by_response(ctx, truncated_msg);
+    if (unconfirmed) {
+        fail_unconfirmed(ctx, unconfirmed, truncated_msg,
                          _avs_coap_err(
                                  AVS_COAP_ERR_TRUNCATED_MESSAGE_RECEIVED));
     }
@@ -1502,10 +1972,10 @@ coap_udp_receive_message(avs_coap_ctx_t *ctx_,
             } else if (avs_coap_code_is_response(msg.header.code)) {
                 // At this point token and ID are available in the msg
                 // struct.
-                AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr =
-                        find_unconfirmed_ptr_by_response(ctx, &msg);
-                if (unconfirmed_ptr) {
-                    fail_unconfirmed(ctx, unconfirmed_ptr, NULL, err);
+                avs_coap_udp_unconfirmed_msg_t *unconfirmed =
+                        find_unconfirmed_by_response(ctx, &msg);
+                if (unconfirmed) {
+                    fail_unconfirmed(ctx, unconfirmed, NULL, err);
                 }
                 const avs_coap_udp_type_t type =
                         _avs_coap_udp_header_get_type(&msg.header);
@@ -1553,12 +2023,17 @@ static avs_error_t coap_udp_accept_observation(avs_coap_ctx_t *ctx_,
 static void coap_udp_cleanup(avs_coap_ctx_t *ctx_) {
     avs_coap_udp_ctx_t *ctx = (avs_coap_udp_ctx_t *) ctx_;
 
-    while (ctx->unconfirmed_messages) {
-        avs_coap_udp_unconfirmed_msg_t *unconfirmed =
-                AVS_LIST_DETACH(&ctx->unconfirmed_messages);
+    avs_coap_udp_unconfirmed_msg_t *unconfirmed;
+    while ((unconfirmed = first_unconfirmed(ctx))) {
+        detach_unconfirmed(ctx, unconfirmed);
         try_cleanup_unconfirmed(ctx, unconfirmed, NULL,
                                 AVS_COAP_SEND_RESULT_CANCEL, AVS_OK);
     }
+    AVS_LIST_CLEAR(&ctx->batch);
+    avs_free(ctx->started_messages.entries);
+    avs_free(ctx->held_messages.entries);
+    _avs_coap_hash_index_cleanup(&ctx->unconfirmed_by_msg_id);
+    _avs_coap_hash_index_cleanup(&ctx->unconfirmed_by_token);
     avs_free(ctx);
 }
 
@@ -1569,7 +2044,24 @@ static avs_coap_base_t *coap_udp_get_base(avs_coap_ctx_t *ctx_) {
 
 static avs_coap_stats_t coap_udp_get_stats(avs_coap_ctx_t *ctx_) {
     avs_coap_udp_ctx_t *ctx = (avs_coap_udp_ctx_t *) ctx_;
-    return ctx->stats;
+    avs_coap_stats_t stats = ctx->stats;
+    if (ctx->rtt_estimation_enabled) {
+        const avs_coap_udp_rtt_estimator_t *estimator = &ctx->rtt_estimator;
+        stats.rtt_estimator.rto = effective_tx_params(ctx).ack_timeout;
+        stats.rtt_estimator.strong_srtt =
+                avs_time_duration_from_fscalar(estimator->strong.srtt,
+                                               AVS_TIME_S);
+        stats.rtt_estimator.strong_rto =
+                avs_time_duration_from_fscalar(estimator->strong.rto,
+                                               AVS_TIME_S);
+        stats.rtt_estimator.weak_srtt =
+                avs_time_duration_from_fscalar(estimator->weak.srtt,
+                                               AVS_TIME_S);
+        stats.rtt_estimator.weak_rto =
+                avs_time_duration_from_fscalar(estimator->weak.rto,
+                                               AVS_TIME_S);
+    }
+    return stats;
 }
 
 static avs_error_t coap_udp_setsock(avs_coap_ctx_t *ctx,
@@ -1670,6 +2162,66 @@ int avs_coap_udp_ctx_set_forced_incoming_mtu(avs_coap_ctx_t *ctx,
     return 0;
 }
 
+int avs_coap_udp_ctx_set_rtt_estimation(avs_coap_ctx_t *ctx, bool enabled) {
+    if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
+        LOG(ERROR, _("avs_coap_udp_ctx_set_rtt_estimation() called on a NULL "
+                     "or non-UDP context"));
+        return -1;
+    }
+
+    avs_coap_udp_ctx_t *udp_ctx = (avs_coap_udp_ctx_t *) ctx;
+    if (enabled && !udp_ctx->rtt_estimation_enabled) {
+        _avs_coap_udp_rtt_reset(&udp_ctx->rtt_estimator,
+                                udp_ctx->tx_params.ack_timeout,
+                                avs_time_monotonic_now());
+    }
+    udp_ctx->rtt_estimation_enabled = enabled;
+    return 0;
+}
+
+int avs_coap_udp_ctx_set_batch_send_handler(avs_coap_ctx_t *ctx,
+                                            avs_coap_udp_batch_send_t *handler,
+                                            void *handler_arg) {
+    if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
+        LOG(ERROR, _("avs_coap_udp_ctx_set_batch_send_handler() called on a "
+                     "NULL or non-UDP context"));
+        return -1;
+    }
+
+    avs_coap_udp_ctx_t *udp_ctx = (avs_coap_udp_ctx_t *) ctx;
+    udp_ctx->batch_send_handler = handler;
+    udp_ctx->batch_send_handler_arg = handler_arg;
+    return 0;
+}
+
+int avs_coap_udp_ctx_begin_batch(avs_coap_ctx_t *ctx) {
+    if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
+        LOG(ERROR, _("avs_coap_udp_ctx_begin_batch() called on a NULL or "
+                     "non-UDP context"));
+        return -1;
+    }
+
+    begin_batch((avs_coap_udp_ctx_t *) ctx);
+    return 0;
+}
+
+int avs_coap_udp_ctx_end_batch(avs_coap_ctx_t *ctx) {
+    if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
+        LOG(ERROR, _("avs_coap_udp_ctx_end_batch() called on a NULL or "
+                     "non-UDP context"));
+        return -1;
+    }
+
+    avs_coap_udp_ctx_t *udp_ctx = (avs_coap_udp_ctx_t *) ctx;
+    if (!udp_ctx->batch_depth) {
+        LOG(ERROR, _("avs_coap_udp_ctx_end_batch() called without matching "
+                     "avs_coap_udp_ctx_begin_batch()"));
+        return -1;
+    }
+    end_batch(udp_ctx);
+    return 0;
+}
+
 int avs_coap_udp_ctx_set_tx_params(avs_coap_ctx_t *ctx,
                                    const avs_coap_udp_tx_params_t *tx_params) {
     if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
@@ -33,16 +33,40 @@
 VISIBILITY_SOURCE_BEGIN
 
 typedef struct endpoint {
+    // interned endpoint handle, unique within a single cache object
+    uint32_t id;
     uint16_t refcount;
     char addr[AVS_ADDRSTRLEN];
     char port[sizeof("65535")];
 } endpoint_t;
 
+#    define INDEX_SLOT_EMPTY UINT64_MAX
+
+/**
+ * Element of the open-addressing hash table that maps (endpoint, message ID)
+ * pairs onto cache entries.
+ */
+typedef struct {
+    // offset of the cache entry, counted from the very first byte ever
+    // appended to the buffer; INDEX_SLOT_EMPTY if the slot is unused
+    uint64_t position;
+    uint32_t endpoint_id;
+    uint16_t msg_id;
+} index_slot_t;
+
 struct avs_coap_udp_response_cache {
-    AVS_LIST(endpoint_t) endpoints; // sorted by id
+    AVS_LIST(endpoint_t) endpoints;
+    uint32_t next_endpoint_id;
 
     // priority queue of cache_entry_t, sorted by expiration_time
     avs_buffer_t *buffer;
+    // total number of bytes ever consumed from the front of the buffer
+    uint64_t consumed_bytes;
+
+    // linear probing hash table; index_capacity is always a power of two
+    index_slot_t *index;
+    size_t index_capacity;
+    size_t index_size;
 };
 
 typedef struct cache_entry {
@@ -80,6 +104,7 @@ avs_coap_udp_response_cache_create(size_t capacity) {
 void avs_coap_udp_response_cache_release(
         avs_coap_udp_response_cache_t **cache_ptr) {
     if (cache_ptr && *cache_ptr) {
+        avs_free((*cache_ptr)->index);
         avs_buffer_free(&(*cache_ptr)->buffer);
         AVS_LIST_CLEAR(&(*cache_ptr)->endpoints);
         avs_free(*cache_ptr);
@@ -87,20 +112,31 @@ void avs_coap_udp_response_cache_release(
     }
 }
 
-static endpoint_t *cache_endpoint_add_ref(avs_coap_udp_response_cache_t *cache,
-                                          const char *remote_addr,
-                                          const char *remote_port) {
+static endpoint_t *
+cache_endpoint_find(const avs_coap_udp_response_cache_t *cache,
+                    const char *remote_addr,
+                    const char *remote_port) {
     assert(remote_addr);
     assert(remote_port);
 
-    AVS_LIST(endpoint_t) *ep_ptr;
-    AVS_LIST_FOREACH_PTR(ep_ptr, &cache->endpoints) {
-        if (!strcmp(remote_addr, (*ep_ptr)->addr)
-                && !strcmp(remote_port, (*ep_ptr)->port)) {
-            ++(*ep_ptr)->refcount;
-            return *ep_ptr;
+    AVS_LIST(endpoint_t) ep;
+    AVS_LIST_FOREACH(ep, cache->endpoints) {
+        if (!strcmp(remote_addr, ep->addr) && !strcmp(remote_port, ep->port)) {
+            return ep;
         }
     }
+    return NULL;
+}
+
+static endpoint_t *cache_endpoint_add_ref(avs_coap_udp_response_cache_t *cache,
+                                          const char *remote_addr,
+                                          const char *remote_port) {
+    endpoint_t *existing_ep =
+            cache_endpoint_find(cache, remote_addr, remote_port);
+    if (existing_ep) {
+        ++existing_ep->refcount;
+        return existing_ep;
+    }
 
     AVS_LIST(endpoint_t) new_ep = AVS_LIST_NEW_ELEMENT(endpoint_t);
     if (!new_ep) {
@@ -122,6 +158,7 @@ static endpoint_t *cache_endpoint_add_ref(avs_coap_udp_response_cache_t *cache,
         return NULL;
     }
 
+    new_ep->id = cache->next_endpoint_id++;
     new_ep->refcount = 1;
     AVS_LIST_INSERT(&cache->endpoints, new_ep);
 
@@ -152,6 +189,101 @@ static size_t padding_bytes_after_msg(size_t msg_size) {
     }
 }
 
+static size_t index_slot_hash(uint32_t endpoint_id, uint16_t msg_id) {
+    // Fibonacci hashing; low bits of the result are used as the slot number
+    uint32_t hash = (endpoint_id * UINT32_C(0x9E3779B1))
+                    ^ (msg_id * UINT32_C(0x85EBCA6B));
+    return (size_t) (hash ^ (hash >> 16));
+}
+
+static size_t index_find_slot(const avs_coap_udp_response_cache_t *cache,
+                              uint32_t endpoint_id,
+                              uint16_t msg_id) {
+    assert(cache->index_capacity);
+    const size_t mask = cache->index_capacity - 1;
+    size_t i = index_slot_hash(endpoint_id, msg_id) & mask;
+    while (cache->index[i].position != INDEX_SLOT_EMPTY
+           && (cache->index[i].endpoint_id != endpoint_id
+               || cache->index[i].msg_id != msg_id)) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static int index_reserve_one(avs_coap_udp_response_cache_t *cache) {
+    // keep load factor at or below 1/2
+    if (2 * (cache->index_size + 1) <= cache->index_capacity) {
+        return 0;
+    }
+    size_t new_capacity =
+            cache->index_capacity ? 2 * cache->index_capacity : 16;
+    index_slot_t *new_index =
+            (index_slot_t *) avs_malloc(new_capacity * sizeof(*new_index));
+    if (!new_index) {
+        LOG(DEBUG, _("out of memory"));
+        return -1;
+    }
+    for (size_t i = 0; i < new_capacity; ++i) {
+        new_index[i].position = INDEX_SLOT_EMPTY;
+    }
+    index_slot_t *old_index = cache->index;
+    size_t old_capacity = cache->index_capacity;
+    cache->index = new_index;
+    cache->index_capacity = new_capacity;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_index[i].position != INDEX_SLOT_EMPTY) {
+            cache->index[index_find_slot(cache, old_index[i].endpoint_id,
+                                         old_index[i].msg_id)] = old_index[i];
+        }
+    }
+    avs_free(old_index);
+    return 0;
+}
+
+static void index_insert(avs_coap_udp_response_cache_t *cache,
+                         uint32_t endpoint_id,
+                         uint16_t msg_id,
+                         uint64_t position) {
+    assert(2 * (cache->index_size + 1) <= cache->index_capacity);
+    size_t i = index_find_slot(cache, endpoint_id, msg_id);
+    assert(cache->index[i].position == INDEX_SLOT_EMPTY);
+    cache->index[i] = (index_slot_t) {
+        .position = position,
+        .endpoint_id = endpoint_id,
+        .msg_id = msg_id
+    };
+    ++cache->index_size;
+}
+
+static void index_remove(avs_coap_udp_response_cache_t *cache,
+                         uint32_t endpoint_id,
+                         uint16_t msg_id) {
+    const size_t mask = cache->index_capacity - 1;
+    size_t i = index_find_slot(cache, endpoint_id, msg_id);
+    assert(cache->index[i].position != INDEX_SLOT_EMPTY);
+    --cache->index_size;
+
+    // backward shift deletion - no tombstones are necessary
+    size_t j = i;
+    while (true) {
+        cache->index[i].position = INDEX_SLOT_EMPTY;
+        size_t home;
+        do {
+            j = (j + 1) & mask;
+            if (cache->index[j].position == INDEX_SLOT_EMPTY) {
+                return;
+            }
+            home = index_slot_hash(cache->index[j].endpoint_id,
+                                   cache->index[j].msg_id)
+                   & mask;
+            // slot j may stay in place if its home slot lies cyclically
+            // within (i, j]
+        } while (i <= j ? (i < home && home <= j) : (i < home || home <= j));
+        cache->index[i] = cache->index[j];
+        i = j;
+    }
+}
+
 static void cache_put_entry(avs_coap_udp_response_cache_t *cache,
                             const avs_time_monotonic_t *expiration_time,
                             endpoint_t *endpoint,
@@ -169,6 +301,8 @@ static void cache_put_entry(avs_coap_udp_response_cache_t *cache,
 
     assert(avs_buffer_data_size(cache->buffer) % AVS_ALIGNOF(cache_entry_t)
            == 0);
+    index_insert(cache, endpoint->id, _avs_coap_udp_header_get_id(&msg->header),
+                 cache->consumed_bytes + avs_buffer_data_size(cache->buffer));
     int res;
     res = avs_buffer_append_bytes(cache->buffer, &entry,
                                   offsetof(cache_entry_t, data));
@@ -254,6 +388,7 @@ static void cache_free_bytes(avs_coap_udp_response_cache_t *cache,
             _("msg_cache: dropping msg (id = ") "%u" _(
                     ") to make room for a new one (size = ") "%lu" _(")"),
             entry_id(entry), (unsigned long) bytes_required);
+        index_remove(cache, entry->endpoint->id, entry_id(entry));
         cache_endpoint_del_ref(cache, entry->endpoint);
         bytes_free += entry_size(entry);
     }
@@ -262,6 +397,7 @@ static void cache_free_bytes(avs_coap_udp_response_cache_t *cache,
     int res = avs_buffer_consume_bytes(cache->buffer, expired_bytes);
     assert(!res);
     (void) res;
+    cache->consumed_bytes += expired_bytes;
 }
 
 static void cache_drop_expired(avs_coap_udp_response_cache_t *cache,
@@ -272,6 +408,7 @@ static void cache_drop_expired(avs_coap_udp_response_cache_t *cache,
         if (entry_expired(entry, now)) {
             LOG(TRACE, _("msg_cache: dropping expired msg (id = ") "%u" _(")"),
                 entry_id(entry));
+            index_remove(cache, entry->endpoint->id, entry_id(entry));
             cache_endpoint_del_ref(cache, entry->endpoint);
         } else {
             break;
@@ -282,6 +419,7 @@ static void cache_drop_expired(avs_coap_udp_response_cache_t *cache,
     int res = avs_buffer_consume_bytes(cache->buffer, expired_bytes);
     assert(!res);
     (void) res;
+    cache->consumed_bytes += expired_bytes;
 }
 
 static const cache_entry_t *
@@ -289,17 +427,29 @@ find_entry(const avs_coap_udp_response_cache_t *cache,
            const char *remote_addr,
            const char *remote_port,
            uint16_t msg_id) {
-    for (const cache_entry_t *entry = entry_first(cache);
-         entry_valid(cache, entry);
-         entry = entry_next(entry)) {
-        if (entry_id(entry) == msg_id
-                && !strcmp(entry->endpoint->addr, remote_addr)
-                && !strcmp(entry->endpoint->port, remote_port)) {
-            return entry;
-        }
+    if (!cache->index_size) {
+        return NULL;
+    }
+    const endpoint_t *endpoint =
+            cache_endpoint_find(cache, remote_addr, remote_port);
+    if (!endpoint) {
+        return NULL;
+    }
+    const index_slot_t *slot =
+            &cache->index[index_find_slot(cache, endpoint->id, msg_id)];
+    if (slot->position == INDEX_SLOT_EMPTY) {
+        return NULL;
     }
 
-    return NULL;
+    assert(slot->position >= cache->consumed_bytes);
+    const cache_entry_t *entry =
+            (const cache_entry_t *) ((const char *) entry_first(cache)
+                                     + (slot->position
+                                        - cache->consumed_bytes));
+    assert(entry_valid(cache, entry));
+    assert(entry->endpoint == endpoint);
+    assert(entry_id(entry) == msg_id);
+    return entry;
 }
 
 int _avs_coap_udp_response_cache_add(
@@ -331,6 +481,10 @@ int _avs_coap_udp_response_cache_add(
         return AVS_COAP_MSG_CACHE_DUPLICATE;
     }
 
+    if (index_reserve_one(cache)) {
+        return -1;
+    }
+
     endpoint_t *ep = cache_endpoint_add_ref(cache, remote_addr, remote_port);
     if (!ep) {
         return -1;
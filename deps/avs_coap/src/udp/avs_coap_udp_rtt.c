@@ -0,0 +1,145 @@
+/*
+ * Copyright 2017-2023 AVSystem <avsystem@avsystem.com>
+ * AVSystem CoAP library
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avs_coap_init.h>
+
+#ifdef WITH_AVS_COAP_UDP
+
+#    include <avsystem/commons/avs_time.h>
+
+#    include "udp/avs_coap_udp_rtt.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+// RFC 6298, 2.3
+#    define RTT_ALPHA 0.125
+#    define RTT_BETA 0.25
+
+// Variance multipliers and weights of the estimators in the overall RTO,
+// as defined by CoCoA
+#    define STRONG_K 4.0
+#    define STRONG_WEIGHT 0.5
+#    define WEAK_K 1.0
+#    define WEAK_WEIGHT 0.25
+
+// RFC 6298, 2.5: "A maximum value MAY be placed on RTO provided it is at
+// least 60 seconds."
+#    define MAX_RTO_S 60.0
+
+// Thresholds (in seconds) of RTO aging and variable backoff factor ranges
+#    define SMALL_RTO_S 1.0
+#    define LARGE_RTO_S 3.0
+
+void _avs_coap_udp_rtt_reset(avs_coap_udp_rtt_estimator_t *estimator,
+                             avs_time_duration_t ack_timeout,
+                             avs_time_monotonic_t now) {
+    *estimator = (avs_coap_udp_rtt_estimator_t) {
+        .rto = avs_time_duration_to_fscalar(ack_timeout, AVS_TIME_S),
+        .last_update = now
+    };
+}
+
+static double abs_diff(double a, double b) {
+    return a > b ? a - b : b - a;
+}
+
+static void update_estimate(avs_coap_udp_rtt_estimate_t *estimate,
+                            double rtt,
+                            double k) {
+    if (estimate->rto == 0.0) {
+        // first measurement - RFC 6298, 2.2
+        estimate->srtt = rtt;
+        estimate->rttvar = rtt / 2.0;
+    } else {
+        // subsequent measurements - RFC 6298, 2.3
+        estimate->rttvar = (1.0 - RTT_BETA) * estimate->rttvar
+                           + RTT_BETA * abs_diff(estimate->srtt, rtt);
+        estimate->srtt = (1.0 - RTT_ALPHA) * estimate->srtt + RTT_ALPHA * rtt;
+    }
+    estimate->rto = estimate->srtt + k * estimate->rttvar;
+}
+
+void _avs_coap_udp_rtt_update(avs_coap_udp_rtt_estimator_t *estimator,
+                              avs_time_duration_t rtt,
+                              unsigned retry_count,
+                              avs_time_monotonic_t now) {
+    if (!avs_time_duration_valid(rtt)
+            || avs_time_duration_less(rtt, AVS_TIME_DURATION_ZERO)) {
+        return;
+    }
+    const double rtt_s = avs_time_duration_to_fscalar(rtt, AVS_TIME_S);
+
+    if (retry_count == 0) {
+        update_estimate(&estimator->strong, rtt_s, STRONG_K);
+        estimator->rto = STRONG_WEIGHT * estimator->strong.rto
+                         + (1.0 - STRONG_WEIGHT) * estimator->rto;
+    } else if (retry_count <= AVS_COAP_UDP_RTT_WEAK_MAX_RETRANSMIT) {
+        update_estimate(&estimator->weak, rtt_s, WEAK_K);
+        estimator->rto = WEAK_WEIGHT * estimator->weak.rto
+                         + (1.0 - WEAK_WEIGHT) * estimator->rto;
+    } else {
+        return;
+    }
+
+    if (estimator->rto > MAX_RTO_S) {
+        estimator->rto = MAX_RTO_S;
+    }
+    estimator->last_update = now;
+}
+
+avs_time_duration_t
+_avs_coap_udp_rtt_get_rto(avs_coap_udp_rtt_estimator_t *estimator,
+                          avs_time_duration_t ack_timeout,
+                          avs_time_monotonic_t now) {
+    const double ack_timeout_s =
+            avs_time_duration_to_fscalar(ack_timeout, AVS_TIME_S);
+    double idle_s = avs_time_duration_to_fscalar(
+            avs_time_monotonic_diff(now, estimator->last_update), AVS_TIME_S);
+
+    // RTO aging: a small RTO that has not been updated for 16 times its value
+    // is doubled, and a large one that has not been updated for 4 times its
+    // value is moved halfway towards ACK_TIMEOUT. Each aging step counts as an
+    // update, so a long idle period may result in several steps.
+    while (true) {
+        double aging_period_s;
+        double aged_rto;
+        if (estimator->rto < SMALL_RTO_S) {
+            aging_period_s = 16.0 * estimator->rto;
+            aged_rto = 2.0 * estimator->rto;
+        } else if (estimator->rto > LARGE_RTO_S
+                   && estimator->rto > ack_timeout_s) {
+            aging_period_s = 4.0 * estimator->rto;
+            aged_rto = 0.5 * (estimator->rto + ack_timeout_s);
+        } else {
+            break;
+        }
+        if (!(idle_s >= aging_period_s) || aging_period_s <= 0.0) {
+            break;
+        }
+        idle_s -= aging_period_s;
+        estimator->last_update = avs_time_monotonic_add(
+                estimator->last_update,
+                avs_time_duration_from_fscalar(aging_period_s, AVS_TIME_S));
+        estimator->rto = aged_rto;
+    }
+
+    return avs_time_duration_from_fscalar(estimator->rto, AVS_TIME_S);
+}
+
+double _avs_coap_udp_rtt_backoff_factor(avs_time_duration_t rto) {
+    const double rto_s = avs_time_duration_to_fscalar(rto, AVS_TIME_S);
+    if (rto_s < SMALL_RTO_S) {
+        return 3.0;
+    } else if (rto_s > LARGE_RTO_S) {
+        return 1.5;
+    }
+    return 2.0;
+}
+
+#endif // WITH_AVS_COAP_UDP
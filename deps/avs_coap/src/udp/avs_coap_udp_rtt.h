@@ -0,0 +1,98 @@
+/*
+ * Copyright 2017-2023 AVSystem <avsystem@avsystem.com>
+ * AVSystem CoAP library
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef AVS_COAP_SRC_UDP_UDP_RTT_H
+#define AVS_COAP_SRC_UDP_UDP_RTT_H
+
+#include <stdbool.h>
+
+#include <avsystem/commons/avs_time.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Maximum number of retransmissions after which an RTT measurement is still
+ * fed to the weak estimator. Exchanges retransmitted more times are ignored.
+ */
+#define AVS_COAP_UDP_RTT_WEAK_MAX_RETRANSMIT 2
+
+/**
+ * Single RFC 6298-style estimator. All values are in seconds; rto is 0 until
+ * the first measurement is made.
+ */
+typedef struct {
+    double srtt;
+    double rttvar;
+    double rto;
+} avs_coap_udp_rtt_estimate_t;
+
+/**
+ * Retransmission timeout estimator, as described in the CoCoA draft
+ * (draft-ietf-core-cocoa).
+ *
+ * Two estimators are kept: the "strong" one is fed with RTTs of exchanges
+ * confirmed without any retransmissions, and the "weak" one with RTTs of
+ * exchanges that needed up to @ref AVS_COAP_UDP_RTT_WEAK_MAX_RETRANSMIT
+ * retransmissions, measured since the initial transmission. Both are combined
+ * into the overall RTO, which is used instead of ACK_TIMEOUT.
+ *
+ * If no measurement is made for a while, the overall RTO drifts back towards
+ * ACK_TIMEOUT, so that stale values do not persist when the link conditions
+ * change.
+ */
+typedef struct {
+    avs_coap_udp_rtt_estimate_t strong;
+    avs_coap_udp_rtt_estimate_t weak;
+    /** Overall RTO, in seconds. */
+    double rto;
+    /** Time of the last update of the overall RTO, including aging. */
+    avs_time_monotonic_t last_update;
+} avs_coap_udp_rtt_estimator_t;
+
+/**
+ * Resets @p estimator to its initial state, in which the overall RTO is equal
+ * to @p ack_timeout .
+ */
+void _avs_coap_udp_rtt_reset(avs_coap_udp_rtt_estimator_t *estimator,
+                             avs_time_duration_t ack_timeout,
+                             avs_time_monotonic_t now);
+
+/**
+ * Feeds an RTT measurement into @p estimator .
+ *
+ * @param rtt         Time between the initial transmission of a message and
+ *                    receiving its acknowledgement.
+ * @param retry_count Number of retransmissions sent before the acknowledgement
+ *                    was received.
+ */
+void _avs_coap_udp_rtt_update(avs_coap_udp_rtt_estimator_t *estimator,
+                              avs_time_duration_t rtt,
+                              unsigned retry_count,
+                              avs_time_monotonic_t now);
+
+/**
+ * Applies RTO aging, if due, and returns the overall RTO.
+ *
+ * @param ack_timeout ACK_TIMEOUT the RTO drifts towards after a long time
+ *                    without measurements.
+ */
+avs_time_duration_t
+_avs_coap_udp_rtt_get_rto(avs_coap_udp_rtt_estimator_t *estimator,
+                          avs_time_duration_t ack_timeout,
+                          avs_time_monotonic_t now);
+
+/**
+ * @returns Variable backoff factor to use for an exchange with the initial
+ *          RTO equal to @p rto .
+ */
+double _avs_coap_udp_rtt_backoff_factor(avs_time_duration_t rto);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif // AVS_COAP_SRC_UDP_UDP_RTT_H
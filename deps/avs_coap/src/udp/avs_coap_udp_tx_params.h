@@ -49,6 +49,11 @@ typedef struct {
      * retransmitted one).
      */
     avs_time_duration_t recv_timeout;
+    /**
+     * Factor by which recv_timeout is multiplied on each retransmission. Zero
+     * means the binary exponential backoff defined by RFC7252.
+     */
+    double backoff_factor;
 } avs_coap_retry_state_t;
 
 static inline avs_error_t
@@ -79,7 +84,10 @@ _avs_coap_udp_initial_retry_state(const avs_coap_udp_tx_params_t *tx_params,
 static inline int
 _avs_coap_udp_update_retry_state(avs_coap_retry_state_t *retry_state) {
     retry_state->recv_timeout =
-            avs_time_duration_mul(retry_state->recv_timeout, 2);
+            retry_state->backoff_factor > 0.0
+                    ? avs_time_duration_fmul(retry_state->recv_timeout,
+                                             retry_state->backoff_factor)
+                    : avs_time_duration_mul(retry_state->recv_timeout, 2);
     ++retry_state->retry_count;
 
     return avs_time_duration_valid(retry_state->recv_timeout) ? 0 : -1;
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2017-2023 AVSystem <avsystem@avsystem.com>
+ * AVSystem CoAP library
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avs_coap_init.h>
+
+#ifdef AVS_UNIT_TESTING
+
+#    include <avsystem/commons/avs_memory.h>
+
+#    define AVS_UNIT_ENABLE_SHORT_ASSERTS
+#    include <avsystem/commons/avs_unit_test.h>
+
+#    include "src/avs_coap_hash_index.h"
+
+#    define MODULE_NAME test
+#    include <avs_coap_x_log_config.h>
+
+typedef struct {
+    uint64_t key;
+} test_element_t;
+
+static bool key_matches(const void *element, const void *key) {
+    return ((const test_element_t *) element)->key == *(const uint64_t *) key;
+}
+
+static test_element_t *find(const avs_coap_hash_index_t *index,
+                            uint32_t hash,
+                            uint64_t key) {
+    void *element = (void *) -1;
+    ASSERT_OK(_avs_coap_hash_index_find(index, hash, key_matches, &key,
+                                        &element));
+    return (test_element_t *) element;
+}
+
+AVS_UNIT_TEST(hash_index, empty) {
+    avs_coap_hash_index_t index = { 0 };
+    ASSERT_NULL(find(&index, _avs_coap_hash_u64(42), 42));
+    // removing something that is not there is a no-op
+    test_element_t element = { 42 };
+    _avs_coap_hash_index_remove(&index, _avs_coap_hash_u64(42), &element);
+    ASSERT_EQ(index.count, 0);
+    _avs_coap_hash_index_cleanup(&index);
+}
+
+AVS_UNIT_TEST(hash_index, insert_find_remove) {
+    avs_coap_hash_index_t index = { 0 };
+    test_element_t elements[] = { { 1 }, { 2 }, { 3 } };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(elements); ++i) {
+        _avs_coap_hash_index_insert(&index, _avs_coap_hash_u64(elements[i].key),
+                                    &elements[i]);
+    }
+    ASSERT_EQ(index.count, 3);
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(elements); ++i) {
+        ASSERT_TRUE(find(&index, _avs_coap_hash_u64(elements[i].key),
+                         elements[i].key)
+                    == &elements[i]);
+    }
+    ASSERT_NULL(find(&index, _avs_coap_hash_u64(4), 4));
+
+    _avs_coap_hash_index_remove(&index, _avs_coap_hash_u64(2), &elements[1]);
+    ASSERT_EQ(index.count, 2);
+    ASSERT_NULL(find(&index, _avs_coap_hash_u64(2), 2));
+    ASSERT_TRUE(find(&index, _avs_coap_hash_u64(3), 3) == &elements[2]);
+
+    _avs_coap_hash_index_cleanup(&index);
+    ASSERT_NULL(index.slots);
+    ASSERT_EQ(index.count, 0);
+}
+
+AVS_UNIT_TEST(hash_index, colliding_hashes) {
+    avs_coap_hash_index_t index = { 0 };
+    test_element_t elements[] = { { 1 }, { 2 }, { 3 } };
+    // all elements land in the same probe sequence
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(elements); ++i) {
+        _avs_coap_hash_index_insert(&index, 0, &elements[i]);
+    }
+    ASSERT_TRUE(find(&index, 0, 3) == &elements[2]);
+
+    // removing an element in the middle must not break the sequence
+    _avs_coap_hash_index_remove(&index, 0, &elements[1]);
+    ASSERT_NULL(find(&index, 0, 2));
+    ASSERT_TRUE(find(&index, 0, 3) == &elements[2]);
+
+    // slot of the removed element is reused
+    const size_t used = index.used;
+    _avs_coap_hash_index_insert(&index, 0, &elements[1]);
+    ASSERT_EQ(index.used, used);
+    ASSERT_TRUE(find(&index, 0, 2) == &elements[1]);
+    ASSERT_TRUE(find(&index, 0, 3) == &elements[2]);
+
+    _avs_coap_hash_index_cleanup(&index);
+}
+
+AVS_UNIT_TEST(hash_index, find_next_iterates_over_all_matches) {
+    avs_coap_hash_index_t index = { 0 };
+    test_element_t elements[] = { { 7 }, { 7 }, { 8 }, { 7 } };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(elements); ++i) {
+        _avs_coap_hash_index_insert(&index, _avs_coap_hash_u64(7),
+                                    &elements[i]);
+    }
+
+    bool found[AVS_ARRAY_SIZE(elements)] = { false };
+    const uint64_t key = 7;
+    size_t cursor = 0;
+    void *element;
+    while (!_avs_coap_hash_index_find_next(&index, _avs_coap_hash_u64(7),
+                                           key_matches, &key, &cursor, &element)
+           && element) {
+        size_t i = (size_t) ((test_element_t *) element - elements);
+        ASSERT_TRUE(i < AVS_ARRAY_SIZE(elements));
+        ASSERT_FALSE(found[i]);
+        found[i] = true;
+    }
+    ASSERT_NULL(element);
+    ASSERT_TRUE(found[0]);
+    ASSERT_TRUE(found[1]);
+    ASSERT_FALSE(found[2]);
+    ASSERT_TRUE(found[3]);
+
+    _avs_coap_hash_index_cleanup(&index);
+}
+
+AVS_UNIT_TEST(hash_index, removed_markers_do_not_accumulate) {
+    avs_coap_hash_index_t index = { 0 };
+    test_element_t elements[8];
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(elements); ++i) {
+        elements[i].key = i;
+        _avs_coap_hash_index_insert(&index, _avs_coap_hash_u64(i),
+                                    &elements[i]);
+    }
+    const size_t capacity = index.capacity;
+
+    // keep a steady number of live elements while cycling through many keys,
+    // like exchange IDs do
+    for (uint64_t key = AVS_ARRAY_SIZE(elements); key < 100000; ++key) {
+        test_element_t *element = &elements[key % AVS_ARRAY_SIZE(elements)];
+        _avs_coap_hash_index_remove(&index, _avs_coap_hash_u64(element->key),
+                                    element);
+        element->key = key;
+        _avs_coap_hash_index_insert(&index, _avs_coap_hash_u64(key), element);
+        ASSERT_TRUE(4 * index.used <= 3 * index.capacity);
+    }
+    ASSERT_EQ(index.count, AVS_ARRAY_SIZE(elements));
+    ASSERT_TRUE(index.capacity <= 2 * capacity);
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(elements); ++i) {
+        ASSERT_TRUE(find(&index, _avs_coap_hash_u64(elements[i].key),
+                         elements[i].key)
+                    == &elements[i]);
+    }
+
+    _avs_coap_hash_index_cleanup(&index);
+}
+
+AVS_UNIT_TEST(hash_index, many_elements) {
+    enum { ELEMENT_COUNT = 10000 };
+    test_element_t *elements =
+            (test_element_t *) avs_calloc(ELEMENT_COUNT, sizeof(*elements));
+    ASSERT_NOT_NULL(elements);
+
+    avs_coap_hash_index_t index = { 0 };
+    for (size_t i = 0; i < ELEMENT_COUNT; ++i) {
+        elements[i].key = i + 1;
+        _avs_coap_hash_index_insert(&index, _avs_coap_hash_u64(i + 1),
+                                    &elements[i]);
+    }
+    ASSERT_FALSE(index.degraded);
+    ASSERT_EQ(index.count, ELEMENT_COUNT);
+    ASSERT_TRUE(index.capacity <= 4 * ELEMENT_COUNT);
+
+    for (size_t i = 0; i < ELEMENT_COUNT; i += 2) {
+        _avs_coap_hash_index_remove(&index, _avs_coap_hash_u64(i + 1),
+                                    &elements[i]);
+    }
+    ASSERT_EQ(index.count, ELEMENT_COUNT / 2);
+    for (size_t i = 0; i < ELEMENT_COUNT; ++i) {
+        test_element_t *found = find(&index, _avs_coap_hash_u64(i + 1), i + 1);
+        if (i % 2) {
+            ASSERT_TRUE(found == &elements[i]);
+        } else {
+            ASSERT_NULL(found);
+        }
+    }
+    ASSERT_NULL(find(&index, _avs_coap_hash_u64(ELEMENT_COUNT + 1),
+                     ELEMENT_COUNT + 1));
+
+    for (size_t i = 1; i < ELEMENT_COUNT; i += 2) {
+        _avs_coap_hash_index_remove(&index, _avs_coap_hash_u64(i + 1),
+                                    &elements[i]);
+    }
+    ASSERT_EQ(index.count, 0);
+    ASSERT_EQ(index.used, 0);
+
+    _avs_coap_hash_index_cleanup(&index);
+    avs_free(elements);
+}
+
+AVS_UNIT_TEST(hash_index, hash_bytes) {
+    // 32-bit FNV-1a test vectors
+    ASSERT_EQ(_avs_coap_hash_bytes("", 0), 0x811c9dc5U);
+    ASSERT_EQ(_avs_coap_hash_bytes("a", 1), 0xe40c292cU);
+    ASSERT_EQ(_avs_coap_hash_bytes("foobar", 6), 0xbf9cf968U);
+}
+
+#endif // AVS_UNIT_TESTING
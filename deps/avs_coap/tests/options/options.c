@@ -890,6 +890,45 @@ AVS_UNIT_TEST(coap_options, add_string_f_nullbyte) {
 #    undef EXPECTED_VALUE
 }
 
+AVS_UNIT_TEST(coap_options, view_next) {
+    uint8_t buf[64];
+    avs_coap_options_t opts = avs_coap_options_create_empty(buf, sizeof(buf));
+    ASSERT_OK(avs_coap_options_add_string(&opts, AVS_COAP_OPTION_URI_QUERY,
+                                          "pmin=5"));
+    ASSERT_OK(avs_coap_options_add_string(&opts, AVS_COAP_OPTION_URI_PATH,
+                                          "3"));
+    ASSERT_OK(avs_coap_options_add_empty(&opts, AVS_COAP_OPTION_URI_PATH));
+
+    avs_coap_option_iterator_t it = AVS_COAP_OPTION_ITERATOR_EMPTY;
+    uint32_t option_number;
+    const void *value;
+    size_t value_size;
+
+    ASSERT_OK(avs_coap_options_view_next_it(&opts, &it, &option_number, &value,
+                                            &value_size));
+    ASSERT_EQ(option_number, AVS_COAP_OPTION_URI_PATH);
+    ASSERT_EQ(value_size, 1);
+    ASSERT_EQ_BYTES_SIZED(value, "3", 1);
+    // value points directly into the options buffer
+    ASSERT_TRUE((const uint8_t *) value > buf
+                && (const uint8_t *) value < buf + sizeof(buf));
+
+    ASSERT_OK(avs_coap_options_view_next_it(&opts, &it, &option_number, &value,
+                                            &value_size));
+    ASSERT_EQ(option_number, AVS_COAP_OPTION_URI_PATH);
+    ASSERT_EQ(value_size, 0);
+
+    ASSERT_OK(avs_coap_options_view_next_it(&opts, &it, &option_number, &value,
+                                            &value_size));
+    ASSERT_EQ(option_number, AVS_COAP_OPTION_URI_QUERY);
+    ASSERT_EQ(value_size, sizeof("pmin=5") - 1);
+    ASSERT_EQ_BYTES_SIZED(value, "pmin=5", sizeof("pmin=5") - 1);
+
+    ASSERT_EQ(avs_coap_options_view_next_it(&opts, &it, &option_number, &value,
+                                            &value_size),
+              AVS_COAP_OPTION_MISSING);
+}
+
 #    define ETAG_FROM_STRING(Data)   \
         (avs_coap_etag_t) {          \
             .bytes = (Data),         \
@@ -335,6 +335,245 @@ AVS_UNIT_TEST(udp_async_client, send_request_multiple_with_nstart) {
     ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
 }
 
+AVS_UNIT_TEST(udp_async_client,
+              send_request_multiple_with_nstart_response_out_of_order) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_with_nstart(2);
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(CON, GET, ID(1), TOKEN(nth_token(1))),
+        COAP_MSG(CON, GET, ID(2), TOKEN(nth_token(2))),
+        COAP_MSG(CON, GET, ID(3), TOKEN(nth_token(3)))
+    };
+    const test_msg_t *responses[] = {
+        COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(ACK, CONTENT, ID(1), TOKEN(nth_token(1))),
+        COAP_MSG(ACK, CONTENT, ID(2), TOKEN(nth_token(2))),
+        COAP_MSG(ACK, CONTENT, ID(3), TOKEN(nth_token(3)))
+    };
+    AVS_STATIC_ASSERT(AVS_ARRAY_SIZE(requests) == AVS_ARRAY_SIZE(responses),
+                      mismatched_requests_responses_lists);
+
+    avs_coap_exchange_id_t ids[AVS_ARRAY_SIZE(requests)];
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(requests); ++i) {
+        ASSERT_OK(avs_coap_client_send_async_request(
+                env.coap_ctx, &ids[i], &requests[i]->request_header, NULL, NULL,
+                test_response_handler, &env.expects_list));
+        ASSERT_TRUE(avs_coap_exchange_id_valid(ids[i]));
+    }
+
+    // only the first two requests may be in flight at the same time
+    expect_send(&env, requests[0]);
+    expect_send(&env, requests[1]);
+    avs_sched_run(env.sched);
+
+    // each response frees a slot for the next held request, regardless of
+    // which of the in-flight requests it matches
+    static const size_t response_order[] = { 1, 0, 3, 2 };
+    size_t next_to_send = 2;
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(response_order); ++i) {
+        const size_t idx = response_order[i];
+        expect_recv(&env, responses[idx]);
+        expect_handler_call(&env, &ids[idx], AVS_COAP_CLIENT_REQUEST_OK,
+                            responses[idx]);
+        expect_has_buffered_data_check(&env, false);
+        ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL,
+                                                        NULL));
+
+        if (next_to_send < AVS_ARRAY_SIZE(requests)) {
+            expect_send(&env, requests[next_to_send++]);
+        }
+        avs_sched_run(env.sched);
+    }
+}
+
+typedef struct {
+    const test_msg_t *const *expected;
+    size_t expected_count;
+    size_t sent;
+    size_t calls;
+    bool decline;
+} test_batch_send_args_t;
+
+static avs_error_t test_batch_send(avs_net_socket_t *socket,
+                                   const avs_coap_udp_datagram_t *datagrams,
+                                   size_t count,
+                                   size_t *out_sent,
+                                   void *args_) {
+    (void) socket;
+    test_batch_send_args_t *args = (test_batch_send_args_t *) args_;
+    ++args->calls;
+    if (args->decline) {
+        *out_sent = 0;
+        return avs_errno(AVS_ENOTSUP);
+    }
+    ASSERT_TRUE(args->sent + count <= args->expected_count);
+    for (size_t i = 0; i < count; ++i) {
+        const test_msg_t *expected = args->expected[args->sent + i];
+        ASSERT_EQ(datagrams[i].size, expected->size);
+        ASSERT_EQ_BYTES_SIZED(datagrams[i].data, expected->data,
+                              expected->size);
+    }
+    args->sent += count;
+    *out_sent = count;
+    return AVS_OK;
+}
+
+AVS_UNIT_TEST(udp_async_client, batched_send) {
+    avs_coap_udp_tx_params_t tx_params = AVS_COAP_DEFAULT_UDP_TX_PARAMS;
+    tx_params.ack_random_factor = 1.0;
+    tx_params.nstart = 2;
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup(&tx_params, 4096, 4096, NULL);
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(CON, GET, ID(1), TOKEN(nth_token(1))),
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(CON, GET, ID(1), TOKEN(nth_token(1)))
+    };
+    const test_msg_t *responses[] = {
+        COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(ACK, CONTENT, ID(1), TOKEN(nth_token(1)))
+    };
+    test_batch_send_args_t args = {
+        .expected = requests,
+        .expected_count = AVS_ARRAY_SIZE(requests)
+    };
+    ASSERT_OK(avs_coap_udp_ctx_set_batch_send_handler(env.coap_ctx,
+                                                      test_batch_send, &args));
+
+    avs_coap_exchange_id_t ids[AVS_ARRAY_SIZE(responses)];
+
+    // requests sent within an explicit batch are sent together at its end
+    ASSERT_OK(avs_coap_udp_ctx_begin_batch(env.coap_ctx));
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(ids); ++i) {
+        ASSERT_OK(avs_coap_client_send_async_request(
+                env.coap_ctx, &ids[i], &requests[i]->request_header, NULL, NULL,
+                test_response_handler, &env.expects_list));
+    }
+    avs_sched_run(env.sched);
+    ASSERT_EQ(args.calls, 0);
+    ASSERT_OK(avs_coap_udp_ctx_end_batch(env.coap_ctx));
+    ASSERT_EQ(args.calls, 1);
+    ASSERT_EQ(args.sent, 2);
+    ASSERT_FAIL(avs_coap_udp_ctx_end_batch(env.coap_ctx));
+
+    // retransmissions that are due at the same time are batched as well
+    _avs_mock_clock_advance(tx_params.ack_timeout);
+    avs_sched_run(env.sched);
+    ASSERT_EQ(args.calls, 2);
+    ASSERT_EQ(args.sent, 4);
+
+    avs_coap_stats_t stats = avs_coap_get_stats(env.coap_ctx);
+    ASSERT_EQ(stats.outgoing_send_calls_count, 2);
+    ASSERT_EQ(stats.outgoing_datagrams_count, 4);
+    ASSERT_EQ(stats.outgoing_retransmissions_count, 2);
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(ids); ++i) {
+        expect_recv(&env, responses[i]);
+        expect_handler_call(&env, &ids[i], AVS_COAP_CLIENT_REQUEST_OK,
+                            responses[i]);
+        expect_has_buffered_data_check(&env, false);
+        ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL,
+                                                        NULL));
+    }
+}
+
+AVS_UNIT_TEST(udp_async_client, batched_send_fallback) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(CON, GET, ID(1), TOKEN(nth_token(1)))
+    };
+    const test_msg_t *responses[] = {
+        COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(ACK, CONTENT, ID(1), TOKEN(nth_token(1)))
+    };
+    test_batch_send_args_t args = {
+        .decline = true
+    };
+    ASSERT_OK(avs_coap_udp_ctx_set_batch_send_handler(env.coap_ctx,
+                                                      test_batch_send, &args));
+
+    avs_coap_exchange_id_t ids[AVS_ARRAY_SIZE(requests)];
+
+    ASSERT_OK(avs_coap_udp_ctx_begin_batch(env.coap_ctx));
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(requests); ++i) {
+        ASSERT_OK(avs_coap_client_send_async_request(
+                env.coap_ctx, &ids[i], &requests[i]->request_header, NULL, NULL,
+                test_response_handler, &env.expects_list));
+    }
+    avs_sched_run(env.sched);
+
+    // the handler declines, so the datagrams are sent one by one
+    expect_send(&env, requests[0]);
+    expect_send(&env, requests[1]);
+    ASSERT_OK(avs_coap_udp_ctx_end_batch(env.coap_ctx));
+    ASSERT_EQ(args.calls, 1);
+
+    avs_coap_stats_t stats = avs_coap_get_stats(env.coap_ctx);
+    ASSERT_EQ(stats.outgoing_send_calls_count, 3);
+    ASSERT_EQ(stats.outgoing_datagrams_count, 2);
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(requests); ++i) {
+        expect_recv(&env, responses[i]);
+        expect_handler_call(&env, &ids[i], AVS_COAP_CLIENT_REQUEST_OK,
+                            responses[i]);
+        expect_has_buffered_data_check(&env, false);
+        ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL,
+                                                        NULL));
+    }
+}
+
+AVS_UNIT_TEST(udp_async_client, batched_send_skips_canceled) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(CON, GET, ID(1), TOKEN(nth_token(1)))
+    };
+    const test_msg_t *response =
+            COAP_MSG(ACK, CONTENT, ID(1), TOKEN(nth_token(1)));
+    test_batch_send_args_t args = {
+        .expected = &requests[1],
+        .expected_count = 1
+    };
+    ASSERT_OK(avs_coap_udp_ctx_set_batch_send_handler(env.coap_ctx,
+                                                      test_batch_send, &args));
+
+    avs_coap_exchange_id_t ids[AVS_ARRAY_SIZE(requests)];
+
+    // only the first request is batched; the other one is held because of
+    // NSTART = 1
+    ASSERT_OK(avs_coap_udp_ctx_begin_batch(env.coap_ctx));
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(requests); ++i) {
+        ASSERT_OK(avs_coap_client_send_async_request(
+                env.coap_ctx, &ids[i], &requests[i]->request_header, NULL, NULL,
+                test_response_handler, &env.expects_list));
+    }
+    avs_sched_run(env.sched);
+
+    // canceling the first exchange starts the held one, and the datagram of
+    // the canceled one is never sent
+    expect_handler_call(&env, &ids[0], AVS_COAP_CLIENT_REQUEST_CANCEL, NULL);
+    avs_coap_exchange_cancel(env.coap_ctx, ids[0]);
+    avs_sched_run(env.sched);
+    ASSERT_OK(avs_coap_udp_ctx_end_batch(env.coap_ctx));
+    ASSERT_EQ(args.calls, 1);
+    ASSERT_EQ(args.sent, 1);
+
+    expect_recv(&env, response);
+    expect_handler_call(&env, &ids[1], AVS_COAP_CLIENT_REQUEST_OK, response);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+}
+
 AVS_UNIT_TEST(udp_async_client, send_request_with_retransmissions) {
     test_env_t env __attribute__((cleanup(test_teardown))) =
             test_setup_default();
@@ -428,6 +667,46 @@ AVS_UNIT_TEST(udp_async_client, cancel_single) {
     avs_coap_exchange_cancel(env.coap_ctx, id);
 }
 
+AVS_UNIT_TEST(udp_async_client, cancel_in_arbitrary_order) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_deterministic();
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(CON, PUT, ID(1), TOKEN(nth_token(1))),
+        COAP_MSG(CON, POST, ID(2), TOKEN(nth_token(2))),
+        COAP_MSG(CON, DELETE, ID(3), TOKEN(nth_token(3)))
+    };
+    avs_coap_exchange_id_t ids[AVS_ARRAY_SIZE(requests)];
+
+    // only the first one should be sent; others are suspended because of
+    // NSTART = 1
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(requests); ++i) {
+        ASSERT_OK(avs_coap_client_send_async_request(
+                env.coap_ctx, &ids[i], &requests[i]->request_header, NULL, NULL,
+                test_response_handler, &env.expects_list));
+        ASSERT_TRUE(avs_coap_exchange_id_valid(ids[i]));
+    }
+
+    expect_send(&env, requests[0]);
+    avs_sched_run(env.sched);
+
+    // exchanges are detached from the middle and from the end of the list,
+    // so links to all the remaining ones need to be kept valid
+    expect_handler_call(&env, &ids[2], AVS_COAP_CLIENT_REQUEST_CANCEL, NULL);
+    avs_coap_exchange_cancel(env.coap_ctx, ids[2]);
+    expect_handler_call(&env, &ids[3], AVS_COAP_CLIENT_REQUEST_CANCEL, NULL);
+    avs_coap_exchange_cancel(env.coap_ctx, ids[3]);
+
+    // canceling an exchange again is a no-op
+    avs_coap_exchange_cancel(env.coap_ctx, ids[2]);
+
+    expect_handler_call(&env, &ids[1], AVS_COAP_CLIENT_REQUEST_CANCEL, NULL);
+    avs_coap_exchange_cancel(env.coap_ctx, ids[1]);
+    expect_handler_call(&env, &ids[0], AVS_COAP_CLIENT_REQUEST_CANCEL, NULL);
+    avs_coap_exchange_cancel(env.coap_ctx, ids[0]);
+}
+
 AVS_UNIT_TEST(udp_async_client, invalid_cancel) {
     test_env_t env __attribute__((cleanup(test_teardown))) =
             test_setup_default();
@@ -35,6 +35,41 @@ AVS_UNIT_TEST(udp_async_server, coap_ping) {
     ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
 }
 
+AVS_UNIT_TEST(udp_async_server, drain_limit) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+
+    const test_msg_t *pings[] = {
+        COAP_MSG(CON, EMPTY, ID(0), NO_PAYLOAD),
+        COAP_MSG(CON, EMPTY, ID(1), NO_PAYLOAD),
+        COAP_MSG(CON, EMPTY, ID(2), NO_PAYLOAD)
+    };
+    const test_msg_t *pongs[] = {
+        COAP_MSG(RST, EMPTY, ID(0), NO_PAYLOAD),
+        COAP_MSG(RST, EMPTY, ID(1), NO_PAYLOAD),
+        COAP_MSG(RST, EMPTY, ID(2), NO_PAYLOAD)
+    };
+
+    avs_coap_set_incoming_packets_drain_limit(env.coap_ctx, 2);
+    ASSERT_EQ(avs_coap_get_incoming_packets_drain_limit(env.coap_ctx), 2);
+
+    // plain UDP sockets never report buffered data, but the datagrams queued
+    // in the OS are handled up to the limit anyway
+    for (size_t i = 0; i < 2; ++i) {
+        expect_recv(&env, pings[i]);
+        expect_send(&env, pongs[i]);
+        expect_has_buffered_data_check(&env, false);
+    }
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    // below the limit, receiving stops when there is nothing more to receive
+    expect_recv(&env, pings[2]);
+    expect_send(&env, pongs[2]);
+    expect_has_buffered_data_check(&env, false);
+    avs_unit_mocksock_input_fail(env.mocksock, avs_errno(AVS_ETIMEDOUT));
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+}
+
 AVS_UNIT_TEST(udp_async_server, non_request_non_response_non_empty_is_ignored) {
     test_env_t env __attribute__((cleanup(test_teardown))) =
             test_setup_default();
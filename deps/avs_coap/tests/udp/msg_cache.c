@@ -424,4 +424,53 @@ AVS_UNIT_TEST(coap_msg_cache, multiple_hosts_same_ids) {
     avs_coap_udp_response_cache_release(&cache);
 }
 
+AVS_UNIT_TEST(coap_msg_cache, index_consistent_after_many_evictions) {
+    static const char *const hosts[] = { "h1", "h2", "h3" };
+    enum { ENTRIES_FITTING = 10, ENTRIES_ADDED = 1000 };
+
+    test_udp_msg_t msgs[ENTRIES_ADDED];
+    for (size_t i = 0; i < ENTRIES_ADDED; ++i) {
+        msgs[i] = setup_msg_with_id((uint16_t) (i * 7), "");
+    }
+    const size_t entry_size =
+            _avs_coap_udp_response_cache_overhead(&msgs[0].udp_msg)
+            + _avs_coap_udp_msg_size(&msgs[0].udp_msg);
+    avs_coap_udp_response_cache_t *cache =
+            avs_coap_udp_response_cache_create(entry_size * ENTRIES_FITTING);
+
+    for (size_t i = 0; i < ENTRIES_ADDED; ++i) {
+        ASSERT_OK(_avs_coap_udp_response_cache_add(
+                cache, hosts[i % AVS_ARRAY_SIZE(hosts)], "port",
+                &msgs[i].udp_msg, &tx_params));
+
+        // the newest ENTRIES_FITTING entries are available
+        for (size_t j = (i >= ENTRIES_FITTING ? i - ENTRIES_FITTING + 1 : 0);
+             j <= i;
+             ++j) {
+            avs_coap_udp_cached_response_t cached_msg;
+            ASSERT_OK(_avs_coap_udp_response_cache_get(
+                    cache, hosts[j % AVS_ARRAY_SIZE(hosts)], "port",
+                    (uint16_t) (j * 7), &cached_msg));
+            assert_udp_msg_equal(msgs[j].udp_msg, cached_msg.msg);
+        }
+        // the evicted ones are not
+        if (i >= ENTRIES_FITTING) {
+            size_t evicted = i - ENTRIES_FITTING;
+            ASSERT_FAIL(_avs_coap_udp_response_cache_get(
+                    cache, hosts[evicted % AVS_ARRAY_SIZE(hosts)], "port",
+                    (uint16_t) (evicted * 7),
+                    &(avs_coap_udp_cached_response_t) { 0 }));
+        }
+        // same ID with a different endpoint is not a hit
+        ASSERT_FAIL(_avs_coap_udp_response_cache_get(
+                cache, hosts[(i + 1) % AVS_ARRAY_SIZE(hosts)], "port",
+                (uint16_t) (i * 7), &(avs_coap_udp_cached_response_t) { 0 }));
+    }
+
+    avs_coap_udp_response_cache_release(&cache);
+    for (size_t i = 0; i < ENTRIES_ADDED; ++i) {
+        free_msg(&msgs[i]);
+    }
+}
+
 #endif // defined(AVS_UNIT_TESTING) && defined(WITH_AVS_COAP_UDP)
@@ -140,6 +140,42 @@ AVS_UNIT_TEST(udp_streaming_server, no_payload) {
             env.coap_ctx, streaming_handle_request, &args));
 }
 
+AVS_UNIT_TEST(udp_streaming_server, drain_limit) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(CON, GET, ID(1), TOKEN(nth_token(1)))
+    };
+    const test_msg_t *responses[] = {
+        COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(ACK, CONTENT, ID(1), TOKEN(nth_token(1)))
+    };
+
+    streaming_handle_request_args_t args = {
+        .expected_request_header = requests[0]->request_header,
+        .response_header = {
+            .code = responses[0]->response_header.code
+        },
+    };
+
+    avs_unit_mocksock_enable_recv_timeout_getsetopt(
+            env.mocksock, avs_time_duration_from_scalar(1, AVS_TIME_S));
+    avs_coap_set_incoming_packets_drain_limit(env.coap_ctx, 8);
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(requests); ++i) {
+        expect_recv(&env, requests[i]);
+        expect_send(&env, responses[i]);
+        expect_has_buffered_data_check(&env, false);
+    }
+    avs_unit_mocksock_input_fail(env.mocksock, avs_errno(AVS_ETIMEDOUT));
+
+    // both requests are handled in a single call
+    ASSERT_OK(avs_coap_streaming_handle_incoming_packet(
+            env.coap_ctx, streaming_handle_request, &args));
+}
+
 AVS_UNIT_TEST(udp_streaming_server, small_payload) {
 #    define REQUEST_PAYLOAD "Actually,"
 #    define RESPONSE_PAYLOAD "fish"
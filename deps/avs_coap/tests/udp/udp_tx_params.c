@@ -19,6 +19,7 @@
 #    include <avs_coap_x_log_config.h>
 
 #    include "./utils.h"
+#    include "udp/avs_coap_udp_rtt.h"
 #    include "udp/avs_coap_udp_tx_params.h"
 
 static const avs_coap_udp_tx_params_t DETERMINISTIC_TX_PARAMS = {
@@ -463,4 +464,183 @@ AVS_UNIT_TEST(udp_tx_params, nstart_decrease) {
     ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
 }
 
+static avs_time_monotonic_t at_ms(int64_t ms) {
+    return avs_time_monotonic_from_scalar(ms, AVS_TIME_MS);
+}
+
+static void assert_rto_ms(avs_coap_udp_rtt_estimator_t *estimator,
+                          avs_time_monotonic_t now,
+                          int64_t expected_ms) {
+    int64_t rto_ms;
+    ASSERT_OK(avs_time_duration_to_scalar(
+            &rto_ms, AVS_TIME_MS,
+            _avs_coap_udp_rtt_get_rto(
+                    estimator, AVS_COAP_DEFAULT_UDP_TX_PARAMS.ack_timeout,
+                    now)));
+    ASSERT_EQ(rto_ms, expected_ms);
+}
+
+AVS_UNIT_TEST(udp_tx_params, rtt_estimator_strong_and_weak) {
+    avs_coap_udp_rtt_estimator_t estimator;
+    _avs_coap_udp_rtt_reset(&estimator,
+                            AVS_COAP_DEFAULT_UDP_TX_PARAMS.ack_timeout,
+                            at_ms(0));
+    assert_rto_ms(&estimator, at_ms(0), 2000);
+
+    // strong: SRTT = 500 ms, RTTVAR = 250 ms, RTO = 500 + 4 * 250 = 1500 ms;
+    // overall: 0.5 * 1500 + 0.5 * 2000
+    _avs_coap_udp_rtt_update(&estimator,
+                             avs_time_duration_from_scalar(500, AVS_TIME_MS), 0,
+                             at_ms(500));
+    assert_rto_ms(&estimator, at_ms(500), 1750);
+
+    // weak: SRTT = 2000 ms, RTTVAR = 1000 ms, RTO = 2000 + 1000 = 3000 ms;
+    // overall: 0.25 * 3000 + 0.75 * 1750
+    _avs_coap_udp_rtt_update(&estimator,
+                             avs_time_duration_from_scalar(2, AVS_TIME_S), 2,
+                             at_ms(3000));
+    assert_rto_ms(&estimator, at_ms(3000), 2062);
+
+    // exchanges retransmitted more than twice are not taken into account
+    _avs_coap_udp_rtt_update(&estimator,
+                             avs_time_duration_from_scalar(30, AVS_TIME_S), 3,
+                             at_ms(4000));
+    assert_rto_ms(&estimator, at_ms(4000), 2062);
+}
+
+AVS_UNIT_TEST(udp_tx_params, rtt_estimator_aging) {
+    avs_coap_udp_rtt_estimator_t estimator;
+    _avs_coap_udp_rtt_reset(&estimator,
+                            AVS_COAP_DEFAULT_UDP_TX_PARAMS.ack_timeout,
+                            at_ms(0));
+
+    // weak: RTO = 8 + 4 = 12 s; overall: 0.25 * 12 + 0.75 * 2 = 4.5 s
+    _avs_coap_udp_rtt_update(&estimator,
+                             avs_time_duration_from_scalar(8, AVS_TIME_S), 1,
+                             at_ms(0));
+    assert_rto_ms(&estimator, at_ms(0), 4500);
+    ASSERT_EQ(_avs_coap_udp_rtt_backoff_factor(
+                      avs_time_duration_from_scalar(4500, AVS_TIME_MS)),
+              1.5);
+
+    // a large RTO is moved halfway towards ACK_TIMEOUT after 4 * RTO without
+    // updates: first after 18 s, then after another 4 * 3.25 = 13 s
+    assert_rto_ms(&estimator, at_ms(17999), 4500);
+    assert_rto_ms(&estimator, at_ms(18000), 3250);
+    assert_rto_ms(&estimator, at_ms(31000), 2625);
+    // RTO between 1 and 3 seconds does not age anymore
+    assert_rto_ms(&estimator, at_ms(1000000), 2625);
+
+    // strong: RTO = 0.125 + 4 * 0.0625 = 0.375 s; overall = 1.5 s
+    _avs_coap_udp_rtt_update(&estimator,
+                             avs_time_duration_from_scalar(125, AVS_TIME_MS), 0,
+                             at_ms(1000000));
+    // strong: RTTVAR = 0.75 * 0.0625, RTO = 0.125 + 4 * 0.046875 = 0.3125 s;
+    // overall = 0.90625 s
+    _avs_coap_udp_rtt_update(&estimator,
+                             avs_time_duration_from_scalar(125, AVS_TIME_MS), 0,
+                             at_ms(1000000));
+    assert_rto_ms(&estimator, at_ms(1000000), 906);
+    ASSERT_EQ(_avs_coap_udp_rtt_backoff_factor(
+                      avs_time_duration_from_scalar(906, AVS_TIME_MS)),
+              3.0);
+
+    // a small RTO is doubled after 16 * RTO = 14.5 s without updates
+    assert_rto_ms(&estimator, at_ms(1014499), 906);
+    assert_rto_ms(&estimator, at_ms(1014500), 1812);
+}
+
+AVS_UNIT_TEST(udp_tx_params, rtt_estimation) {
+    avs_coap_udp_tx_params_t tx_params = AVS_COAP_DEFAULT_UDP_TX_PARAMS;
+    tx_params.ack_random_factor = 1.0;
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup(&tx_params, 4096, 4096, NULL);
+
+    // disabled by default
+    avs_coap_stats_t stats = avs_coap_get_stats(env.coap_ctx);
+    ASSERT_TRUE(avs_time_duration_equal(stats.rtt_estimator.rto,
+                                        AVS_TIME_DURATION_ZERO));
+
+    ASSERT_OK(avs_coap_udp_ctx_set_rtt_estimation(env.coap_ctx, true));
+    stats = avs_coap_get_stats(env.coap_ctx);
+    ASSERT_TRUE(avs_time_duration_equal(stats.rtt_estimator.rto,
+                                        tx_params.ack_timeout));
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(CON, GET, ID(1), TOKEN(nth_token(1)))
+    };
+    const test_msg_t *responses[] = {
+        COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(ACK, CONTENT, ID(1), TOKEN(nth_token(1)))
+    };
+    avs_coap_exchange_id_t id;
+
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id, &requests[0]->request_header, NULL, NULL,
+            test_response_handler, &env.expects_list));
+    expect_send(&env, requests[0]);
+    avs_sched_run(env.sched);
+
+    // response without retransmissions after 500 ms updates the strong
+    // estimator: RTO = 0.5 + 4 * 0.25 = 1.5 s, overall: 0.5 * 1.5 + 0.5 * 2
+    _avs_mock_clock_advance(avs_time_duration_from_scalar(500, AVS_TIME_MS));
+    expect_recv(&env, responses[0]);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, responses[0]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    stats = avs_coap_get_stats(env.coap_ctx);
+    ASSERT_TRUE(avs_time_duration_equal(
+            stats.rtt_estimator.strong_srtt,
+            avs_time_duration_from_scalar(500, AVS_TIME_MS)));
+    ASSERT_TRUE(avs_time_duration_equal(
+            stats.rtt_estimator.strong_rto,
+            avs_time_duration_from_scalar(1500, AVS_TIME_MS)));
+    ASSERT_TRUE(avs_time_duration_equal(
+            stats.rtt_estimator.rto,
+            avs_time_duration_from_scalar(1750, AVS_TIME_MS)));
+
+    // the next request is retransmitted after the estimated RTO instead of
+    // ACK_TIMEOUT
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id, &requests[1]->request_header, NULL, NULL,
+            test_response_handler, &env.expects_list));
+    expect_send(&env, requests[1]);
+    avs_sched_run(env.sched);
+
+    _avs_mock_clock_advance(avs_time_duration_from_scalar(1500, AVS_TIME_MS));
+    avs_sched_run(env.sched);
+
+    _avs_mock_clock_advance(avs_time_duration_from_scalar(250, AVS_TIME_MS));
+    expect_send(&env, requests[1]);
+    avs_sched_run(env.sched);
+
+    // response after a retransmission, 2 s after the initial transmission,
+    // updates the weak estimator: RTO = 2 + 1 = 3 s,
+    // overall: 0.25 * 3 + 0.75 * 1.75
+    _avs_mock_clock_advance(avs_time_duration_from_scalar(250, AVS_TIME_MS));
+    expect_recv(&env, responses[1]);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, responses[1]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    stats = avs_coap_get_stats(env.coap_ctx);
+    ASSERT_TRUE(avs_time_duration_equal(
+            stats.rtt_estimator.weak_srtt,
+            avs_time_duration_from_scalar(2, AVS_TIME_S)));
+    ASSERT_TRUE(avs_time_duration_equal(
+            stats.rtt_estimator.weak_rto,
+            avs_time_duration_from_scalar(3, AVS_TIME_S)));
+    ASSERT_TRUE(avs_time_duration_equal(
+            stats.rtt_estimator.rto,
+            avs_time_duration_from_scalar(2062500, AVS_TIME_US)));
+
+    // disabling the estimator restores static ACK_TIMEOUT
+    ASSERT_OK(avs_coap_udp_ctx_set_rtt_estimation(env.coap_ctx, false));
+    stats = avs_coap_get_stats(env.coap_ctx);
+    ASSERT_TRUE(avs_time_duration_equal(stats.rtt_estimator.rto,
+                                        AVS_TIME_DURATION_ZERO));
+}
+
 #endif // defined(AVS_UNIT_TESTING) && defined(WITH_AVS_COAP_UDP)
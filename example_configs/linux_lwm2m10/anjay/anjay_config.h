@@ -187,6 +187,29 @@
  */
 #define ANJAY_WITH_EVENT_LOOP
 
+/**
+ * Use Linux <c>epoll</c> API instead of <c>poll()</c> or <c>select()</c> in
+ * <c>anjay_event_loop_run()</c>, and enable the <c>anjay_event_loop_group_t</c>
+ * API that allows serving multiple Anjay objects with a single, shared
+ * <c>epoll</c> instance.
+ *
+ * Requires <c>ANJAY_WITH_EVENT_LOOP</c> to be enabled, and the
+ * <c>sys/epoll.h</c> header to be available.
+ */
+#define ANJAY_WITH_EVENT_LOOP_EPOLL
+
+/**
+ * Send CoAP/UDP datagrams released at the same time, e.g. notifications
+ * triggered together, with a single <c>sendmmsg()</c> call on non-DTLS
+ * connections.
+ *
+ * Requires <c>AVS_COMMONS_NET_WITH_POSIX_AVS_SOCKET</c> to be enabled and the
+ * Linux <c>sendmmsg()</c> system call to be available. Cannot be used together
+ * with <c>ANJAY_WITH_NET_STATS</c>, as datagrams sent this way bypass the
+ * socket layer and are not accounted for in its statistics.
+ */
+/* #undef ANJAY_WITH_UDP_SENDMMSG */
+
 /**
  * Enable support for features new to LwM2M protocol version 1.1.
  */
@@ -244,6 +244,50 @@ typedef struct anjay_configuration {
      */
     size_t stored_notification_limit;
 
+    /**
+     * Enables aligned evaluation of periodic notifications, if set to a
+     * positive value.
+     *
+     * Triggers resulting from the "Maximum Period" attribute are then moved
+     * earlier, by less than this duration, so that they fall on multiples of
+     * this duration in real time. Periodic notifications of many observations
+     * are thus evaluated together and sent back-to-back, instead of being
+     * spread over time, which reduces the number of times the radio needs to be
+     * woken up.
+     *
+     * NOTE: Enabling this causes periodic notifications to be sent up to this
+     * duration earlier than required by the "Maximum Period" attribute. They
+     * are never sent earlier than allowed by the "Minimum Period" attribute,
+     * though - if these two are close to each other, the trigger is moved back
+     * only as far as the "Minimum Period" allows. Notifications caused by
+     * value changes are not affected.
+     *
+     * If zero-initialized (default), triggers are not aligned.
+     */
+    avs_time_duration_t notify_alignment;
+
+    /**
+     * Enables caching of effective attributes of observed paths.
+     *
+     * If set to true, attributes resolved for each observed path (including
+     * the inherited and server-level ones) are remembered and reused whenever
+     * notifications are evaluated, instead of being queried from the data
+     * model each time. The cache is dropped whenever the set of instances of
+     * any object changes (see @ref anjay_notify_instances_changed), Short
+     * Server ID or Default Minimum/Maximum Period resource of the Server
+     * object changes, attributes are written by the server, Attribute Storage
+     * contents are modified or objects are registered or unregistered. Changes
+     * of other resource values do not drop the cache.
+     *
+     * NOTE: If any object implements custom attribute handlers, enabling this
+     * requires the application to call @ref anjay_notify_instances_changed
+     * after changing attributes in any other way than via the handlers called
+     * by the library. Otherwise, stale attribute values might be used.
+     *
+     * If false (default), attributes are queried each time they are needed.
+     */
+    bool cache_effective_attributes;
+
     /**
      * Sets the preference of the library for Content-Format used when
      * responding to a request without Accept option.
@@ -422,6 +466,20 @@ typedef struct anjay_configuration {
     bool rebuild_client_cert_chain;
 #endif // ANJAY_WITH_LWM2M11
 
+    /**
+     * Maximum number of incoming CoAP/UDP packets handled by a single call to
+     * @ref anjay_serve, if more datagrams are already queued on the socket.
+     *
+     * If left at 0, each call to @ref anjay_serve handles a single datagram
+     * (plus any data already buffered by the DTLS layer), so a burst of
+     * incoming requests requires a separate @ref anjay_serve call, and a
+     * separate poll() wakeup, for each packet.
+     *
+     * Setting this to a nonzero value allows handling such bursts within a
+     * single @ref anjay_serve call, at the cost of one additional receive
+     * operation that fails with a timeout at the end of each call.
+     */
+    size_t udp_incoming_packets_drain_limit;
 } anjay_configuration_t;
 
 /**
@@ -750,7 +808,8 @@ void anjay_sched_run(anjay_t *anjay);
  *
  * <strong>CAUTION:</strong> The preimplemented event loop will only work if all
  * the sockets that may be created by Anjay will return file descriptors
- * compatible with <c>poll()</c> or <c>select()</c> through
+ * compatible with <c>poll()</c> or <c>select()</c> (or <c>epoll</c>, if
+ * <c>ANJAY_WITH_EVENT_LOOP_EPOLL</c> is enabled) through
  * <c>avs_net_socket_get_system()</c>.
  *
  * In particular, please be cautious when using SMS or NIDD transports (in
@@ -871,7 +930,139 @@ int anjay_event_loop_interrupt(anjay_t *anjay);
  *          fatal.
  */
 int anjay_serve_any(anjay_t *anjay, avs_time_duration_t max_wait_time);
-#endif // ANJAY_WITH_EVENT_LOOP
+
+#    ifdef ANJAY_WITH_EVENT_LOOP_EPOLL
+/**
+ * A set of Anjay objects that are served by a single event loop, waiting on a
+ * single, shared <c>epoll</c> instance.
+ *
+ * This is intended for applications that run many Anjay instances in a single
+ * process - the cost of each wakeup of the event loop is then proportional to
+ * the number of sockets that are actually ready, instead of the total number of
+ * sockets used by all the instances.
+ */
+typedef struct anjay_event_loop_group_struct anjay_event_loop_group_t;
+
+/**
+ * Creates a new, empty event loop group.
+ *
+ * @returns Newly created group, or NULL in case of an error.
+ */
+anjay_event_loop_group_t *anjay_event_loop_group_new(void);
+
+/**
+ * Frees all resources associated with an event loop group. All the Anjay
+ * objects that still belong to the group are removed from it, as if
+ * @ref anjay_event_loop_group_remove was called on them; the Anjay objects
+ * themselves are <strong>not</strong> deleted.
+ *
+ * This function shall not be called while @ref anjay_event_loop_group_run is
+ * running on the same group.
+ *
+ * @param group_ptr Pointer to a variable holding the group to delete. It will
+ *                  be set to NULL afterwards.
+ */
+void anjay_event_loop_group_delete(anjay_event_loop_group_t **group_ptr);
+
+/**
+ * Adds an Anjay object to an event loop group.
+ *
+ * While the object belongs to the group, it is considered to have its event
+ * loop running, i.e. attempting to call @ref anjay_event_loop_run or
+ * @ref anjay_event_loop_run_with_error_handling on it will fail.
+ *
+ * This function may be called while @ref anjay_event_loop_group_run is running
+ * on the same group, including from within callbacks called by the loop. The
+ * newly added object will be served starting with the next iteration of the
+ * loop.
+ *
+ * @param group Event loop group to operate on.
+ * @param anjay Anjay object to add. It must not be deleted before being
+ *              removed from the group.
+ *
+ * @returns 0 for success, or a negative value in case of error, including the
+ *          case in which the event loop is already running for @p anjay.
+ */
+int anjay_event_loop_group_add(anjay_event_loop_group_t *group, anjay_t *anjay);
+
+/**
+ * Removes an Anjay object from an event loop group.
+ *
+ * This function may be called while @ref anjay_event_loop_group_run is running
+ * on the same group. Other objects in the group keep being served normally.
+ *
+ * If thread safety is enabled, this function waits until none of the threads
+ * running the loop uses @p anjay anymore, so the object may be safely deleted
+ * after this function returns. For this reason, it MUST NOT be called from
+ * within a callback called by the event loop for @p anjay itself, as it would
+ * then wait forever.
+ *
+ * If thread safety is disabled, it may also be called from within such
+ * callback. The object will then stop being used by the loop as soon as the
+ * callback returns.
+ *
+ * @param group Event loop group to operate on.
+ * @param anjay Anjay object to remove.
+ *
+ * @returns 0 for success, or a negative value if @p anjay does not belong to
+ *          @p group.
+ */
+int anjay_event_loop_group_remove(anjay_event_loop_group_t *group,
+                                  anjay_t *anjay);
+
+/**
+ * Runs an event loop that executes @ref anjay_serve and @ref anjay_sched_run
+ * as appropriate for all Anjay objects in the group.
+ *
+ * The semantics are the same as for
+ * @ref anjay_event_loop_run_with_error_handling (if
+ * <c>enable_error_handling</c> is true) or @ref anjay_event_loop_run
+ * (otherwise), applied to each of the Anjay objects, except that the loop can
+ * only be stopped using @ref anjay_event_loop_group_interrupt.
+ *
+ * If Anjay is compiled with thread safety enabled, this function may be called
+ * concurrently from multiple threads on the same group, so that the objects in
+ * the group are served by a pool of worker threads created by the application.
+ * Each call joins the already running loop instead of failing. Each Anjay
+ * object is still accessed under its own mutex, so the operations on a single
+ * object are serialized, while different objects may be served in parallel.
+ * Readiness of each socket is reported to at most one of the threads at a
+ * time. All the calls return after the group is interrupted, although each of
+ * the threads may need up to @p max_wait_time to notice that.
+ *
+ * If thread safety is disabled, calling this function while it is already
+ * running on the same group fails.
+ *
+ * @param group                 Event loop group to operate on.
+ * @param max_wait_time         Maximum time to spend in each single call to
+ *                              <c>epoll_wait()</c>.
+ * @param enable_error_handling Whether to call
+ *                              @ref anjay_transport_schedule_reconnect on
+ *                              objects for which none of the configured servers
+ *                              could be reached.
+ *
+ * @returns 0 after having been successfully interrupted by
+ *          @ref anjay_event_loop_group_interrupt, or a negative value in case
+ *          of a fatal error.
+ */
+int anjay_event_loop_group_run(anjay_event_loop_group_t *group,
+                               avs_time_duration_t max_wait_time,
+                               bool enable_error_handling);
+
+/**
+ * Interrupts an ongoing execution of @ref anjay_event_loop_group_run.
+ *
+ * The same caveats as for @ref anjay_event_loop_interrupt apply.
+ *
+ * @param group Event loop group to operate on.
+ *
+ * @returns 0 if the interrupt has been successfully raised, or a negative value
+ *          if the event loop is either not running or already in the process of
+ *          finishing due to a previous interrupt.
+ */
+int anjay_event_loop_group_interrupt(anjay_event_loop_group_t *group);
+#    endif // ANJAY_WITH_EVENT_LOOP_EPOLL
+#endif     // ANJAY_WITH_EVENT_LOOP
 
 /**
  * Schedules sending a Register message to the server identified by given
@@ -995,6 +995,37 @@ int anjay_notify_changed(anjay_t *anjay,
                          anjay_iid_t iid,
                          anjay_rid_t rid);
 
+/**
+ * Path of a Resource, as used by @ref anjay_notify_changed_batch.
+ */
+typedef struct {
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+    anjay_rid_t rid;
+} anjay_notify_resource_path_t;
+
+/**
+ * Works like calling @ref anjay_notify_changed for each of the specified
+ * Resources, but acquires the Anjay mutex only once. It is intended for
+ * applications that report changes of many Resources at a high rate.
+ *
+ * Changes of Resources in Objects with small Instance and Resource IDs are
+ * recorded in compact bitmaps that are reused between notification rounds, so
+ * that reporting repeated changes does not allocate memory.
+ *
+ * @param anjay       Anjay object to operate on.
+ * @param paths       Array of paths of changed Resources. Duplicate entries are
+ *                    allowed and are coalesced.
+ * @param paths_count Number of elements in @p paths.
+ *
+ * @returns 0 on success, a negative value in case of error. In case of error,
+ *          notifications about some of the Resources may still have been
+ *          scheduled.
+ */
+int anjay_notify_changed_batch(anjay_t *anjay,
+                               const anjay_notify_resource_path_t *paths,
+                               size_t paths_count);
+
 /**
  * Notifies the library that the set of Instances existing in a given Object
  * changed. It may trigger a LwM2M Notify message, update server connections
@@ -1013,6 +1044,78 @@ int anjay_notify_changed(anjay_t *anjay,
  */
 int anjay_notify_instances_changed(anjay_t *anjay, anjay_oid_t oid);
 
+/**
+ * Enables caching of the set of Instances of a registered Object.
+ *
+ * By default, the library calls the <c>list_instances</c> handler every time it
+ * needs to check whether a given Object Instance exists, which happens during
+ * processing of almost every request, notification and access control check.
+ * With the cache enabled, the set of Instances is retrieved once and reused
+ * until it is invalidated, so that presence checks do not call into user code.
+ *
+ * The cache is invalidated whenever Instances are created or removed by the
+ * LwM2M Server and whenever @ref anjay_notify_instances_changed is called for
+ * the Object. This means that when the cache is enabled, it is REQUIRED to call
+ * @ref anjay_notify_instances_changed immediately after any change to the set
+ * of Instances performed by means other than LwM2M - otherwise the library may
+ * operate on outdated data.
+ *
+ * The cache is automatically freed when the Object is unregistered.
+ *
+ * @param anjay Anjay object to operate on.
+ * @param oid   Object ID of an Object previously registered using
+ *              @ref anjay_register_object.
+ *
+ * @returns 0 on success, a negative value if the Object is not registered or in
+ *          case of an out-of-memory condition.
+ */
+int anjay_enable_instance_cache(anjay_t *anjay, anjay_oid_t oid);
+
+/**
+ * Enables caching of Resource kinds and presence in Instances of a registered
+ * Object.
+ *
+ * By default, the library calls the <c>list_resources</c> handler every time it
+ * needs to know the kind or presence of a single Resource, which happens during
+ * Write, Execute, Discover and evaluation of notifications. With the cache
+ * enabled, the list of Resources of each Instance is retrieved once and reused
+ * until it is invalidated.
+ *
+ * The cached data of an Instance is dropped whenever any of its Resources is
+ * written, reset or executed by the LwM2M Server, and whenever
+ * @ref anjay_notify_changed is called for any of its Resources. Cached data of
+ * all Instances is dropped whenever the set of Instances changes. This means
+ * that when the cache is enabled, it is REQUIRED to call
+ * @ref anjay_notify_changed after any change to the kind or presence of a
+ * Resource performed by means other than LwM2M.
+ *
+ * The cache is automatically freed when the Object is unregistered.
+ *
+ * @param anjay Anjay object to operate on.
+ * @param oid   Object ID of an Object previously registered using
+ *              @ref anjay_register_object.
+ *
+ * @returns 0 on success, a negative value if the Object is not registered or in
+ *          case of an out-of-memory condition.
+ */
+int anjay_enable_resource_cache(anjay_t *anjay, anjay_oid_t oid);
+
+/**
+ * @returns the number of <c>list_instances</c> handler calls that were avoided
+ *          thanks to caches enabled using @ref anjay_enable_instance_cache.
+ */
+uint64_t anjay_get_instance_cache_saved_calls(anjay_t *anjay);
+
+#ifdef ANJAY_WITH_OBSERVE
+/**
+ * @returns the number of data model reads avoided when evaluating
+ *          observations, thanks to reusing values that have already been read
+ *          for other observations (possibly on behalf of other servers) of the
+ *          same path during the same run of the scheduler.
+ */
+uint64_t anjay_get_observe_saved_reads(anjay_t *anjay);
+#endif // ANJAY_WITH_OBSERVE
+
 #ifdef ANJAY_WITH_OBSERVATION_STATUS
 /**
  * Maximum number of servers observing a Resource reported in
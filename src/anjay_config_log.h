@@ -134,6 +134,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_EVENT_LOOP
     _anjay_log(anjay, TRACE, "ANJAY_WITH_EVENT_LOOP = OFF");
 #endif // ANJAY_WITH_EVENT_LOOP
+#ifdef ANJAY_WITH_EVENT_LOOP_EPOLL
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_EVENT_LOOP_EPOLL = ON");
+#else // ANJAY_WITH_EVENT_LOOP_EPOLL
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_EVENT_LOOP_EPOLL = OFF");
+#endif // ANJAY_WITH_EVENT_LOOP_EPOLL
 #ifdef ANJAY_WITH_HTTP_DOWNLOAD
     _anjay_log(anjay, TRACE, "ANJAY_WITH_HTTP_DOWNLOAD = ON");
 #else // ANJAY_WITH_HTTP_DOWNLOAD
@@ -279,6 +284,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_TRACE_LOGS
     _anjay_log(anjay, TRACE, "ANJAY_WITH_TRACE_LOGS = OFF");
 #endif // ANJAY_WITH_TRACE_LOGS
+#ifdef ANJAY_WITH_UDP_SENDMMSG
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_UDP_SENDMMSG = ON");
+#else // ANJAY_WITH_UDP_SENDMMSG
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_UDP_SENDMMSG = OFF");
+#endif // ANJAY_WITH_UDP_SENDMMSG
     _anjay_log(anjay, TRACE, "AVS_COAP_UDP_NOTIFY_CACHE_SIZE = " AVS_QUOTE_MACRO(AVS_COAP_UDP_NOTIFY_CACHE_SIZE));
 #ifdef AVS_COMMONS_BIG_ENDIAN
     _anjay_log(anjay, TRACE, "AVS_COMMONS_BIG_ENDIAN = ON");
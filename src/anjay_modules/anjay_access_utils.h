@@ -46,6 +46,24 @@ int _anjay_acl_ref_validate_inst_ref(anjay_unlocked_t *anjay,
                                      anjay_oid_t target_oid,
                                      anjay_iid_t target_iid);
 
+#ifdef ANJAY_WITH_MODULE_ACCESS_CONTROL
+/**
+ * Calculates the access mask that the Access Control object would yield for
+ * the given target and SSID, using a compiled lookup table maintained by the
+ * Access Control module, instead of walking the data model.
+ *
+ * @returns 0 on success, in which case <c>*out_mask</c> is set. A negative
+ *          value is returned if the lookup table cannot be used - e.g. when
+ *          the Access Control object is not provided by the module - in which
+ *          case the caller shall fall back to querying the data model.
+ */
+int _anjay_access_control_compiled_mask(anjay_unlocked_t *anjay,
+                                        anjay_oid_t target_oid,
+                                        anjay_iid_t target_iid,
+                                        anjay_ssid_t ssid,
+                                        anjay_access_mask_t *out_mask);
+#endif // ANJAY_WITH_MODULE_ACCESS_CONTROL
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* ANJAY_INCLUDE_ANJAY_MODULES_ACCESS_UTILS_H */
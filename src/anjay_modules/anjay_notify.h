@@ -20,6 +20,13 @@ typedef struct {
     bool instance_set_changed;
     // NOTE: known_added_iids list may not be exhaustive
     AVS_LIST(anjay_iid_t) known_added_iids;
+    // NOTE: known_removed_iids list is exhaustive only if
+    // instance_set_unknown_change is false. It may contain IIDs that have been
+    // recreated afterwards - these are also present in known_added_iids.
+    AVS_LIST(anjay_iid_t) known_removed_iids;
+    // true if the instance set has been changed in a way that has not been
+    // reported in detail
+    bool instance_set_unknown_change;
 } anjay_notify_queue_instance_entry_t;
 
 typedef struct {
@@ -35,6 +42,23 @@ typedef struct {
 
 typedef AVS_LIST(anjay_notify_queue_object_entry_t) anjay_notify_queue_t;
 
+/**
+ * Dense representation of Resource value changes in a single Object. Bit
+ * number <c>rid % 32</c> of <c>words[iid * row_words + rid / 32]</c> is set if
+ * the Resource /oid/iid/rid has been changed.
+ *
+ * Bitmaps are only used for Objects with small Instance and Resource IDs, and
+ * are retained (with all bits cleared) after being flushed, so that recording
+ * repeated changes of the same Resources does not allocate any memory.
+ */
+typedef struct {
+    anjay_oid_t oid;
+    bool any_set;
+    size_t iid_count;
+    size_t row_words;
+    uint32_t *words;
+} anjay_notify_bitmap_t;
+
 /**
  * Performs all the actions necessary due to all the changes in the data model
  * specified by the <c>queue</c>.
@@ -85,6 +109,34 @@ int _anjay_notify_queue_resource_change(anjay_notify_queue_t *out_queue,
 
 void _anjay_notify_clear_queue(anjay_notify_queue_t *out_queue);
 
+/**
+ * Records a change of value of the data model resource specified by
+ * <c>oid</c>, <c>iid</c> and <c>rid</c> in the bitmap for the given Object.
+ *
+ * @returns 0 on success, a positive value if the path cannot be represented
+ *          in a bitmap of acceptable size (in which case the change needs to
+ *          be added to a regular queue instead), or a negative value in case
+ *          of an out-of-memory condition.
+ */
+int _anjay_notify_bitmap_set(AVS_LIST(anjay_notify_bitmap_t) *bitmaps_ptr,
+                             anjay_oid_t oid,
+                             anjay_iid_t iid,
+                             anjay_rid_t rid);
+
+/**
+ * Adds all changes recorded in <c>bitmaps</c> to <c>out_queue</c>, and clears
+ * the bitmaps that have been merged successfully. Changes that could not be
+ * merged stay recorded, so that they can be retried later.
+ */
+int _anjay_notify_bitmaps_flush(AVS_LIST(anjay_notify_bitmap_t) bitmaps,
+                                anjay_notify_queue_t *out_queue);
+
+void _anjay_notify_bitmaps_remove_object(
+        AVS_LIST(anjay_notify_bitmap_t) *bitmaps_ptr, anjay_oid_t oid);
+
+void _anjay_notify_bitmaps_cleanup(
+        AVS_LIST(anjay_notify_bitmap_t) *bitmaps_ptr);
+
 int _anjay_notify_instance_created(anjay_unlocked_t *anjay,
                                    anjay_oid_t oid,
                                    anjay_iid_t iid);
@@ -263,6 +263,13 @@ static anjay_access_mask_t access_control_mask(anjay_unlocked_t *anjay,
                                                anjay_oid_t oid,
                                                anjay_iid_t iid,
                                                anjay_ssid_t ssid) {
+#    ifdef ANJAY_WITH_MODULE_ACCESS_CONTROL
+    anjay_access_mask_t compiled_mask;
+    if (!_anjay_access_control_compiled_mask(anjay, oid, iid, ssid,
+                                             &compiled_mask)) {
+        return compiled_mask;
+    }
+#    endif // ANJAY_WITH_MODULE_ACCESS_CONTROL
     const anjay_dm_installed_object_t *ac_obj =
             _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_ACCESS_CONTROL);
     anjay_iid_t ac_iid;
@@ -328,6 +335,15 @@ static bool is_single_ssid_environment(anjay_unlocked_t *anjay) {
 
 #endif // ANJAY_WITH_ACCESS_CONTROL
 
+bool _anjay_access_control_in_effect(anjay_unlocked_t *anjay) {
+#ifdef ANJAY_WITH_ACCESS_CONTROL
+    return get_access_control(anjay) && !is_single_ssid_environment(anjay);
+#else  // ANJAY_WITH_ACCESS_CONTROL
+    (void) anjay;
+    return false;
+#endif // ANJAY_WITH_ACCESS_CONTROL
+}
+
 bool _anjay_instance_action_allowed(anjay_unlocked_t *anjay,
                                     const anjay_action_info_t *info) {
     if (info->oid == ANJAY_DM_OID_SECURITY) {
@@ -348,7 +364,7 @@ bool _anjay_instance_action_allowed(anjay_unlocked_t *anjay,
         return true;
     }
 
-    if (!get_access_control(anjay) || is_single_ssid_environment(anjay)) {
+    if (!_anjay_access_control_in_effect(anjay)) {
         return true;
     }
 
@@ -22,6 +22,13 @@ typedef struct {
     anjay_request_action_t action;
 } anjay_action_info_t;
 
+/**
+ * Checks whether Access Control may cause the results of operations to differ
+ * between non-Bootstrap Servers, i.e. whether the Access Control object is
+ * present and there is more than one such Server configured.
+ */
+bool _anjay_access_control_in_effect(anjay_unlocked_t *anjay);
+
 /**
  * Checks whether an operation described by the @p info on a non-restricted
  * Object is allowed. Security checks for restricted objects shall be performed
@@ -145,6 +145,8 @@ static int init_anjay(anjay_unlocked_t *anjay,
                 (avs_coap_udp_tx_params_t) ANJAY_COAP_DEFAULT_UDP_TX_PARAMS;
     }
     anjay->udp_exchange_timeout = AVS_COAP_DEFAULT_EXCHANGE_MAX_TIME;
+    anjay->udp_incoming_packets_drain_limit =
+            config->udp_incoming_packets_drain_limit;
     if (config->msg_cache_size) {
         anjay->udp_response_cache =
                 avs_coap_udp_response_cache_create(config->msg_cache_size);
@@ -215,7 +217,9 @@ static int init_anjay(anjay_unlocked_t *anjay,
 
     _anjay_observe_init(&anjay->observe,
                         config->confirmable_notifications,
-                        config->stored_notification_limit);
+                        config->stored_notification_limit,
+                        config->notify_alignment,
+                        config->cache_effective_attributes);
 
     anjay->online_transports =
             _anjay_transport_set_remove_unavailable(anjay,
@@ -359,6 +363,7 @@ static void anjay_cleanup_impl(anjay_unlocked_t *anjay, bool deregister) {
 #endif // ANJAY_WITH_ATTR_STORAGE
     _anjay_dm_cleanup(anjay);
     _anjay_notify_clear_queue(&anjay->scheduled_notify.queue);
+    _anjay_notify_bitmaps_cleanup(&anjay->scheduled_notify.bitmaps);
 
 #ifdef ANJAY_WITH_SEND
     _anjay_send_cleanup(&anjay->sender);
@@ -442,34 +447,70 @@ void anjay_delete(anjay_t *anjay) {
     avs_free(anjay);
 }
 
-static void
-split_query_string(char *query, const char **out_key, const char **out_value) {
-    char *eq = strchr(query, '=');
+/**
+ * Fragment of a CoAP option value. It is NOT zero-terminated - it points
+ * directly into the options buffer of the request being parsed.
+ */
+typedef struct {
+    const char *data;
+    size_t size;
+} string_view_t;
 
-    *out_key = query;
+static bool string_view_equal(string_view_t view, const char *str) {
+    return strlen(str) == view.size && !memcmp(view.data, str, view.size);
+}
+
+static void split_query_string(string_view_t query,
+                               string_view_t *out_key,
+                               string_view_t *out_value) {
+    const char *eq = (const char *) memchr(query.data, '=', query.size);
 
     if (eq) {
-        *eq = '\0';
-        *out_value = eq + 1;
+        out_key->data = query.data;
+        out_key->size = (size_t) (eq - query.data);
+        out_value->data = eq + 1;
+        out_value->size = query.size - out_key->size - 1;
     } else {
-        *out_value = NULL;
+        *out_key = query;
+        out_value->data = NULL;
+        out_value->size = 0;
     }
 }
 
-static int parse_nullable_integer(const char *key_str,
-                                  const char *integer_str,
+static int
+parse_decimal(string_view_t str, uint32_t max_value, uint32_t *out_value) {
+    if (!str.size) {
+        return -1;
+    }
+    uint32_t value = 0;
+    for (size_t i = 0; i < str.size; ++i) {
+        if (str.data[i] < '0' || str.data[i] > '9') {
+            return -1;
+        }
+        uint32_t digit = (uint32_t) (str.data[i] - '0');
+        if (value > (max_value - digit) / 10) {
+            return -1;
+        }
+        value = 10 * value + digit;
+    }
+    *out_value = value;
+    return 0;
+}
+
+static int parse_nullable_integer(string_view_t key,
+                                  string_view_t integer_str,
                                   bool *out_present,
                                   int32_t *out_value) {
-    long long num;
+    uint32_t num;
     if (*out_present) {
-        anjay_log(WARNING, _("Duplicated attribute in query string: ") "%s",
-                  key_str);
+        anjay_log(WARNING, _("Duplicated attribute in query string: ") "%.*s",
+                  (int) key.size, key.data);
         return -1;
-    } else if (!integer_str) {
+    } else if (!integer_str.data) {
         *out_present = true;
         *out_value = ANJAY_ATTRIB_INTEGER_NONE;
         return 0;
-    } else if (_anjay_safe_strtoll(integer_str, &num) || num < 0) {
+    } else if (parse_decimal(integer_str, INT32_MAX, &num)) {
         return -1;
     } else {
         *out_present = true;
@@ -478,19 +519,27 @@ static int parse_nullable_integer(const char *key_str,
     }
 }
 
-static int parse_nullable_double(const char *key_str,
-                                 const char *double_str,
+static int parse_nullable_double(string_view_t key,
+                                 string_view_t double_str,
                                  bool *out_present,
                                  double *out_value) {
+    // strtod() requires a zero-terminated string, so unlike everything else,
+    // the value needs to be copied
+    char buffer[ANJAY_MAX_URI_QUERY_SEGMENT_SIZE];
     if (*out_present) {
-        anjay_log(WARNING, _("Duplicated attribute in query string: ") "%s",
-                  key_str);
+        anjay_log(WARNING, _("Duplicated attribute in query string: ") "%.*s",
+                  (int) key.size, key.data);
         return -1;
-    } else if (!double_str) {
+    } else if (!double_str.data) {
         *out_present = true;
         *out_value = ANJAY_ATTRIB_DOUBLE_NONE;
         return 0;
-    } else if (_anjay_safe_strtod(double_str, out_value) || isnan(*out_value)) {
+    } else if (double_str.size >= sizeof(buffer)) {
+        return -1;
+    }
+    memcpy(buffer, double_str.data, double_str.size);
+    buffer[double_str.size] = '\0';
+    if (_anjay_safe_strtod(buffer, out_value) || isnan(*out_value)) {
         return -1;
     } else {
         *out_present = true;
@@ -499,102 +548,82 @@ static int parse_nullable_double(const char *key_str,
 }
 
 #ifdef ANJAY_WITH_CON_ATTR
-static int parse_con(const char *value,
+static int parse_con(string_view_t value,
                      bool *out_present,
                      anjay_dm_con_attr_t *out_value) {
     if (*out_present) {
         anjay_log(WARNING, _("Duplicated attribute in query string: con"));
         return -1;
-    } else if (!value) {
+    } else if (!value.data) {
         *out_present = true;
         *out_value = ANJAY_DM_CON_ATTR_NONE;
         return 0;
-    } else if (strcmp(value, "0") == 0) {
+    } else if (string_view_equal(value, "0")) {
         *out_present = true;
         *out_value = ANJAY_DM_CON_ATTR_NON;
         return 0;
-    } else if (strcmp(value, "1") == 0) {
+    } else if (string_view_equal(value, "1")) {
         *out_present = true;
         *out_value = ANJAY_DM_CON_ATTR_CON;
         return 0;
     } else {
-        anjay_log(WARNING, _("Invalid con attribute value: ") "%s", value);
+        anjay_log(WARNING, _("Invalid con attribute value: ") "%.*s",
+                  (int) value.size, value.data);
         return -1;
     }
 }
 #endif // ANJAY_WITH_CON_ATTR
 
 static int parse_query(anjay_request_attributes_t *out_attrs,
-                       const char *key,
-                       const char *value) {
-    if (!strcmp(key, ANJAY_ATTR_PMIN)) {
+                       string_view_t key,
+                       string_view_t value) {
+    if (string_view_equal(key, ANJAY_ATTR_PMIN)) {
         return parse_nullable_integer(key, value, &out_attrs->has_min_period,
                                       &out_attrs->values.common.min_period);
-    } else if (!strcmp(key, ANJAY_ATTR_PMAX)) {
+    } else if (string_view_equal(key, ANJAY_ATTR_PMAX)) {
         return parse_nullable_integer(key, value, &out_attrs->has_max_period,
                                       &out_attrs->values.common.max_period);
-    } else if (!strcmp(key, ANJAY_ATTR_EPMIN)) {
+    } else if (string_view_equal(key, ANJAY_ATTR_EPMIN)) {
         return parse_nullable_integer(
                 key, value, &out_attrs->has_min_eval_period,
                 &out_attrs->values.common.min_eval_period);
-    } else if (!strcmp(key, ANJAY_ATTR_EPMAX)) {
+    } else if (string_view_equal(key, ANJAY_ATTR_EPMAX)) {
         return parse_nullable_integer(
                 key, value, &out_attrs->has_max_eval_period,
                 &out_attrs->values.common.max_eval_period);
-    } else if (!strcmp(key, ANJAY_ATTR_GT)) {
+    } else if (string_view_equal(key, ANJAY_ATTR_GT)) {
         return parse_nullable_double(key, value, &out_attrs->has_greater_than,
                                      &out_attrs->values.greater_than);
-    } else if (!strcmp(key, ANJAY_ATTR_LT)) {
+    } else if (string_view_equal(key, ANJAY_ATTR_LT)) {
         return parse_nullable_double(key, value, &out_attrs->has_less_than,
                                      &out_attrs->values.less_than);
-    } else if (!strcmp(key, ANJAY_ATTR_ST)) {
+    } else if (string_view_equal(key, ANJAY_ATTR_ST)) {
         return parse_nullable_double(key, value, &out_attrs->has_step,
                                      &out_attrs->values.step);
 #ifdef ANJAY_WITH_CON_ATTR
-    } else if (!strcmp(key, ANJAY_CUSTOM_ATTR_CON)) {
+    } else if (string_view_equal(key, ANJAY_CUSTOM_ATTR_CON)) {
         return parse_con(value, &out_attrs->has_con,
                          &out_attrs->values.common.con);
 #endif // ANJAY_WITH_CON_ATTR
     } else {
-        anjay_log(DEBUG, _("unrecognized query string: ") "%s" _(" = ") "%s",
-                  key, value ? value : "(null)");
+        anjay_log(DEBUG,
+                  _("unrecognized query string: ") "%.*s" _(" = ") "%.*s",
+                  (int) key.size, key.data, (int) value.size,
+                  value.data ? value.data : "");
         return -1;
     }
 }
 
-static int parse_queries(const avs_coap_request_header_t *hdr,
-                         anjay_request_attributes_t *out_attrs) {
-    memset(out_attrs, 0, sizeof(*out_attrs));
-    out_attrs->values = ANJAY_DM_R_ATTRIBUTES_EMPTY;
-
-    char buffer[ANJAY_MAX_URI_QUERY_SEGMENT_SIZE];
-    size_t attr_size;
-
-    int result;
-    avs_coap_option_iterator_t it = AVS_COAP_OPTION_ITERATOR_EMPTY;
-    while ((result = avs_coap_options_get_string_it(
-                    &hdr->options, AVS_COAP_OPTION_URI_QUERY, &it, &attr_size,
-                    buffer, sizeof(buffer) - 1))
-           == 0) {
-        const char *key;
-        const char *value;
-
-        buffer[attr_size] = '\0';
-        split_query_string(buffer, &key, &value);
-        assert(key != NULL);
-
-        if (parse_query(out_attrs, key, value)) {
-            anjay_log(DEBUG, _("invalid query string: ") "%s" _(" = ") "%s",
-                      key, value ? value : "(null)");
-            return -1;
-        }
-    }
-
-    if (result < 0) {
-        anjay_log(WARNING, _("could not read Request-Query"));
+static int parse_query_option(string_view_t query,
+                              anjay_request_attributes_t *out_attrs) {
+    string_view_t key;
+    string_view_t value;
+    split_query_string(query, &key, &value);
+    if (parse_query(out_attrs, key, value)) {
+        anjay_log(DEBUG, _("invalid query string: ") "%.*s", (int) query.size,
+                  query.data);
         return -1;
     }
-
     return 0;
 }
 
@@ -704,10 +733,11 @@ static int parse_action(const avs_coap_request_header_t *hdr,
     return result;
 }
 
-static int parse_request_uri_segment(const char *uri, uint16_t *out_id) {
-    long long num;
-    if (_anjay_safe_strtoll(uri, &num) || num < 0 || num >= UINT16_MAX) {
-        anjay_log(DEBUG, _("invalid Uri-Path segment: ") "%s", uri);
+static int parse_request_uri_segment(string_view_t segment, uint16_t *out_id) {
+    uint32_t num;
+    if (parse_decimal(segment, UINT16_MAX - 1, &num)) {
+        anjay_log(DEBUG, _("invalid Uri-Path segment: ") "%.*s",
+                  (int) segment.size, segment.data);
         return -1;
     }
 
@@ -715,86 +745,80 @@ static int parse_request_uri_segment(const char *uri, uint16_t *out_id) {
     return 0;
 }
 
-static int parse_bs_uri(const avs_coap_request_header_t *hdr, bool *out_is_bs) {
-    char uri[ANJAY_MAX_URI_SEGMENT_SIZE] = "";
-    size_t uri_size;
-
-    *out_is_bs = false;
-
-    avs_coap_option_iterator_t it = AVS_COAP_OPTION_ITERATOR_EMPTY;
-    int result =
-            avs_coap_options_get_string_it(&hdr->options,
-                                           AVS_COAP_OPTION_URI_PATH, &it,
-                                           &uri_size, uri, sizeof(uri) - 1);
-
-    if (result) {
-        return (result == AVS_COAP_OPTION_MISSING) ? 0 : result;
-    }
-
-    if (strcmp(uri, "bs") == 0) {
-        result =
-                avs_coap_options_get_string_it(&hdr->options,
-                                               AVS_COAP_OPTION_URI_PATH, &it,
-                                               &uri_size, uri, sizeof(uri) - 1);
-        if (result == AVS_COAP_OPTION_MISSING) {
-            *out_is_bs = true;
-            return 0;
-        }
+typedef struct {
+    size_t segment_index;
+    bool expect_no_more_segments;
+} uri_path_parse_state_t;
+
+static int parse_uri_path_option(uri_path_parse_state_t *state,
+                                 string_view_t segment,
+                                 bool *out_is_bs,
+                                 anjay_uri_path_t *out_uri) {
+    const size_t segment_index = state->segment_index++;
+    if (segment_index == 0 && !segment.size) {
+        // Empty URI segment is only allowed as the first and only segment
+        // as an alternative representation of an empty path.
+        state->expect_no_more_segments = true;
+    } else if (segment_index == 0 && string_view_equal(segment, "bs")) {
+        *out_is_bs = true;
+        state->expect_no_more_segments = true;
+    } else if (state->expect_no_more_segments) {
+        anjay_log(WARNING, _("superfluous Uri-Path segment"));
+        return -1;
+    } else if (!segment.size) {
+        anjay_log(WARNING, _("superfluous empty Uri-Path segment"));
+        return -1;
+    } else if (segment_index >= AVS_ARRAY_SIZE(out_uri->ids)) {
+        // 4 or more segments...
+        anjay_log(WARNING, _("prefixed Uri-Path are not supported"));
+        return -1;
+    } else if (parse_request_uri_segment(segment,
+                                         &out_uri->ids[segment_index])) {
+        return -1;
     }
-
-    return result;
+    return 0;
 }
 
-static int parse_dm_uri(const avs_coap_request_header_t *hdr,
-                        anjay_uri_path_t *out_uri) {
-    char uri[ANJAY_MAX_URI_SEGMENT_SIZE] = "";
-    size_t uri_size;
-
+/**
+ * Parses both Uri-Path and Uri-Query options of the request in a single pass
+ * over the options buffer, without copying their values.
+ */
+static int parse_request_options(const avs_coap_request_header_t *hdr,
+                                 bool *out_is_bs,
+                                 anjay_uri_path_t *out_uri,
+                                 anjay_request_attributes_t *out_attrs) {
+    *out_is_bs = false;
     *out_uri = MAKE_ROOT_PATH();
+    memset(out_attrs, 0, sizeof(*out_attrs));
+    out_attrs->values = ANJAY_DM_R_ATTRIBUTES_EMPTY;
 
+    uri_path_parse_state_t uri_path_state = { 0 };
     avs_coap_option_iterator_t it = AVS_COAP_OPTION_ITERATOR_EMPTY;
-
-    size_t segment_index = 0;
-    bool expect_no_more_options = false;
-    int result = 0;
-
-    while (!(result = avs_coap_options_get_string_it(
-                     &hdr->options, AVS_COAP_OPTION_URI_PATH, &it, &uri_size,
-                     uri, sizeof(uri) - 1))) {
-        if (segment_index == 0 && uri[0] == '\0') {
-            // Empty URI segment is only allowed as the first and only segment
-            // as an alternative representation of an empty path.
-            expect_no_more_options = true;
-        } else if (expect_no_more_options || uri[0] == '\0') {
-            anjay_log(WARNING, _("superfluous empty Uri-Path segment"));
-            return -1;
-        } else if (segment_index >= AVS_ARRAY_SIZE(out_uri->ids)) {
-            // 4 or more segments...
-            anjay_log(WARNING, _("prefixed Uri-Path are not supported"));
-            return -1;
-        } else if (parse_request_uri_segment(uri,
-                                             &out_uri->ids[segment_index])) {
-            return -1;
+    uint32_t option_number;
+    const void *value;
+    size_t value_size;
+    while (!avs_coap_options_view_next_it(&hdr->options, &it, &option_number,
+                                          &value, &value_size)) {
+        const string_view_t view = {
+            .data = (const char *) value,
+            .size = value_size
+        };
+        if (option_number == AVS_COAP_OPTION_URI_PATH) {
+            if (parse_uri_path_option(&uri_path_state, view, out_is_bs,
+                                      out_uri)) {
+                return -1;
+            }
+        } else if (option_number == AVS_COAP_OPTION_URI_QUERY) {
+            if (parse_query_option(view, out_attrs)) {
+                return -1;
+            }
+        } else if (option_number > AVS_COAP_OPTION_URI_QUERY) {
+            // options are sorted by number, so there are no more Uri-Path or
+            // Uri-Query options
+            break;
         }
-        ++segment_index;
-    }
-
-    return result == AVS_COAP_OPTION_MISSING ? 0 : result;
-}
-
-static int parse_request_uri(const avs_coap_request_header_t *hdr,
-                             bool *out_is_bs,
-                             anjay_uri_path_t *out_uri) {
-    int result = parse_bs_uri(hdr, out_is_bs);
-    if (result) {
-        return result;
-    }
-    if (*out_is_bs) {
-        *out_uri = MAKE_ROOT_PATH();
-        return 0;
-    } else {
-        return parse_dm_uri(hdr, out_uri);
     }
+    return 0;
 }
 
 static int parse_request(const avs_coap_request_header_t *hdr,
@@ -802,8 +826,8 @@ static int parse_request(const avs_coap_request_header_t *hdr,
                          const avs_coap_observe_id_t *observe_id) {
     memset(out_request, 0, sizeof(*out_request));
     out_request->request_code = hdr->code;
-    if (parse_request_uri(hdr, &out_request->is_bs_uri, &out_request->uri)
-            || parse_queries(hdr, &out_request->attributes)
+    if (parse_request_options(hdr, &out_request->is_bs_uri, &out_request->uri,
+                              &out_request->attributes)
             || avs_coap_options_get_content_format(&hdr->options,
                                                    &out_request->content_format)
             || parse_action(hdr, out_request)) {
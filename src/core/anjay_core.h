@@ -39,6 +39,8 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 
 typedef struct {
     anjay_notify_queue_t queue;
+    // Changes of Resources in dense Objects, merged into queue when flushing
+    AVS_LIST(anjay_notify_bitmap_t) bitmaps;
     avs_sched_handle_t handle;
 } anjay_scheduled_notify_t;
 
@@ -104,6 +106,14 @@ struct
      */
     AVS_LIST(const anjay_socket_entry_t) cached_public_sockets;
 
+    /**
+     * Incremented whenever a socket that might be returned by
+     * _anjay_collect_socket_entries() is created, destroyed, connected or
+     * closed. Allows the event loop to reuse its descriptor set between
+     * iterations for as long as this value stays the same.
+     */
+    uint32_t socket_set_generation;
+
     avs_sched_handle_t reload_servers_sched_job_handle;
 #ifdef ANJAY_WITH_OBSERVE
     anjay_observe_state_t observe;
@@ -115,6 +125,7 @@ struct
     avs_coap_udp_response_cache_t *udp_response_cache;
     avs_coap_udp_tx_params_t udp_tx_params;
     avs_time_duration_t udp_exchange_timeout;
+    size_t udp_incoming_packets_drain_limit;
 #endif
     avs_net_dtls_handshake_timeouts_t udp_dtls_hs_tx_params;
     avs_net_socket_tls_ciphersuites_t default_tls_ciphersuites;
@@ -183,6 +194,10 @@ static inline avs_sched_t *_anjay_get_coap_sched(anjay_unlocked_t *anjay) {
 #endif // ANJAY_WITH_THREAD_SAFETY
 }
 
+static inline void _anjay_socket_set_changed(anjay_unlocked_t *anjay) {
+    ++anjay->socket_set_generation;
+}
+
 #if defined(ANJAY_WITH_ATTR_STORAGE)
 
 // clang-format off
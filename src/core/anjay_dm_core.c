@@ -16,6 +16,7 @@
 #include <string.h>
 
 #include <anjay/core.h>
+#include <avsystem/commons/avs_memory.h>
 #include <avsystem/commons/avs_stream.h>
 #include <avsystem/commons/avs_stream_membuf.h>
 #include <avsystem/commons/avs_stream_v_table.h>
@@ -105,6 +106,115 @@ static int validate_version(const anjay_dm_installed_object_t *obj) {
     return 0;
 }
 
+/**
+ * Returns the position in anjay->dm.objects_index of the first object with
+ * Object ID greater or equal to @p oid.
+ */
+static size_t objects_index_lower_bound(const anjay_dm_t *dm,
+                                        anjay_oid_t oid) {
+    size_t low = 0;
+    size_t high = dm->objects_index_size;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (_anjay_dm_installed_object_oid(dm->objects_index[mid].obj) < oid) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static anjay_dm_object_index_entry_t *
+objects_index_find(const anjay_dm_t *dm, anjay_oid_t oid) {
+    size_t pos = objects_index_lower_bound(dm, oid);
+    if (pos < dm->objects_index_size
+            && _anjay_dm_installed_object_oid(dm->objects_index[pos].obj)
+                           == oid) {
+        return &dm->objects_index[pos];
+    }
+    return NULL;
+}
+
+static int objects_index_reserve_one(anjay_dm_t *dm) {
+    if (dm->objects_index_size < dm->objects_index_capacity) {
+        return 0;
+    }
+    size_t new_capacity =
+            dm->objects_index_capacity ? 2 * dm->objects_index_capacity : 8;
+    anjay_dm_object_index_entry_t *new_index =
+            (anjay_dm_object_index_entry_t *) avs_realloc(
+                    dm->objects_index, new_capacity * sizeof(*new_index));
+    if (!new_index) {
+        dm_log(ERROR, _("out of memory"));
+        return -1;
+    }
+    dm->objects_index = new_index;
+    dm->objects_index_capacity = new_capacity;
+    return 0;
+}
+
+static void objects_index_insert(anjay_dm_t *dm,
+                                 anjay_dm_installed_object_t *obj) {
+    assert(dm->objects_index_size < dm->objects_index_capacity);
+    size_t pos =
+            objects_index_lower_bound(dm, _anjay_dm_installed_object_oid(obj));
+    memmove(&dm->objects_index[pos + 1], &dm->objects_index[pos],
+            (dm->objects_index_size - pos) * sizeof(*dm->objects_index));
+    dm->objects_index[pos] = (anjay_dm_object_index_entry_t) {
+        .obj = obj,
+        .instance_cache = NULL,
+        .resource_cache = NULL
+    };
+    ++dm->objects_index_size;
+}
+
+static void instance_cache_delete(anjay_dm_instance_cache_t **cache_ptr) {
+    if (*cache_ptr) {
+        avs_free((*cache_ptr)->iids);
+        avs_free(*cache_ptr);
+        *cache_ptr = NULL;
+    }
+}
+
+static void
+resource_cache_clear_instances(anjay_dm_resource_cache_t *cache,
+                               size_t first_index,
+                               size_t count) {
+    assert(first_index + count <= cache->instances_count);
+    for (size_t i = first_index; i < first_index + count; ++i) {
+        avs_free(cache->instances[i].resources);
+    }
+    memmove(&cache->instances[first_index],
+            &cache->instances[first_index + count],
+            (cache->instances_count - first_index - count)
+                    * sizeof(*cache->instances));
+    cache->instances_count -= count;
+}
+
+static void resource_cache_delete(anjay_dm_resource_cache_t **cache_ptr) {
+    if (*cache_ptr) {
+        resource_cache_clear_instances(*cache_ptr, 0,
+                                       (*cache_ptr)->instances_count);
+        avs_free((*cache_ptr)->instances);
+        avs_free(*cache_ptr);
+        *cache_ptr = NULL;
+    }
+}
+
+static void objects_index_remove(anjay_dm_t *dm,
+                                 const anjay_dm_installed_object_t *obj) {
+    size_t pos =
+            objects_index_lower_bound(dm, _anjay_dm_installed_object_oid(obj));
+    assert(pos < dm->objects_index_size);
+    assert(dm->objects_index[pos].obj == obj);
+    instance_cache_delete(&dm->objects_index[pos].instance_cache);
+    resource_cache_delete(&dm->objects_index[pos].resource_cache);
+    --dm->objects_index_size;
+    memmove(&dm->objects_index[pos], &dm->objects_index[pos + 1],
+            (dm->objects_index_size - pos) * sizeof(*dm->objects_index));
+}
+
 int _anjay_register_object_unlocked(
         anjay_unlocked_t *anjay,
         AVS_LIST(anjay_dm_installed_object_t) *elem_ptr_move) {
@@ -136,7 +246,13 @@ int _anjay_register_object_unlocked(
         return -1;
     }
 
+    if (objects_index_reserve_one(&anjay->dm)) {
+        return -1;
+    }
+
     AVS_LIST_INSERT(obj_iter, *elem_ptr_move);
+    objects_index_insert(&anjay->dm, *elem_ptr_move);
+    _anjay_observe_attrs_cache_invalidate(&anjay->observe);
 
     dm_log(INFO, _("successfully registered object ") "/%u",
            _anjay_dm_installed_object_oid(*elem_ptr_move));
@@ -209,6 +325,7 @@ unregister_object_unlocked(anjay_unlocked_t *anjay,
     assert(def_ptr && *def_ptr);
     assert(AVS_LIST_FIND_PTR(&anjay->dm.objects, *def_ptr));
 
+    objects_index_remove(&anjay->dm, *def_ptr);
     AVS_LIST(anjay_dm_installed_object_t) detached = AVS_LIST_DETACH(def_ptr);
 
     AVS_LIST(const anjay_dm_installed_object_t *) *obj_in_transaction_iter;
@@ -230,6 +347,8 @@ unregister_object_unlocked(anjay_unlocked_t *anjay,
         }
     }
 
+    _anjay_observe_attrs_cache_invalidate(&anjay->observe);
+
     anjay_notify_queue_t notify = NULL;
     if (_anjay_notify_queue_instance_set_unknown_change(
                 &notify, _anjay_dm_installed_object_oid(detached))
@@ -241,6 +360,9 @@ unregister_object_unlocked(anjay_unlocked_t *anjay,
 
     remove_oid_from_notify_queue(&anjay->scheduled_notify.queue,
                                  _anjay_dm_installed_object_oid(detached));
+    _anjay_notify_bitmaps_remove_object(
+            &anjay->scheduled_notify.bitmaps,
+            _anjay_dm_installed_object_oid(detached));
 #ifdef ANJAY_WITH_BOOTSTRAP
     remove_oid_from_notify_queue(&anjay->bootstrap.notification_queue,
                                  _anjay_dm_installed_object_oid(detached));
@@ -303,18 +425,115 @@ void _anjay_dm_cleanup(anjay_unlocked_t *anjay) {
     }
 
     AVS_LIST_CLEAR(&anjay->dm.objects);
+    for (size_t i = 0; i < anjay->dm.objects_index_size; ++i) {
+        instance_cache_delete(&anjay->dm.objects_index[i].instance_cache);
+        resource_cache_delete(&anjay->dm.objects_index[i].resource_cache);
+    }
+    avs_free(anjay->dm.objects_index);
+    anjay->dm.objects_index = NULL;
+    anjay->dm.objects_index_size = 0;
+    anjay->dm.objects_index_capacity = 0;
 }
 
 const anjay_dm_installed_object_t *
 _anjay_dm_find_object_by_oid(anjay_unlocked_t *anjay, anjay_oid_t oid) {
-    AVS_LIST(anjay_dm_installed_object_t) obj;
-    AVS_LIST_FOREACH(obj, anjay->dm.objects) {
-        if (_anjay_dm_installed_object_oid(obj) == oid) {
-            return obj;
+    const anjay_dm_object_index_entry_t *entry =
+            objects_index_find(&anjay->dm, oid);
+    return entry ? entry->obj : NULL;
+}
+
+void _anjay_dm_instance_cache_invalidate(anjay_unlocked_t *anjay,
+                                         anjay_oid_t oid) {
+    anjay_dm_object_index_entry_t *entry = objects_index_find(&anjay->dm, oid);
+    if (!entry) {
+        return;
+    }
+    if (entry->instance_cache) {
+        entry->instance_cache->valid = false;
+    }
+    if (entry->resource_cache) {
+        resource_cache_clear_instances(entry->resource_cache, 0,
+                                       entry->resource_cache->instances_count);
+    }
+}
+
+/**
+ * Returns the position in cache->instances of the first entry with Instance ID
+ * greater or equal to @p iid.
+ */
+static size_t resource_cache_lower_bound(const anjay_dm_resource_cache_t *cache,
+                                         anjay_iid_t iid) {
+    size_t low = 0;
+    size_t high = cache->instances_count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (cache->instances[mid].iid < iid) {
+            low = mid + 1;
+        } else {
+            high = mid;
         }
     }
+    return low;
+}
 
-    return NULL;
+void _anjay_dm_resource_cache_invalidate(anjay_unlocked_t *anjay,
+                                         anjay_oid_t oid,
+                                         anjay_iid_t iid) {
+    anjay_dm_object_index_entry_t *entry = objects_index_find(&anjay->dm, oid);
+    if (!entry || !entry->resource_cache) {
+        return;
+    }
+    size_t pos = resource_cache_lower_bound(entry->resource_cache, iid);
+    if (pos < entry->resource_cache->instances_count
+            && entry->resource_cache->instances[pos].iid == iid) {
+        resource_cache_clear_instances(entry->resource_cache, pos, 1);
+    }
+}
+
+int anjay_enable_instance_cache(anjay_t *anjay_locked, anjay_oid_t oid) {
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    anjay_dm_object_index_entry_t *entry = objects_index_find(&anjay->dm, oid);
+    if (!entry) {
+        dm_log(ERROR, _("object ") "%" PRIu16 _(" is not currently registered"),
+               oid);
+    } else if (entry->instance_cache) {
+        result = 0;
+    } else if (!(entry->instance_cache = (anjay_dm_instance_cache_t *)
+                         avs_calloc(1, sizeof(anjay_dm_instance_cache_t)))) {
+        dm_log(ERROR, _("out of memory"));
+    } else {
+        result = 0;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+int anjay_enable_resource_cache(anjay_t *anjay_locked, anjay_oid_t oid) {
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    anjay_dm_object_index_entry_t *entry = objects_index_find(&anjay->dm, oid);
+    if (!entry) {
+        dm_log(ERROR, _("object ") "%" PRIu16 _(" is not currently registered"),
+               oid);
+    } else if (entry->resource_cache) {
+        result = 0;
+    } else if (!(entry->resource_cache = (anjay_dm_resource_cache_t *)
+                         avs_calloc(1, sizeof(anjay_dm_resource_cache_t)))) {
+        dm_log(ERROR, _("out of memory"));
+    } else {
+        result = 0;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+uint64_t anjay_get_instance_cache_saved_calls(anjay_t *anjay_locked) {
+    uint64_t result = 0;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    result = anjay->dm.instance_cache_saved_calls;
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
 }
 
 uint8_t _anjay_dm_make_success_response_code(anjay_request_action_t action) {
@@ -898,9 +1117,78 @@ static int instance_present_clb(anjay_unlocked_t *anjay,
     return ANJAY_FOREACH_CONTINUE;
 }
 
+static int instance_cache_append_clb(anjay_unlocked_t *anjay,
+                                     const anjay_dm_installed_object_t *obj,
+                                     anjay_iid_t iid,
+                                     void *cache_) {
+    (void) anjay;
+    (void) obj;
+    anjay_dm_instance_cache_t *cache = (anjay_dm_instance_cache_t *) cache_;
+    if (cache->iids_count >= cache->iids_capacity) {
+        size_t new_capacity =
+                cache->iids_capacity ? 2 * cache->iids_capacity : 16;
+        anjay_iid_t *new_iids = (anjay_iid_t *) avs_realloc(
+                cache->iids, new_capacity * sizeof(*new_iids));
+        if (!new_iids) {
+            dm_log(ERROR, _("out of memory"));
+            return -1;
+        }
+        cache->iids = new_iids;
+        cache->iids_capacity = new_capacity;
+    }
+    cache->iids[cache->iids_count++] = iid;
+    return 0;
+}
+
+static int instance_cache_fill(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t *obj,
+                               anjay_dm_instance_cache_t *cache) {
+    assert(!cache->valid);
+    cache->iids_count = 0;
+    int result = _anjay_dm_foreach_instance(anjay, obj,
+                                            instance_cache_append_clb, cache);
+    if (!result) {
+        cache->valid = true;
+    }
+    return result;
+}
+
+static bool instance_cache_contains(const anjay_dm_instance_cache_t *cache,
+                                    anjay_iid_t iid) {
+    assert(cache->valid);
+    size_t low = 0;
+    size_t high = cache->iids_count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (cache->iids[mid] < iid) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low < cache->iids_count && cache->iids[low] == iid;
+}
+
 int _anjay_dm_instance_present(anjay_unlocked_t *anjay,
                                const anjay_dm_installed_object_t *obj_ptr,
                                anjay_iid_t iid) {
+    const anjay_dm_object_index_entry_t *entry =
+            obj_ptr ? objects_index_find(
+                              &anjay->dm,
+                              _anjay_dm_installed_object_oid(obj_ptr))
+                    : NULL;
+    if (entry && entry->obj == obj_ptr && entry->instance_cache) {
+        if (entry->instance_cache->valid) {
+            ++anjay->dm.instance_cache_saved_calls;
+            return instance_cache_contains(entry->instance_cache, iid) ? 1 : 0;
+        }
+        int result = instance_cache_fill(anjay, obj_ptr, entry->instance_cache);
+        if (result) {
+            return result < 0 ? result : -1;
+        }
+        return instance_cache_contains(entry->instance_cache, iid) ? 1 : 0;
+    }
+
     instance_present_args_t args = {
         .iid_to_find = iid,
         .found = false
@@ -1048,6 +1336,124 @@ static int kind_and_presence_clb(anjay_unlocked_t *anjay,
     return ANJAY_FOREACH_CONTINUE;
 }
 
+typedef struct {
+    anjay_dm_resource_descriptor_t *resources;
+    size_t count;
+    size_t capacity;
+} resource_descriptors_builder_t;
+
+static int resource_descriptor_append_clb(
+        anjay_unlocked_t *anjay,
+        const anjay_dm_installed_object_t *obj,
+        anjay_iid_t iid,
+        anjay_rid_t rid,
+        anjay_dm_resource_kind_t kind,
+        anjay_dm_resource_presence_t presence,
+        void *builder_) {
+    (void) anjay;
+    (void) obj;
+    (void) iid;
+    resource_descriptors_builder_t *builder =
+            (resource_descriptors_builder_t *) builder_;
+    if (builder->count >= builder->capacity) {
+        size_t new_capacity = builder->capacity ? 2 * builder->capacity : 16;
+        anjay_dm_resource_descriptor_t *new_resources =
+                (anjay_dm_resource_descriptor_t *) avs_realloc(
+                        builder->resources,
+                        new_capacity * sizeof(*new_resources));
+        if (!new_resources) {
+            dm_log(ERROR, _("out of memory"));
+            return -1;
+        }
+        builder->resources = new_resources;
+        builder->capacity = new_capacity;
+    }
+    builder->resources[builder->count++] = (anjay_dm_resource_descriptor_t) {
+        .rid = rid,
+        .kind = (uint8_t) kind,
+        .presence = (uint8_t) presence
+    };
+    return 0;
+}
+
+/**
+ * Returns the cached descriptor table of a given Instance, creating it by
+ * calling list_resources if necessary. Returns NULL on error.
+ */
+static const anjay_dm_resource_cache_instance_t *
+resource_cache_get_instance(anjay_unlocked_t *anjay,
+                            const anjay_dm_installed_object_t *obj,
+                            anjay_dm_resource_cache_t *cache,
+                            anjay_iid_t iid,
+                            int *out_result) {
+    size_t pos = resource_cache_lower_bound(cache, iid);
+    if (pos < cache->instances_count && cache->instances[pos].iid == iid) {
+        *out_result = 0;
+        return &cache->instances[pos];
+    }
+    if (cache->instances_count >= cache->instances_capacity) {
+        size_t new_capacity =
+                cache->instances_capacity ? 2 * cache->instances_capacity : 8;
+        anjay_dm_resource_cache_instance_t *new_instances =
+                (anjay_dm_resource_cache_instance_t *) avs_realloc(
+                        cache->instances,
+                        new_capacity * sizeof(*new_instances));
+        if (!new_instances) {
+            dm_log(ERROR, _("out of memory"));
+            *out_result = -1;
+            return NULL;
+        }
+        cache->instances = new_instances;
+        cache->instances_capacity = new_capacity;
+    }
+    resource_descriptors_builder_t builder = {
+        .resources = NULL
+    };
+    if ((*out_result = _anjay_dm_foreach_resource(
+                 anjay, obj, iid, resource_descriptor_append_clb, &builder))) {
+        avs_free(builder.resources);
+        return NULL;
+    }
+    memmove(&cache->instances[pos + 1], &cache->instances[pos],
+            (cache->instances_count - pos) * sizeof(*cache->instances));
+    cache->instances[pos] = (anjay_dm_resource_cache_instance_t) {
+        .iid = iid,
+        .resources = builder.resources,
+        .resources_count = builder.count
+    };
+    ++cache->instances_count;
+    return &cache->instances[pos];
+}
+
+static int resource_cache_kind_and_presence(
+        const anjay_dm_resource_cache_instance_t *instance,
+        anjay_rid_t rid,
+        anjay_dm_resource_kind_t *out_kind,
+        anjay_dm_resource_presence_t *out_presence) {
+    size_t low = 0;
+    size_t high = instance->resources_count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (instance->resources[mid].rid < rid) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low >= instance->resources_count
+            || instance->resources[low].rid != rid) {
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    if (out_kind) {
+        *out_kind = (anjay_dm_resource_kind_t) instance->resources[low].kind;
+    }
+    if (out_presence) {
+        *out_presence = (anjay_dm_resource_presence_t) instance->resources[low]
+                                .presence;
+    }
+    return 0;
+}
+
 int _anjay_dm_resource_kind_and_presence(
         anjay_unlocked_t *anjay,
         const anjay_dm_installed_object_t *obj_ptr,
@@ -1055,6 +1461,24 @@ int _anjay_dm_resource_kind_and_presence(
         anjay_rid_t rid,
         anjay_dm_resource_kind_t *out_kind,
         anjay_dm_resource_presence_t *out_presence) {
+    anjay_dm_object_index_entry_t *entry =
+            obj_ptr ? objects_index_find(
+                              &anjay->dm,
+                              _anjay_dm_installed_object_oid(obj_ptr))
+                    : NULL;
+    if (entry && entry->obj == obj_ptr && entry->resource_cache) {
+        int retval;
+        const anjay_dm_resource_cache_instance_t *instance =
+                resource_cache_get_instance(anjay, obj_ptr,
+                                            entry->resource_cache, iid,
+                                            &retval);
+        if (!instance) {
+            return retval;
+        }
+        return resource_cache_kind_and_presence(instance, rid, out_kind,
+                                                out_presence);
+    }
+
     resource_present_args_t args = {
         .rid_to_find = rid,
         .kind = (anjay_dm_resource_kind_t) -1,
@@ -30,13 +30,91 @@ typedef struct {
     void *arg;
 } anjay_dm_installed_module_t;
 
+typedef struct {
+    /**
+     * True if @ref anjay_dm_instance_cache_t::iids reflects the current set of
+     * Instances of the Object. Reset whenever the set of Instances might have
+     * changed.
+     */
+    bool valid;
+    /** Sorted array of Instance IDs, as returned by list_instances. */
+    anjay_iid_t *iids;
+    size_t iids_count;
+    size_t iids_capacity;
+} anjay_dm_instance_cache_t;
+
+typedef struct {
+    anjay_rid_t rid;
+    uint8_t kind;     // anjay_dm_resource_kind_t
+    uint8_t presence; // anjay_dm_resource_presence_t
+} anjay_dm_resource_descriptor_t;
+
+typedef struct {
+    anjay_iid_t iid;
+    /** Array of descriptors, sorted by Resource ID, as from list_resources. */
+    anjay_dm_resource_descriptor_t *resources;
+    size_t resources_count;
+} anjay_dm_resource_cache_instance_t;
+
+typedef struct {
+    /** Array of per-Instance descriptor tables, sorted by Instance ID. */
+    anjay_dm_resource_cache_instance_t *instances;
+    size_t instances_count;
+    size_t instances_capacity;
+} anjay_dm_resource_cache_t;
+
+typedef struct {
+    anjay_dm_installed_object_t *obj;
+    /**
+     * Cache of the Instance set, used by @ref _anjay_dm_instance_present. NULL
+     * unless enabled for the Object using @ref anjay_enable_instance_cache.
+     */
+    anjay_dm_instance_cache_t *instance_cache;
+    /**
+     * Cache of Resource kinds and presence, used by
+     * @ref _anjay_dm_resource_kind_and_presence. NULL unless enabled for the
+     * Object using @ref anjay_enable_resource_cache.
+     */
+    anjay_dm_resource_cache_t *resource_cache;
+} anjay_dm_object_index_entry_t;
+
 struct anjay_dm {
     AVS_LIST(anjay_dm_installed_object_t) objects;
+    /**
+     * Entries pointing to all elements of @ref anjay_dm::objects, in the same
+     * order (i.e. sorted by Object ID). Used to look up objects by OID using
+     * binary search instead of a linear list walk.
+     */
+    anjay_dm_object_index_entry_t *objects_index;
+    size_t objects_index_size;
+    size_t objects_index_capacity;
     AVS_LIST(anjay_dm_installed_module_t) modules;
+    /**
+     * Number of list_instances handler calls that were avoided thanks to
+     * Instance set caches.
+     */
+    uint64_t instance_cache_saved_calls;
 };
 
 void _anjay_dm_cleanup(anjay_unlocked_t *anjay);
 
+/**
+ * Marks the cached Instance set of the Object @p oid (if caching is enabled for
+ * it) as outdated and drops all cached Resource descriptors of that Object.
+ * Shall be called whenever the set of Instances might have changed.
+ */
+void _anjay_dm_instance_cache_invalidate(anjay_unlocked_t *anjay,
+                                         anjay_oid_t oid);
+
+/**
+ * Drops the cached Resource descriptors of the Instance /@p oid/@p iid (if
+ * caching is enabled for the Object). Shall be called whenever the set of
+ * present Resources in that Instance might have changed.
+ */
+void _anjay_dm_resource_cache_invalidate(anjay_unlocked_t *anjay,
+                                         anjay_oid_t oid,
+                                         anjay_iid_t iid);
+
 typedef struct {
     bool has_min_period;
     bool has_max_period;
@@ -24,8 +24,20 @@
 #        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
 #    endif     // AVS_COMMONS_POSIX_COMPAT_HEADER
 
+#    ifdef ANJAY_WITH_EVENT_LOOP_EPOLL
+#        include <errno.h>
+#        include <string.h>
+#        include <sys/epoll.h>
+#        include <unistd.h>
+#    endif // ANJAY_WITH_EVENT_LOOP_EPOLL
+
 #    include <anjay_init.h>
 
+#    if defined(ANJAY_WITH_EVENT_LOOP_EPOLL) && defined(ANJAY_WITH_THREAD_SAFETY)
+#        include <avsystem/commons/avs_condvar.h>
+#    endif // defined(ANJAY_WITH_EVENT_LOOP_EPOLL) &&
+           // defined(ANJAY_WITH_THREAD_SAFETY)
+
 #    include "anjay_core.h"
 
 VISIBILITY_SOURCE_BEGIN
@@ -38,10 +50,9 @@ typedef int sockfd_t;
 #        define INVALID_SOCKET (-1)
 #    endif
 
-static bool should_event_loop_still_run(anjay_t *anjay) {
+static bool should_event_loop_still_run(volatile atomic_int *status_ptr) {
     int status = ANJAY_EVENT_LOOP_INTERRUPT;
-    if (atomic_compare_exchange_strong(&anjay->atomic_fields.event_loop_status,
-                                       &status,
+    if (atomic_compare_exchange_strong(status_ptr, &status,
                                        ANJAY_EVENT_LOOP_IDLE)) {
         // interrupt has been just handled
         return false;
@@ -55,18 +66,33 @@ typedef struct {
     anjay_t *const anjay_locked;
     const avs_time_duration_t max_wait_time;
     const bool allow_interrupt;
+    /**
+     * Sockets collected during the last call to refresh_socket_set(). These
+     * are reused between iterations for as long as
+     * anjay_unlocked_t::socket_set_generation stays the same, so that idle
+     * wakeups do not need to allocate anything.
+     */
+    AVS_LIST(const anjay_socket_entry_t) entries;
+    uint32_t socket_set_generation;
+    bool socket_set_valid;
 #    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
     struct pollfd *pollfds;
-    size_t pollfds_size;
+    size_t pollfds_capacity;
+    size_t pollfds_count;
+#    else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    fd_set fds;
+    sockfd_t nfds;
 #    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
 } event_loop_state_t;
 
 static void event_loop_state_cleanup(event_loop_state_t *state) {
-    (void) state;
+    AVS_LIST_CLEAR(&state->entries);
+    state->socket_set_valid = false;
 #    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
     avs_free(state->pollfds);
     state->pollfds = NULL;
-    state->pollfds_size = 0;
+    state->pollfds_capacity = 0;
+    state->pollfds_count = 0;
 #    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
 }
 
@@ -76,88 +102,100 @@ typedef enum {
     HANDLE_SOCKETS_BREAK = 1
 } handle_sockets_result_t;
 
-static handle_sockets_result_t handle_sockets(event_loop_state_t *state) {
-    assert(state->anjay_locked);
-    assert(avs_time_duration_valid(state->max_wait_time)
-           && !avs_time_duration_less(state->max_wait_time,
-                                      AVS_TIME_DURATION_ZERO));
-#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-    size_t numsocks = 0;
-    size_t i = 0;
-#    else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-    fd_set infds;
-    fd_set outfds;
-    fd_set errfds;
-    sockfd_t nfds = 0;
-#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-    handle_sockets_result_t result = HANDLE_SOCKETS_CONTINUE;
-    AVS_LIST(const anjay_socket_entry_t) entries = NULL;
+static bool socket_set_up_to_date(event_loop_state_t *state,
+                                  anjay_unlocked_t *anjay) {
+    return state->socket_set_valid
+           && state->socket_set_generation == anjay->socket_set_generation;
+}
+
+static sockfd_t get_entry_fd(const anjay_socket_entry_t *entry) {
+    const void *fd_ptr = avs_net_socket_get_system(entry->socket);
+    return fd_ptr ? *(const sockfd_t *) fd_ptr : INVALID_SOCKET;
+}
+
+static handle_sockets_result_t refresh_socket_set(event_loop_state_t *state,
+                                                  anjay_unlocked_t *anjay) {
     AVS_LIST(const anjay_socket_entry_t) *entry_ptr = NULL;
     AVS_LIST(const anjay_socket_entry_t) entry = NULL;
-    bool sockets_ready = false;
 
-    ANJAY_MUTEX_LOCK(anjay, state->anjay_locked);
-    entries =
+    AVS_LIST_CLEAR(&state->entries);
+    state->entries =
             _anjay_collect_socket_entries(anjay, /* include_offline = */ false);
+    state->socket_set_generation = anjay->socket_set_generation;
+    // Download sockets may be reconnected by the underlying streams without
+    // going through Anjay, so their descriptors cannot be reused safely
+    state->socket_set_valid = true;
+#    ifdef ANJAY_WITH_DOWNLOADER
+    state->socket_set_valid = !anjay->downloader.downloads;
+#    endif // ANJAY_WITH_DOWNLOADER
 
 #    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-    numsocks = AVS_LIST_SIZE(entries);
-    if (numsocks != state->pollfds_size) {
-        struct pollfd *pollfds_new = NULL;
-        if (!numsocks) {
-            avs_free(state->pollfds);
-        } else {
-            pollfds_new = (struct pollfd *) avs_realloc(
-                    state->pollfds, numsocks * sizeof(*state->pollfds));
-        }
-        if (pollfds_new || !numsocks) {
-            state->pollfds = pollfds_new;
-            state->pollfds_size = numsocks;
-        } else if (numsocks > state->pollfds_size) {
+    size_t numsocks = AVS_LIST_SIZE(state->entries);
+    if (numsocks > state->pollfds_capacity) {
+        struct pollfd *pollfds_new = (struct pollfd *) avs_realloc(
+                state->pollfds, numsocks * sizeof(*state->pollfds));
+        if (!pollfds_new) {
             anjay_log(ERROR, "Out of memory in anjay_event_loop_run()");
-            result = HANDLE_SOCKETS_ERROR;
+            AVS_LIST_CLEAR(&state->entries);
+            state->pollfds_count = 0;
+            state->socket_set_valid = false;
+            return HANDLE_SOCKETS_ERROR;
         }
+        state->pollfds = pollfds_new;
+        state->pollfds_capacity = numsocks;
     }
 
-    if (result == HANDLE_SOCKETS_CONTINUE) {
-        AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, entry, &entries) {
-            assert(i < numsocks);
+    size_t i = 0;
+    AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, entry, &state->entries) {
+        assert(i < numsocks);
+        sockfd_t fd = get_entry_fd(*entry_ptr);
+        if (fd == INVALID_SOCKET) {
+            AVS_LIST_DELETE(entry_ptr);
+        } else {
+            state->pollfds[i].fd = fd;
             state->pollfds[i].events = POLLIN;
             state->pollfds[i].revents = 0;
-            state->pollfds[i].fd = INVALID_SOCKET;
-            const void *fd_ptr =
-                    avs_net_socket_get_system((*entry_ptr)->socket);
-            if (fd_ptr) {
-                state->pollfds[i].fd = *(const sockfd_t *) fd_ptr;
-            }
-            if (state->pollfds[i].fd == INVALID_SOCKET) {
-                AVS_LIST_DELETE(entry_ptr);
-            } else {
-                ++i;
-            }
+            ++i;
         }
     }
+    state->pollfds_count = i;
 #    else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-    FD_ZERO(&infds);
-    FD_ZERO(&outfds);
-    FD_ZERO(&errfds);
-    nfds = 0;
-
-    AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, entry, &entries) {
-        sockfd_t fd = INVALID_SOCKET;
-        const void *fd_ptr = avs_net_socket_get_system((*entry_ptr)->socket);
-        if (fd_ptr) {
-            fd = *(const sockfd_t *) fd_ptr;
-        }
+    FD_ZERO(&state->fds);
+    state->nfds = 0;
+
+    AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, entry, &state->entries) {
+        sockfd_t fd = get_entry_fd(*entry_ptr);
         if (fd == INVALID_SOCKET || fd >= FD_SETSIZE) {
             AVS_LIST_DELETE(entry_ptr);
         } else {
-            FD_SET(fd, &infds);
-            FD_SET(fd, &errfds);
-            nfds = AVS_MAX(nfds, fd + 1);
+            FD_SET(fd, &state->fds);
+            state->nfds = AVS_MAX(state->nfds, fd + 1);
         }
     }
 #    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    return HANDLE_SOCKETS_CONTINUE;
+}
+
+static handle_sockets_result_t handle_sockets(event_loop_state_t *state) {
+    assert(state->anjay_locked);
+    assert(avs_time_duration_valid(state->max_wait_time)
+           && !avs_time_duration_less(state->max_wait_time,
+                                      AVS_TIME_DURATION_ZERO));
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    size_t i = 0;
+#    else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    fd_set infds;
+    fd_set outfds;
+    fd_set errfds;
+#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    handle_sockets_result_t result = HANDLE_SOCKETS_CONTINUE;
+    AVS_LIST(const anjay_socket_entry_t) entry = NULL;
+    bool sockets_ready = false;
+
+    ANJAY_MUTEX_LOCK(anjay, state->anjay_locked);
+    if (!socket_set_up_to_date(state, anjay)) {
+        result = refresh_socket_set(state, anjay);
+    }
     ANJAY_MUTEX_UNLOCK(state->anjay_locked);
 
     avs_time_duration_t wait_time;
@@ -176,9 +214,9 @@ static handle_sockets_result_t handle_sockets(event_loop_state_t *state) {
                 || wait_ms > INT_MAX) {
             wait_ms = (int64_t) INT_MAX;
         }
-        sockets_ready = (poll(state->pollfds, i, (int) wait_ms) > 0);
+        sockets_ready =
+                (poll(state->pollfds, state->pollfds_count, (int) wait_ms) > 0);
     }
-    i = 0;
 #    else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
            // NOTE: This assumes that time_t is a signed integer type
     static const time_t AVS_TIME_MAX =
@@ -190,27 +228,29 @@ static handle_sockets_result_t handle_sockets(event_loop_state_t *state) {
         wait_timeval.tv_sec = (time_t) wait_time.seconds;
         wait_timeval.tv_usec = (int32_t) (wait_time.nanoseconds / 1000);
     }
-    sockets_ready = (select(nfds, &infds, &outfds, &errfds, &wait_timeval) > 0);
+    infds = state->fds;
+    FD_ZERO(&outfds);
+    errfds = state->fds;
+    sockets_ready =
+            (select(state->nfds, &infds, &outfds, &errfds, &wait_timeval) > 0);
 #    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
 
     if (sockets_ready) {
-        AVS_LIST_FOREACH(entry, entries) {
+        AVS_LIST_FOREACH(entry, state->entries) {
             if (state->allow_interrupt
-                    && !should_event_loop_still_run(state->anjay_locked)) {
+                    && !should_event_loop_still_run(
+                               &state->anjay_locked->atomic_fields
+                                        .event_loop_status)) {
                 result = HANDLE_SOCKETS_BREAK;
                 break;
             }
 #    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-            assert(i < numsocks);
+            assert(i < state->pollfds_count);
             if (!state->pollfds[i++].revents) {
                 continue;
             }
 #    else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-            sockfd_t fd = INVALID_SOCKET;
-            const void *fd_ptr = avs_net_socket_get_system(entry->socket);
-            if (fd_ptr) {
-                fd = *(const sockfd_t *) fd_ptr;
-            }
+            sockfd_t fd = get_entry_fd(entry);
             if (fd == INVALID_SOCKET
                     || !(FD_ISSET(fd, &infds) || FD_ISSET(fd, &errfds))) {
                 continue;
@@ -222,10 +262,695 @@ static handle_sockets_result_t handle_sockets(event_loop_state_t *state) {
         }
     }
 
+    return result;
+}
+
+#    ifdef ANJAY_WITH_EVENT_LOOP_EPOLL
+#        define EPOLL_EVENTS_BATCH_SIZE 64
+
+typedef struct {
+    avs_net_socket_t *socket;
+    int fd;
+} epoll_registration_t;
+
+typedef struct {
+    anjay_t *anjay_locked;
+    /**
+     * Identifier of the member, unique within the group. Used instead of a
+     * pointer in epoll event data, so that a stale event can never reach a
+     * member that has been removed in the meantime.
+     */
+    uint32_t id;
+    /**
+     * Registrations of this member's sockets in the epoll set. Only accessed
+     * with the member's Anjay mutex locked.
+     */
+    AVS_LIST(epoll_registration_t) registrations;
+    uint32_t socket_set_generation;
+    bool socket_set_valid;
+    /**
+     * Set while one of the workers is executing anjay_sched_run() for this
+     * member, so that the scheduler is never run concurrently.
+     */
+    atomic_flag sched_busy;
+    /**
+     * Number of workers currently using this member. Guarded by the group
+     * mutex.
+     */
+    size_t refs;
+    /**
+     * Set when the member has been removed from the group while still being
+     * used. Guarded by the group mutex.
+     */
+    bool removed;
+} epoll_member_t;
+
+struct anjay_event_loop_group_struct {
+    int epoll_fd;
+#        ifdef ANJAY_WITH_THREAD_SAFETY
+    /**
+     * Guards the members array, reference counts of the members, fd_owners
+     * and modifications of the epoll set, which may be performed by multiple
+     * workers on behalf of different members.
+     */
+    avs_mutex_t *mutex;
+    /**
+     * Notified when the last reference to a removed member is released.
+     */
+    avs_condvar_t *member_released;
+#        endif // ANJAY_WITH_THREAD_SAFETY
+    /**
+     * Maps file descriptor numbers onto registrations that most recently added
+     * them to the epoll set. Used to avoid removing or re-arming a descriptor
+     * that has been closed and reused for another socket in the meantime.
+     */
+    epoll_registration_t **fd_owners;
+    size_t fd_owners_size;
+    /**
+     * Members of the group, sorted by ID. Each member is allocated separately
+     * and never moved, so that workers can keep using it without holding the
+     * group mutex, as long as they hold a reference.
+     */
+    epoll_member_t **members;
+    size_t members_count;
+    size_t members_capacity;
+    uint32_t next_member_id;
+    volatile atomic_int status;
+};
+
+static void group_lock(anjay_event_loop_group_t *group) {
+    (void) group;
+#        ifdef ANJAY_WITH_THREAD_SAFETY
+    avs_mutex_lock(group->mutex);
+#        endif // ANJAY_WITH_THREAD_SAFETY
+}
+
+static void group_unlock(anjay_event_loop_group_t *group) {
+    (void) group;
+#        ifdef ANJAY_WITH_THREAD_SAFETY
+    avs_mutex_unlock(group->mutex);
+#        endif // ANJAY_WITH_THREAD_SAFETY
+}
+
+static int group_init(anjay_event_loop_group_t *group) {
+    memset(group, 0, sizeof(*group));
+    atomic_init(&group->status, ANJAY_EVENT_LOOP_IDLE);
+    if ((group->epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        anjay_log(ERROR, _("epoll_create1() failed: ") "%d", errno);
+        return -1;
+    }
+#        ifdef ANJAY_WITH_THREAD_SAFETY
+    if (avs_mutex_create(&group->mutex)
+            || avs_condvar_create(&group->member_released)) {
+        anjay_log(ERROR, _("could not create event loop group mutex"));
+        return -1;
+    }
+#        endif // ANJAY_WITH_THREAD_SAFETY
+    return 0;
+}
+
+static uint64_t make_event_data(uint32_t member_id, int fd) {
+    return ((uint64_t) member_id << 32) | (uint32_t) fd;
+}
+
+static int arm_registration(anjay_event_loop_group_t *group,
+                            uint32_t member_id,
+                            epoll_registration_t *reg,
+                            bool add) {
+    // EPOLLONESHOT ensures that readiness of a single socket is never reported
+    // to more than one worker at a time; the registration is re-armed after
+    // the socket has been served.
+    struct epoll_event event = {
+        .events = EPOLLIN | EPOLLONESHOT,
+        .data.u64 = make_event_data(member_id, reg->fd)
+    };
+    if (add) {
+        if (!epoll_ctl(group->epoll_fd, EPOLL_CTL_ADD, reg->fd, &event)) {
+            return 0;
+        } else if (errno != EEXIST) {
+            return -1;
+        }
+    }
+    if (!epoll_ctl(group->epoll_fd, EPOLL_CTL_MOD, reg->fd, &event)) {
+        return 0;
+    } else if (add || errno != ENOENT) {
+        return -1;
+    }
+    // The socket has been closed and reopened with the same descriptor number
+    // (e.g. when reconnecting in queue mode), so the kernel has dropped it from
+    // the epoll set, even though the registration is still valid.
+    return epoll_ctl(group->epoll_fd, EPOLL_CTL_ADD, reg->fd, &event);
+}
+
+static int group_register(anjay_event_loop_group_t *group,
+                          uint32_t member_id,
+                          epoll_registration_t *reg) {
+    assert(reg->fd >= 0);
+    int result = 0;
+    group_lock(group);
+    if ((size_t) reg->fd >= group->fd_owners_size) {
+        size_t new_size = AVS_MAX(2 * group->fd_owners_size,
+                                  (size_t) reg->fd + 1);
+        epoll_registration_t **new_owners =
+                (epoll_registration_t **) avs_realloc(
+                        group->fd_owners, new_size * sizeof(*new_owners));
+        if (!new_owners) {
+            anjay_log(ERROR, _("out of memory"));
+            result = -1;
+        } else {
+            memset(new_owners + group->fd_owners_size, 0,
+                   (new_size - group->fd_owners_size) * sizeof(*new_owners));
+            group->fd_owners = new_owners;
+            group->fd_owners_size = new_size;
+        }
+    }
+    if (!result) {
+        if (arm_registration(group, member_id, reg, true)) {
+            anjay_log(ERROR, _("epoll_ctl() failed: ") "%d", errno);
+            result = -1;
+        } else {
+            group->fd_owners[reg->fd] = reg;
+        }
+    }
+    group_unlock(group);
+    return result;
+}
+
+static void group_rearm(anjay_event_loop_group_t *group,
+                        uint32_t member_id,
+                        epoll_registration_t *reg) {
+    group_lock(group);
+    if ((size_t) reg->fd < group->fd_owners_size
+            && group->fd_owners[reg->fd] == reg
+            && arm_registration(group, member_id, reg, false)) {
+        anjay_log(ERROR, _("could not re-arm descriptor ") "%d" _(": ") "%d",
+                  reg->fd, errno);
+    }
+    group_unlock(group);
+}
+
+static void group_unregister(anjay_event_loop_group_t *group,
+                             epoll_registration_t *reg) {
+    group_lock(group);
+    if ((size_t) reg->fd < group->fd_owners_size
+            && group->fd_owners[reg->fd] == reg) {
+        // If the descriptor has been closed in the meantime, the kernel has
+        // already dropped it from the epoll set, and this call will harmlessly
+        // fail.
+        (void) epoll_ctl(group->epoll_fd, EPOLL_CTL_DEL, reg->fd, NULL);
+        group->fd_owners[reg->fd] = NULL;
+    }
+    group_unlock(group);
+}
+
+static epoll_registration_t *find_registration(epoll_member_t *member,
+                                               const avs_net_socket_t *socket,
+                                               int fd) {
+    AVS_LIST(epoll_registration_t) reg;
+    AVS_LIST_FOREACH(reg, member->registrations) {
+        if (reg->fd == fd && (!socket || reg->socket == socket)) {
+            return reg;
+        }
+    }
+    return NULL;
+}
+
+static bool entries_contain(AVS_LIST(const anjay_socket_entry_t) entries,
+                            const epoll_registration_t *reg) {
+    AVS_LIST(const anjay_socket_entry_t) entry;
+    AVS_LIST_FOREACH(entry, entries) {
+        if (entry->socket == reg->socket && get_entry_fd(entry) == reg->fd) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool member_up_to_date(const epoll_member_t *member,
+                              anjay_unlocked_t *anjay) {
+    return member->socket_set_generation == anjay->socket_set_generation;
+}
+
+static handle_sockets_result_t member_sync(anjay_event_loop_group_t *group,
+                                           epoll_member_t *member,
+                                           anjay_unlocked_t *anjay) {
+    AVS_LIST(const anjay_socket_entry_t) entries =
+            _anjay_collect_socket_entries(anjay, /* include_offline = */ false);
+    handle_sockets_result_t result = HANDLE_SOCKETS_CONTINUE;
+
+    AVS_LIST(epoll_registration_t) *reg_ptr;
+    AVS_LIST(epoll_registration_t) reg_helper;
+    AVS_LIST_DELETABLE_FOREACH_PTR(reg_ptr, reg_helper,
+                                   &member->registrations) {
+        if (!entries_contain(entries, *reg_ptr)) {
+            group_unregister(group, *reg_ptr);
+            AVS_LIST_DELETE(reg_ptr);
+        } else {
+            // the registration might have been left disarmed if the socket
+            // set changed while it was being served
+            group_rearm(group, member->id, *reg_ptr);
+        }
+    }
+
+    AVS_LIST(const anjay_socket_entry_t) entry;
+    AVS_LIST_FOREACH(entry, entries) {
+        int fd = get_entry_fd(entry);
+        if (fd == INVALID_SOCKET
+                || find_registration(member, entry->socket, fd)) {
+            continue;
+        }
+        AVS_LIST(epoll_registration_t) reg =
+                AVS_LIST_NEW_ELEMENT(epoll_registration_t);
+        if (!reg) {
+            anjay_log(ERROR, _("out of memory"));
+            result = HANDLE_SOCKETS_ERROR;
+            break;
+        }
+        reg->socket = entry->socket;
+        reg->fd = fd;
+        if (group_register(group, member->id, reg)) {
+            AVS_LIST_DELETE(&reg);
+            result = HANDLE_SOCKETS_ERROR;
+            break;
+        }
+        AVS_LIST_INSERT(&member->registrations, reg);
+    }
     AVS_LIST_CLEAR(&entries);
+
+    member->socket_set_generation = anjay->socket_set_generation;
+    // See the comment in refresh_socket_set()
+    member->socket_set_valid = (result == HANDLE_SOCKETS_CONTINUE);
+#        ifdef ANJAY_WITH_DOWNLOADER
+    member->socket_set_valid =
+            member->socket_set_valid && !anjay->downloader.downloads;
+#        endif // ANJAY_WITH_DOWNLOADER
+    return result;
+}
+
+/**
+ * Unregisters all sockets of a member that is no longer used by any worker,
+ * and frees it.
+ */
+static void member_delete(anjay_event_loop_group_t *group,
+                          epoll_member_t *member) {
+    assert(!member->refs);
+    AVS_LIST_CLEAR(&member->registrations) {
+        group_unregister(group, member->registrations);
+    }
+    atomic_store(&member->anjay_locked->atomic_fields.event_loop_status,
+                 ANJAY_EVENT_LOOP_IDLE);
+    avs_free(member);
+}
+
+/**
+ * Finds the index at which the member with a given ID is, or would be, stored
+ * in the members array. MUST be called with the group mutex locked.
+ */
+static size_t find_member_index(anjay_event_loop_group_t *group, uint32_t id) {
+    size_t begin = 0;
+    size_t end = group->members_count;
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        if (group->members[mid]->id < id) {
+            begin = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    return begin;
+}
+
+/**
+ * Returns the member stored at @p index , or with ID equal to @p id if
+ * @p index is SIZE_MAX, with its reference count incremented, or NULL if there
+ * is no such member. Each successful call MUST be matched with a call to
+ * @ref member_release .
+ */
+static epoll_member_t *member_acquire(anjay_event_loop_group_t *group,
+                                      size_t index,
+                                      uint32_t id) {
+    epoll_member_t *member = NULL;
+    group_lock(group);
+    if (index == SIZE_MAX) {
+        index = find_member_index(group, id);
+        if (index < group->members_count && group->members[index]->id != id) {
+            index = group->members_count;
+        }
+    }
+    if (index < group->members_count) {
+        member = group->members[index];
+        ++member->refs;
+    }
+    group_unlock(group);
+    return member;
+}
+
+static void member_release(anjay_event_loop_group_t *group,
+                           epoll_member_t *member) {
+    group_lock(group);
+    assert(member->refs > 0);
+    bool last_user = (!--member->refs && member->removed);
+#        ifdef ANJAY_WITH_THREAD_SAFETY
+    if (last_user) {
+        // anjay_event_loop_group_remove() is waiting for this
+        avs_condvar_notify_all(group->member_released);
+    }
+    group_unlock(group);
+#        else  // ANJAY_WITH_THREAD_SAFETY
+    group_unlock(group);
+    if (last_user) {
+        // the member has been removed from within one of its own callbacks
+        member_delete(group, member);
+    }
+#        endif // ANJAY_WITH_THREAD_SAFETY
+}
+
+static void group_cleanup(anjay_event_loop_group_t *group) {
+    for (size_t i = 0; i < group->members_count; ++i) {
+        member_delete(group, group->members[i]);
+    }
+    avs_free(group->members);
+    group->members = NULL;
+    group->members_count = 0;
+    group->members_capacity = 0;
+    avs_free(group->fd_owners);
+    group->fd_owners = NULL;
+    group->fd_owners_size = 0;
+#        ifdef ANJAY_WITH_THREAD_SAFETY
+    avs_condvar_cleanup(&group->member_released);
+    avs_mutex_cleanup(&group->mutex);
+#        endif // ANJAY_WITH_THREAD_SAFETY
+    if (group->epoll_fd >= 0) {
+        close(group->epoll_fd);
+        group->epoll_fd = -1;
+    }
+}
+
+static int group_add_member(anjay_event_loop_group_t *group,
+                            anjay_t *anjay_locked) {
+    epoll_member_t *member =
+            (epoll_member_t *) avs_calloc(1, sizeof(epoll_member_t));
+    if (!member) {
+        anjay_log(ERROR, _("out of memory"));
+        return -1;
+    }
+    member->anjay_locked = anjay_locked;
+    atomic_flag_clear(&member->sched_busy);
+
+    int result = -1;
+    group_lock(group);
+    if (group->next_member_id == UINT32_MAX) {
+        anjay_log(ERROR, _("too many members added to the event loop group"));
+        goto finish;
+    }
+    if (group->members_count == group->members_capacity) {
+        size_t new_capacity =
+                group->members_capacity ? 2 * group->members_capacity : 4;
+        epoll_member_t **new_members = (epoll_member_t **) avs_realloc(
+                group->members, new_capacity * sizeof(*new_members));
+        if (!new_members) {
+            anjay_log(ERROR, _("out of memory"));
+            goto finish;
+        }
+        group->members = new_members;
+        group->members_capacity = new_capacity;
+    }
+    if (!atomic_compare_exchange_strong(
+                &anjay_locked->atomic_fields.event_loop_status,
+                &(int) { ANJAY_EVENT_LOOP_IDLE },
+                ANJAY_EVENT_LOOP_RUNNING)) {
+        anjay_log(ERROR, _("Event loop is already running"));
+        goto finish;
+    }
+    // IDs are assigned in increasing order, so the array stays sorted
+    member->id = group->next_member_id++;
+    group->members[group->members_count++] = member;
+    member = NULL;
+    result = 0;
+finish:
+    group_unlock(group);
+    avs_free(member);
+    return result;
+}
+
+static int group_remove_member(anjay_event_loop_group_t *group,
+                               anjay_t *anjay_locked) {
+    epoll_member_t *member = NULL;
+    group_lock(group);
+    for (size_t i = 0; i < group->members_count; ++i) {
+        if (group->members[i]->anjay_locked == anjay_locked) {
+            member = group->members[i];
+            memmove(&group->members[i], &group->members[i + 1],
+                    (group->members_count - i - 1) * sizeof(*group->members));
+            --group->members_count;
+            break;
+        }
+    }
+    if (!member) {
+        group_unlock(group);
+        anjay_log(ERROR,
+                  _("Anjay object does not belong to the event loop group"));
+        return -1;
+    }
+    member->removed = true;
+#        ifdef ANJAY_WITH_THREAD_SAFETY
+    // Wait until no worker uses the member, so that the Anjay object may be
+    // safely deleted after this function returns
+    while (member->refs) {
+        avs_condvar_wait(group->member_released, group->mutex,
+                         AVS_TIME_MONOTONIC_INVALID);
+    }
+#        endif // ANJAY_WITH_THREAD_SAFETY
+    bool in_use = (member->refs > 0);
+    group_unlock(group);
+    if (!in_use) {
+        member_delete(group, member);
+    }
+    return 0;
+}
+
+/**
+ * Synchronizes the epoll registrations, runs the scheduler jobs that are due,
+ * and calculates the time until the earliest scheduler job of any member.
+ */
+static handle_sockets_result_t
+group_prepare_wait(anjay_event_loop_group_t *group,
+                   bool enable_error_handling,
+                   avs_time_duration_t *inout_wait_time) {
+    handle_sockets_result_t result = HANDLE_SOCKETS_CONTINUE;
+    epoll_member_t *member;
+    // If members are removed concurrently, some other member may be skipped
+    // during this pass; it will be handled during the next one.
+    for (size_t i = 0; result == HANDLE_SOCKETS_CONTINUE
+                       && (member = member_acquire(group, i, 0));
+         ++i) {
+        ANJAY_MUTEX_LOCK(anjay, member->anjay_locked);
+        if (!member->socket_set_valid || !member_up_to_date(member, anjay)) {
+            result = member_sync(group, member, anjay);
+        }
+        ANJAY_MUTEX_UNLOCK(member->anjay_locked);
+
+        avs_time_duration_t member_wait_time;
+        if (!anjay_sched_time_to_next(member->anjay_locked, &member_wait_time)
+                && !avs_time_duration_less(AVS_TIME_DURATION_ZERO,
+                                           member_wait_time)
+                && !atomic_flag_test_and_set(&member->sched_busy)) {
+            anjay_sched_run(member->anjay_locked);
+            atomic_flag_clear(&member->sched_busy);
+        }
+        // This needs to be checked even if there are no scheduler jobs at all,
+        // as that is the usual state after all connections have failed
+        if (enable_error_handling
+                && anjay_all_connections_failed(member->anjay_locked)) {
+            anjay_transport_schedule_reconnect(member->anjay_locked,
+                                               ANJAY_TRANSPORT_SET_ALL);
+        }
+        if (!anjay_sched_time_to_next(member->anjay_locked, &member_wait_time)
+                && avs_time_duration_less(member_wait_time, *inout_wait_time)) {
+            *inout_wait_time = member_wait_time;
+        }
+        member_release(group, member);
+    }
+    if (avs_time_duration_less(*inout_wait_time, AVS_TIME_DURATION_ZERO)) {
+        *inout_wait_time = AVS_TIME_DURATION_ZERO;
+    }
     return result;
 }
 
+static void group_serve(anjay_event_loop_group_t *group, uint64_t data) {
+    epoll_member_t *member =
+            member_acquire(group, SIZE_MAX, (uint32_t) (data >> 32));
+    int fd = (int) (uint32_t) data;
+    if (!member) {
+        return;
+    }
+    ANJAY_MUTEX_LOCK(anjay, member->anjay_locked);
+    epoll_registration_t *reg = find_registration(member, NULL, fd);
+    // If the socket set has changed since the registrations were last
+    // updated, the socket might not exist anymore. The registration will be
+    // re-armed during the next update, if still applicable.
+    if (reg && member_up_to_date(member, anjay)) {
+        if (_anjay_serve_unlocked(anjay, reg->socket)) {
+            anjay_log(WARNING, "anjay_serve failed");
+        }
+        if (member_up_to_date(member, anjay)) {
+            group_rearm(group, member->id, reg);
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(member->anjay_locked);
+    member_release(group, member);
+}
+
+static handle_sockets_result_t
+group_handle_sockets(anjay_event_loop_group_t *group,
+                     avs_time_duration_t max_wait_time,
+                     bool enable_error_handling,
+                     volatile atomic_int *status_ptr) {
+    avs_time_duration_t wait_time = max_wait_time;
+    handle_sockets_result_t result =
+            group_prepare_wait(group, enable_error_handling, &wait_time);
+    if (result != HANDLE_SOCKETS_CONTINUE) {
+        return result;
+    }
+
+    int64_t wait_ms;
+    if (avs_time_duration_to_scalar(&wait_ms, AVS_TIME_MS, wait_time)
+            || wait_ms > INT_MAX) {
+        wait_ms = (int64_t) INT_MAX;
+    }
+    struct epoll_event events[EPOLL_EVENTS_BATCH_SIZE];
+    int count = epoll_wait(group->epoll_fd, events, EPOLL_EVENTS_BATCH_SIZE,
+                           (int) wait_ms);
+    if (count < 0) {
+        if (errno == EINTR) {
+            return HANDLE_SOCKETS_CONTINUE;
+        }
+        anjay_log(ERROR, _("epoll_wait() failed: ") "%d", errno);
+        return HANDLE_SOCKETS_ERROR;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (!should_event_loop_still_run(status_ptr)) {
+            return HANDLE_SOCKETS_BREAK;
+        }
+        group_serve(group, events[i].data.u64);
+    }
+    return HANDLE_SOCKETS_CONTINUE;
+}
+
+static int group_run(anjay_event_loop_group_t *group,
+                     avs_time_duration_t max_wait_time,
+                     bool enable_error_handling,
+                     volatile atomic_int *status_ptr) {
+    handle_sockets_result_t handle_sockets_result = HANDLE_SOCKETS_CONTINUE;
+    bool running = should_event_loop_still_run(status_ptr);
+    while (running) {
+        handle_sockets_result =
+                group_handle_sockets(group, max_wait_time,
+                                     enable_error_handling, status_ptr);
+        switch (handle_sockets_result) {
+        case HANDLE_SOCKETS_ERROR:
+            atomic_store(status_ptr, ANJAY_EVENT_LOOP_IDLE);
+            // fall through
+        case HANDLE_SOCKETS_BREAK:
+            running = false;
+            break;
+        case HANDLE_SOCKETS_CONTINUE:
+            running = should_event_loop_still_run(status_ptr);
+        }
+    }
+    return handle_sockets_result == HANDLE_SOCKETS_ERROR ? -1 : 0;
+}
+
+static int event_loop_run_with_error_handling(anjay_t *anjay_locked,
+                                              avs_time_duration_t max_wait_time,
+                                              bool enable_error_handling) {
+    if (!avs_time_duration_valid(max_wait_time)
+            || avs_time_duration_less(max_wait_time, AVS_TIME_DURATION_ZERO)) {
+        anjay_log(ERROR, "max_wait_time needs to be valid and non-negative");
+        return -1;
+    }
+    anjay_event_loop_group_t group;
+    int result = group_init(&group);
+    if (!result && !(result = group_add_member(&group, anjay_locked))) {
+        result = group_run(&group, max_wait_time, enable_error_handling,
+                           &anjay_locked->atomic_fields.event_loop_status);
+    }
+    group_cleanup(&group);
+    return result;
+}
+
+anjay_event_loop_group_t *anjay_event_loop_group_new(void) {
+    anjay_event_loop_group_t *group = (anjay_event_loop_group_t *) avs_malloc(
+            sizeof(anjay_event_loop_group_t));
+    if (!group) {
+        anjay_log(ERROR, _("out of memory"));
+        return NULL;
+    }
+    if (group_init(group)) {
+        group_cleanup(group);
+        avs_free(group);
+        return NULL;
+    }
+    return group;
+}
+
+void anjay_event_loop_group_delete(anjay_event_loop_group_t **group_ptr) {
+    if (group_ptr && *group_ptr) {
+        assert(atomic_load(&(*group_ptr)->status) == ANJAY_EVENT_LOOP_IDLE);
+        group_cleanup(*group_ptr);
+        avs_free(*group_ptr);
+        *group_ptr = NULL;
+    }
+}
+
+int anjay_event_loop_group_add(anjay_event_loop_group_t *group,
+                               anjay_t *anjay_locked) {
+    assert(group);
+    assert(anjay_locked);
+    return group_add_member(group, anjay_locked);
+}
+
+int anjay_event_loop_group_remove(anjay_event_loop_group_t *group,
+                                  anjay_t *anjay_locked) {
+    assert(group);
+    return group_remove_member(group, anjay_locked);
+}
+
+int anjay_event_loop_group_run(anjay_event_loop_group_t *group,
+                               avs_time_duration_t max_wait_time,
+                               bool enable_error_handling) {
+    assert(group);
+    if (!avs_time_duration_valid(max_wait_time)
+            || avs_time_duration_less(max_wait_time, AVS_TIME_DURATION_ZERO)) {
+        anjay_log(ERROR, "max_wait_time needs to be valid and non-negative");
+        return -1;
+    }
+    int status = ANJAY_EVENT_LOOP_IDLE;
+    if (!atomic_compare_exchange_strong(&group->status, &status,
+                                        ANJAY_EVENT_LOOP_RUNNING)
+            && status != ANJAY_EVENT_LOOP_RUNNING) {
+        anjay_log(ERROR, "Event loop is being interrupted");
+        return -1;
+    }
+#        ifndef ANJAY_WITH_THREAD_SAFETY
+    if (status == ANJAY_EVENT_LOOP_RUNNING) {
+        anjay_log(ERROR, "Event loop is already running");
+        return -1;
+    }
+#        endif // ANJAY_WITH_THREAD_SAFETY
+    return group_run(group, max_wait_time, enable_error_handling,
+                     &group->status);
+}
+
+int anjay_event_loop_group_interrupt(anjay_event_loop_group_t *group) {
+    return atomic_compare_exchange_strong(&group->status,
+                                          &(int) { ANJAY_EVENT_LOOP_RUNNING },
+                                          ANJAY_EVENT_LOOP_INTERRUPT)
+                   ? 0
+                   : -1;
+}
+#    else // ANJAY_WITH_EVENT_LOOP_EPOLL
 static int event_loop_run_with_error_handling(anjay_t *anjay_locked,
                                               avs_time_duration_t max_wait_time,
                                               bool enable_error_handling) {
@@ -247,7 +972,8 @@ static int event_loop_run_with_error_handling(anjay_t *anjay_locked,
         .max_wait_time = max_wait_time,
         .allow_interrupt = true
     };
-    bool running = should_event_loop_still_run(anjay_locked);
+    bool running = should_event_loop_still_run(
+            &anjay_locked->atomic_fields.event_loop_status);
     while (running) {
         handle_sockets_result = handle_sockets(&state);
         switch (handle_sockets_result) {
@@ -260,7 +986,8 @@ static int event_loop_run_with_error_handling(anjay_t *anjay_locked,
             break;
         case HANDLE_SOCKETS_CONTINUE:
             anjay_sched_run(anjay_locked);
-            running = should_event_loop_still_run(anjay_locked);
+            running = should_event_loop_still_run(
+                    &anjay_locked->atomic_fields.event_loop_status);
 
             if (enable_error_handling) {
                 if (anjay_all_connections_failed(anjay_locked)) {
@@ -273,6 +1000,7 @@ static int event_loop_run_with_error_handling(anjay_t *anjay_locked,
     event_loop_state_cleanup(&state);
     return handle_sockets_result == HANDLE_SOCKETS_ERROR ? -1 : 0;
 }
+#    endif // ANJAY_WITH_EVENT_LOOP_EPOLL
 
 int anjay_event_loop_run(anjay_t *anjay_locked,
                          avs_time_duration_t max_wait_time) {
@@ -311,4 +1039,8 @@ int anjay_serve_any(anjay_t *anjay_locked, avs_time_duration_t max_wait_time) {
     return handle_sockets_result == HANDLE_SOCKETS_ERROR ? -1 : 0;
 }
 
+#    if defined(ANJAY_WITH_EVENT_LOOP_EPOLL) && defined(ANJAY_TEST)
+#        include "tests/core/event_loop.c"
+#    endif // defined(ANJAY_WITH_EVENT_LOOP_EPOLL) && defined(ANJAY_TEST)
+
 #endif // ANJAY_WITH_EVENT_LOOP
@@ -154,7 +154,8 @@ static int request_payload_writer(size_t payload_offset,
             break;
         }
         int result = _anjay_batch_data_output_entry(
-                entry->anjay, entry->payload_batch, entry->target_ssid,
+                entry->anjay, entry->payload_batch, AVS_TIME_DURATION_ZERO,
+                entry->target_ssid,
                 entry->exchange_status.serialization_time,
                 &entry->exchange_status.output_state,
                 entry->exchange_status.out_ctx);
@@ -656,7 +657,7 @@ int _anjay_send_batch_data_add_current_multiple_unlocked(
     assert(anjay);
 
     anjay_batch_builder_t *batch_builder = cast_to_builder(builder);
-    AVS_LIST(anjay_batch_entry_t) *append_ptr = batch_builder->append_ptr;
+    const size_t initial_entry_count = batch_builder->entry_count;
     avs_time_real_t timestamp = avs_time_real_now();
 
     for (size_t i = 0; i < paths_length; i++) {
@@ -668,8 +669,7 @@ int _anjay_send_batch_data_add_current_multiple_unlocked(
                      _("resource ") "/%u/%u/%u" _(" not found, ignoring"),
                      paths[i].oid, paths[i].iid, paths[i].rid);
         } else if (result) {
-            batch_builder->append_ptr = append_ptr;
-            _anjay_batch_entry_list_cleanup(batch_builder->append_ptr);
+            _anjay_batch_builder_truncate(batch_builder, initial_entry_count);
             return result;
         }
     }
@@ -9,6 +9,8 @@
 
 #include <anjay_init.h>
 
+#include <string.h>
+
 #include <anjay_modules/anjay_dm_utils.h>
 #include <anjay_modules/anjay_notify.h>
 
@@ -22,11 +24,43 @@
 VISIBILITY_SOURCE_BEGIN
 
 #ifdef ANJAY_WITH_OBSERVE
+/**
+ * Checks whether the change might affect effective attributes of observed
+ * paths - i.e. whether it changes presence of instances (and so also of the
+ * attributes attached to them), or the Server object resources used for
+ * determining default attribute values.
+ */
+static bool
+affects_observe_attrs(const anjay_notify_queue_object_entry_t *entry) {
+    if (entry->instance_set_changes.instance_set_changed) {
+        return true;
+    }
+    if (entry->oid == ANJAY_DM_OID_SERVER) {
+        AVS_LIST(anjay_notify_queue_resource_entry_t) it;
+        AVS_LIST_FOREACH(it, entry->resources_changed) {
+            if (it->rid == ANJAY_DM_RID_SERVER_SSID
+                    || it->rid == ANJAY_DM_RID_SERVER_DEFAULT_PMIN
+                    || it->rid == ANJAY_DM_RID_SERVER_DEFAULT_PMAX) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 static int observe_notify(anjay_unlocked_t *anjay,
                           anjay_ssid_t origin_ssid,
                           anjay_notify_queue_t queue) {
+    // values read before the change must not be reused
+    _anjay_observe_read_cache_clear(&anjay->observe);
     int ret = 0;
     AVS_LIST(anjay_notify_queue_object_entry_t) it;
+    AVS_LIST_FOREACH(it, queue) {
+        if (affects_observe_attrs(it)) {
+            _anjay_observe_attrs_cache_invalidate(&anjay->observe);
+            break;
+        }
+    }
     AVS_LIST_FOREACH(it, queue) {
         if (it->instance_set_changes.instance_set_changed) {
             _anjay_update_ret(&ret,
@@ -140,6 +174,13 @@ static int anjay_notify_perform_impl(anjay_unlocked_t *anjay,
     AVS_LIST_FOREACH(it, *queue_ptr) {
         if (it->instance_set_changes.instance_set_changed) {
             instances_modified = true;
+            _anjay_dm_instance_cache_invalidate(anjay, it->oid);
+        } else {
+            AVS_LIST(anjay_notify_queue_resource_entry_t) res_it;
+            AVS_LIST_FOREACH(res_it, it->resources_changed) {
+                _anjay_dm_resource_cache_invalidate(anjay, it->oid,
+                                                    res_it->iid);
+            }
         }
         if (it->oid == ANJAY_DM_OID_SECURITY) {
             _anjay_update_ret(&ret, security_modified_notify(anjay, it));
@@ -239,6 +280,7 @@ static void delete_notify_queue_object_entry_if_empty(
         return;
     }
     assert(!(*entry_ptr)->instance_set_changes.known_added_iids);
+    assert(!(*entry_ptr)->instance_set_changes.known_removed_iids);
     AVS_LIST_DELETE(entry_ptr);
 }
 
@@ -270,6 +312,12 @@ int _anjay_notify_queue_instance_removed(anjay_notify_queue_t *out_queue,
         anjay_log(ERROR, _("out of memory"));
         return -1;
     }
+    if (add_entry_to_iid_set(
+                &(*entry_ptr)->instance_set_changes.known_removed_iids, iid)) {
+        anjay_log(ERROR, _("out of memory"));
+        delete_notify_queue_object_entry_if_empty(entry_ptr);
+        return -1;
+    }
     remove_entry_from_iid_set(
             &(*entry_ptr)->instance_set_changes.known_added_iids, iid);
     (*entry_ptr)->instance_set_changes.instance_set_changed = true;
@@ -285,6 +333,7 @@ int _anjay_notify_queue_instance_set_unknown_change(
         return -1;
     }
     (*entry_ptr)->instance_set_changes.instance_set_changed = true;
+    (*entry_ptr)->instance_set_changes.instance_set_unknown_change = true;
     return 0;
 }
 
@@ -337,14 +386,178 @@ int _anjay_notify_queue_resource_change(anjay_notify_queue_t *out_queue,
 void _anjay_notify_clear_queue(anjay_notify_queue_t *out_queue) {
     AVS_LIST_CLEAR(out_queue) {
         AVS_LIST_CLEAR(&(*out_queue)->instance_set_changes.known_added_iids);
+        AVS_LIST_CLEAR(
+                &(*out_queue)->instance_set_changes.known_removed_iids);
         AVS_LIST_CLEAR(&(*out_queue)->resources_changed);
     }
 }
 
+// Maximum size of a single bitmap - 4096 bits, i.e. 512 bytes
+#define NOTIFY_BITMAP_MAX_WORDS 128
+
+static AVS_LIST(anjay_notify_bitmap_t) *
+find_bitmap_ptr(AVS_LIST(anjay_notify_bitmap_t) *bitmaps_ptr, anjay_oid_t oid) {
+    AVS_LIST(anjay_notify_bitmap_t) *it;
+    AVS_LIST_FOREACH_PTR(it, bitmaps_ptr) {
+        if ((*it)->oid >= oid) {
+            break;
+        }
+    }
+    return it;
+}
+
+static int resize_bitmap(anjay_notify_bitmap_t *bitmap,
+                         size_t iid_count,
+                         size_t row_words) {
+    uint32_t *words =
+            (uint32_t *) avs_calloc(iid_count * row_words, sizeof(uint32_t));
+    if (!words) {
+        return -1;
+    }
+    for (size_t i = 0; i < bitmap->iid_count; ++i) {
+        memcpy(&words[i * row_words], &bitmap->words[i * bitmap->row_words],
+               bitmap->row_words * sizeof(uint32_t));
+    }
+    avs_free(bitmap->words);
+    bitmap->words = words;
+    bitmap->iid_count = iid_count;
+    bitmap->row_words = row_words;
+    return 0;
+}
+
+int _anjay_notify_bitmap_set(AVS_LIST(anjay_notify_bitmap_t) *bitmaps_ptr,
+                             anjay_oid_t oid,
+                             anjay_iid_t iid,
+                             anjay_rid_t rid) {
+    AVS_LIST(anjay_notify_bitmap_t) *bitmap_ptr =
+            find_bitmap_ptr(bitmaps_ptr, oid);
+    bool exists = (*bitmap_ptr && (*bitmap_ptr)->oid == oid);
+    size_t iid_count = (size_t) iid + 1;
+    size_t row_words = (size_t) rid / 32 + 1;
+    if (exists) {
+        iid_count = AVS_MAX(iid_count, (*bitmap_ptr)->iid_count);
+        row_words = AVS_MAX(row_words, (*bitmap_ptr)->row_words);
+    }
+    if (iid_count * row_words > NOTIFY_BITMAP_MAX_WORDS) {
+        return 1;
+    }
+    if (!exists) {
+        if (!AVS_LIST_INSERT_NEW(anjay_notify_bitmap_t, bitmap_ptr)) {
+            anjay_log(ERROR, _("out of memory"));
+            return -1;
+        }
+        (*bitmap_ptr)->oid = oid;
+    }
+    anjay_notify_bitmap_t *bitmap = *bitmap_ptr;
+    if ((iid_count != bitmap->iid_count || row_words != bitmap->row_words)
+            && resize_bitmap(bitmap, iid_count, row_words)) {
+        anjay_log(ERROR, _("out of memory"));
+        if (!bitmap->words) {
+            AVS_LIST_DELETE(bitmap_ptr);
+        }
+        return -1;
+    }
+    bitmap->words[iid * bitmap->row_words + rid / 32] |= (uint32_t) 1
+                                                         << (rid % 32);
+    bitmap->any_set = true;
+    return 0;
+}
+
+static int merge_bitmap_into_queue(const anjay_notify_bitmap_t *bitmap,
+                                   anjay_notify_queue_t *out_queue) {
+    AVS_LIST(anjay_notify_queue_object_entry_t) *obj_entry_ptr =
+            find_or_create_object_entry(out_queue, bitmap->oid);
+    if (!obj_entry_ptr) {
+        anjay_log(ERROR, _("out of memory"));
+        return -1;
+    }
+    // Both the bitmap and the resources_changed list are ordered by (IID,
+    // RID), so they can be merged in a single pass
+    AVS_LIST(anjay_notify_queue_resource_entry_t) *res_entry_ptr =
+            &(*obj_entry_ptr)->resources_changed;
+    for (size_t i = 0; i < bitmap->iid_count * bitmap->row_words; ++i) {
+        for (size_t bit = 0; bit < 32 && (bitmap->words[i] >> bit); ++bit) {
+            if (!((bitmap->words[i] >> bit) & 1)) {
+                continue;
+            }
+            const anjay_notify_queue_resource_entry_t new_entry = {
+                .iid = (anjay_iid_t) (i / bitmap->row_words),
+                .rid = (anjay_rid_t) ((i % bitmap->row_words) * 32 + bit)
+            };
+            int compare = -1;
+            while (*res_entry_ptr
+                   && (compare = compare_resource_entries(*res_entry_ptr,
+                                                          &new_entry))
+                              < 0) {
+                res_entry_ptr = AVS_LIST_NEXT_PTR(res_entry_ptr);
+            }
+            if (*res_entry_ptr && compare == 0) {
+                continue;
+            }
+            if (!AVS_LIST_INSERT_NEW(anjay_notify_queue_resource_entry_t,
+                                     res_entry_ptr)) {
+                anjay_log(ERROR, _("out of memory"));
+                delete_notify_queue_object_entry_if_empty(obj_entry_ptr);
+                return -1;
+            }
+            **res_entry_ptr = new_entry;
+        }
+    }
+    return 0;
+}
+
+static void clear_bitmap(anjay_notify_bitmap_t *bitmap) {
+    if (bitmap->any_set) {
+        memset(bitmap->words, 0,
+               bitmap->iid_count * bitmap->row_words * sizeof(uint32_t));
+        bitmap->any_set = false;
+    }
+}
+
+int _anjay_notify_bitmaps_flush(AVS_LIST(anjay_notify_bitmap_t) bitmaps,
+                                anjay_notify_queue_t *out_queue) {
+    int result = 0;
+    AVS_LIST(anjay_notify_bitmap_t) it;
+    AVS_LIST_FOREACH(it, bitmaps) {
+        if (it->any_set) {
+            int merge_result = merge_bitmap_into_queue(it, out_queue);
+            if (merge_result) {
+                // keep the changes recorded, so that they are not lost
+                _anjay_update_ret(&result, merge_result);
+            } else {
+                clear_bitmap(it);
+            }
+        }
+    }
+    return result;
+}
+
+void _anjay_notify_bitmaps_remove_object(
+        AVS_LIST(anjay_notify_bitmap_t) *bitmaps_ptr, anjay_oid_t oid) {
+    AVS_LIST(anjay_notify_bitmap_t) *bitmap_ptr =
+            find_bitmap_ptr(bitmaps_ptr, oid);
+    if (*bitmap_ptr && (*bitmap_ptr)->oid == oid) {
+        avs_free((*bitmap_ptr)->words);
+        AVS_LIST_DELETE(bitmap_ptr);
+    }
+}
+
+void _anjay_notify_bitmaps_cleanup(
+        AVS_LIST(anjay_notify_bitmap_t) *bitmaps_ptr) {
+    AVS_LIST_CLEAR(bitmaps_ptr) {
+        avs_free((*bitmaps_ptr)->words);
+    }
+}
+
 static void notify_clb(avs_sched_t *sched, const void *dummy) {
     (void) dummy;
     anjay_t *anjay_locked = _anjay_get_from_sched(sched);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    if (_anjay_notify_bitmaps_flush(anjay->scheduled_notify.bitmaps,
+                                    &anjay->scheduled_notify.queue)) {
+        anjay_log(ERROR, _("could not queue some of the changes, they will be "
+                           "retried during the next flush"));
+    }
     _anjay_notify_flush(anjay, ANJAY_SSID_BOOTSTRAP,
                         &anjay->scheduled_notify.queue);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
@@ -361,6 +574,7 @@ static int reschedule_notify(anjay_unlocked_t *anjay) {
 int _anjay_notify_instance_created(anjay_unlocked_t *anjay,
                                    anjay_oid_t oid,
                                    anjay_iid_t iid) {
+    _anjay_dm_instance_cache_invalidate(anjay, oid);
     int retval;
     (void) ((retval = _anjay_notify_queue_instance_created(
                      &anjay->scheduled_notify.queue, oid, iid))
@@ -368,13 +582,26 @@ int _anjay_notify_instance_created(anjay_unlocked_t *anjay,
     return retval;
 }
 
+static int queue_scheduled_resource_change(anjay_unlocked_t *anjay,
+                                           anjay_oid_t oid,
+                                           anjay_iid_t iid,
+                                           anjay_rid_t rid) {
+    _anjay_dm_resource_cache_invalidate(anjay, oid, iid);
+    int retval = _anjay_notify_bitmap_set(&anjay->scheduled_notify.bitmaps,
+                                          oid, iid, rid);
+    if (retval > 0) {
+        retval = _anjay_notify_queue_resource_change(
+                &anjay->scheduled_notify.queue, oid, iid, rid);
+    }
+    return retval;
+}
+
 int _anjay_notify_changed_unlocked(anjay_unlocked_t *anjay,
                                    anjay_oid_t oid,
                                    anjay_iid_t iid,
                                    anjay_rid_t rid) {
     int retval;
-    (void) ((retval = _anjay_notify_queue_resource_change(
-                     &anjay->scheduled_notify.queue, oid, iid, rid))
+    (void) ((retval = queue_scheduled_resource_change(anjay, oid, iid, rid))
             || (retval = reschedule_notify(anjay)));
     return retval;
 }
@@ -390,8 +617,29 @@ int anjay_notify_changed(anjay_t *anjay_locked,
     return retval;
 }
 
+int anjay_notify_changed_batch(anjay_t *anjay_locked,
+                               const anjay_notify_resource_path_t *paths,
+                               size_t paths_count) {
+    assert(paths || !paths_count);
+    int retval = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    retval = 0;
+    for (size_t i = 0; i < paths_count; ++i) {
+        _anjay_update_ret(&retval,
+                          queue_scheduled_resource_change(anjay, paths[i].oid,
+                                                          paths[i].iid,
+                                                          paths[i].rid));
+    }
+    if (paths_count) {
+        _anjay_update_ret(&retval, reschedule_notify(anjay));
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return retval;
+}
+
 int _anjay_notify_instances_changed_unlocked(anjay_unlocked_t *anjay,
                                              anjay_oid_t oid) {
+    _anjay_dm_instance_cache_invalidate(anjay, oid);
     int retval;
     (void) ((retval = _anjay_notify_queue_instance_set_unknown_change(
                      &anjay->scheduled_notify.queue, oid))
@@ -453,3 +701,7 @@ anjay_resource_observation_status(anjay_t *anjay_locked,
     return retval;
 }
 #endif // ANJAY_WITH_OBSERVATION_STATUS
+
+#ifdef ANJAY_TEST
+#    include "tests/core/notify.c"
+#endif // ANJAY_TEST
@@ -229,6 +229,7 @@ avs_error_t _anjay_socket_cleanup(anjay_unlocked_t *anjay,
                                   avs_net_socket_t **socket) {
     assert(socket);
     if (*socket) {
+        _anjay_socket_set_changed(anjay);
         avs_net_socket_shutdown(*socket);
 #ifdef ANJAY_WITH_NET_STATS
         anjay->closed_connections_stats.socket_stats.bytes_sent +=
@@ -236,7 +237,6 @@ avs_error_t _anjay_socket_cleanup(anjay_unlocked_t *anjay,
         anjay->closed_connections_stats.socket_stats.bytes_received +=
                 get_socket_stats(*socket, NET_STATS_BYTES_RECEIVED);
 #endif // ANJAY_WITH_NET_STATS
-        (void) anjay;
     }
     return avs_net_socket_cleanup(socket);
 }
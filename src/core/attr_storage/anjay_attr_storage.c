@@ -16,10 +16,12 @@
 #    include <math.h>
 #    include <string.h>
 
+#    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_stream_membuf.h>
 
 #    include <anjay_modules/anjay_dm_utils.h>
 #    include <anjay_modules/anjay_raw_buffer.h>
+#    include <anjay_modules/anjay_sched.h>
 
 #    include "../anjay_core.h"
 
@@ -42,6 +44,8 @@ int _anjay_attr_storage_init(anjay_unlocked_t *anjay) {
 
 void _anjay_attr_storage_cleanup(anjay_attr_storage_t *as) {
     assert(as);
+    avs_sched_del(&as->gc_job_handle);
+    _anjay_notify_clear_queue(&as->gc_queue);
     _anjay_attr_storage_clear(as);
     avs_stream_cleanup(&as->saved_state.persist_data);
 }
@@ -55,135 +59,228 @@ bool anjay_attr_storage_is_modified(anjay_t *anjay_locked) {
 }
 
 void _anjay_attr_storage_clear(anjay_attr_storage_t *as) {
-    while (as->objects) {
-        remove_object_entry(as, &as->objects);
+    if (as->entry_count) {
+        _anjay_attr_storage_mark_modified(as);
     }
+    avs_free(as->entries);
+    as->entries = NULL;
+    as->entry_count = 0;
+    as->entry_capacity = 0;
 }
 
 void anjay_attr_storage_purge(anjay_t *anjay_locked) {
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     _anjay_attr_storage_clear(&anjay->attr_storage);
     _anjay_attr_storage_mark_modified(&anjay->attr_storage);
+    _anjay_observe_attrs_cache_invalidate(&anjay->observe);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
 
 //// HELPERS ///////////////////////////////////////////////////////////////////
 
-AVS_STATIC_ASSERT(offsetof(as_object_entry_t, oid) == 0, object_id_offset);
-AVS_STATIC_ASSERT(offsetof(as_instance_entry_t, iid) == 0, instance_id_offset);
-AVS_STATIC_ASSERT(offsetof(as_resource_entry_t, rid) == 0, resource_id_offset);
-AVS_STATIC_ASSERT(offsetof(as_resource_instance_entry_t, riid) == 0,
-                  resource_instance_id_offset);
-
-static AVS_LIST(void) *
-find_or_create_entry_impl(AVS_LIST(void) *children_list_ptr,
-                          size_t entry_size,
-                          uint16_t id,
-                          bool allow_create) {
-    AVS_LIST(void) *entry_ptr;
-    AVS_LIST_FOREACH_PTR(entry_ptr, children_list_ptr) {
-        if (*(uint16_t *) *entry_ptr >= id) {
-            break;
+#    define AS_KEY_ID_BITS 16
+
+as_key_t _anjay_attr_storage_key(const anjay_uri_path_t *path) {
+    const size_t length = _anjay_uri_path_length(path);
+    as_key_t key = 0;
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(path->ids); ++i) {
+        key <<= AS_KEY_ID_BITS;
+        if (i < length) {
+            key |= (as_key_t) path->ids[i] + 1;
         }
     }
-    if (!*entry_ptr || *(uint16_t *) *entry_ptr != id) {
-        if (allow_create) {
-            AVS_LIST(void) new_entry = AVS_LIST_NEW_BUFFER(entry_size);
-            if (!new_entry) {
-                as_log(ERROR, _("out of memory"));
-                return NULL;
-            }
-            *(uint16_t *) new_entry = id;
-            AVS_LIST_INSERT(entry_ptr, new_entry);
+    return key;
+}
+
+anjay_uri_path_t _anjay_attr_storage_key_path(as_key_t key) {
+    anjay_uri_path_t path = MAKE_ROOT_PATH();
+    for (size_t i = AVS_ARRAY_SIZE(path.ids); i-- > 0;) {
+        path.ids[i] = (uint16_t) ((key & UINT16_MAX) - 1);
+        key >>= AS_KEY_ID_BITS;
+    }
+    return path;
+}
+
+/**
+ * Returns the greatest key of any path that is either @p path itself or one of
+ * its descendants.
+ */
+static as_key_t subtree_last_key(const anjay_uri_path_t *path) {
+    const size_t missing_ids =
+            AVS_ARRAY_SIZE(path->ids) - _anjay_uri_path_length(path);
+    if (missing_ids >= AVS_ARRAY_SIZE(path->ids)) {
+        return UINT64_MAX;
+    }
+    return _anjay_attr_storage_key(path)
+           | ((UINT64_C(1) << (missing_ids * AS_KEY_ID_BITS)) - 1);
+}
+
+size_t _anjay_attr_storage_lower_bound(const anjay_attr_storage_t *as,
+                                       as_key_t key,
+                                       anjay_ssid_t ssid) {
+    size_t begin = 0;
+    size_t end = as->entry_count;
+    while (begin < end) {
+        size_t middle = begin + (end - begin) / 2;
+        const as_entry_t *entry = &as->entries[middle];
+        if (entry->key < key || (entry->key == key && entry->ssid < ssid)) {
+            begin = middle + 1;
         } else {
-            return NULL;
+            end = middle;
         }
     }
-    return entry_ptr;
+    return begin;
 }
 
-static inline AVS_LIST(as_object_entry_t) *
-find_object(anjay_attr_storage_t *parent, anjay_oid_t id) {
-    return (AVS_LIST(as_object_entry_t) *) find_or_create_entry_impl(
-            (AVS_LIST(void) *) &parent->objects, sizeof(as_object_entry_t), id,
-            false);
+/**
+ * Returns index of the first entry with key greater than @p key.
+ */
+static size_t key_upper_bound(const anjay_attr_storage_t *as, as_key_t key) {
+    size_t begin = 0;
+    size_t end = as->entry_count;
+    while (begin < end) {
+        size_t middle = begin + (end - begin) / 2;
+        if (as->entries[middle].key <= key) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return begin;
 }
 
-static inline AVS_LIST(as_object_entry_t) *
-find_or_create_object(anjay_attr_storage_t *parent, anjay_oid_t id) {
-    return (AVS_LIST(as_object_entry_t) *) find_or_create_entry_impl(
-            (AVS_LIST(void) *) &parent->objects, sizeof(as_object_entry_t), id,
-            true);
+size_t _anjay_attr_storage_subtree_end(const anjay_attr_storage_t *as,
+                                       const anjay_uri_path_t *path) {
+    return key_upper_bound(as, subtree_last_key(path));
 }
 
-static inline AVS_LIST(as_instance_entry_t) *
-find_instance(as_object_entry_t *parent, anjay_iid_t id) {
-    return (AVS_LIST(as_instance_entry_t) *) find_or_create_entry_impl(
-            (AVS_LIST(void) *) &parent->instances, sizeof(as_instance_entry_t),
-            id, false);
+static bool has_subtree_entries(const anjay_attr_storage_t *as,
+                                const anjay_uri_path_t *path) {
+    return _anjay_attr_storage_subtree_begin(as, path)
+           < _anjay_attr_storage_subtree_end(as, path);
 }
 
-static inline AVS_LIST(as_instance_entry_t) *
-find_or_create_instance(as_object_entry_t *parent, anjay_iid_t id) {
-    return (AVS_LIST(as_instance_entry_t) *) find_or_create_entry_impl(
-            (AVS_LIST(void) *) &parent->instances, sizeof(as_instance_entry_t),
-            id, true);
+void _anjay_attr_storage_remove_range(anjay_attr_storage_t *as,
+                                      size_t begin,
+                                      size_t end) {
+    assert(begin <= end && end <= as->entry_count);
+    if (begin == end) {
+        return;
+    }
+    memmove(&as->entries[begin], &as->entries[end],
+            (as->entry_count - end) * sizeof(*as->entries));
+    as->entry_count -= end - begin;
+    _anjay_attr_storage_mark_modified(as);
 }
 
-static inline AVS_LIST(as_resource_entry_t) *
-find_resource(as_instance_entry_t *parent, anjay_rid_t id) {
-    return (AVS_LIST(as_resource_entry_t) *) find_or_create_entry_impl(
-            (AVS_LIST(void) *) &parent->resources, sizeof(as_resource_entry_t),
-            id, false);
+static as_entry_t *find_entry(const anjay_attr_storage_t *as,
+                              const anjay_uri_path_t *path,
+                              anjay_ssid_t ssid) {
+    const as_key_t key = _anjay_attr_storage_key(path);
+    size_t index = _anjay_attr_storage_lower_bound(as, key, ssid);
+    if (index < as->entry_count && as->entries[index].key == key
+            && as->entries[index].ssid == ssid) {
+        return &as->entries[index];
+    }
+    return NULL;
 }
 
-static inline AVS_LIST(as_resource_entry_t) *
-find_or_create_resource(as_instance_entry_t *parent, anjay_rid_t id) {
-    return (AVS_LIST(as_resource_entry_t) *) find_or_create_entry_impl(
-            (AVS_LIST(void) *) &parent->resources, sizeof(as_resource_entry_t),
-            id, true);
+static as_entry_t *insert_entry(anjay_attr_storage_t *as, size_t index) {
+    assert(index <= as->entry_count);
+    if (as->entry_count == as->entry_capacity) {
+        size_t new_capacity = as->entry_capacity ? 2 * as->entry_capacity : 8;
+        as_entry_t *new_entries = (as_entry_t *) avs_realloc(
+                as->entries, new_capacity * sizeof(*as->entries));
+        if (!new_entries) {
+            as_log(ERROR, _("out of memory"));
+            return NULL;
+        }
+        as->entries = new_entries;
+        as->entry_capacity = new_capacity;
+    }
+    memmove(&as->entries[index + 1], &as->entries[index],
+            (as->entry_count - index) * sizeof(*as->entries));
+    ++as->entry_count;
+    return &as->entries[index];
 }
 
-#    ifdef ANJAY_WITH_LWM2M11
-static inline AVS_LIST(as_resource_instance_entry_t) *
-find_resource_instance(as_resource_entry_t *parent, anjay_riid_t id) {
-    return (AVS_LIST(as_resource_instance_entry_t) *) find_or_create_entry_impl(
-            (AVS_LIST(void) *) &parent->resource_instances,
-            sizeof(as_resource_instance_entry_t), id, false);
+/**
+ * Inserts or overwrites the entry for (@p path, @p ssid), without marking the
+ * storage as modified.
+ */
+static int put_entry(anjay_attr_storage_t *as,
+                     const anjay_uri_path_t *path,
+                     anjay_ssid_t ssid,
+                     const anjay_dm_r_attributes_t *attrs) {
+    const as_key_t key = _anjay_attr_storage_key(path);
+    size_t index = _anjay_attr_storage_lower_bound(as, key, ssid);
+    as_entry_t *entry = NULL;
+    if (index < as->entry_count && as->entries[index].key == key
+            && as->entries[index].ssid == ssid) {
+        entry = &as->entries[index];
+    } else if ((entry = insert_entry(as, index))) {
+        entry->key = key;
+        entry->ssid = ssid;
+    } else {
+        return ANJAY_ERR_INTERNAL;
+    }
+    entry->attrs = *attrs;
+    return 0;
 }
 
-static inline AVS_LIST(as_resource_instance_entry_t) *
-find_or_create_resource_instance(as_resource_entry_t *parent, anjay_riid_t id) {
-    return (AVS_LIST(as_resource_instance_entry_t) *) find_or_create_entry_impl(
-            (AVS_LIST(void) *) &parent->resource_instances,
-            sizeof(as_resource_instance_entry_t), id, true);
+static int write_attrs(anjay_attr_storage_t *as,
+                       const anjay_uri_path_t *path,
+                       anjay_ssid_t ssid,
+                       const anjay_dm_r_attributes_t *attrs) {
+    if (!_anjay_dm_resource_attributes_empty(attrs)) {
+        // writing non-empty set of attributes
+        int result = put_entry(as, path, ssid, attrs);
+        if (!result) {
+            _anjay_attr_storage_mark_modified(as);
+        }
+        return result;
+    }
+    // writing EMPTY set of attributes - removing the entry, if it exists
+    as_entry_t *entry = find_entry(as, path, ssid);
+    if (entry) {
+        size_t index = (size_t) (entry - as->entries);
+        _anjay_attr_storage_remove_range(as, index, index + 1);
+    }
+    return 0;
 }
-#    endif // ANJAY_WITH_LWM2M11
 
-static void remove_instance_if_empty(AVS_LIST(as_instance_entry_t) *entry_ptr) {
-    if (!(*entry_ptr)->default_attrs && !(*entry_ptr)->resources) {
-        AVS_LIST_DELETE(entry_ptr);
-    }
+static int write_default_attrs(anjay_attr_storage_t *as,
+                               const anjay_uri_path_t *path,
+                               anjay_ssid_t ssid,
+                               const anjay_dm_oi_attributes_t *attrs) {
+    anjay_dm_r_attributes_t r_attrs = ANJAY_DM_R_ATTRIBUTES_EMPTY;
+    r_attrs.common = *attrs;
+    return write_attrs(as, path, ssid, &r_attrs);
 }
 
-static void remove_resource_if_empty(AVS_LIST(as_resource_entry_t) *entry_ptr) {
-    if (!(*entry_ptr)->attrs
-#    ifdef ANJAY_WITH_LWM2M11
-            && !(*entry_ptr)->resource_instances
-#    endif // ANJAY_WITH_LWM2M11
-    ) {
-        AVS_LIST_DELETE(entry_ptr);
+static void read_attrs(const anjay_attr_storage_t *as,
+                       const anjay_uri_path_t *path,
+                       anjay_ssid_t ssid,
+                       anjay_dm_r_attributes_t *out) {
+    const as_entry_t *entry = find_entry(as, path, ssid);
+    if (entry) {
+        *out = entry->attrs;
+    } else {
+        *out = ANJAY_DM_R_ATTRIBUTES_EMPTY;
     }
 }
 
-#    ifdef ANJAY_WITH_LWM2M11
-static void remove_resource_instance_if_empty(
-        AVS_LIST(as_resource_instance_entry_t) *entry_ptr) {
-    if (!(*entry_ptr)->attrs) {
-        AVS_LIST_DELETE(entry_ptr);
+static void read_default_attrs(const anjay_attr_storage_t *as,
+                               const anjay_uri_path_t *path,
+                               anjay_ssid_t ssid,
+                               anjay_dm_oi_attributes_t *out) {
+    const as_entry_t *entry = find_entry(as, path, ssid);
+    if (entry) {
+        *out = entry->attrs.common;
+    } else {
+        *out = ANJAY_DM_OI_ATTRIBUTES_EMPTY;
     }
 }
-#    endif // ANJAY_WITH_LWM2M11
 
 static inline bool is_ssid_reference_object(anjay_oid_t oid) {
     return oid == ANJAY_DM_OID_SECURITY || oid == ANJAY_DM_OID_SERVER;
@@ -217,93 +314,88 @@ query_ssid(anjay_unlocked_t *anjay, anjay_oid_t oid, anjay_iid_t iid) {
     return (anjay_ssid_t) ssid;
 }
 
-static void remove_attrs_entry(anjay_attr_storage_t *as,
-                               AVS_LIST(void) *attrs_ptr) {
-    AVS_LIST_DELETE(attrs_ptr);
-    _anjay_attr_storage_mark_modified(as);
-}
-
-static void
-remove_attrs_for_servers_not_on_list(anjay_attr_storage_t *as,
-                                     AVS_LIST(void) *attrs_ptr,
-                                     AVS_LIST(anjay_ssid_t) ssid_list) {
-    AVS_LIST(anjay_ssid_t) ssid_ptr = ssid_list;
-    while (*attrs_ptr) {
-        if (!ssid_ptr || *get_ssid_ptr(*attrs_ptr) < *ssid_ptr) {
-            remove_attrs_entry(as, attrs_ptr);
-        } else {
-            while (ssid_ptr && *get_ssid_ptr(*attrs_ptr) > *ssid_ptr) {
-                AVS_LIST_ADVANCE(&ssid_ptr);
-            }
-            if (ssid_ptr && *get_ssid_ptr(*attrs_ptr) == *ssid_ptr) {
-                AVS_LIST_ADVANCE(&ssid_ptr);
-                AVS_LIST_ADVANCE_PTR(&attrs_ptr);
-            }
+static bool ssid_on_list(anjay_ssid_t ssid,
+                         AVS_LIST(anjay_ssid_t) sorted_ssid_list) {
+    AVS_LIST_ITERATE(sorted_ssid_list) {
+        if (*sorted_ssid_list >= ssid) {
+            return *sorted_ssid_list == ssid;
         }
     }
+    return false;
 }
 
 static void remove_servers_not_on_ssid_list(anjay_attr_storage_t *as,
                                             AVS_LIST(anjay_ssid_t) ssid_list) {
-    AVS_LIST(as_object_entry_t) *object_ptr;
-    AVS_LIST(as_object_entry_t) object_helper;
-    AVS_LIST_DELETABLE_FOREACH_PTR(object_ptr, object_helper, &as->objects) {
-        remove_attrs_for_servers_not_on_list(
-                as, (AVS_LIST(void) *) &(*object_ptr)->default_attrs,
-                ssid_list);
-        AVS_LIST(as_instance_entry_t) *instance_ptr;
-        AVS_LIST(as_instance_entry_t) instance_helper;
-        AVS_LIST_DELETABLE_FOREACH_PTR(instance_ptr, instance_helper,
-                                       &(*object_ptr)->instances) {
-            remove_attrs_for_servers_not_on_list(
-                    as, (AVS_LIST(void) *) &(*instance_ptr)->default_attrs,
-                    ssid_list);
-            AVS_LIST(as_resource_entry_t) *res_ptr;
-            AVS_LIST(as_resource_entry_t) res_helper;
-            AVS_LIST_DELETABLE_FOREACH_PTR(res_ptr, res_helper,
-                                           &(*instance_ptr)->resources) {
-                remove_attrs_for_servers_not_on_list(
-                        as, (AVS_LIST(void) *) &(*res_ptr)->attrs, ssid_list);
-#    ifdef ANJAY_WITH_LWM2M11
-                AVS_LIST(as_resource_instance_entry_t) *res_instance_ptr;
-                AVS_LIST(as_resource_instance_entry_t) res_instance_helper;
-                AVS_LIST_DELETABLE_FOREACH_PTR(
-                        res_instance_ptr, res_instance_helper,
-                        &(*res_ptr)->resource_instances) {
-                    remove_attrs_for_servers_not_on_list(
-                            as, (AVS_LIST(void) *) &(*res_instance_ptr)->attrs,
-                            ssid_list);
-
-                    remove_resource_instance_if_empty(res_instance_ptr);
-                }
-#    endif // ANJAY_WITH_LWM2M11
-                remove_resource_if_empty(res_ptr);
+    size_t kept = 0;
+    for (size_t i = 0; i < as->entry_count; ++i) {
+        if (ssid_on_list(as->entries[i].ssid, ssid_list)) {
+            if (kept != i) {
+                as->entries[kept] = as->entries[i];
             }
-            remove_instance_if_empty(instance_ptr);
+            ++kept;
         }
-        remove_object_if_empty(object_ptr);
     }
+    if (kept != as->entry_count) {
+        as->entry_count = kept;
+        _anjay_attr_storage_mark_modified(as);
+    }
+}
+
+/**
+ * Common part of the callbacks that remove entries for children of some path
+ * that are not present in the data model. The children are expected to be
+ * enumerated in ascending order; the ones reported out of order are ignored.
+ *
+ * Entries in range [*cursor_ptr, beginning of @p child_path's subtree) are
+ * removed. If @p present is true, *cursor_ptr is then advanced past the
+ * subtree of @p child_path; otherwise that subtree is removed as well.
+ */
+static void remove_absent_until(anjay_attr_storage_t *as,
+                                size_t *cursor_ptr,
+                                const anjay_uri_path_t *child_path,
+                                bool present) {
+    size_t begin = _anjay_attr_storage_subtree_begin(as, child_path);
+    if (begin < *cursor_ptr) {
+        return;
+    }
+    _anjay_attr_storage_remove_range(as, *cursor_ptr, begin);
+    if (present) {
+        *cursor_ptr = _anjay_attr_storage_subtree_end(as, child_path);
+    } else {
+        _anjay_attr_storage_remove_subtree(as, child_path);
+    }
+}
+
+as_remove_absent_instances_ctx_t
+_anjay_attr_storage_remove_absent_instances_begin(anjay_attr_storage_t *as,
+                                                  anjay_oid_t oid) {
+    return (as_remove_absent_instances_ctx_t) {
+        .oid = oid,
+        .cursor = _anjay_attr_storage_children_begin(as,
+                                                     &MAKE_OBJECT_PATH(oid))
+    };
 }
 
 int _anjay_attr_storage_remove_absent_instances_clb(
         anjay_unlocked_t *anjay,
         const anjay_dm_installed_object_t *def_ptr,
         anjay_iid_t iid,
-        void *instance_ptr_ptr_) {
+        void *ctx_) {
     (void) def_ptr;
-    AVS_LIST(as_instance_entry_t) **instance_ptr_ptr =
-            (AVS_LIST(as_instance_entry_t) **) instance_ptr_ptr_;
-    if (**instance_ptr_ptr && (**instance_ptr_ptr)->iid < iid) {
-        while (**instance_ptr_ptr && (**instance_ptr_ptr)->iid < iid) {
-            remove_instance_entry(&anjay->attr_storage, *instance_ptr_ptr);
-        }
-    }
-    if (**instance_ptr_ptr && (**instance_ptr_ptr)->iid == iid) {
-        AVS_LIST_ADVANCE_PTR(instance_ptr_ptr);
-    }
+    as_remove_absent_instances_ctx_t *ctx =
+            (as_remove_absent_instances_ctx_t *) ctx_;
+    remove_absent_until(&anjay->attr_storage, &ctx->cursor,
+                        &MAKE_INSTANCE_PATH(ctx->oid, iid), true);
     return 0;
 }
 
+void _anjay_attr_storage_remove_absent_instances_end(
+        anjay_attr_storage_t *as, as_remove_absent_instances_ctx_t *ctx) {
+    _anjay_attr_storage_remove_range(
+            as, ctx->cursor,
+            _anjay_attr_storage_subtree_end(as, &MAKE_OBJECT_PATH(ctx->oid)));
+}
+
 static int
 remove_absent_resources_clb(anjay_unlocked_t *anjay,
                             const anjay_dm_installed_object_t *def_ptr,
@@ -311,44 +403,32 @@ remove_absent_resources_clb(anjay_unlocked_t *anjay,
                             anjay_rid_t rid,
                             anjay_dm_resource_kind_t kind,
                             anjay_dm_resource_presence_t presence,
-                            void *resource_ptr_ptr_) {
-    (void) anjay;
-    (void) def_ptr;
-    (void) iid;
+                            void *cursor_ptr_) {
     (void) kind;
-    AVS_LIST(as_resource_entry_t) **resource_ptr_ptr =
-            (AVS_LIST(as_resource_entry_t) **) resource_ptr_ptr_;
-    while (**resource_ptr_ptr && (**resource_ptr_ptr)->rid < rid) {
-        remove_resource_entry(&anjay->attr_storage, *resource_ptr_ptr);
-    }
-    if (**resource_ptr_ptr && (**resource_ptr_ptr)->rid == rid) {
-        if (presence == ANJAY_DM_RES_ABSENT) {
-            remove_resource_entry(&anjay->attr_storage, *resource_ptr_ptr);
-        } else {
-            AVS_LIST_ADVANCE_PTR(resource_ptr_ptr);
-        }
-    }
+    remove_absent_until(&anjay->attr_storage, (size_t *) cursor_ptr_,
+                        &MAKE_RESOURCE_PATH(
+                                _anjay_dm_installed_object_oid(def_ptr), iid,
+                                rid),
+                        presence != ANJAY_DM_RES_ABSENT);
     return 0;
 }
 
 int _anjay_attr_storage_remove_absent_resources(
         anjay_unlocked_t *anjay,
-        AVS_LIST(as_instance_entry_t) *instance_ptr,
-        const anjay_dm_installed_object_t *def_ptr) {
-    AVS_LIST(as_resource_entry_t) *resource_ptr = &(*instance_ptr)->resources;
-    int result = 0;
-    if (def_ptr) {
-        result =
-                _anjay_dm_foreach_resource(anjay, def_ptr, (*instance_ptr)->iid,
-                                           remove_absent_resources_clb,
-                                           &resource_ptr);
-    }
+        const anjay_dm_installed_object_t *def_ptr,
+        anjay_iid_t iid) {
+    assert(def_ptr);
+    anjay_attr_storage_t *as = &anjay->attr_storage;
+    const anjay_uri_path_t instance_path =
+            MAKE_INSTANCE_PATH(_anjay_dm_installed_object_oid(def_ptr), iid);
+    size_t cursor = _anjay_attr_storage_children_begin(as, &instance_path);
+    int result = _anjay_dm_foreach_resource(
+            anjay, def_ptr, iid, remove_absent_resources_clb, &cursor);
     if (!result) {
-        while (*resource_ptr) {
-            remove_resource_entry(&anjay->attr_storage, resource_ptr);
-        }
+        _anjay_attr_storage_remove_range(
+                as, cursor,
+                _anjay_attr_storage_subtree_end(as, &instance_path));
     }
-    remove_instance_if_empty(instance_ptr);
     return result;
 }
 
@@ -359,23 +439,12 @@ remove_absent_resource_instances_clb(anjay_unlocked_t *anjay,
                                      anjay_iid_t iid,
                                      anjay_rid_t rid,
                                      anjay_riid_t riid,
-                                     void *resource_instance_ptr_ptr_) {
-    (void) anjay;
-    (void) def_ptr;
-    (void) iid;
-    (void) rid;
-    AVS_LIST(as_resource_instance_entry_t) **resource_instance_ptr_ptr =
-            (AVS_LIST(as_resource_instance_entry_t) **)
-                    resource_instance_ptr_ptr_;
-    while (**resource_instance_ptr_ptr
-           && (**resource_instance_ptr_ptr)->riid < riid) {
-        remove_resource_instance_entry(&anjay->attr_storage,
-                                       *resource_instance_ptr_ptr);
-    }
-    if (**resource_instance_ptr_ptr
-            && (**resource_instance_ptr_ptr)->riid == riid) {
-        AVS_LIST_ADVANCE_PTR(resource_instance_ptr_ptr);
-    }
+                                     void *cursor_ptr_) {
+    remove_absent_until(&anjay->attr_storage, (size_t *) cursor_ptr_,
+                        &MAKE_RESOURCE_INSTANCE_PATH(
+                                _anjay_dm_installed_object_oid(def_ptr), iid,
+                                rid, riid),
+                        true);
     return 0;
 }
 
@@ -383,121 +452,284 @@ int _anjay_attr_storage_remove_absent_resource_instances(
         anjay_unlocked_t *anjay,
         const anjay_dm_installed_object_t *def_ptr,
         anjay_iid_t iid,
-        AVS_LIST(as_resource_entry_t) *resource_ptr) {
-    AVS_LIST(as_resource_instance_entry_t) *resource_instance_ptr =
-            &(*resource_ptr)->resource_instances;
-    int result = 0;
-    if (def_ptr) {
-        anjay_dm_resource_kind_t resource_kind;
-        (void) ((result = _anjay_dm_resource_kind_and_presence(
-                         anjay, def_ptr, iid, (*resource_ptr)->rid,
-                         &resource_kind, NULL))
-                || !_anjay_dm_res_kind_multiple(resource_kind)
-                || (result = _anjay_dm_foreach_resource_instance(
-                            anjay, def_ptr, iid, (*resource_ptr)->rid,
-                            remove_absent_resource_instances_clb,
-                            &resource_instance_ptr)));
-    }
+        anjay_rid_t rid) {
+    assert(def_ptr);
+    anjay_attr_storage_t *as = &anjay->attr_storage;
+    const anjay_uri_path_t resource_path =
+            MAKE_RESOURCE_PATH(_anjay_dm_installed_object_oid(def_ptr), iid,
+                               rid);
+    size_t cursor = _anjay_attr_storage_children_begin(as, &resource_path);
+    anjay_dm_resource_kind_t resource_kind;
+    int result;
+    (void) ((result = _anjay_dm_resource_kind_and_presence(
+                     anjay, def_ptr, iid, rid, &resource_kind, NULL))
+            || !_anjay_dm_res_kind_multiple(resource_kind)
+            || (result = _anjay_dm_foreach_resource_instance(
+                        anjay, def_ptr, iid, rid,
+                        remove_absent_resource_instances_clb, &cursor)));
     if (!result) {
-        while (*resource_instance_ptr) {
-            remove_resource_instance_entry(&anjay->attr_storage,
-                                           resource_instance_ptr);
-        }
+        _anjay_attr_storage_remove_range(
+                as, cursor,
+                _anjay_attr_storage_subtree_end(as, &resource_path));
     }
-    remove_resource_if_empty(resource_ptr);
     return result;
 }
 #    endif // ANJAY_WITH_LWM2M11
 
-static void read_default_attrs(AVS_LIST(as_default_attrs_t) attrs,
-                               anjay_ssid_t ssid,
-                               anjay_dm_oi_attributes_t *out) {
+//// HIERARCHICAL REPRESENTATION ///////////////////////////////////////////////
+
+static int export_default_attrs(const anjay_attr_storage_t *as,
+                                size_t *index_ptr,
+                                const anjay_uri_path_t *path,
+                                AVS_LIST(as_default_attrs_t) *out_attrs) {
+    const as_key_t key = _anjay_attr_storage_key(path);
+    for (; *index_ptr < as->entry_count && as->entries[*index_ptr].key == key;
+         ++*index_ptr) {
+        if (!(*out_attrs = AVS_LIST_NEW_ELEMENT(as_default_attrs_t))) {
+            return -1;
+        }
+        (*out_attrs)->ssid = as->entries[*index_ptr].ssid;
+        (*out_attrs)->attrs = as->entries[*index_ptr].attrs.common;
+        AVS_LIST_ADVANCE_PTR(&out_attrs);
+    }
+    return 0;
+}
+
+static int export_resource_attrs(const anjay_attr_storage_t *as,
+                                 size_t *index_ptr,
+                                 const anjay_uri_path_t *path,
+                                 AVS_LIST(as_resource_attrs_t) *out_attrs) {
+    const as_key_t key = _anjay_attr_storage_key(path);
+    for (; *index_ptr < as->entry_count && as->entries[*index_ptr].key == key;
+         ++*index_ptr) {
+        if (!(*out_attrs = AVS_LIST_NEW_ELEMENT(as_resource_attrs_t))) {
+            return -1;
+        }
+        (*out_attrs)->ssid = as->entries[*index_ptr].ssid;
+        (*out_attrs)->attrs = as->entries[*index_ptr].attrs;
+        AVS_LIST_ADVANCE_PTR(&out_attrs);
+    }
+    return 0;
+}
+
+static int export_resource(const anjay_attr_storage_t *as,
+                           size_t *index_ptr,
+                           anjay_oid_t oid,
+                           anjay_iid_t iid,
+                           as_resource_entry_t *resource) {
+    const anjay_uri_path_t resource_path =
+            MAKE_RESOURCE_PATH(oid, iid, resource->rid);
+    const size_t end = _anjay_attr_storage_subtree_end(as, &resource_path);
+    if (export_resource_attrs(as, index_ptr, &resource_path,
+                              &resource->attrs)) {
+        return -1;
+    }
+#    ifdef ANJAY_WITH_LWM2M11
+    AVS_LIST(as_resource_instance_entry_t) *resource_instance_ptr =
+            &resource->resource_instances;
+    while (*index_ptr < end) {
+        if (!(*resource_instance_ptr =
+                      AVS_LIST_NEW_ELEMENT(as_resource_instance_entry_t))) {
+            return -1;
+        }
+        (*resource_instance_ptr)->riid =
+                _anjay_attr_storage_key_path(as->entries[*index_ptr].key)
+                        .ids[ANJAY_ID_RIID];
+        if (export_resource_attrs(
+                    as, index_ptr,
+                    &MAKE_RESOURCE_INSTANCE_PATH(
+                            oid, iid, resource->rid,
+                            (*resource_instance_ptr)->riid),
+                    &(*resource_instance_ptr)->attrs)) {
+            return -1;
+        }
+        AVS_LIST_ADVANCE_PTR(&resource_instance_ptr);
+    }
+#    endif // ANJAY_WITH_LWM2M11
+    assert(*index_ptr == end);
+    (void) end;
+    return 0;
+}
+
+static int export_instance(const anjay_attr_storage_t *as,
+                           size_t *index_ptr,
+                           anjay_oid_t oid,
+                           as_instance_entry_t *instance) {
+    const anjay_uri_path_t instance_path =
+            MAKE_INSTANCE_PATH(oid, instance->iid);
+    const size_t end = _anjay_attr_storage_subtree_end(as, &instance_path);
+    if (export_default_attrs(as, index_ptr, &instance_path,
+                             &instance->default_attrs)) {
+        return -1;
+    }
+    AVS_LIST(as_resource_entry_t) *resource_ptr = &instance->resources;
+    while (*index_ptr < end) {
+        if (!(*resource_ptr = AVS_LIST_NEW_ELEMENT(as_resource_entry_t))) {
+            return -1;
+        }
+        (*resource_ptr)->rid =
+                _anjay_attr_storage_key_path(as->entries[*index_ptr].key)
+                        .ids[ANJAY_ID_RID];
+        if (export_resource(as, index_ptr, oid, instance->iid,
+                            *resource_ptr)) {
+            return -1;
+        }
+        AVS_LIST_ADVANCE_PTR(&resource_ptr);
+    }
+    return 0;
+}
+
+static int export_object(const anjay_attr_storage_t *as,
+                         size_t *index_ptr,
+                         as_object_entry_t *object) {
+    const anjay_uri_path_t object_path = MAKE_OBJECT_PATH(object->oid);
+    const size_t end = _anjay_attr_storage_subtree_end(as, &object_path);
+    if (export_default_attrs(as, index_ptr, &object_path,
+                             &object->default_attrs)) {
+        return -1;
+    }
+    AVS_LIST(as_instance_entry_t) *instance_ptr = &object->instances;
+    while (*index_ptr < end) {
+        if (!(*instance_ptr = AVS_LIST_NEW_ELEMENT(as_instance_entry_t))) {
+            return -1;
+        }
+        (*instance_ptr)->iid =
+                _anjay_attr_storage_key_path(as->entries[*index_ptr].key)
+                        .ids[ANJAY_ID_IID];
+        if (export_instance(as, index_ptr, object->oid, *instance_ptr)) {
+            return -1;
+        }
+        AVS_LIST_ADVANCE_PTR(&instance_ptr);
+    }
+    return 0;
+}
+
+int _anjay_attr_storage_export(const anjay_attr_storage_t *as,
+                               AVS_LIST(as_object_entry_t) *out_objects) {
+    assert(out_objects && !*out_objects);
+    AVS_LIST(as_object_entry_t) *object_ptr = out_objects;
+    size_t index = 0;
+    while (index < as->entry_count) {
+        if (!(*object_ptr = AVS_LIST_NEW_ELEMENT(as_object_entry_t))) {
+            goto fail;
+        }
+        (*object_ptr)->oid =
+                _anjay_attr_storage_key_path(as->entries[index].key)
+                        .ids[ANJAY_ID_OID];
+        if (export_object(as, &index, *object_ptr)) {
+            goto fail;
+        }
+        AVS_LIST_ADVANCE_PTR(&object_ptr);
+    }
+    return 0;
+fail:
+    as_log(ERROR, _("out of memory"));
+    _anjay_attr_storage_free_objects(out_objects);
+    return -1;
+}
+
+static int import_default_attrs(anjay_attr_storage_t *as,
+                                const anjay_uri_path_t *path,
+                                AVS_LIST(as_default_attrs_t) attrs) {
     AVS_LIST_ITERATE(attrs) {
-        if (attrs->ssid == ssid) {
-            *out = attrs->attrs;
-            return;
-        } else if (attrs->ssid > ssid) {
-            break;
+        anjay_dm_r_attributes_t r_attrs = ANJAY_DM_R_ATTRIBUTES_EMPTY;
+        r_attrs.common = attrs->attrs;
+        if (!_anjay_dm_resource_attributes_empty(&r_attrs)
+                && put_entry(as, path, attrs->ssid, &r_attrs)) {
+            return -1;
         }
     }
-    *out = ANJAY_DM_OI_ATTRIBUTES_EMPTY;
+    return 0;
 }
 
-static void read_resource_attrs(AVS_LIST(as_resource_attrs_t) attrs,
-                                anjay_ssid_t ssid,
-                                anjay_dm_r_attributes_t *out) {
+static int import_resource_attrs(anjay_attr_storage_t *as,
+                                 const anjay_uri_path_t *path,
+                                 AVS_LIST(as_resource_attrs_t) attrs) {
     AVS_LIST_ITERATE(attrs) {
-        if (attrs->ssid == ssid) {
-            *out = attrs->attrs;
-            return;
-        } else if (attrs->ssid > ssid) {
-            break;
+        if (!_anjay_dm_resource_attributes_empty(&attrs->attrs)
+                && put_entry(as, path, attrs->ssid, &attrs->attrs)) {
+            return -1;
         }
     }
-    *out = ANJAY_DM_R_ATTRIBUTES_EMPTY;
+    return 0;
 }
 
-static int write_attrs_impl(anjay_attr_storage_t *as,
-                            AVS_LIST(void) *out_attrs,
-                            size_t element_size,
-                            size_t attrs_field_offset,
-                            size_t attrs_field_size,
-                            is_empty_func_t *is_empty_func,
-                            anjay_ssid_t ssid,
-                            const void *attrs) {
-    AVS_LIST_ITERATE_PTR(out_attrs) {
-        if (*get_ssid_ptr(*out_attrs) >= ssid) {
-            break;
+static int import_instance(anjay_attr_storage_t *as,
+                           anjay_oid_t oid,
+                           const as_instance_entry_t *instance) {
+    if (import_default_attrs(as, &MAKE_INSTANCE_PATH(oid, instance->iid),
+                             instance->default_attrs)) {
+        return -1;
+    }
+    AVS_LIST(as_resource_entry_t) resource;
+    AVS_LIST_FOREACH(resource, instance->resources) {
+        if (import_resource_attrs(
+                    as, &MAKE_RESOURCE_PATH(oid, instance->iid, resource->rid),
+                    resource->attrs)) {
+            return -1;
         }
+#    ifdef ANJAY_WITH_LWM2M11
+        AVS_LIST(as_resource_instance_entry_t) resource_instance;
+        AVS_LIST_FOREACH(resource_instance, resource->resource_instances) {
+            if (import_resource_attrs(as,
+                                      &MAKE_RESOURCE_INSTANCE_PATH(
+                                              oid, instance->iid, resource->rid,
+                                              resource_instance->riid),
+                                      resource_instance->attrs)) {
+                return -1;
+            }
+        }
+#    endif // ANJAY_WITH_LWM2M11
     }
-    bool found = (*out_attrs && *get_ssid_ptr(*out_attrs) == ssid);
-    bool filled = !is_empty_func(attrs);
-    if (filled) {
-        // writing non-empty set of attributes
-        if (!found) {
-            // entry does not exist, creating
-            AVS_LIST(void) new_attrs = AVS_LIST_NEW_BUFFER(element_size);
-            if (!new_attrs) {
-                as_log(ERROR, _("out of memory"));
-                return ANJAY_ERR_INTERNAL;
+    return 0;
+}
+
+int _anjay_attr_storage_import(anjay_attr_storage_t *as,
+                               AVS_LIST(as_object_entry_t) objects) {
+    AVS_LIST_ITERATE(objects) {
+        if (import_default_attrs(as, &MAKE_OBJECT_PATH(objects->oid),
+                                 objects->default_attrs)) {
+            return -1;
+        }
+        AVS_LIST(as_instance_entry_t) instance;
+        AVS_LIST_FOREACH(instance, objects->instances) {
+            if (import_instance(as, objects->oid, instance)) {
+                return -1;
             }
-            *get_ssid_ptr(new_attrs) = ssid;
-            AVS_LIST_INSERT(out_attrs, new_attrs);
         }
-        memcpy(get_attrs_ptr(*out_attrs, attrs_field_offset), attrs,
-               attrs_field_size);
-        _anjay_attr_storage_mark_modified(as);
-    } else if (found) {
-        // entry exists, but writing EMPTY set of attributes
-        // hence - removing
-        remove_attrs_entry(as, (AVS_LIST(void) *) out_attrs);
     }
     return 0;
 }
 
-#    define WRITE_ATTRS(As, OutAttrs, IsEmptyFunc, Ssid, Attrs)               \
-        write_attrs_impl((As), (AVS_LIST(void) *) (OutAttrs),                 \
-                         sizeof(**(OutAttrs)),                                \
-                         (size_t) ((char *) &(*(OutAttrs))->attrs             \
-                                   - (char *) *(OutAttrs)),                   \
-                         sizeof((*(OutAttrs))->attrs), (IsEmptyFunc), (Ssid), \
-                         (Attrs))
+void _anjay_attr_storage_free_objects(AVS_LIST(as_object_entry_t) *objects) {
+    AVS_LIST_CLEAR(objects) {
+        AVS_LIST_CLEAR(&(*objects)->default_attrs);
+        AVS_LIST_CLEAR(&(*objects)->instances) {
+            as_instance_entry_t *instance = (*objects)->instances;
+            AVS_LIST_CLEAR(&instance->default_attrs);
+            AVS_LIST_CLEAR(&instance->resources) {
+                AVS_LIST_CLEAR(&instance->resources->attrs);
+#    ifdef ANJAY_WITH_LWM2M11
+                AVS_LIST_CLEAR(&instance->resources->resource_instances) {
+                    AVS_LIST_CLEAR(
+                            &instance->resources->resource_instances->attrs);
+                }
+#    endif // ANJAY_WITH_LWM2M11
+            }
+        }
+    }
+}
+
+//// WRITING ATTRIBUTES ////////////////////////////////////////////////////////
 
 static int write_object_attrs(anjay_unlocked_t *anjay,
                               anjay_ssid_t ssid,
                               const anjay_dm_installed_object_t *obj_ptr,
                               const anjay_dm_oi_attributes_t *attrs) {
-    AVS_LIST(as_object_entry_t) *object_ptr =
-            find_or_create_object(&anjay->attr_storage,
-                                  _anjay_dm_installed_object_oid(obj_ptr));
-    if (!object_ptr) {
-        return -1;
-    }
-    int result =
-            WRITE_ATTRS(&anjay->attr_storage, &(*object_ptr)->default_attrs,
-                        default_attrs_empty, ssid, attrs);
-    remove_object_if_empty(object_ptr);
-    return result;
+    return write_default_attrs(
+            &anjay->attr_storage,
+            &MAKE_OBJECT_PATH(_anjay_dm_installed_object_oid(obj_ptr)), ssid,
+            attrs);
 }
 
 static int write_instance_attrs(anjay_unlocked_t *anjay,
@@ -506,24 +738,10 @@ static int write_instance_attrs(anjay_unlocked_t *anjay,
                                 anjay_iid_t iid,
                                 const anjay_dm_oi_attributes_t *attrs) {
     assert(iid != ANJAY_ID_INVALID);
-    int result = -1;
-    AVS_LIST(as_object_entry_t) *object_ptr = NULL;
-    AVS_LIST(as_instance_entry_t) *instance_ptr = NULL;
-    if ((object_ptr = find_or_create_object(
-                 &anjay->attr_storage, _anjay_dm_installed_object_oid(obj_ptr)))
-            && (instance_ptr = find_or_create_instance(*object_ptr, iid))) {
-        result = WRITE_ATTRS(&anjay->attr_storage,
-                             &(*instance_ptr)->default_attrs,
-                             default_attrs_empty, ssid, attrs);
-    }
-
-    if (instance_ptr) {
-        remove_instance_if_empty(instance_ptr);
-    }
-    if (object_ptr) {
-        remove_object_if_empty(object_ptr);
-    }
-    return result;
+    return write_default_attrs(
+            &anjay->attr_storage,
+            &MAKE_INSTANCE_PATH(_anjay_dm_installed_object_oid(obj_ptr), iid),
+            ssid, attrs);
 }
 
 static int write_resource_attrs(anjay_unlocked_t *anjay,
@@ -533,28 +751,11 @@ static int write_resource_attrs(anjay_unlocked_t *anjay,
                                 anjay_rid_t rid,
                                 const anjay_dm_r_attributes_t *attrs) {
     assert(iid != ANJAY_ID_INVALID && rid != ANJAY_ID_INVALID);
-    int result = -1;
-    AVS_LIST(as_object_entry_t) *object_ptr = NULL;
-    AVS_LIST(as_instance_entry_t) *instance_ptr = NULL;
-    AVS_LIST(as_resource_entry_t) *resource_ptr = NULL;
-    if ((object_ptr = find_or_create_object(
-                 &anjay->attr_storage, _anjay_dm_installed_object_oid(obj_ptr)))
-            && (instance_ptr = find_or_create_instance(*object_ptr, iid))
-            && (resource_ptr = find_or_create_resource(*instance_ptr, rid))) {
-        result = WRITE_ATTRS(&anjay->attr_storage, &(*resource_ptr)->attrs,
-                             resource_attrs_empty, ssid, attrs);
-    }
-
-    if (resource_ptr) {
-        remove_resource_if_empty(resource_ptr);
-    }
-    if (instance_ptr) {
-        remove_instance_if_empty(instance_ptr);
-    }
-    if (object_ptr) {
-        remove_object_if_empty(object_ptr);
-    }
-    return result;
+    return write_attrs(&anjay->attr_storage,
+                       &MAKE_RESOURCE_PATH(
+                               _anjay_dm_installed_object_oid(obj_ptr), iid,
+                               rid),
+                       ssid, attrs);
 }
 
 #    ifdef ANJAY_WITH_LWM2M11
@@ -568,42 +769,19 @@ write_resource_instance_attrs(anjay_unlocked_t *anjay,
                               const anjay_dm_r_attributes_t *attrs) {
     assert(iid != ANJAY_ID_INVALID && rid != ANJAY_ID_INVALID
            && riid != ANJAY_ID_INVALID);
-    int result = -1;
-    AVS_LIST(as_object_entry_t) *object_ptr = NULL;
-    AVS_LIST(as_instance_entry_t) *instance_ptr = NULL;
-    AVS_LIST(as_resource_entry_t) *resource_ptr = NULL;
-    AVS_LIST(as_resource_instance_entry_t) *resource_instance_ptr = NULL;
-    if ((object_ptr = find_or_create_object(
-                 &anjay->attr_storage, _anjay_dm_installed_object_oid(obj_ptr)))
-            && (instance_ptr = find_or_create_instance(*object_ptr, iid))
-            && (resource_ptr = find_or_create_resource(*instance_ptr, rid))
-            && (resource_instance_ptr = find_or_create_resource_instance(
-                        *resource_ptr, riid))) {
-        result = WRITE_ATTRS(&anjay->attr_storage,
-                             &(*resource_instance_ptr)->attrs,
-                             resource_attrs_empty, ssid, attrs);
-    }
-
-    if (resource_instance_ptr) {
-        remove_resource_instance_if_empty(resource_instance_ptr);
-    }
-    if (resource_ptr) {
-        remove_resource_if_empty(resource_ptr);
-    }
-    if (instance_ptr) {
-        remove_instance_if_empty(instance_ptr);
-    }
-    if (object_ptr) {
-        remove_object_if_empty(object_ptr);
-    }
-    return result;
+    return write_attrs(&anjay->attr_storage,
+                       &MAKE_RESOURCE_INSTANCE_PATH(
+                               _anjay_dm_installed_object_oid(obj_ptr), iid,
+                               rid, riid),
+                       ssid, attrs);
 }
 #    endif // ANJAY_WITH_LWM2M11
 
 //// NOTIFICATION HANDLING /////////////////////////////////////////////////////
 
 typedef struct {
-    AVS_LIST(as_instance_entry_t) *instance_ptr;
+    // NULL if there are no entries for the Object
+    as_remove_absent_instances_ctx_t *instances_ctx;
     AVS_LIST(anjay_ssid_t) *ssid_ptr;
 } remove_absent_instances_and_enumerate_ssids_args_t;
 
@@ -615,9 +793,9 @@ static int remove_absent_instances_and_enumerate_ssids_clb(
     remove_absent_instances_and_enumerate_ssids_args_t *args =
             (remove_absent_instances_and_enumerate_ssids_args_t *) args_;
     int result = 0;
-    if (args->instance_ptr) {
+    if (args->instances_ctx) {
         result = _anjay_attr_storage_remove_absent_instances_clb(
-                anjay, def_ptr, iid, &args->instance_ptr);
+                anjay, def_ptr, iid, args->instances_ctx);
         if (result) {
             return result;
         }
@@ -640,12 +818,16 @@ static int remove_absent_instances_and_enumerate_ssids_clb(
 
 static int remove_absent_instances_and_enumerate_ssids(
         anjay_unlocked_t *anjay,
+        anjay_oid_t oid,
         const anjay_dm_installed_object_t *def_ptr,
-        AVS_LIST(as_object_entry_t) *object_ptr,
+        bool has_object_entries,
         AVS_LIST(anjay_ssid_t) *out_ssids) {
     assert(out_ssids && !*out_ssids);
+    as_remove_absent_instances_ctx_t instances_ctx =
+            _anjay_attr_storage_remove_absent_instances_begin(
+                    &anjay->attr_storage, oid);
     remove_absent_instances_and_enumerate_ssids_args_t args = {
-        .instance_ptr = object_ptr ? &(*object_ptr)->instances : NULL,
+        .instances_ctx = has_object_entries ? &instances_ctx : NULL,
         .ssid_ptr = out_ssids
     };
     int result = _anjay_dm_foreach_instance(
@@ -654,8 +836,9 @@ static int remove_absent_instances_and_enumerate_ssids(
     if (result) {
         return result;
     }
-    while (args.instance_ptr && *args.instance_ptr) {
-        remove_instance_entry(&anjay->attr_storage, args.instance_ptr);
+    if (args.instances_ctx) {
+        _anjay_attr_storage_remove_absent_instances_end(&anjay->attr_storage,
+                                                        args.instances_ctx);
     }
     return 0;
 }
@@ -666,92 +849,213 @@ static int compare_u16ids(const void *a, const void *b, size_t element_size) {
     return *(const uint16_t *) a - *(const uint16_t *) b;
 }
 
-static int remove_absent_resources(anjay_unlocked_t *anjay,
-                                   AVS_LIST(as_object_entry_t) *as_object_ptr,
-                                   const anjay_dm_installed_object_t *obj_ptr,
-                                   anjay_iid_t iid) {
-    assert(as_object_ptr);
-    AVS_LIST(as_instance_entry_t) *instance_ptr =
-            find_instance(*as_object_ptr, iid);
-    if (!instance_ptr) {
+static int remove_absent_resources_in_all_instances(
+        anjay_unlocked_t *anjay,
+        const anjay_dm_installed_object_t *def_ptr,
+        AVS_LIST(anjay_notify_queue_resource_entry_t) resources_changed) {
+    int result = 0;
+    const anjay_oid_t oid = _anjay_dm_installed_object_oid(def_ptr);
+    anjay_iid_t last_iid = ANJAY_ID_INVALID;
+    AVS_LIST(anjay_notify_queue_resource_entry_t) resource_entry;
+    AVS_LIST_FOREACH(resource_entry, resources_changed) {
+        if (resource_entry->iid != last_iid
+                && has_subtree_entries(
+                           &anjay->attr_storage,
+                           &MAKE_INSTANCE_PATH(oid, resource_entry->iid))) {
+            _anjay_update_ret(&result,
+                              _anjay_attr_storage_remove_absent_resources(
+                                      anjay, def_ptr, resource_entry->iid));
+        }
+        last_iid = resource_entry->iid;
+    }
+    return result;
+}
+
+static bool iid_set_contains(AVS_LIST(anjay_iid_t) iid_set, anjay_iid_t iid) {
+    AVS_LIST_ITERATE(iid_set) {
+        if (*iid_set >= iid) {
+            return *iid_set == iid;
+        }
+    }
+    return false;
+}
+
+static void
+remove_removed_instances(anjay_attr_storage_t *as,
+                         const anjay_notify_queue_object_entry_t *entry) {
+    const anjay_notify_queue_instance_entry_t *changes =
+            &entry->instance_set_changes;
+    AVS_LIST(anjay_iid_t) iid;
+    AVS_LIST_FOREACH(iid, changes->known_removed_iids) {
+        // Instances removed and then recreated are present in both lists
+        if (!iid_set_contains(changes->known_added_iids, *iid)) {
+            _anjay_attr_storage_remove_subtree(
+                    as, &MAKE_INSTANCE_PATH(entry->oid, *iid));
+        }
+    }
+}
+
+static int gc_object(anjay_unlocked_t *anjay,
+                     const anjay_notify_queue_object_entry_t *entry) {
+    anjay_attr_storage_t *as = &anjay->attr_storage;
+    const anjay_uri_path_t object_path = MAKE_OBJECT_PATH(entry->oid);
+    const bool has_object_entries = has_subtree_entries(as, &object_path);
+    const bool full_rescan =
+            entry->instance_set_changes.instance_set_unknown_change;
+    if (!has_object_entries
+            && !(full_rescan && is_ssid_reference_object(entry->oid))) {
+        return 0;
+    }
+    const anjay_dm_installed_object_t *def_ptr =
+            _anjay_dm_find_object_by_oid(anjay, entry->oid);
+    if (!def_ptr) {
+        _anjay_attr_storage_remove_subtree(as, &object_path);
         return 0;
     }
     int result = 0;
-    if (obj_ptr) {
-        result =
-                _anjay_attr_storage_remove_absent_resources(anjay, instance_ptr,
-                                                            obj_ptr);
+    if (full_rescan) {
+        AVS_LIST(anjay_ssid_t) ssids = NULL;
+        result = remove_absent_instances_and_enumerate_ssids(
+                anjay, entry->oid, def_ptr, has_object_entries, &ssids);
+        if (!result && is_ssid_reference_object(entry->oid)) {
+            AVS_LIST_SORT(&ssids, compare_u16ids);
+            remove_servers_not_on_ssid_list(as, ssids);
+        }
+        AVS_LIST_CLEAR(&ssids);
+    } else {
+        remove_removed_instances(as, entry);
+    }
+    if (!result) {
+        result = remove_absent_resources_in_all_instances(
+                anjay, def_ptr, entry->resources_changed);
     }
     return result;
 }
 
-static int remove_absent_resources_in_all_instances(
-        anjay_unlocked_t *anjay,
-        const anjay_dm_installed_object_t *def_ptr,
-        AVS_LIST(anjay_notify_queue_resource_entry_t) resources_changed) {
-    int result = 0;
-    AVS_LIST(as_object_entry_t) *object_ptr =
-            find_object(&anjay->attr_storage,
-                        _anjay_dm_installed_object_oid(def_ptr));
-    if (object_ptr) {
-        anjay_iid_t last_iid = ANJAY_ID_INVALID;
-        AVS_LIST(anjay_notify_queue_resource_entry_t) resource_entry;
-        AVS_LIST_FOREACH(resource_entry, resources_changed) {
-            if (resource_entry->iid != last_iid) {
-                // note that remove_absent_resources() does NOT call
-                // remove_object_if_empty().
-                _anjay_update_ret(&result, remove_absent_resources(
-                                                   anjay, object_ptr, def_ptr,
-                                                   resource_entry->iid));
-            }
-            last_iid = resource_entry->iid;
+static int gc_step(anjay_unlocked_t *anjay) {
+    AVS_LIST(anjay_notify_queue_object_entry_t) entry =
+            AVS_LIST_DETACH(&anjay->attr_storage.gc_queue);
+    int result = gc_object(anjay, entry);
+    _anjay_notify_clear_queue(&entry);
+    return result;
+}
+
+static int schedule_gc(anjay_unlocked_t *anjay);
+
+static void gc_clb(avs_sched_t *sched, const void *dummy) {
+    (void) dummy;
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    // Only a single Object is processed at a time, so that other jobs do not
+    // need to wait for the whole queue to be processed
+    if (anjay->attr_storage.gc_queue) {
+        if (gc_step(anjay)) {
+            as_log(WARNING, _("could not remove stale attributes"));
+        }
+        if (schedule_gc(anjay)) {
+            as_log(ERROR, _("could not schedule removal of stale attributes"));
         }
-        remove_object_if_empty(object_ptr);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+static int schedule_gc(anjay_unlocked_t *anjay) {
+    if (!anjay->attr_storage.gc_queue || anjay->attr_storage.gc_job_handle) {
+        return 0;
+    }
+    return AVS_SCHED_NOW(anjay->sched, &anjay->attr_storage.gc_job_handle,
+                         gc_clb, NULL, 0);
+}
+
+int _anjay_attr_storage_gc_flush(anjay_unlocked_t *anjay) {
+    avs_sched_del(&anjay->attr_storage.gc_job_handle);
+    int result = 0;
+    while (anjay->attr_storage.gc_queue) {
+        _anjay_update_ret(&result, gc_step(anjay));
     }
     return result;
 }
 
+/**
+ * Checks whether the change might have affected the set of Short Server IDs
+ * present in the data model.
+ */
+static bool
+ssids_might_have_changed(const anjay_notify_queue_object_entry_t *entry) {
+    if (!is_ssid_reference_object(entry->oid)) {
+        return false;
+    }
+    if (entry->instance_set_changes.instance_set_changed) {
+        return true;
+    }
+    AVS_LIST(anjay_notify_queue_resource_entry_t) resource_entry;
+    AVS_LIST_FOREACH(resource_entry, entry->resources_changed) {
+        if (resource_entry->rid == ssid_rid(entry->oid)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int enqueue_gc(anjay_notify_queue_t *gc_queue,
+                      const anjay_notify_queue_object_entry_t *entry) {
+    const anjay_notify_queue_instance_entry_t *changes =
+            &entry->instance_set_changes;
+    int result = 0;
+    if (changes->instance_set_unknown_change
+            || ssids_might_have_changed(entry)) {
+        if ((result = _anjay_notify_queue_instance_set_unknown_change(
+                     gc_queue, entry->oid))) {
+            return result;
+        }
+    }
+    // Removals are replayed before additions, so that an Instance that has
+    // been removed and then recreated ends up in both lists, as it would if
+    // the changes were queued in the original order
+    AVS_LIST(anjay_iid_t) iid;
+    AVS_LIST_FOREACH(iid, changes->known_removed_iids) {
+        if ((result = _anjay_notify_queue_instance_removed(gc_queue, entry->oid,
+                                                           *iid))) {
+            return result;
+        }
+    }
+    AVS_LIST_FOREACH(iid, changes->known_added_iids) {
+        if ((result = _anjay_notify_queue_instance_created(gc_queue, entry->oid,
+                                                           *iid))) {
+            return result;
+        }
+    }
+    AVS_LIST(anjay_notify_queue_resource_entry_t) resource_entry;
+    AVS_LIST_FOREACH(resource_entry, entry->resources_changed) {
+        if ((result = _anjay_notify_queue_resource_change(
+                     gc_queue, entry->oid, resource_entry->iid,
+                     resource_entry->rid))) {
+            return result;
+        }
+    }
+    return 0;
+}
+
 int _anjay_attr_storage_notify(anjay_unlocked_t *anjay,
                                anjay_notify_queue_t queue) {
-    int result = 0;
+    anjay_attr_storage_t *as = &anjay->attr_storage;
+    if (!as->entry_count) {
+        // no entries that could become stale
+        return 0;
+    }
     AVS_LIST(anjay_notify_queue_object_entry_t) object_entry;
     AVS_LIST_FOREACH(object_entry, queue) {
-        AVS_LIST(as_object_entry_t) *object_ptr =
-                find_object(&anjay->attr_storage, object_entry->oid);
-        assert(!object_ptr || *object_ptr);
-        if (!object_ptr && !is_ssid_reference_object(object_entry->oid)) {
-            continue;
-        }
-        const anjay_dm_installed_object_t *def_ptr =
-                _anjay_dm_find_object_by_oid(anjay, object_entry->oid);
-        if (!def_ptr && object_ptr) {
-            remove_object_entry(&anjay->attr_storage, object_ptr);
+        if (!ssids_might_have_changed(object_entry)
+                && !has_subtree_entries(as,
+                                        &MAKE_OBJECT_PATH(object_entry->oid))) {
             continue;
         }
-        AVS_LIST(anjay_ssid_t) ssids = NULL;
-        int partial_result =
-                remove_absent_instances_and_enumerate_ssids(anjay, def_ptr,
-                                                            object_ptr, &ssids);
-        if (object_ptr) {
-            remove_object_if_empty(object_ptr);
-        }
-        if (!partial_result && is_ssid_reference_object(object_entry->oid)) {
-            AVS_LIST_SORT(&ssids, compare_u16ids);
-            remove_servers_not_on_ssid_list(&anjay->attr_storage, ssids);
-        }
-        AVS_LIST_CLEAR(&ssids);
-        if (!partial_result) {
-            // NOTE: This looks up object_ptr the second time, which is
-            // necessary because the above code might have removed
-            // as_object_entry_t entries, thus potentially invalidating
-            // object_ptr
-            assert(def_ptr);
-            partial_result = remove_absent_resources_in_all_instances(
-                    anjay, def_ptr, object_entry->resources_changed);
+        int result = enqueue_gc(&as->gc_queue, object_entry);
+        if (result) {
+            return result;
         }
-        _anjay_update_ret(&result, partial_result);
     }
-    return result;
+    return schedule_gc(anjay);
 }
 
 //// ATTRIBUTE HANDLERS ////////////////////////////////////////////////////////
@@ -760,11 +1064,10 @@ static int object_read_default_attrs(anjay_unlocked_t *anjay,
                                      const anjay_dm_installed_object_t obj_ptr,
                                      anjay_ssid_t ssid,
                                      anjay_dm_oi_attributes_t *out) {
-    AVS_LIST(as_object_entry_t) *object_ptr =
-            find_object(&anjay->attr_storage,
-                        _anjay_dm_installed_object_oid(&obj_ptr));
-    read_default_attrs(object_ptr ? (*object_ptr)->default_attrs : NULL, ssid,
-                       out);
+    read_default_attrs(
+            &anjay->attr_storage,
+            &MAKE_OBJECT_PATH(_anjay_dm_installed_object_oid(&obj_ptr)), ssid,
+            out);
     return 0;
 }
 
@@ -782,12 +1085,9 @@ instance_read_default_attrs(anjay_unlocked_t *anjay,
                             anjay_iid_t iid,
                             anjay_ssid_t ssid,
                             anjay_dm_oi_attributes_t *out) {
-    AVS_LIST(as_object_entry_t) *object_ptr =
-            find_object(&anjay->attr_storage,
-                        _anjay_dm_installed_object_oid(&obj_ptr));
-    AVS_LIST(as_instance_entry_t) *instance_ptr =
-            object_ptr ? find_instance(*object_ptr, iid) : NULL;
-    read_default_attrs(instance_ptr ? (*instance_ptr)->default_attrs : NULL,
+    read_default_attrs(&anjay->attr_storage,
+                       &MAKE_INSTANCE_PATH(
+                               _anjay_dm_installed_object_oid(&obj_ptr), iid),
                        ssid, out);
     return 0;
 }
@@ -809,14 +1109,10 @@ static int resource_read_attrs(anjay_unlocked_t *anjay,
                                anjay_rid_t rid,
                                anjay_ssid_t ssid,
                                anjay_dm_r_attributes_t *out) {
-    AVS_LIST(as_object_entry_t) *object_ptr =
-            find_object(&anjay->attr_storage,
-                        _anjay_dm_installed_object_oid(&obj_ptr));
-    AVS_LIST(as_instance_entry_t) *instance_ptr =
-            object_ptr ? find_instance(*object_ptr, iid) : NULL;
-    AVS_LIST(as_resource_entry_t) *res_ptr =
-            instance_ptr ? find_resource(*instance_ptr, rid) : NULL;
-    read_resource_attrs(res_ptr ? (*res_ptr)->attrs : NULL, ssid, out);
+    read_attrs(&anjay->attr_storage,
+               &MAKE_RESOURCE_PATH(_anjay_dm_installed_object_oid(&obj_ptr),
+                                   iid, rid),
+               ssid, out);
     return 0;
 }
 
@@ -840,17 +1136,11 @@ resource_instance_read_attrs(anjay_unlocked_t *anjay,
                              anjay_riid_t riid,
                              anjay_ssid_t ssid,
                              anjay_dm_r_attributes_t *out) {
-    AVS_LIST(as_object_entry_t) *object_ptr =
-            find_object(&anjay->attr_storage,
-                        _anjay_dm_installed_object_oid(&obj_ptr));
-    AVS_LIST(as_instance_entry_t) *instance_ptr =
-            object_ptr ? find_instance(*object_ptr, iid) : NULL;
-    AVS_LIST(as_resource_entry_t) *res_ptr =
-            instance_ptr ? find_resource(*instance_ptr, rid) : NULL;
-    AVS_LIST(as_resource_instance_entry_t) *res_instance_ptr =
-            res_ptr ? find_resource_instance(*res_ptr, riid) : NULL;
-    read_resource_attrs(res_instance_ptr ? (*res_instance_ptr)->attrs : NULL,
-                        ssid, out);
+    read_attrs(&anjay->attr_storage,
+               &MAKE_RESOURCE_INSTANCE_PATH(
+                       _anjay_dm_installed_object_oid(&obj_ptr), iid, rid,
+                       riid),
+               ssid, out);
     return 0;
 }
 
@@ -13,11 +13,14 @@
 #include <anjay/attr_storage.h>
 #include <anjay/core.h>
 
+#include <avsystem/commons/avs_sched.h>
+
+#include <anjay_modules/anjay_notify.h>
 #include <anjay_modules/anjay_utils_core.h>
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
-typedef struct as_object_entry as_object_entry_t;
+typedef struct as_entry as_entry_t;
 
 typedef struct {
     avs_stream_t *persist_data;
@@ -25,9 +28,16 @@ typedef struct {
 } as_saved_state_t;
 
 typedef struct {
-    AVS_LIST(as_object_entry_t) objects;
+    // Flat array of stored attributes, sorted by path and SSID
+    as_entry_t *entries;
+    size_t entry_count;
+    size_t entry_capacity;
     bool modified_since_persist;
     as_saved_state_t saved_state;
+    // Data model changes that might have made some of the entries stale, to
+    // be processed by a deferred job scheduled with gc_job_handle
+    anjay_notify_queue_t gc_queue;
+    avs_sched_handle_t gc_job_handle;
 } anjay_attr_storage_t;
 
 static inline bool _anjay_dm_implements_any_object_default_attrs_handlers(
@@ -281,16 +281,15 @@ static bool is_object_sane(as_object_entry_t *object) {
            && is_instances_list_sane(object->instances);
 }
 
-static bool is_attr_storage_sane(anjay_attr_storage_t *as) {
+static bool is_attr_storage_sane(AVS_LIST(as_object_entry_t) objects) {
     int32_t last_oid = -1;
-    AVS_LIST(as_object_entry_t) *object_ptr;
-    AVS_LIST(as_object_entry_t) object_helper;
-    AVS_LIST_DELETABLE_FOREACH_PTR(object_ptr, object_helper, &as->objects) {
-        if ((*object_ptr)->oid <= last_oid) {
+    AVS_LIST(as_object_entry_t) object;
+    AVS_LIST_FOREACH(object, objects) {
+        if (object->oid <= last_oid) {
             return false;
         }
-        last_oid = (*object_ptr)->oid;
-        if (!is_object_sane(*object_ptr)) {
+        last_oid = object->oid;
+        if (!is_object_sane(object)) {
             return false;
         }
     }
@@ -299,68 +298,80 @@ static bool is_attr_storage_sane(anjay_attr_storage_t *as) {
 
 #    ifdef ANJAY_WITH_LWM2M11
 static int clear_nonexistent_riids(anjay_unlocked_t *anjay,
-                                   AVS_LIST(as_instance_entry_t) *instance_ptr,
-                                   const anjay_dm_installed_object_t *def_ptr) {
-    if (!*instance_ptr) {
-        return 0;
-    }
-
-    AVS_LIST(as_resource_entry_t) *resource_ptr;
-    AVS_LIST(as_resource_entry_t) resource_helper;
-    AVS_LIST_DELETABLE_FOREACH_PTR(resource_ptr, resource_helper,
-                                   &(*instance_ptr)->resources) {
-        if (_anjay_attr_storage_remove_absent_resource_instances(
-                    anjay, def_ptr, (*instance_ptr)->iid, resource_ptr)) {
+                                   const anjay_dm_installed_object_t *def_ptr,
+                                   anjay_iid_t iid) {
+    anjay_attr_storage_t *as = &anjay->attr_storage;
+    const anjay_oid_t oid = _anjay_dm_installed_object_oid(def_ptr);
+    const anjay_uri_path_t instance_path = MAKE_INSTANCE_PATH(oid, iid);
+    size_t index = _anjay_attr_storage_children_begin(as, &instance_path);
+    while (index < _anjay_attr_storage_subtree_end(as, &instance_path)) {
+        const anjay_rid_t rid =
+                _anjay_attr_storage_key_path(as->entries[index].key)
+                        .ids[ANJAY_ID_RID];
+        if (_anjay_attr_storage_remove_absent_resource_instances(anjay, def_ptr,
+                                                                 iid, rid)) {
             return -1;
         }
+        index = _anjay_attr_storage_subtree_end(
+                as, &MAKE_RESOURCE_PATH(oid, iid, rid));
     }
     return 0;
 }
 #    endif // ANJAY_WITH_LWM2M11
 
 static int clear_nonexistent_rids(anjay_unlocked_t *anjay,
-                                  AVS_LIST(as_object_entry_t) *object_ptr,
                                   const anjay_dm_installed_object_t *def_ptr) {
-    AVS_LIST(as_instance_entry_t) *instance_ptr;
-    AVS_LIST(as_instance_entry_t) instance_helper;
-    AVS_LIST_DELETABLE_FOREACH_PTR(instance_ptr, instance_helper,
-                                   &(*object_ptr)->instances) {
+    anjay_attr_storage_t *as = &anjay->attr_storage;
+    const anjay_oid_t oid = _anjay_dm_installed_object_oid(def_ptr);
+    const anjay_uri_path_t object_path = MAKE_OBJECT_PATH(oid);
+    size_t index = _anjay_attr_storage_children_begin(as, &object_path);
+    while (index < _anjay_attr_storage_subtree_end(as, &object_path)) {
+        const anjay_iid_t iid =
+                _anjay_attr_storage_key_path(as->entries[index].key)
+                        .ids[ANJAY_ID_IID];
         if (
 #    ifdef ANJAY_WITH_LWM2M11
-                    clear_nonexistent_riids(anjay, instance_ptr, def_ptr) ||
+                clear_nonexistent_riids(anjay, def_ptr, iid) ||
 #    endif // ANJAY_WITH_LWM2M11
-                        _anjay_attr_storage_remove_absent_resources(
-                                anjay, instance_ptr, def_ptr)) {
+                _anjay_attr_storage_remove_absent_resources(anjay, def_ptr,
+                                                            iid)) {
             return -1;
         }
+        index = _anjay_attr_storage_subtree_end(
+                as, &MAKE_INSTANCE_PATH(oid, iid));
     }
     return 0;
 }
 
 static avs_error_t clear_nonexistent_entries(anjay_unlocked_t *anjay,
                                              anjay_attr_storage_t *as) {
-    AVS_LIST(as_object_entry_t) *object_ptr;
-    AVS_LIST(as_object_entry_t) object_helper;
-    AVS_LIST_DELETABLE_FOREACH_PTR(object_ptr, object_helper, &as->objects) {
+    size_t index = 0;
+    while (index < as->entry_count) {
+        const anjay_uri_path_t object_path = MAKE_OBJECT_PATH(
+                _anjay_attr_storage_key_path(as->entries[index].key)
+                        .ids[ANJAY_ID_OID]);
         const anjay_dm_installed_object_t *def_ptr =
-                _anjay_dm_find_object_by_oid(anjay, (*object_ptr)->oid);
+                _anjay_dm_find_object_by_oid(anjay,
+                                             object_path.ids[ANJAY_ID_OID]);
         if (!def_ptr) {
-            remove_object_entry(as, object_ptr);
+            _anjay_attr_storage_remove_subtree(as, &object_path);
         } else {
-            AVS_LIST(as_instance_entry_t) *instance_ptr =
-                    &(*object_ptr)->instances;
+            as_remove_absent_instances_ctx_t instances_ctx =
+                    _anjay_attr_storage_remove_absent_instances_begin(
+                            as, object_path.ids[ANJAY_ID_OID]);
             int retval = _anjay_dm_foreach_instance(
                     anjay, def_ptr,
                     _anjay_attr_storage_remove_absent_instances_clb,
-                    &instance_ptr);
-            while (!retval && instance_ptr && *instance_ptr) {
-                remove_instance_entry(as, instance_ptr);
+                    &instances_ctx);
+            if (!retval) {
+                _anjay_attr_storage_remove_absent_instances_end(
+                        as, &instances_ctx);
             }
-            if (retval || clear_nonexistent_rids(anjay, object_ptr, def_ptr)) {
+            if (retval || clear_nonexistent_rids(anjay, def_ptr)) {
                 return avs_errno(AVS_EPROTO);
             }
-            remove_object_if_empty(object_ptr);
         }
+        index = _anjay_attr_storage_subtree_end(as, &object_path);
     }
     return AVS_OK;
 }
@@ -370,6 +381,10 @@ static avs_error_t clear_nonexistent_entries(anjay_unlocked_t *anjay,
 avs_error_t
 _anjay_attr_storage_persist_inner(anjay_attr_storage_t *attr_storage,
                                   avs_stream_t *out) {
+    AVS_LIST(as_object_entry_t) objects = NULL;
+    if (_anjay_attr_storage_export(attr_storage, &objects)) {
+        return avs_errno(AVS_ENOMEM);
+    }
     avs_persistence_context_t ctx = avs_persistence_store_context_create(out);
     as_persistence_version_t version = AS_PERSISTENCE_VERSION_CURRENT;
     avs_error_t err;
@@ -378,9 +393,9 @@ _anjay_attr_storage_persist_inner(anjay_attr_storage_t *attr_storage,
                                    &ctx, (uint8_t *) &version,
                                    SUPPORTED_VERSIONS_ARRAY,
                                    sizeof(SUPPORTED_VERSIONS_ARRAY))))
-            || avs_is_err(
-                       (err = HANDLE_LIST(object, &ctx, &attr_storage->objects,
-                                          (void *) version))));
+            || avs_is_err((err = HANDLE_LIST(object, &ctx, &objects,
+                                             (void *) version))));
+    _anjay_attr_storage_free_objects(&objects);
     return err;
 }
 
@@ -390,6 +405,7 @@ avs_error_t _anjay_attr_storage_restore_inner(anjay_unlocked_t *anjay,
 
     avs_persistence_context_t ctx = avs_persistence_restore_context_create(in);
     as_persistence_version_t version = (as_persistence_version_t) 0;
+    AVS_LIST(as_object_entry_t) objects = NULL;
     avs_error_t err;
 
     if (avs_is_err((err = avs_persistence_magic_string(&ctx, MAGIC)))
@@ -397,16 +413,20 @@ avs_error_t _anjay_attr_storage_restore_inner(anjay_unlocked_t *anjay,
                                    &ctx, (uint8_t *) &version,
                                    SUPPORTED_VERSIONS_ARRAY,
                                    sizeof(SUPPORTED_VERSIONS_ARRAY))))
-            || avs_is_err((err = HANDLE_LIST(object, &ctx,
-                                             &anjay->attr_storage.objects,
+            || avs_is_err((err = HANDLE_LIST(object, &ctx, &objects,
                                              (void *) version)))
-            || avs_is_err((err = (is_attr_storage_sane(&anjay->attr_storage)
+            || avs_is_err((err = (is_attr_storage_sane(objects)
                                           ? AVS_OK
                                           : avs_errno(AVS_EBADMSG))))
+            || avs_is_err((err = (_anjay_attr_storage_import(
+                                          &anjay->attr_storage, objects)
+                                          ? avs_errno(AVS_ENOMEM)
+                                          : AVS_OK)))
             || avs_is_err((err = clear_nonexistent_entries(
                                    anjay, &anjay->attr_storage)))) {
         _anjay_attr_storage_clear(&anjay->attr_storage);
     }
+    _anjay_attr_storage_free_objects(&objects);
     return err;
 }
 
@@ -414,6 +434,10 @@ avs_error_t anjay_attr_storage_persist(anjay_t *anjay_locked,
                                        avs_stream_t *out) {
     avs_error_t err = avs_errno(AVS_EINVAL);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    // make sure that no stale entries are persisted
+    if (_anjay_attr_storage_gc_flush(anjay)) {
+        as_log(WARNING, _("could not remove stale attributes"));
+    }
     if (avs_is_ok((err = _anjay_attr_storage_persist_inner(&anjay->attr_storage,
                                                            out)))) {
         anjay->attr_storage.modified_since_persist = false;
@@ -440,6 +464,7 @@ avs_error_t anjay_attr_storage_restore(anjay_t *anjay_locked,
                 err = rollback_err;
             }
         }
+        _anjay_observe_attrs_cache_invalidate(&anjay->observe);
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return err;
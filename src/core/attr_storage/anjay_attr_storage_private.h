@@ -20,6 +20,30 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 
 #define as_log(...) _anjay_log(anjay_attr_storage, __VA_ARGS__)
 
+/**
+ * Data model path packed into a single integer, 16 bits per ID, with the
+ * Object ID in the most significant bits. Each ID is stored incremented by one,
+ * so that missing IDs (ANJAY_ID_INVALID) are represented as zero. Thanks to
+ * that, keys sort in the same order as a depth-first traversal of the data
+ * model, and all descendants of any path form a contiguous range of keys
+ * directly following the key of that path.
+ */
+typedef uint64_t as_key_t;
+
+struct as_entry {
+    as_key_t key;
+    anjay_ssid_t ssid;
+    // For Object and Object Instance paths, only the common part is used and
+    // the rest is always empty
+    anjay_dm_r_attributes_t attrs;
+};
+
+/*
+ * The following types are the hierarchical representation of the storage,
+ * used as the persistence format. It is converted from and to the flat array
+ * with _anjay_attr_storage_export() and _anjay_attr_storage_import().
+ */
+
 typedef struct {
     anjay_ssid_t ssid;
     anjay_dm_oi_attributes_t attrs;
@@ -49,95 +73,135 @@ typedef struct {
     AVS_LIST(as_resource_entry_t) resources;
 } as_instance_entry_t;
 
-struct as_object_entry {
+typedef struct {
     anjay_oid_t oid;
     AVS_LIST(as_default_attrs_t) default_attrs;
     AVS_LIST(as_instance_entry_t) instances;
-};
+} as_object_entry_t;
 
 void _anjay_attr_storage_clear(anjay_attr_storage_t *as);
 
+as_key_t _anjay_attr_storage_key(const anjay_uri_path_t *path);
+
+anjay_uri_path_t _anjay_attr_storage_key_path(as_key_t key);
+
 /**
- * @param instance_ptr_ptr_
- * Conceptually of type AVS_LIST(as_instance_entry_t) **. Pointer to a variable
- * that is used to iterate over a list of instances. Before the first call in
- * iretarion, it shall point always points to the list's head.
+ * Returns index of the first entry that is not less than (key, ssid).
+ */
+size_t _anjay_attr_storage_lower_bound(const anjay_attr_storage_t *as,
+                                       as_key_t key,
+                                       anjay_ssid_t ssid);
+
+/**
+ * Returns index of the first entry that is neither for @p path itself, nor for
+ * any of its descendants, and follows them.
+ */
+size_t _anjay_attr_storage_subtree_end(const anjay_attr_storage_t *as,
+                                       const anjay_uri_path_t *path);
+
+/**
+ * Removes entries with indices in range [begin, end).
+ */
+void _anjay_attr_storage_remove_range(anjay_attr_storage_t *as,
+                                      size_t begin,
+                                      size_t end);
+
+static inline size_t
+_anjay_attr_storage_subtree_begin(const anjay_attr_storage_t *as,
+                                  const anjay_uri_path_t *path) {
+    return _anjay_attr_storage_lower_bound(as, _anjay_attr_storage_key(path),
+                                           0);
+}
+
+/**
+ * Returns index of the first entry for any descendant of @p path.
+ */
+static inline size_t
+_anjay_attr_storage_children_begin(const anjay_attr_storage_t *as,
+                                   const anjay_uri_path_t *path) {
+    return _anjay_attr_storage_lower_bound(
+            as, _anjay_attr_storage_key(path) + 1, 0);
+}
+
+static inline void _anjay_attr_storage_remove_subtree(
+        anjay_attr_storage_t *as, const anjay_uri_path_t *path) {
+    _anjay_attr_storage_remove_range(
+            as, _anjay_attr_storage_subtree_begin(as, path),
+            _anjay_attr_storage_subtree_end(as, path));
+}
+
+/**
+ * State of removing entries for Object Instances that are not present in the
+ * data model, performed by passing
+ * _anjay_attr_storage_remove_absent_instances_clb() to
+ * _anjay_dm_foreach_instance().
+ */
+typedef struct {
+    anjay_oid_t oid;
+    // Index of the first entry of the Object that has not been verified yet
+    size_t cursor;
+} as_remove_absent_instances_ctx_t;
+
+as_remove_absent_instances_ctx_t
+_anjay_attr_storage_remove_absent_instances_begin(anjay_attr_storage_t *as,
+                                                  anjay_oid_t oid);
+
+/**
+ * @param ctx_
+ * Conceptually of type as_remove_absent_instances_ctx_t *, initialized using
+ * _anjay_attr_storage_remove_absent_instances_begin().
  */
 int _anjay_attr_storage_remove_absent_instances_clb(
         anjay_unlocked_t *anjay,
         const anjay_dm_installed_object_t *def_ptr,
         anjay_iid_t iid,
-        void *instance_ptr_ptr_);
+        void *ctx_);
 
-typedef struct {
-    anjay_rid_t rid;
-    anjay_dm_resource_kind_t kind;
-    anjay_dm_resource_presence_t presence;
-} resource_entry_t;
+/**
+ * Removes entries for all Object Instances that have not been verified yet.
+ * Shall be called after successful iteration.
+ */
+void _anjay_attr_storage_remove_absent_instances_end(
+        anjay_attr_storage_t *as, as_remove_absent_instances_ctx_t *ctx);
 
 int _anjay_attr_storage_remove_absent_resources(
         anjay_unlocked_t *anjay,
-        AVS_LIST(as_instance_entry_t) *instance_ptr,
-        const anjay_dm_installed_object_t *def_ptr);
+        const anjay_dm_installed_object_t *def_ptr,
+        anjay_iid_t iid);
 
 #ifdef ANJAY_WITH_LWM2M11
 int _anjay_attr_storage_remove_absent_resource_instances(
         anjay_unlocked_t *anjay,
         const anjay_dm_installed_object_t *def_ptr,
         anjay_iid_t iid,
-        AVS_LIST(as_resource_entry_t) *resource_ptr);
+        anjay_rid_t rid);
 #endif // ANJAY_WITH_LWM2M11
 
-static inline void _anjay_attr_storage_mark_modified(anjay_attr_storage_t *as) {
-    as->modified_since_persist = true;
-}
-
-#ifdef ANJAY_WITH_LWM2M11
-static void remove_resource_instance_entry(
-        anjay_attr_storage_t *as,
-        AVS_LIST(as_resource_instance_entry_t) *entry_ptr) {
-    AVS_LIST_CLEAR(&(*entry_ptr)->attrs);
-    AVS_LIST_DELETE(entry_ptr);
-    _anjay_attr_storage_mark_modified(as);
-}
-#endif // ANJAY_WITH_LWM2M11
+/**
+ * Converts the storage to the hierarchical representation. On success, the
+ * caller is responsible for freeing @p out_objects using
+ * _anjay_attr_storage_free_objects().
+ */
+int _anjay_attr_storage_export(const anjay_attr_storage_t *as,
+                               AVS_LIST(as_object_entry_t) *out_objects);
 
-static void remove_resource_entry(anjay_attr_storage_t *as,
-                                  AVS_LIST(as_resource_entry_t) *entry_ptr) {
-    AVS_LIST_CLEAR(&(*entry_ptr)->attrs);
-#ifdef ANJAY_WITH_LWM2M11
-    while ((*entry_ptr)->resource_instances) {
-        remove_resource_instance_entry(as, &(*entry_ptr)->resource_instances);
-    }
-#endif // ANJAY_WITH_LWM2M11
-    AVS_LIST_DELETE(entry_ptr);
-    _anjay_attr_storage_mark_modified(as);
-}
+/**
+ * Inserts all attributes from the hierarchical representation into the
+ * storage. Empty entries are skipped.
+ */
+int _anjay_attr_storage_import(anjay_attr_storage_t *as,
+                               AVS_LIST(as_object_entry_t) objects);
 
-static void remove_instance_entry(anjay_attr_storage_t *as,
-                                  AVS_LIST(as_instance_entry_t) *entry_ptr) {
-    AVS_LIST_CLEAR(&(*entry_ptr)->default_attrs);
-    while ((*entry_ptr)->resources) {
-        remove_resource_entry(as, &(*entry_ptr)->resources);
-    }
-    AVS_LIST_DELETE(entry_ptr);
-    _anjay_attr_storage_mark_modified(as);
-}
+void _anjay_attr_storage_free_objects(AVS_LIST(as_object_entry_t) *objects);
 
-static void remove_object_entry(anjay_attr_storage_t *as,
-                                AVS_LIST(as_object_entry_t) *entry_ptr) {
-    AVS_LIST_CLEAR(&(*entry_ptr)->default_attrs);
-    while ((*entry_ptr)->instances) {
-        remove_instance_entry(as, &(*entry_ptr)->instances);
-    }
-    AVS_LIST_DELETE(entry_ptr);
-    _anjay_attr_storage_mark_modified(as);
-}
+/**
+ * Synchronously processes all data model changes queued for removal of stale
+ * entries, that would otherwise be handled by the deferred job.
+ */
+int _anjay_attr_storage_gc_flush(anjay_unlocked_t *anjay);
 
-static void remove_object_if_empty(AVS_LIST(as_object_entry_t) *entry_ptr) {
-    if (!(*entry_ptr)->default_attrs && !(*entry_ptr)->instances) {
-        AVS_LIST_DELETE(entry_ptr);
-    }
+static inline void _anjay_attr_storage_mark_modified(anjay_attr_storage_t *as) {
+    as->modified_since_persist = true;
 }
 
 static inline anjay_ssid_t *get_ssid_ptr(void *generic_attrs) {
@@ -155,11 +219,11 @@ static inline void *get_attrs_ptr(void *generic_attrs,
 
 typedef bool is_empty_func_t(const void *attrs);
 
-static bool default_attrs_empty(const void *attrs) {
+static inline bool default_attrs_empty(const void *attrs) {
     return _anjay_dm_attributes_empty((const anjay_dm_oi_attributes_t *) attrs);
 }
 
-static bool resource_attrs_empty(const void *attrs) {
+static inline bool resource_attrs_empty(const void *attrs) {
     return _anjay_dm_resource_attributes_empty(
             (const anjay_dm_r_attributes_t *) attrs);
 }
@@ -726,6 +726,8 @@ int _anjay_dm_call_instance_reset(anjay_unlocked_t *anjay,
     if (result) {
         return result;
     }
+    _anjay_dm_resource_cache_invalidate(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr), iid);
     CHECKED_TAIL_CALL_HANDLER(obj_ptr, instance_reset, anjay, *obj_ptr, iid);
 }
 
@@ -738,6 +740,8 @@ int _anjay_dm_call_instance_create(anjay_unlocked_t *anjay,
     if (result) {
         return result;
     }
+    _anjay_dm_instance_cache_invalidate(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr));
     CHECKED_TAIL_CALL_HANDLER(obj_ptr, instance_create, anjay, *obj_ptr, iid);
 }
 
@@ -750,6 +754,8 @@ int _anjay_dm_call_instance_remove(anjay_unlocked_t *anjay,
     if (result) {
         return result;
     }
+    _anjay_dm_instance_cache_invalidate(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr));
     CHECKED_TAIL_CALL_HANDLER(obj_ptr, instance_remove, anjay, *obj_ptr, iid);
 }
 
@@ -813,6 +819,8 @@ int _anjay_dm_call_resource_write(anjay_unlocked_t *anjay,
     if (result) {
         return result;
     }
+    _anjay_dm_resource_cache_invalidate(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr), iid);
     CHECKED_TAIL_CALL_HANDLER(obj_ptr, resource_write, anjay, *obj_ptr, iid,
                               rid, riid, ctx);
 }
@@ -824,6 +832,8 @@ int _anjay_dm_call_resource_execute(anjay_unlocked_t *anjay,
                                     anjay_unlocked_execute_ctx_t *execute_ctx) {
     dm_log(TRACE, _("resource_execute ") "/%u/%u/%u",
            _anjay_dm_installed_object_oid(obj_ptr), iid, rid);
+    _anjay_dm_resource_cache_invalidate(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr), iid);
     CHECKED_TAIL_CALL_HANDLER(obj_ptr, resource_execute, anjay, *obj_ptr, iid,
                               rid, execute_ctx);
 }
@@ -838,6 +848,8 @@ int _anjay_dm_call_resource_reset(anjay_unlocked_t *anjay,
     if (result) {
         return result;
     }
+    _anjay_dm_resource_cache_invalidate(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr), iid);
     CHECKED_TAIL_CALL_HANDLER(obj_ptr, resource_reset, anjay, *obj_ptr, iid,
                               rid);
 }
@@ -943,6 +955,9 @@ int _anjay_dm_call_transaction_rollback(
         anjay_unlocked_t *anjay, const anjay_dm_installed_object_t *obj_ptr) {
     dm_log(TRACE, _("rollback_object ") "/%u",
            _anjay_dm_installed_object_oid(obj_ptr));
+    // rollback may restore or drop Instances created or removed earlier
+    _anjay_dm_instance_cache_invalidate(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr));
     CHECKED_TAIL_CALL_HANDLER(obj_ptr, transaction_rollback, anjay, *obj_ptr);
 }
 
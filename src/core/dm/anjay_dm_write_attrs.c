@@ -246,6 +246,7 @@ int _anjay_dm_write_attributes(anjay_unlocked_t *anjay,
 #ifdef ANJAY_WITH_OBSERVE
     if (!result) {
         // verify that new attributes are "seen" by the observe code
+        _anjay_observe_attrs_cache_invalidate(&anjay->observe);
         result = _anjay_observe_notify(anjay, &request->uri, ssid, false);
     }
 #endif // ANJAY_WITH_OBSERVE
@@ -54,6 +54,7 @@ static void cleanup_transfer(AVS_LIST(anjay_download_ctx_t) *ctx) {
     assert(*ctx);
     assert((*ctx)->common.vtable);
 
+    _anjay_socket_set_changed(_anjay_downloader_get_anjay((*ctx)->common.dl));
     (*ctx)->common.vtable->cleanup(ctx);
 }
 
@@ -131,6 +132,7 @@ void _anjay_downloader_abort_transfer(AVS_LIST(anjay_download_ctx_t) *ctx,
 static void suspend_transfer(anjay_download_ctx_t *ctx) {
     assert(ctx);
     assert(ctx->common.vtable);
+    _anjay_socket_set_changed(_anjay_downloader_get_anjay(ctx->common.dl));
     ctx->common.vtable->suspend(ctx);
 }
 
@@ -139,6 +141,7 @@ static void reconnect_transfer(AVS_LIST(anjay_download_ctx_t) *ctx) {
     assert(*ctx);
     assert((*ctx)->common.vtable);
 
+    _anjay_socket_set_changed(_anjay_downloader_get_anjay((*ctx)->common.dl));
     avs_error_t err = (*ctx)->common.vtable->reconnect(ctx);
     if (avs_is_err(err)) {
         _anjay_downloader_abort_transfer(ctx,
@@ -323,6 +326,8 @@ avs_error_t _anjay_downloader_download(anjay_downloader_t *dl,
 
     if (dl_ctx) {
         AVS_LIST_APPEND(&dl->downloads, dl_ctx);
+        // the constructor has already connected the socket, if any
+        _anjay_socket_set_changed(_anjay_downloader_get_anjay(dl));
 
         assert(dl_ctx->common.id != INVALID_DOWNLOAD_ID);
         dl_log(INFO, _("download scheduled: ") "%s", config->url);
@@ -26,6 +26,7 @@
 
 #    include <anjay_modules/anjay_dm_utils.h>
 
+#    include <stddef.h>
 #    include <string.h>
 
 VISIBILITY_SOURCE_BEGIN
@@ -72,10 +73,18 @@ struct anjay_batch_entry {
     avs_time_real_t timestamp;
 };
 
+/**
+ * Compiled batches are immutable, so they are stored as a single allocation:
+ * the header is followed by a flat array of entries, and the contents of all
+ * string and bytes values referenced by these entries are stored at the end of
+ * the same memory block. This is the block in which the batch builder
+ * accumulates the entries, see @ref anjay_batch_builder_t.
+ */
 struct anjay_batch_struct {
-    AVS_LIST(anjay_batch_entry_t) list;
     size_t ref_count;
     avs_time_real_t compilation_time;
+    size_t entry_count;
+    anjay_batch_entry_t entries[];
 };
 
 struct anjay_batch_data_output_state_struct {
@@ -84,7 +93,11 @@ struct anjay_batch_data_output_state_struct {
 
 typedef struct {
     const anjay_ret_bytes_ctx_vtable_t *vtable;
-    void *data;
+    anjay_batch_builder_t *builder;
+    // position at which the next chunk will be written, counted back from the
+    // end of the builder's memory block, so that it stays valid if the block
+    // is reallocated
+    size_t offset_from_end;
     size_t remaining_bytes;
 } builder_bytes_t;
 
@@ -100,41 +113,81 @@ typedef struct builder_out_struct {
 } builder_out_ctx_t;
 
 anjay_batch_builder_t *_anjay_batch_builder_new(void) {
-    anjay_batch_builder_t *builder =
-            (anjay_batch_builder_t *) avs_calloc(1,
-                                                 sizeof(anjay_batch_builder_t));
-    if (!builder) {
-        return NULL;
-    }
-    builder->append_ptr = &builder->list;
-    return builder;
+    return (anjay_batch_builder_t *) avs_calloc(1,
+                                                sizeof(anjay_batch_builder_t));
 }
 
-static int make_data_with_duplicated_string(anjay_batch_data_t *batch_data,
-                                            const char *str) {
-    assert(batch_data);
-    assert(str);
-    char *new_str = avs_strdup(str);
-    if (!new_str) {
+static char *builder_block_end(const anjay_batch_builder_t *builder) {
+    assert(builder->block);
+    return (char *) builder->block->entries + builder->capacity;
+}
+
+static const void *rebase_payload(const void *ptr,
+                                  const char *old_end,
+                                  char *new_end) {
+    return new_end - (old_end - (const char *) ptr);
+}
+
+/**
+ * Ensures that there is enough free space in the builder's memory block for
+ * one more entry and @p payload_size bytes of its value. The block is grown
+ * geometrically, so that appending is amortized constant time.
+ */
+static int builder_reserve(anjay_batch_builder_t *builder,
+                           size_t payload_size) {
+    const size_t required = (builder->entry_count + 1)
+                                    * sizeof(anjay_batch_entry_t)
+                            + builder->payload_size + payload_size;
+    if (builder->block && required <= builder->capacity) {
+        return 0;
+    }
+    const size_t new_capacity = AVS_MAX(2 * builder->capacity, required);
+    anjay_batch_t *new_block = (anjay_batch_t *) avs_malloc(
+            offsetof(anjay_batch_t, entries) + new_capacity);
+    if (!new_block) {
+        batch_log(ERROR, _("out of memory"));
         return -1;
     }
-    *batch_data = (anjay_batch_data_t) {
-        .type = ANJAY_BATCH_DATA_STRING,
-        .value = {
-            .string = new_str
+    char *new_end = (char *) new_block->entries + new_capacity;
+    if (builder->block) {
+        const char *old_end = builder_block_end(builder);
+        memcpy(new_end - builder->payload_size,
+               old_end - builder->payload_size, builder->payload_size);
+        for (size_t i = 0; i < builder->entry_count; ++i) {
+            anjay_batch_entry_t *entry = &new_block->entries[i];
+            *entry = builder->block->entries[i];
+            if (entry->data.type == ANJAY_BATCH_DATA_STRING) {
+                entry->data.value.string = (const char *) rebase_payload(
+                        entry->data.value.string, old_end, new_end);
+            } else if (entry->data.type == ANJAY_BATCH_DATA_BYTES
+                       && entry->data.value.bytes.length) {
+                entry->data.value.bytes.data = rebase_payload(
+                        entry->data.value.bytes.data, old_end, new_end);
+            }
         }
-    };
+        avs_free(builder->block);
+    }
+    builder->block = new_block;
+    builder->capacity = new_capacity;
     return 0;
 }
 
-static void batch_data_cleanup(anjay_batch_data_t *data) {
+static size_t batch_data_payload_size(const anjay_batch_data_t *data) {
     if (data->type == ANJAY_BATCH_DATA_STRING) {
-        avs_free((void *) (intptr_t) data->value.string);
+        return strlen(data->value.string) + 1;
     } else if (data->type == ANJAY_BATCH_DATA_BYTES) {
-        avs_free((void *) (intptr_t) data->value.bytes.data);
+        return data->value.bytes.length;
     }
+    return 0;
 }
 
+/**
+ * Appends an entry to the builder. If @p data is a string or bytes value, the
+ * payload it points to is copied into the builder's memory block.
+ *
+ * If @p data is a bytes value with NULL data pointer, space for the payload is
+ * reserved, but left uninitialized.
+ */
 static int batch_data_add(anjay_batch_builder_t *builder,
                           const anjay_uri_path_t *uri,
                           avs_time_real_t timestamp,
@@ -142,23 +195,45 @@ static int batch_data_add(anjay_batch_builder_t *builder,
     assert(builder);
     if (data.type != ANJAY_BATCH_DATA_START_AGGREGATE
             && !_anjay_uri_path_has(uri, ANJAY_ID_RID)) {
-        batch_data_cleanup(&data);
         return -1;
     }
-    *builder->append_ptr = AVS_LIST_NEW_ELEMENT(anjay_batch_entry_t);
-    if (!*builder->append_ptr) {
-        batch_data_cleanup(&data);
+    const size_t payload_size = batch_data_payload_size(&data);
+    if (builder_reserve(builder, payload_size)) {
         return -1;
     }
-    **builder->append_ptr = (anjay_batch_entry_t) {
+    if (payload_size) {
+        builder->payload_size += payload_size;
+        char *payload = builder_block_end(builder) - builder->payload_size;
+        if (data.type == ANJAY_BATCH_DATA_STRING) {
+            memcpy(payload, data.value.string, payload_size);
+            data.value.string = payload;
+        } else {
+            if (data.value.bytes.data) {
+                memcpy(payload, data.value.bytes.data, payload_size);
+            }
+            data.value.bytes.data = payload;
+        }
+    }
+    builder->block->entries[builder->entry_count++] = (anjay_batch_entry_t) {
         .path = *uri,
         .timestamp = timestamp,
         .data = data
     };
-    AVS_LIST_ADVANCE_PTR(&builder->append_ptr);
     return 0;
 }
 
+void _anjay_batch_builder_truncate(anjay_batch_builder_t *builder,
+                                   size_t entry_count) {
+    assert(builder);
+    assert(entry_count <= builder->entry_count);
+    // payloads are stored in reverse order of appending, so the ones of the
+    // removed entries are exactly the most recently stored ones
+    while (builder->entry_count > entry_count) {
+        builder->payload_size -= batch_data_payload_size(
+                &builder->block->entries[--builder->entry_count].data);
+    }
+}
+
 int _anjay_batch_add_int(anjay_batch_builder_t *builder,
                          const anjay_uri_path_t *uri,
                          avs_time_real_t timestamp,
@@ -217,52 +292,34 @@ int _anjay_batch_add_string(anjay_batch_builder_t *builder,
                             const anjay_uri_path_t *uri,
                             avs_time_real_t timestamp,
                             const char *str) {
-    anjay_batch_data_t str_data;
-    if (make_data_with_duplicated_string(&str_data, str)) {
-        return -1;
-    }
-    return batch_data_add(builder, uri, timestamp, str_data);
+    assert(str);
+    const anjay_batch_data_t data = {
+        .type = ANJAY_BATCH_DATA_STRING,
+        .value = {
+            .string = str
+        }
+    };
+    return batch_data_add(builder, uri, timestamp, data);
 }
 
 #    ifdef ANJAY_WITH_LWM2M11
-static int make_data_with_duplicated_bytes(anjay_batch_data_t *batch_data,
-                                           const void *data,
-                                           size_t length) {
-    assert(batch_data);
+int _anjay_batch_add_bytes(anjay_batch_builder_t *builder,
+                           const anjay_uri_path_t *uri,
+                           avs_time_real_t timestamp,
+                           const void *data,
+                           size_t length) {
     if (!data && length) {
         return -1;
     }
-    void *new_data = NULL;
-
-    if (data && length) {
-        new_data = avs_malloc(length);
-        if (!new_data) {
-            return -1;
-        }
-        memcpy(new_data, data, length);
-    }
-
-    *batch_data = (anjay_batch_data_t) {
+    const anjay_batch_data_t bytes_data = {
         .type = ANJAY_BATCH_DATA_BYTES,
         .value = {
             .bytes = {
-                .data = new_data,
+                .data = length ? data : NULL,
                 .length = length
             }
         }
     };
-    return 0;
-}
-
-int _anjay_batch_add_bytes(anjay_batch_builder_t *builder,
-                           const anjay_uri_path_t *uri,
-                           avs_time_real_t timestamp,
-                           const void *data,
-                           size_t length) {
-    anjay_batch_data_t bytes_data;
-    if (make_data_with_duplicated_bytes(&bytes_data, data, length)) {
-        return -1;
-    }
     return batch_data_add(builder, uri, timestamp, bytes_data);
 }
 #    endif // ANJAY_WITH_LWM2M11
@@ -284,20 +341,9 @@ int _anjay_batch_add_objlnk(anjay_batch_builder_t *builder,
     return batch_data_add(builder, uri, timestamp, data);
 }
 
-static void batch_entry_cleanup(void *entry_) {
-    anjay_batch_entry_t *entry = (anjay_batch_entry_t *) entry_;
-    batch_data_cleanup(&entry->data);
-}
-
-void _anjay_batch_entry_list_cleanup(AVS_LIST(anjay_batch_entry_t) *list) {
-    AVS_LIST_CLEAR(list) {
-        batch_entry_cleanup(*list);
-    }
-}
-
 void _anjay_batch_builder_cleanup(anjay_batch_builder_t **builder) {
     if (builder && *builder) {
-        _anjay_batch_entry_list_cleanup(&(*builder)->list);
+        avs_free((*builder)->block);
         avs_free(*builder);
         *builder = NULL;
     }
@@ -331,16 +377,21 @@ anjay_batch_t *_anjay_batch_builder_compile(anjay_batch_builder_t **builder) {
     }
     assert(REF_COUNT_MUTEX);
 #    endif // ANJAY_WITH_THREAD_SAFETY
-    anjay_batch_t *batch =
-            (anjay_batch_t *) avs_calloc(1, sizeof(anjay_batch_t));
-    if (!batch) {
+    anjay_batch_t *batch = (*builder)->block;
+    if (!batch
+            && !(batch = (anjay_batch_t *) avs_malloc(
+                         offsetof(anjay_batch_t, entries)))) {
+        batch_log(ERROR, _("out of memory"));
         return NULL;
     }
-    batch->list = (*builder)->list;
+    // The entries and their payloads are already in place, so the batch just
+    // takes over the builder's memory block
     batch->ref_count = 1;
     batch->compilation_time = avs_time_real_now();
-    avs_free(*builder);
-    *builder = NULL;
+    batch->entry_count = (*builder)->entry_count;
+
+    (*builder)->block = NULL;
+    _anjay_batch_builder_cleanup(builder);
     return batch;
 }
 
@@ -377,7 +428,6 @@ void _anjay_batch_release(anjay_batch_t **batch) {
 #    endif // ANJAY_WITH_THREAD_SAFETY
 
     if (old_count <= 1) {
-        _anjay_batch_entry_list_cleanup(&(*batch)->list);
         avs_free(*batch);
     }
     *batch = NULL;
@@ -387,10 +437,9 @@ void _anjay_batch_release(anjay_batch_t **batch) {
 void _anjay_batch_update_common_path_prefix(const anjay_uri_path_t **prefix_ptr,
                                             anjay_uri_path_t *prefix_buf,
                                             const anjay_batch_t *batch) {
-    AVS_LIST(anjay_batch_entry_t) element;
-    AVS_LIST_FOREACH(element, batch->list) {
+    for (size_t i = 0; i < batch->entry_count; ++i) {
         _anjay_uri_path_update_common_prefix(prefix_ptr, prefix_buf,
-                                             &element->path);
+                                             &batch->entries[i].path);
     }
 }
 #    endif // ANJAY_WITH_LWM2M11
@@ -411,8 +460,9 @@ static int bytes_append(anjay_unlocked_ret_bytes_ctx_t *ctx,
         return -1;
     }
 
-    memcpy(bytes->data, data, length);
-    bytes->data = ((uint8_t *) bytes->data) + length;
+    memcpy(builder_block_end(bytes->builder) - bytes->offset_from_end, data,
+           length);
+    bytes->offset_from_end -= length;
     bytes->remaining_bytes -= length;
     return 0;
 }
@@ -434,31 +484,24 @@ static int bytes_begin(anjay_unlocked_output_ctx_t *ctx_,
         return -1;
     }
 
-    void *buf = NULL;
-    if (length) {
-        buf = avs_malloc(length);
-        if (!buf) {
-            return -1;
-        }
-    }
-
+    // data pointer is NULL, so the space is reserved, to be filled by
+    // bytes_append()
     anjay_batch_data_t data = {
         .type = ANJAY_BATCH_DATA_BYTES,
         .value.bytes = {
-            .data = buf,
+            .data = NULL,
             .length = length
         }
     };
 
     if (batch_data_add(ctx->builder, &ctx->path, ctx->timestamp, data)) {
-        avs_free(buf);
         return -1;
     }
 
     value_returned(ctx);
 
-    // Doesn't change owner of buf
-    ctx->bytes.data = buf;
+    // payload of the entry that has just been added is the most recent one
+    ctx->bytes.offset_from_end = ctx->builder->payload_size;
     ctx->bytes.remaining_bytes = length;
     *out_bytes_ctx = (anjay_unlocked_ret_bytes_ctx_t *) &ctx->bytes;
     return 0;
@@ -618,6 +661,7 @@ builder_out_ctx_new(anjay_batch_builder_t *builder,
         .builder = builder,
         .bytes = {
             .vtable = &BYTES_VTABLE,
+            .builder = builder,
             .remaining_bytes = 0
         },
         .root_path = *uri,
@@ -653,14 +697,13 @@ int _anjay_dm_read_into_batch(anjay_batch_builder_t *builder,
            || path_info->uri.ids[ANJAY_ID_OID]
                       == _anjay_dm_installed_object_oid(obj));
 
-    AVS_LIST(anjay_batch_entry_t) *initial_append_ptr = builder->append_ptr;
+    const size_t initial_entry_count = builder->entry_count;
     int result = read_into_batch(builder, anjay, obj, path_info,
                                  requesting_ssid, forced_timestamp);
 
     // Despite of failure, the new element may be added. Remove it.
     if (result) {
-        builder->append_ptr = initial_append_ptr;
-        _anjay_batch_entry_list_cleanup(builder->append_ptr);
+        _anjay_batch_builder_truncate(builder, initial_entry_count);
     }
     return result;
 }
@@ -702,16 +745,19 @@ static double convert_to_senml_time(avs_time_real_t timestamp,
 }
 
 static int serialize_batch_entry(const anjay_batch_entry_t *entry,
+                                 avs_time_duration_t timestamp_shift,
                                  avs_time_real_t serialization_time,
                                  anjay_unlocked_output_ctx_t *output) {
     int result = _anjay_output_set_path(output, &entry->path);
     if (result) {
         return result;
     }
-    if (avs_time_real_valid(entry->timestamp)
+    const avs_time_real_t timestamp =
+            avs_time_real_add(entry->timestamp, timestamp_shift);
+    if (avs_time_real_valid(timestamp)
             && (result = _anjay_output_set_time(
                         output,
-                        convert_to_senml_time(entry->timestamp,
+                        convert_to_senml_time(timestamp,
                                               serialization_time)))) {
         return result;
     }
@@ -766,8 +812,10 @@ int _anjay_batch_data_output(anjay_unlocked_t *anjay,
     const anjay_batch_data_output_state_t *state = NULL;
     int result = 0;
     do {
-        result = _anjay_batch_data_output_entry(
-                anjay, batch, target_ssid, serialization_time, &state, out_ctx);
+        result = _anjay_batch_data_output_entry(anjay, batch,
+                                                AVS_TIME_DURATION_ZERO,
+                                                target_ssid, serialization_time,
+                                                &state, out_ctx);
     } while (!result && state);
     return result;
 }
@@ -775,30 +823,35 @@ int _anjay_batch_data_output(anjay_unlocked_t *anjay,
 int _anjay_batch_data_output_entry(
         anjay_unlocked_t *anjay,
         const anjay_batch_t *batch,
+        avs_time_duration_t timestamp_shift,
         anjay_ssid_t target_ssid,
         avs_time_real_t serialization_time,
         const anjay_batch_data_output_state_t **state,
         anjay_unlocked_output_ctx_t *out_ctx) {
     assert(state);
-    AVS_LIST(const anjay_batch_entry_t) it;
+    const anjay_batch_entry_t *const end = &batch->entries[batch->entry_count];
+    const anjay_batch_entry_t *it;
     if (!*state) {
-        it = batch->list;
+        it = batch->entries;
     } else {
         it = &(*state)->entry;
-        assert(AVS_LIST_FIND_PTR(&batch->list, it) != NULL);
+        assert(it >= batch->entries && it < end);
     }
-    while (it
+    while (it < end
            && !is_server_allowed_to_read(anjay, it->path.ids[ANJAY_ID_OID],
                                          it->path.ids[ANJAY_ID_IID],
                                          target_ssid)) {
-        AVS_LIST_ADVANCE((AVS_LIST(anjay_batch_entry_t) *) (intptr_t) &it);
+        ++it;
     }
     int result = 0;
-    if (it) {
-        result = serialize_batch_entry(it, serialization_time, out_ctx);
-        AVS_LIST_ADVANCE((AVS_LIST(anjay_batch_entry_t) *) (intptr_t) &it);
-    }
-    *state = AVS_CONTAINER_OF(it, anjay_batch_data_output_state_t, entry);
+    if (it < end) {
+        result = serialize_batch_entry(it, timestamp_shift, serialization_time,
+                                       out_ctx);
+        ++it;
+    }
+    *state = it < end ? AVS_CONTAINER_OF(it, anjay_batch_data_output_state_t,
+                                         entry)
+                      : NULL;
     return result;
 }
 
@@ -837,26 +890,71 @@ bool _anjay_batch_values_equal(const anjay_batch_t *a, const anjay_batch_t *b) {
     if (!a || !b) {
         return !a && !b;
     }
-    AVS_LIST(anjay_batch_entry_t) ait = a->list;
-    AVS_LIST(anjay_batch_entry_t) bit = b->list;
-    while (ait && bit) {
-        if (!_anjay_uri_path_equal(&ait->path, &bit->path)
-                || !batch_data_equal(&ait->data, &bit->data)) {
+    if (a->entry_count != b->entry_count) {
+        return false;
+    }
+    for (size_t i = 0; i < a->entry_count; ++i) {
+        if (!_anjay_uri_path_equal(&a->entries[i].path, &b->entries[i].path)
+                || !batch_data_equal(&a->entries[i].data,
+                                     &b->entries[i].data)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool timestamps_shifted(avs_time_real_t timestamp,
+                               avs_time_real_t base_timestamp,
+                               avs_time_duration_t *inout_shift,
+                               bool *inout_shift_known) {
+    if (!avs_time_real_valid(timestamp)
+            || !avs_time_real_valid(base_timestamp)) {
+        return !avs_time_real_valid(timestamp)
+               && !avs_time_real_valid(base_timestamp);
+    }
+    avs_time_duration_t shift = avs_time_real_diff(timestamp, base_timestamp);
+    if (!*inout_shift_known) {
+        *inout_shift = shift;
+        *inout_shift_known = true;
+        return true;
+    }
+    return avs_time_duration_equal(shift, *inout_shift);
+}
+
+bool _anjay_batch_values_shifted(const anjay_batch_t *batch,
+                                 const anjay_batch_t *base,
+                                 avs_time_duration_t *out_shift) {
+    assert(batch);
+    assert(base);
+    assert(out_shift);
+    if (batch->entry_count != base->entry_count) {
+        return false;
+    }
+    avs_time_duration_t shift = AVS_TIME_DURATION_ZERO;
+    bool shift_known = false;
+    for (size_t i = 0; i < batch->entry_count; ++i) {
+        const anjay_batch_entry_t *entry = &batch->entries[i];
+        const anjay_batch_entry_t *base_entry = &base->entries[i];
+        if (!_anjay_uri_path_equal(&entry->path, &base_entry->path)
+                || !batch_data_equal(&entry->data, &base_entry->data)
+                || !timestamps_shifted(entry->timestamp, base_entry->timestamp,
+                                       &shift, &shift_known)) {
             return false;
         }
-        AVS_LIST_ADVANCE(&ait);
-        AVS_LIST_ADVANCE(&bit);
     }
-    return !ait && !bit;
+    *out_shift = shift_known ? shift
+                             : avs_time_real_diff(batch->compilation_time,
+                                                  base->compilation_time);
+    return true;
 }
 
 bool _anjay_batch_data_requires_hierarchical_format(
         const anjay_batch_t *batch) {
-    if (!batch || !batch->list || AVS_LIST_NEXT(batch->list)) {
+    if (!batch || batch->entry_count != 1) {
         // entry list is not exactly 1 element long
         return true;
     }
-    const anjay_batch_entry_t *const entry = batch->list;
+    const anjay_batch_entry_t *const entry = &batch->entries[0];
     if (entry->data.type == ANJAY_BATCH_DATA_START_AGGREGATE) {
         // batch consists of an empty aggregate, so isn't a single simple value
         return true;
@@ -870,7 +968,7 @@ double _anjay_batch_data_numeric_value(const anjay_batch_t *batch) {
         // not a simple value
         return NAN;
     }
-    const anjay_batch_entry_t *const entry = batch->list;
+    const anjay_batch_entry_t *const entry = &batch->entries[0];
     switch (entry->data.type) {
     case ANJAY_BATCH_DATA_INT:
         return (double) entry->data.value.int_value;
@@ -891,7 +989,7 @@ int _anjay_batch_data_boolean_value(const anjay_batch_t *batch,
         // not a simple value
         return -1;
     }
-    const anjay_batch_entry_t *const entry = batch->list;
+    const anjay_batch_entry_t *const entry = &batch->entries[0];
     if (entry->data.type == ANJAY_BATCH_DATA_BOOL) {
         if (out_value) {
             *out_value = entry->data.value.bool_value;
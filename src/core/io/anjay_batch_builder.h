@@ -27,13 +27,24 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 
 typedef struct anjay_batch_entry anjay_batch_entry_t;
 
+typedef struct anjay_batch_struct anjay_batch_t;
+
+/**
+ * The builder accumulates entries directly in the memory block that will
+ * become the compiled batch. Entries are stored in order from the beginning of
+ * the block, and contents of string and bytes values are stored from the end
+ * of the block backwards. The block is reallocated when these two regions
+ * would overlap.
+ */
 typedef struct anjay_batch_builder_struct {
-    AVS_LIST(anjay_batch_entry_t) list;
-    AVS_LIST(anjay_batch_entry_t) *append_ptr;
+    anjay_batch_t *block;
+    // size of the block, not including the batch header
+    size_t capacity;
+    size_t entry_count;
+    // number of bytes used for values at the end of the block
+    size_t payload_size;
 } anjay_batch_builder_t;
 
-typedef struct anjay_batch_struct anjay_batch_t;
-
 typedef struct anjay_batch_data_output_state_struct
         anjay_batch_data_output_state_t;
 
@@ -87,6 +98,13 @@ int _anjay_batch_add_objlnk(anjay_batch_builder_t *builder,
                             anjay_iid_t objlnk_iid);
 /**@}*/
 
+/**
+ * Removes all entries except the first @p entry_count ones from the builder.
+ * Used to roll back entries added by an operation that has failed.
+ */
+void _anjay_batch_builder_truncate(anjay_batch_builder_t *builder,
+                                   size_t entry_count);
+
 /**
  * Releases batch builder and discards all data. It has no effect if builder was
  * previously compiled.
@@ -99,6 +117,9 @@ void _anjay_batch_builder_cleanup(anjay_batch_builder_t **builder);
  * Compiles data from the batch builder into a reference-counted (with count
  * initialized to 1) immutable data batch.
  *
+ * The batch takes over the memory block in which the builder has accumulated
+ * the entries, so no data is copied, and releasing the batch is a single free.
+ *
  * @param builder Pointer to pointer to batch builder. Set to NULL after
  *                successful return.
  *
@@ -130,8 +151,6 @@ anjay_batch_t *_anjay_batch_acquire(const anjay_batch_t *batch);
  */
 void _anjay_batch_release(anjay_batch_t **batch);
 
-void _anjay_batch_entry_list_cleanup(AVS_LIST(anjay_batch_entry_t) *list);
-
 int _anjay_dm_read_into_batch(anjay_batch_builder_t *builder,
                               anjay_unlocked_t *anjay,
                               const anjay_dm_installed_object_t *obj,
@@ -172,7 +191,8 @@ int _anjay_batch_data_output(anjay_unlocked_t *anjay,
  * int result = 0;
  * do {
  *     result = _anjay_batch_data_output_entry(
- *             anjay, batch, target_ssid, serialization_time, &state, out_ctx);
+ *             anjay, batch, AVS_TIME_DURATION_ZERO, target_ssid,
+ *             serialization_time, &state, out_ctx);
  * } while (!result && state);
  * @endcode
  * </example>
@@ -181,6 +201,10 @@ int _anjay_batch_data_output(anjay_unlocked_t *anjay,
  *
  * @param [in]    batch              Compiled batch.
  *
+ * @param [in]    timestamp_shift    Duration added to all valid timestamps of
+ *                                   the batch entries before serializing them.
+ *                                   See @ref _anjay_batch_values_shifted.
+ *
  * @param [in]    target_ssid        SSID of the server for which this batch is
  *                                   being serialized.
  *
@@ -223,6 +247,7 @@ int _anjay_batch_data_output(anjay_unlocked_t *anjay,
 int _anjay_batch_data_output_entry(
         anjay_unlocked_t *anjay,
         const anjay_batch_t *batch,
+        avs_time_duration_t timestamp_shift,
         anjay_ssid_t target_ssid,
         avs_time_real_t serialization_time,
         const anjay_batch_data_output_state_t **state,
@@ -241,6 +266,26 @@ int _anjay_batch_data_output_entry(
  */
 bool _anjay_batch_values_equal(const anjay_batch_t *a, const anjay_batch_t *b);
 
+/**
+ * Checks whether @p batch holds exactly the same entries as @p base, with all
+ * valid timestamps shifted by the same amount. If so, @p base may be used in
+ * place of @p batch, passing the shift to @ref _anjay_batch_data_output_entry.
+ *
+ * @param batch     Non-null batch to check.
+ *
+ * @param base      Non-null batch to compare against.
+ *
+ * @param out_shift On success, set to the difference between the timestamps of
+ *                  @p batch and @p base entries, or between their compilation
+ *                  times if none of the entries has a valid timestamp.
+ *
+ * @returns true if @p batch is equivalent to @p base shifted in time, false
+ *          otherwise.
+ */
+bool _anjay_batch_values_shifted(const anjay_batch_t *batch,
+                                 const anjay_batch_t *base,
+                                 avs_time_duration_t *out_shift);
+
 bool _anjay_batch_data_requires_hierarchical_format(const anjay_batch_t *batch);
 
 /**
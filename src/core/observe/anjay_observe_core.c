@@ -18,8 +18,13 @@
 #    include <avsystem/commons/avs_stream_membuf.h>
 #    include <avsystem/commons/avs_stream_v_table.h>
 
+#    ifdef WITH_AVS_COAP_UDP
+#        include <avsystem/coap/udp.h>
+#    endif // WITH_AVS_COAP_UDP
+
 #    include <anjay_modules/anjay_time_defs.h>
 
+#    include "../anjay_access_utils_private.h"
 #    include "../anjay_core.h"
 #    include "../anjay_io_core.h"
 #    include "../anjay_servers_utils.h"
@@ -68,11 +73,34 @@ int _anjay_observe_path_entry_cmp(const void *left, const void *right) {
             &((const anjay_observe_path_entry_t *) right)->path);
 }
 
+int _anjay_observe_trigger_slot_cmp(const void *left, const void *right) {
+    const avs_time_monotonic_t left_instant =
+            ((const anjay_observe_trigger_slot_t *) left)->instant;
+    const avs_time_monotonic_t right_instant =
+            ((const anjay_observe_trigger_slot_t *) right)->instant;
+    if (avs_time_monotonic_before(left_instant, right_instant)) {
+        return -1;
+    }
+    return avs_time_monotonic_before(right_instant, left_instant) ? 1 : 0;
+}
+
 void _anjay_observe_init(anjay_observe_state_t *observe,
                          bool confirmable_notifications,
-                         size_t stored_notification_limit) {
+                         size_t stored_notification_limit,
+                         avs_time_duration_t notify_alignment,
+                         bool cache_effective_attrs) {
     assert(!observe->connection_entries);
     observe->confirmable_notifications = confirmable_notifications;
+    observe->effective_attrs_cache_enabled = cache_effective_attrs;
+    // newly created path entries have generation 0, i.e. are never valid
+    observe->effective_attrs_generation = 1;
+    if (avs_time_duration_valid(notify_alignment)
+            && avs_time_duration_less(AVS_TIME_DURATION_ZERO,
+                                      notify_alignment)) {
+        observe->notify_alignment = notify_alignment;
+    } else {
+        observe->notify_alignment = AVS_TIME_DURATION_ZERO;
+    }
 
     if (stored_notification_limit == 0) {
         observe->notify_queue_limit_mode = NOTIFY_QUEUE_UNLIMITED;
@@ -92,8 +120,8 @@ static void delete_value(anjay_unlocked_t *anjay,
     assert(value_ptr && *value_ptr);
     if (!is_error_value(*value_ptr)) {
         for (size_t i = 0; i < (*value_ptr)->ref->paths_count; ++i) {
-            if ((*value_ptr)->values[i]) {
-                _anjay_batch_release(&(*value_ptr)->values[i]);
+            if ((*value_ptr)->values[i].batch) {
+                _anjay_batch_release(&(*value_ptr)->values[i].batch);
             }
         }
     }
@@ -106,6 +134,129 @@ path_entry_query(const anjay_uri_path_t *path) {
     return AVS_CONTAINER_OF(path, anjay_observe_path_entry_t, path);
 }
 
+static size_t path_index_lower_bound(const anjay_observe_path_node_t *node,
+                                     anjay_id_t id) {
+    size_t lo = 0;
+    size_t hi = node->children_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (node->children[mid]->id < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static anjay_observe_path_node_t *
+path_index_find_child(const anjay_observe_path_node_t *node, anjay_id_t id) {
+    size_t index = path_index_lower_bound(node, id);
+    if (index < node->children_count && node->children[index]->id == id) {
+        return node->children[index];
+    }
+    return NULL;
+}
+
+static anjay_observe_path_node_t *
+path_index_find_or_create_child(anjay_observe_path_node_t *node,
+                                anjay_id_t id) {
+    size_t index = path_index_lower_bound(node, id);
+    if (index < node->children_count && node->children[index]->id == id) {
+        return node->children[index];
+    }
+    if (node->children_count == node->children_capacity) {
+        size_t new_capacity =
+                node->children_capacity ? 2 * node->children_capacity : 4;
+        anjay_observe_path_node_t **new_children =
+                (anjay_observe_path_node_t **) avs_realloc(
+                        node->children, new_capacity * sizeof(*new_children));
+        if (!new_children) {
+            return NULL;
+        }
+        node->children = new_children;
+        node->children_capacity = new_capacity;
+    }
+    anjay_observe_path_node_t *child = (anjay_observe_path_node_t *)
+            avs_calloc(1, sizeof(anjay_observe_path_node_t));
+    if (!child) {
+        return NULL;
+    }
+    child->id = id;
+    memmove(&node->children[index + 1], &node->children[index],
+            (node->children_count - index) * sizeof(*node->children));
+    node->children[index] = child;
+    ++node->children_count;
+    return child;
+}
+
+/**
+ * Removes the entry for @p path from the index, and then all the nodes on that
+ * path that are left with neither an entry nor any children.
+ */
+static void path_index_remove(anjay_observe_path_node_t *root,
+                              const anjay_uri_path_t *path) {
+    anjay_observe_path_node_t *nodes[_ANJAY_URI_PATH_MAX_LENGTH + 1] = {
+        root
+    };
+    size_t path_length = _anjay_uri_path_length(path);
+    size_t depth = 0;
+    while (depth < path_length
+           && (nodes[depth + 1] = path_index_find_child(nodes[depth],
+                                                        path->ids[depth]))) {
+        ++depth;
+    }
+    if (depth == path_length) {
+        nodes[depth]->entry = NULL;
+    }
+    for (size_t i = depth; i > 0; --i) {
+        anjay_observe_path_node_t *node = nodes[i];
+        if (node->entry || node->children_count) {
+            break;
+        }
+        anjay_observe_path_node_t *parent = nodes[i - 1];
+        size_t index = path_index_lower_bound(parent, node->id);
+        assert(index < parent->children_count
+               && parent->children[index] == node);
+        memmove(&parent->children[index], &parent->children[index + 1],
+                (parent->children_count - index - 1)
+                        * sizeof(*parent->children));
+        --parent->children_count;
+        avs_free(node->children);
+        avs_free(node);
+    }
+    if (!root->children_count) {
+        avs_free(root->children);
+        root->children = NULL;
+        root->children_capacity = 0;
+    }
+}
+
+static int path_index_insert(anjay_observe_path_node_t *root,
+                             anjay_observe_path_entry_t *entry) {
+    anjay_observe_path_node_t *node = root;
+    size_t path_length = _anjay_uri_path_length(&entry->path);
+    for (size_t i = 0; i < path_length; ++i) {
+        if (!(node = path_index_find_or_create_child(node,
+                                                     entry->path.ids[i]))) {
+            // clean up the nodes that might have just been created
+            path_index_remove(root, &entry->path);
+            return -1;
+        }
+    }
+    assert(!node->entry);
+    node->entry = entry;
+    return 0;
+}
+
+static void
+delete_observe_path_entry(anjay_observe_connection_entry_t *connection,
+                          AVS_SORTED_SET_ELEM(anjay_observe_path_entry_t)
+                                  *entry_ptr) {
+    path_index_remove(&connection->observed_paths_index, &(*entry_ptr)->path);
+    AVS_SORTED_SET_DELETE_ELEM(connection->observed_paths, entry_ptr);
+}
+
 static AVS_SORTED_SET_ELEM(anjay_observe_path_entry_t)
 find_or_create_observe_path_entry(anjay_observe_connection_entry_t *connection,
                                   const anjay_uri_path_t *path) {
@@ -124,6 +275,11 @@ find_or_create_observe_path_entry(anjay_observe_connection_entry_t *connection,
                sizeof(*path));
         entry = AVS_SORTED_SET_INSERT(connection->observed_paths, new_entry);
         assert(entry == new_entry);
+        if (path_index_insert(&connection->observed_paths_index, entry)) {
+            anjay_log(ERROR, _("out of memory"));
+            AVS_SORTED_SET_DELETE_ELEM(connection->observed_paths, &entry);
+            return NULL;
+        }
     }
     return entry;
 }
@@ -143,7 +299,7 @@ static int add_path_to_observed_paths(
     if (!entry) {
         anjay_log(ERROR, _("out of memory"));
         if (!observed_path->refs) {
-            AVS_SORTED_SET_DELETE_ELEM(conn->observed_paths, &observed_path);
+            delete_observe_path_entry(conn, &observed_path);
         }
         return -1;
     }
@@ -163,8 +319,7 @@ static void remove_path_from_observed_paths(
         if (**ref_ptr == observation) {
             AVS_LIST_DELETE(ref_ptr);
             if (!observed_path->refs) {
-                AVS_SORTED_SET_DELETE_ELEM(conn->observed_paths,
-                                           &observed_path);
+                delete_observe_path_entry(conn, &observed_path);
             }
             return;
         }
@@ -198,10 +353,117 @@ static void remove_from_observed_paths(
     }
 }
 
+/**
+ * Resolution of trigger instants. Triggers that fall within the same period of
+ * this length are evaluated together, by a single scheduler job.
+ */
+#    define TRIGGER_SLOT_RESOLUTION_NS 10000000 // 10 ms
+
+static avs_time_monotonic_t trigger_slot_instant(avs_time_monotonic_t instant) {
+    const int32_t remainder = instant.since_monotonic_epoch.nanoseconds
+                              % TRIGGER_SLOT_RESOLUTION_NS;
+    if (remainder > 0) {
+        instant = avs_time_monotonic_add(
+                instant,
+                avs_time_duration_from_scalar(TRIGGER_SLOT_RESOLUTION_NS
+                                                      - remainder,
+                                              AVS_TIME_NS));
+    }
+    return instant;
+}
+
+static avs_time_monotonic_t
+trigger_time(const anjay_observation_t *observation) {
+    if (observation->notify_trigger.slot) {
+        return observation->notify_trigger.slot->instant;
+    }
+    return AVS_TIME_MONOTONIC_INVALID;
+}
+
+static void trigger_cancel(anjay_observation_t *observation) {
+    anjay_observe_trigger_t *trigger = &observation->notify_trigger;
+    AVS_SORTED_SET_ELEM(anjay_observe_trigger_slot_t) slot = trigger->slot;
+    if (!slot) {
+        return;
+    }
+    anjay_unlocked_t *anjay =
+            _anjay_from_server(trigger->conn->conn_ref.server);
+    if (trigger->prev) {
+        trigger->prev->next = trigger->next;
+    } else {
+        slot->first = trigger->next;
+    }
+    if (trigger->next) {
+        trigger->next->prev = trigger->prev;
+    } else {
+        slot->last = trigger->prev;
+    }
+    memset(trigger, 0, sizeof(*trigger));
+
+    // slot that is currently firing is deleted by trigger_slot_job() itself
+    if (!slot->first && !slot->firing) {
+        avs_sched_del(&slot->job);
+        AVS_SORTED_SET_DELETE_ELEM(anjay->observe.trigger_slots, &slot);
+    }
+}
+
+static void trigger_slot_job(avs_sched_t *sched, const void *slot_ptr);
+
+static int trigger_schedule(anjay_observe_connection_entry_t *conn,
+                            anjay_observation_t *observation,
+                            avs_time_monotonic_t instant) {
+    anjay_unlocked_t *anjay = _anjay_from_server(conn->conn_ref.server);
+    anjay_observe_state_t *observe = &anjay->observe;
+    instant = trigger_slot_instant(instant);
+    if (avs_time_monotonic_equal(trigger_time(observation), instant)) {
+        return 0;
+    }
+
+    if (!observe->trigger_slots
+            && !(observe->trigger_slots =
+                         AVS_SORTED_SET_NEW(anjay_observe_trigger_slot_t,
+                                            _anjay_observe_trigger_slot_cmp))) {
+        anjay_log(ERROR, _("out of memory"));
+        return -1;
+    }
+    AVS_SORTED_SET_ELEM(anjay_observe_trigger_slot_t) slot =
+            AVS_SORTED_SET_FIND(observe->trigger_slots,
+                                &(const anjay_observe_trigger_slot_t) {
+                                    .instant = instant
+                                });
+    if (!slot) {
+        if (!(slot = AVS_SORTED_SET_ELEM_NEW(anjay_observe_trigger_slot_t))) {
+            anjay_log(ERROR, _("out of memory"));
+            return -1;
+        }
+        slot->instant = instant;
+        if (AVS_SCHED_AT(anjay->sched, &slot->job, instant, trigger_slot_job,
+                         &slot, sizeof(slot))) {
+            AVS_SORTED_SET_ELEM_DELETE_DETACHED(&slot);
+            return -1;
+        }
+        AVS_SORTED_SET_INSERT(observe->trigger_slots, slot);
+    }
+
+    trigger_cancel(observation);
+    anjay_observe_trigger_t *trigger = &observation->notify_trigger;
+    trigger->slot = slot;
+    trigger->conn = conn;
+    trigger->prev = slot->last;
+    trigger->next = NULL;
+    if (slot->last) {
+        slot->last->next = trigger;
+    } else {
+        slot->first = trigger;
+    }
+    slot->last = trigger;
+    return 0;
+}
+
 static void clear_observation(anjay_observe_connection_entry_t *connection,
                               anjay_observation_t *observation) {
     anjay_unlocked_t *anjay = _anjay_from_server(connection->conn_ref.server);
-    avs_sched_del(&observation->notify_task);
+    trigger_cancel(observation);
     while (observation->last_sent) {
         delete_value(anjay, &observation->last_sent);
     }
@@ -234,7 +496,7 @@ static void
 cleanup_observation(anjay_observe_connection_entry_t *conn,
                     AVS_SORTED_SET_ELEM(anjay_observation_t) observation) {
     remove_from_observed_paths(conn, observation);
-    avs_sched_del(&observation->notify_task);
+    trigger_cancel(observation);
     if (observation->last_sent) {
         delete_value(_anjay_from_server(conn->conn_ref.server),
                      &observation->last_sent);
@@ -256,6 +518,11 @@ static void cleanup_connection_without_observations_set(
         assert(!AVS_SORTED_SET_FIRST(conn->observed_paths));
         AVS_SORTED_SET_DELETE(&conn->observed_paths);
     }
+    assert(!conn->observed_paths_index.entry);
+    assert(!conn->observed_paths_index.children_count);
+    avs_free(conn->observed_paths_index.children);
+    conn->observed_paths_index.children = NULL;
+    conn->observed_paths_index.children_capacity = 0;
     if (conn->flush_task) {
         avs_sched_del(&conn->flush_task);
     }
@@ -273,8 +540,7 @@ cancel_ongoing_notify_exchange(anjay_observe_connection_entry_t *conn) {
         avs_coap_exchange_cancel(coap, conn->notify_exchange_id);
     }
     assert(!avs_coap_exchange_id_valid(conn->notify_exchange_id));
-    assert(!conn->serialization_state.membuf_stream);
-    assert(!conn->serialization_state.out_ctx);
+    assert(!conn->serialization_state.payload);
 }
 
 void _anjay_observe_invalidate(anjay_connection_ref_t ref) {
@@ -310,10 +576,26 @@ void _anjay_observe_invalidate(anjay_connection_ref_t ref) {
     AVS_LIST_DELETE(&conn);
 }
 
+void _anjay_observe_read_cache_clear(anjay_observe_state_t *observe) {
+    AVS_LIST_CLEAR(&observe->read_cache) {
+        _anjay_batch_release(&observe->read_cache->value);
+    }
+    avs_sched_del(&observe->read_cache_cleanup_handle);
+}
+
+void _anjay_observe_attrs_cache_invalidate(anjay_observe_state_t *observe) {
+    ++observe->effective_attrs_generation;
+}
+
 void _anjay_observe_cleanup(anjay_observe_state_t *observe) {
+    _anjay_observe_read_cache_clear(observe);
     AVS_LIST_CLEAR(&observe->connection_entries) {
         _anjay_observe_cleanup_connection(observe->connection_entries);
     }
+    if (observe->trigger_slots) {
+        assert(!AVS_SORTED_SET_FIRST(observe->trigger_slots));
+        AVS_SORTED_SET_DELETE(&observe->trigger_slots);
+    }
 }
 
 static void
@@ -337,8 +619,6 @@ typedef struct {
     anjay_observation_t *observation;
 } trigger_observe_args_t;
 
-static void trigger_observe(avs_sched_t *sched, const void *args_);
-
 static const anjay_observation_value_t *
 newest_value(const anjay_observation_t *observation) {
     if (observation->last_unsent) {
@@ -354,10 +634,36 @@ typedef enum {
     SCHEDULE_PERIOD_MAX
 } schedule_period_type_t;
 
+/**
+ * Moves @p instant back to the nearest multiple of @p alignment, so that
+ * triggers of different observations coincide.
+ */
+static avs_time_real_t align_trigger_instant(avs_time_real_t instant,
+                                             avs_time_duration_t alignment) {
+    int64_t instant_ms;
+    int64_t alignment_ms;
+    if (avs_time_duration_to_scalar(&alignment_ms, AVS_TIME_MS, alignment)
+            || alignment_ms <= 0
+            || avs_time_real_to_scalar(&instant_ms, AVS_TIME_MS, instant)) {
+        return instant;
+    }
+    return avs_time_real_from_scalar(instant_ms - instant_ms % alignment_ms,
+                                     AVS_TIME_MS);
+}
+
+/**
+ * Schedules the trigger of @p observation to happen @p period seconds after the
+ * newest value has been read.
+ *
+ * If @p period_type is SCHEDULE_PERIOD_MAX, the trigger may be moved back
+ * according to the notify_alignment setting, but never to before @p pmin
+ * seconds after the newest value has been read.
+ */
 static int schedule_trigger(anjay_observe_connection_entry_t *conn_state,
                             anjay_observation_t *observation,
                             int32_t period,
-                            schedule_period_type_t period_type) {
+                            schedule_period_type_t period_type,
+                            int32_t pmin) {
     if (period < 0) {
         return 0;
     }
@@ -368,6 +674,29 @@ static int schedule_trigger(anjay_observe_connection_entry_t *conn_state,
     avs_time_real_t trigger_instant_real = avs_time_real_add(
             newest_value(observation)->timestamp,
             avs_time_duration_from_scalar(period, AVS_TIME_S));
+    if (period_type == SCHEDULE_PERIOD_MAX) {
+        avs_time_real_t aligned_instant = align_trigger_instant(
+                trigger_instant_real,
+                _anjay_from_server(conn_state->conn_ref.server)
+                        ->observe.notify_alignment);
+        // Never move the trigger back to before pmin has passed since the
+        // newest value has been read, as the notification would violate
+        // pmin. Never move it back to the time of reading the newest value
+        // either - otherwise, short pmax could cause notifications to be sent
+        // in a loop.
+        const avs_time_real_t earliest_instant = avs_time_real_add(
+                newest_value(observation)->timestamp,
+                avs_time_duration_from_scalar(AVS_MAX(pmin, 0), AVS_TIME_S));
+        if (avs_time_real_before(aligned_instant, earliest_instant)) {
+            aligned_instant = earliest_instant;
+        }
+        if (avs_time_real_before(newest_value(observation)->timestamp,
+                                 aligned_instant)
+                && avs_time_real_before(aligned_instant,
+                                        trigger_instant_real)) {
+            trigger_instant_real = aligned_instant;
+        }
+    }
     if (avs_time_real_before(trigger_instant_real, real_now)) {
         trigger_instant_real = real_now;
     }
@@ -387,8 +716,9 @@ static int schedule_trigger(anjay_observe_connection_entry_t *conn_state,
 
     avs_time_monotonic_t trigger_instant_monotonic = avs_time_monotonic_add(
             monotonic_now, avs_time_real_diff(trigger_instant_real, real_now));
-    if (avs_time_monotonic_before(avs_sched_time(&observation->notify_task),
-                                  trigger_instant_monotonic)) {
+    if (avs_time_monotonic_before(trigger_time(observation),
+                                  trigger_slot_instant(
+                                          trigger_instant_monotonic))) {
         anjay_log(
                 LAZY_TRACE,
                 _("Notify for token ") "%s" _(" already scheduled earlier "
@@ -407,15 +737,8 @@ static int schedule_trigger(anjay_observe_connection_entry_t *conn_state,
             (long) trigger_instant_monotonic.since_monotonic_epoch.seconds,
             (long) trigger_instant_monotonic.since_monotonic_epoch.nanoseconds);
 
-    int retval =
-            AVS_SCHED_AT(_anjay_from_server(conn_state->conn_ref.server)->sched,
-                         &observation->notify_task, trigger_instant_monotonic,
-                         trigger_observe,
-                         (&(const trigger_observe_args_t) {
-                             .conn_state = conn_state,
-                             .observation = observation
-                         }),
-                         sizeof(trigger_observe_args_t));
+    int retval = trigger_schedule(conn_state, observation,
+                                  trigger_instant_monotonic);
     if (retval) {
         anjay_log(ERROR,
                   _("Could not schedule automatic notification trigger, "
@@ -425,16 +748,45 @@ static int schedule_trigger(anjay_observe_connection_entry_t *conn_state,
     return retval;
 }
 
+static int
+init_value_element(anjay_observation_value_element_t *out_element,
+                   const anjay_batch_t *batch,
+                   const anjay_observation_value_element_t *previous) {
+    const anjay_batch_t *data = batch;
+    avs_time_duration_t timestamp_shift = AVS_TIME_DURATION_ZERO;
+    if (previous) {
+        if (batch == previous->batch) {
+            // previous value has been copied, e.g. because of epmin
+            timestamp_shift = previous->timestamp_shift;
+        } else if (_anjay_batch_values_shifted(batch, previous->batch,
+                                               &timestamp_shift)) {
+            data = previous->batch;
+        }
+    }
+    if (!(out_element->batch = _anjay_batch_acquire(data))) {
+        return -1;
+    }
+    out_element->timestamp_shift = timestamp_shift;
+    return 0;
+}
+
+/**
+ * If @p previous is not NULL, values equal to the corresponding ones in
+ * @p previous reuse the batches held by @p previous, so that long queues of
+ * mostly unchanged values don't keep copies of the same data.
+ */
 static AVS_LIST(anjay_observation_value_t)
 create_observation_value(const anjay_msg_details_t *details,
                          avs_coap_notify_reliability_hint_t reliability_hint,
                          anjay_observation_t *ref,
                          const avs_time_real_t *timestamp,
-                         const anjay_batch_t *const *values) {
+                         const anjay_batch_t *const *values,
+                         const anjay_observation_value_t *previous) {
     const size_t values_count =
             _anjay_observe_is_error_details(details) ? 0 : ref->paths_count;
-    const size_t element_size = offsetof(anjay_observation_value_t, values)
-                                + values_count * sizeof(anjay_batch_t *);
+    const size_t element_size =
+            offsetof(anjay_observation_value_t, values)
+            + values_count * sizeof(anjay_observation_value_element_t);
     AVS_LIST(anjay_observation_value_t) result = (AVS_LIST(
             anjay_observation_value_t)) AVS_LIST_NEW_BUFFER(element_size);
     if (!result) {
@@ -445,10 +797,14 @@ create_observation_value(const anjay_msg_details_t *details,
     result->reliability_hint = reliability_hint;
     memcpy((void *) (intptr_t) (const void *) &result->ref, &ref, sizeof(ref));
     result->timestamp = *timestamp;
+    if (previous && is_error_value(previous)) {
+        previous = NULL;
+    }
     for (size_t i = 0; i < values_count; ++i) {
         assert(values);
         assert(values[i]);
-        if (!(result->values[i] = _anjay_batch_acquire(values[i]))) {
+        if (init_value_element(&result->values[i], values[i],
+                               previous ? &previous->values[i] : NULL)) {
             AVS_LIST_CLEAR(&result);
             break;
         }
@@ -548,7 +904,10 @@ static int insert_new_value(anjay_observe_connection_entry_t *conn_state,
 
     AVS_LIST(anjay_observation_value_t) res_value =
             create_observation_value(details, reliability_hint, observation,
-                                     timestamp, values);
+                                     timestamp, values,
+                                     observation->last_unsent
+                                             ? observation->last_unsent
+                                             : observation->last_sent);
     if (!res_value) {
         return -1;
     }
@@ -566,7 +925,7 @@ static int insert_new_value(anjay_observe_connection_entry_t *conn_state,
 static int insert_error(anjay_observe_connection_entry_t *conn_state,
                         anjay_observation_t *observation,
                         int outer_result) {
-    avs_sched_del(&observation->notify_task);
+    trigger_cancel(observation);
     const anjay_msg_details_t details = {
         .msg_code = _anjay_make_error_response_code(outer_result),
         .format = AVS_COAP_FORMAT_NONE
@@ -622,6 +981,31 @@ static int get_effective_attrs(anjay_unlocked_t *anjay,
     return _anjay_dm_effective_attrs(anjay, &details, out_attrs);
 }
 
+static int
+get_observed_path_attrs(anjay_observe_connection_entry_t *conn_state,
+                        anjay_dm_r_attributes_t *out_attrs,
+                        const anjay_uri_path_t *path) {
+    anjay_unlocked_t *anjay = _anjay_from_server(conn_state->conn_ref.server);
+    AVS_SORTED_SET_ELEM(anjay_observe_path_entry_t) entry = NULL;
+    if (anjay->observe.effective_attrs_cache_enabled
+            && (entry = AVS_SORTED_SET_FIND(conn_state->observed_paths,
+                                            path_entry_query(path)))
+            && entry->effective_attrs_generation
+                           == anjay->observe.effective_attrs_generation) {
+        *out_attrs = entry->effective_attrs;
+        return 0;
+    }
+    int result =
+            get_effective_attrs(anjay, out_attrs, path,
+                                _anjay_server_ssid(conn_state->conn_ref.server));
+    if (!result && entry) {
+        entry->effective_attrs = *out_attrs;
+        entry->effective_attrs_generation =
+                anjay->observe.effective_attrs_generation;
+    }
+    return result;
+}
+
 static inline bool is_pmax_valid(anjay_dm_oi_attributes_t attr) {
     if (attr.max_period < 0) {
         return false;
@@ -647,17 +1031,23 @@ static void update_batch_pmax(int32_t *out_ptr,
     }
 }
 
+static void update_batch_pmin(int32_t *out_ptr,
+                              const anjay_dm_r_attributes_t *attrs) {
+    if (attrs->common.min_period > *out_ptr) {
+        *out_ptr = attrs->common.min_period;
+    }
+}
+
 int _anjay_observe_schedule_pmax_trigger(
         anjay_observe_connection_entry_t *conn_state,
         anjay_observation_t *observation) {
+    int32_t pmin = 0;
     int32_t pmax = -1;
 
     for (size_t i = 0; i < observation->paths_count; ++i) {
         anjay_dm_r_attributes_t attrs;
-        int result = get_effective_attrs(
-                _anjay_from_server(conn_state->conn_ref.server), &attrs,
-                &observation->paths[i],
-                _anjay_server_ssid(conn_state->conn_ref.server));
+        int result = get_observed_path_attrs(conn_state, &attrs,
+                                             &observation->paths[i]);
         if (result) {
             anjay_log(DEBUG,
                       _("Could not get observe attributes, result: ") "%d",
@@ -665,12 +1055,13 @@ int _anjay_observe_schedule_pmax_trigger(
             return result;
         }
 
+        update_batch_pmin(&pmin, &attrs);
         update_batch_pmax(&pmax, &attrs);
     }
 
     if (pmax >= 0) {
         return schedule_trigger(conn_state, observation, pmax,
-                                SCHEDULE_PERIOD_MAX);
+                                SCHEDULE_PERIOD_MAX, pmin);
     }
     return 0;
 }
@@ -690,7 +1081,7 @@ static int insert_initial_value(anjay_observe_connection_entry_t *conn_state,
     // even though we haven't actually sent it ourselves
     if ((observation->last_sent = create_observation_value(
                  details, AVS_COAP_NOTIFY_PREFER_NON_CONFIRMABLE, observation,
-                 timestamp, values))
+                 timestamp, values, NULL))
             && !(result = _anjay_observe_schedule_pmax_trigger(conn_state,
                                                                observation))) {
         observation->last_confirmable = now;
@@ -783,6 +1174,7 @@ find_or_create_connection_state(anjay_connection_ref_t ref) {
         }
         memcpy((void *) (intptr_t) (const void *) &(*conn_ptr)->conn_ref, &ref,
                sizeof(ref));
+        (*conn_ptr)->observed_paths_index.id = ANJAY_ID_INVALID;
         (*conn_ptr)->next_trigger = AVS_TIME_REAL_INVALID;
         (*conn_ptr)->next_pmax_trigger = AVS_TIME_REAL_INVALID;
     }
@@ -793,7 +1185,7 @@ static int schedule_all_triggers(anjay_observe_connection_entry_t *conn) {
     int result = 0;
     AVS_SORTED_SET_ELEM(anjay_observation_t) observation;
     AVS_SORTED_SET_FOREACH(observation, conn->observations) {
-        if (!observation->notify_task) {
+        if (!observation->notify_trigger.slot) {
             _anjay_update_ret(&result, _anjay_observe_schedule_pmax_trigger(
                                                conn, observation));
         }
@@ -801,18 +1193,15 @@ static int schedule_all_triggers(anjay_observe_connection_entry_t *conn) {
     return result;
 }
 
-static void flush_next_unsent(anjay_observe_connection_entry_t *conn);
+static void flush_all_unsent(anjay_observe_connection_entry_t *conn);
 
 static void flush_send_queue_job(avs_sched_t *sched, const void *conn_ptr) {
     anjay_t *anjay_locked = _anjay_get_from_sched(sched);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     anjay_observe_connection_entry_t *conn =
             *(anjay_observe_connection_entry_t *const *) conn_ptr;
-    if (conn && conn->unsent
-            && !avs_coap_exchange_id_valid(conn->notify_exchange_id)
-            && _anjay_connection_ready_for_outgoing_message(conn->conn_ref)
-            && _anjay_connection_get_online_socket(conn->conn_ref)) {
-        flush_next_unsent(conn);
+    if (conn) {
+        flush_all_unsent(conn);
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
@@ -982,8 +1371,13 @@ static anjay_uri_path_t get_response_path(anjay_observation_value_t *value) {
     anjay_observation_t *observation = value->ref;
 #    ifdef ANJAY_WITH_LWM2M11
     if (observation->action == ANJAY_ACTION_READ_COMPOSITE) {
-        return get_composite_root_path(cast_to_const_batch_array(value->values),
-                                       observation->paths_count);
+        anjay_uri_path_t prefix_buf = MAKE_ROOT_PATH();
+        const anjay_uri_path_t *prefix_ptr = NULL;
+        for (size_t i = 0; i < observation->paths_count; ++i) {
+            _anjay_batch_update_common_path_prefix(&prefix_ptr, &prefix_buf,
+                                                   value->values[i].batch);
+        }
+        return prefix_buf;
     }
 #    endif // ANJAY_WITH_LWM2M11
     return observation->paths[0];
@@ -996,55 +1390,22 @@ static int write_notify_payload(size_t payload_offset,
                                 void *conn_) {
     anjay_observe_connection_entry_t *conn =
             (anjay_observe_connection_entry_t *) conn_;
-    if (payload_offset != conn->serialization_state.expected_offset) {
+    if (payload_offset > conn->serialization_state.payload_size) {
         anjay_log(DEBUG,
-                  _("Server requested unexpected chunk of payload (expected "
-                    "offset ") "%u" _(", got ") "%u" _(")"),
-                  (unsigned) conn->serialization_state.expected_offset,
+                  _("Server requested unexpected chunk of payload (payload "
+                    "size ") "%u" _(", got offset ") "%u",
+                  (unsigned) conn->serialization_state.payload_size,
                   (unsigned) payload_offset);
         return -1;
     }
-
-    anjay_unlocked_t *anjay = _anjay_from_server(conn->conn_ref.server);
-    anjay_observation_value_t *value = conn->unsent;
-    anjay_observation_t *observation = value->ref;
-
-    char *write_ptr = (char *) payload_buf;
-    const char *end_ptr = write_ptr + payload_buf_size;
-    while (true) {
-        size_t bytes_read;
-        if (avs_is_err(avs_stream_read(conn->serialization_state.membuf_stream,
-                                       &bytes_read, NULL, write_ptr,
-                                       (size_t) (end_ptr - write_ptr)))) {
-            return -1;
-        }
-        write_ptr += bytes_read;
-        if (write_ptr >= end_ptr || !conn->serialization_state.out_ctx) {
-            break;
-        }
-        // NOTE: Access Control permissions have been checked during the
-        // read_as_batch() stage, so we're "spoofing" ANJAY_SSID_BOOTSTRAP
-        // as the permissions are checked now
-        int result = _anjay_batch_data_output_entry(
-                anjay, value->values[conn->serialization_state.curr_value_idx],
-                ANJAY_SSID_BOOTSTRAP,
-                conn->serialization_state.serialization_time,
-                &conn->serialization_state.output_state,
-                conn->serialization_state.out_ctx);
-        if (!result && !conn->serialization_state.output_state) {
-            ++conn->serialization_state.curr_value_idx;
-            if (conn->serialization_state.curr_value_idx
-                    >= observation->paths_count) {
-                result = _anjay_output_ctx_destroy_and_process_result(
-                        &conn->serialization_state.out_ctx, result);
-            }
-        }
-        if (result) {
-            return result;
-        }
+    *out_payload_chunk_size =
+            AVS_MIN(payload_buf_size,
+                    conn->serialization_state.payload_size - payload_offset);
+    if (*out_payload_chunk_size) {
+        memcpy(payload_buf,
+               conn->serialization_state.payload + payload_offset,
+               *out_payload_chunk_size);
     }
-    *out_payload_chunk_size = (size_t) (write_ptr - (char *) payload_buf);
-    conn->serialization_state.expected_offset += *out_payload_chunk_size;
     return 0;
 }
 
@@ -1069,6 +1430,30 @@ initial_response_details(anjay_unlocked_t *anjay,
             anjay, request, requires_hierarchical_format, lwm2m_version);
 }
 
+/**
+ * Serializes @p batch as a part of a payload. The same @p serialization_time
+ * shall be used for all batches within a single payload, so that relative
+ * timestamps are consistent.
+ */
+static int output_observed_batch(anjay_unlocked_t *anjay,
+                                 const anjay_batch_t *batch,
+                                 avs_time_duration_t timestamp_shift,
+                                 avs_time_real_t serialization_time,
+                                 anjay_unlocked_output_ctx_t *out_ctx) {
+    const anjay_batch_data_output_state_t *state = NULL;
+    int result;
+    do {
+        // NOTE: Access Control permissions have been checked during the
+        // read_as_batch() stage, so we're "spoofing" ANJAY_SSID_BOOTSTRAP
+        // as the permissions are checked now
+        result = _anjay_batch_data_output_entry(anjay, batch, timestamp_shift,
+                                                ANJAY_SSID_BOOTSTRAP,
+                                                serialization_time, &state,
+                                                out_ctx);
+    } while (!result && state);
+    return result;
+}
+
 static int send_initial_response(anjay_unlocked_t *anjay,
                                  const anjay_msg_details_t *details,
                                  const anjay_request_t *request,
@@ -1092,12 +1477,10 @@ static int send_initial_response(anjay_unlocked_t *anjay,
     int result =
             _anjay_output_dynamic_construct(&out_ctx, notify_stream, &root_path,
                                             details->format, request->action);
+    const avs_time_real_t serialization_time = avs_time_real_now();
     for (size_t i = 0; !result && i < values_count; ++i) {
-        // NOTE: Access Control permissions have been checked during the
-        // read_as_batch() stage, so we're "spoofing" ANJAY_SSID_BOOTSTRAP
-        // as the permissions are checked now
-        result = _anjay_batch_data_output(anjay, values[i],
-                                          ANJAY_SSID_BOOTSTRAP, out_ctx);
+        result = output_observed_batch(anjay, values[i], AVS_TIME_DURATION_ZERO,
+                                       serialization_time, out_ctx);
     }
     return _anjay_output_ctx_destroy_and_process_result(&out_ctx, result);
 }
@@ -1138,6 +1521,86 @@ static int read_observation_path(anjay_unlocked_t *anjay,
     return result;
 }
 
+static void read_cache_cleanup_job(avs_sched_t *sched, const void *dummy) {
+    (void) dummy;
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    _anjay_observe_read_cache_clear(&anjay->observe);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+static void read_cache_insert(anjay_unlocked_t *anjay,
+                              const anjay_uri_path_t *path,
+                              anjay_request_action_t action,
+                              anjay_ssid_t ac_context,
+                              const anjay_batch_t *value) {
+    // The cache is dropped by a job that is scheduled to run immediately, i.e.
+    // after all the jobs (including other observation triggers) that are
+    // already due. Failure to cache the value is not an error.
+    if (!anjay->observe.read_cache_cleanup_handle
+            && AVS_SCHED_NOW(anjay->sched,
+                             &anjay->observe.read_cache_cleanup_handle,
+                             read_cache_cleanup_job, NULL, 0)) {
+        return;
+    }
+    AVS_LIST(anjay_observe_read_cache_entry_t) entry =
+            AVS_LIST_NEW_ELEMENT(anjay_observe_read_cache_entry_t);
+    if (!entry) {
+        return;
+    }
+    if (!(entry->value = _anjay_batch_acquire(value))) {
+        AVS_LIST_DELETE(&entry);
+        return;
+    }
+    entry->path = *path;
+    entry->action = action;
+    entry->ac_context = ac_context;
+    AVS_LIST_INSERT(&anjay->observe.read_cache, entry);
+}
+
+/**
+ * Works like read_observation_path(), but reuses values already read for
+ * other observations during the same scheduler run, if their path, action and
+ * Access Control context are the same.
+ */
+static int read_observation_path_cached(anjay_unlocked_t *anjay,
+                                        const anjay_uri_path_t *path,
+                                        anjay_request_action_t action,
+                                        anjay_ssid_t connection_ssid,
+                                        const avs_time_real_t *timestamp,
+                                        anjay_batch_t **out_batch) {
+    anjay_ssid_t ac_context = connection_ssid;
+    if (connection_ssid != ANJAY_SSID_BOOTSTRAP
+            && !_anjay_access_control_in_effect(anjay)) {
+        ac_context = ANJAY_SSID_ANY;
+    }
+    AVS_LIST(anjay_observe_read_cache_entry_t) entry;
+    AVS_LIST_FOREACH(entry, anjay->observe.read_cache) {
+        if (entry->action == action && entry->ac_context == ac_context
+                && _anjay_uri_path_equal(&entry->path, path)) {
+            if (!(*out_batch = _anjay_batch_acquire(entry->value))) {
+                return -1;
+            }
+            ++anjay->observe.read_cache_saved_reads;
+            return 0;
+        }
+    }
+    int result = read_observation_path(anjay, path, action, connection_ssid,
+                                       timestamp, out_batch);
+    if (!result) {
+        read_cache_insert(anjay, path, action, ac_context, *out_batch);
+    }
+    return result;
+}
+
+uint64_t anjay_get_observe_saved_reads(anjay_t *anjay_locked) {
+    uint64_t result = 0;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    result = anjay->observe.read_cache_saved_reads;
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
 static int read_observation_values(anjay_unlocked_t *anjay,
                                    const paths_arg_t *paths,
                                    anjay_request_action_t action,
@@ -1302,19 +1765,32 @@ void _anjay_observe_gc(anjay_unlocked_t *anjay) {
     }
 }
 
+/**
+ * @param tolerance Duration by which pmax is considered expired earlier. This
+ *                  is the notify_alignment setting when evaluating an aligned
+ *                  pmax trigger, which might have been moved back by up to this
+ *                  duration, and zero otherwise.
+ */
 static bool has_pmax_expired(const anjay_observation_value_t *value,
-                             const anjay_dm_oi_attributes_t *attrs) {
+                             const anjay_dm_oi_attributes_t *attrs,
+                             avs_time_duration_t tolerance) {
     return is_pmax_valid(*attrs)
-           && avs_time_real_diff(avs_time_real_now(), value->timestamp).seconds
+           && avs_time_real_diff(avs_time_real_add(avs_time_real_now(),
+                                                   tolerance),
+                                 value->timestamp)
+                              .seconds
                       >= attrs->max_period;
 }
 
-static bool has_epmin_expired(const anjay_batch_t *value_element,
-                              const anjay_dm_oi_attributes_t *attrs) {
+static bool
+has_epmin_expired(const anjay_observation_value_element_t *value_element,
+                  const anjay_dm_oi_attributes_t *attrs) {
     return attrs->min_eval_period == ANJAY_ATTRIB_INTEGER_NONE
            || avs_time_real_diff(avs_time_real_now(),
-                                 _anjay_batch_get_compilation_time(
-                                         value_element))
+                                 avs_time_real_add(
+                                         _anjay_batch_get_compilation_time(
+                                                 value_element->batch),
+                                         value_element->timestamp_shift))
                               .seconds
                       >= attrs->min_eval_period;
 }
@@ -1434,10 +1910,8 @@ recalculate_conn_trigger_times(anjay_observe_connection_entry_t *conn) {
             conn->next_pmax_trigger = observation->next_pmax_trigger;
         }
         avs_time_real_t next_trigger = avs_time_real_add(
-                real_now,
-                avs_time_monotonic_diff(avs_sched_time(
-                                                &observation->notify_task),
-                                        monotonic_now));
+                real_now, avs_time_monotonic_diff(trigger_time(observation),
+                                                  monotonic_now));
         if (avs_time_real_valid(next_trigger)
                 && !avs_time_real_before(conn->next_trigger, next_trigger)) {
             conn->next_trigger = next_trigger;
@@ -1507,27 +1981,50 @@ static void on_entry_flushed(anjay_observe_connection_entry_t *conn,
 
 static void
 cleanup_serialization_state(anjay_observation_serialization_state_t *state) {
-    _anjay_output_ctx_destroy(&state->out_ctx);
-    avs_stream_cleanup(&state->membuf_stream);
+    avs_free(state->payload);
+    state->payload = NULL;
+    state->payload_size = 0;
 }
 
 static int
 initialize_serialization_state(anjay_observe_connection_entry_t *conn) {
-    assert(!conn->serialization_state.membuf_stream);
-    assert(!conn->serialization_state.out_ctx);
-    memset(&conn->serialization_state, 0, sizeof(conn->serialization_state));
+    assert(!conn->serialization_state.payload);
 
+    anjay_unlocked_t *anjay = _anjay_from_server(conn->conn_ref.server);
     anjay_observation_value_t *value = conn->unsent;
     const anjay_uri_path_t root_path = get_response_path(value);
 
-    if (!(conn->serialization_state.membuf_stream = avs_stream_membuf_create())
-            || _anjay_output_dynamic_construct(
-                       &conn->serialization_state.out_ctx,
-                       conn->serialization_state.membuf_stream, &root_path,
-                       value->details.format, value->ref->action)) {
+    avs_stream_t *membuf_stream = avs_stream_membuf_create();
+    if (!membuf_stream) {
+        anjay_log(ERROR, _("out of memory"));
         return -1;
     }
-    conn->serialization_state.serialization_time = avs_time_real_now();
+    anjay_unlocked_output_ctx_t *out_ctx = NULL;
+    int result = _anjay_output_dynamic_construct(&out_ctx, membuf_stream,
+                                                 &root_path,
+                                                 value->details.format,
+                                                 value->ref->action);
+    const avs_time_real_t serialization_time = avs_time_real_now();
+    for (size_t i = 0; !result && i < value->ref->paths_count; ++i) {
+        result = output_observed_batch(anjay, value->values[i].batch,
+                                       value->values[i].timestamp_shift,
+                                       serialization_time, out_ctx);
+    }
+    void *payload = NULL;
+    size_t payload_size = 0;
+    if (!(result = _anjay_output_ctx_destroy_and_process_result(&out_ctx,
+                                                                result))
+            && avs_is_err(avs_stream_membuf_take_ownership(
+                       membuf_stream, &payload, &payload_size))) {
+        result = -1;
+    }
+    avs_stream_cleanup(&membuf_stream);
+    if (result) {
+        anjay_log(ERROR, _("could not serialize notification payload"));
+        return result;
+    }
+    conn->serialization_state.payload = (char *) payload;
+    conn->serialization_state.payload_size = payload_size;
     return 0;
 }
 
@@ -1621,6 +2118,53 @@ static void flush_next_unsent(anjay_observe_connection_entry_t *conn) {
 #    endif // ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
 }
 
+static bool ready_to_flush(const anjay_observe_connection_entry_t *conn) {
+    return conn->unsent
+           && !avs_coap_exchange_id_valid(conn->notify_exchange_id)
+           && _anjay_connection_ready_for_outgoing_message(conn->conn_ref)
+           && _anjay_connection_get_online_socket(conn->conn_ref);
+}
+
+/**
+ * Sends queued notifications until one of them needs to wait, e.g. for a
+ * Confirmable one to be acknowledged. On CoAP/UDP connections, all of them are
+ * sent as a single batch of datagrams.
+ */
+static void flush_all_unsent(anjay_observe_connection_entry_t *conn) {
+    if (!ready_to_flush(conn)) {
+        return;
+    }
+    anjay_connection_ref_t conn_ref = conn->conn_ref;
+    anjay_unlocked_t *anjay = _anjay_from_server(conn_ref.server);
+#    ifdef WITH_AVS_COAP_UDP
+    avs_coap_ctx_t *batch_coap = NULL;
+    if (_anjay_connection_transport(conn_ref) == ANJAY_SOCKET_TRANSPORT_UDP
+            && !avs_coap_udp_ctx_begin_batch(
+                       _anjay_connection_get_coap(conn_ref))) {
+        batch_coap = _anjay_connection_get_coap(conn_ref);
+    }
+#    endif // WITH_AVS_COAP_UDP
+
+    AVS_LIST(anjay_observation_value_t) flushed;
+    do {
+        flushed = conn->unsent;
+        flush_next_unsent(conn);
+        if (!connection_exists(anjay, conn)) {
+            // the observation got cancelled and the entry deleted
+            break;
+        }
+        // sending a Non-confirmable notification schedules flushing the next
+        // one, which is done right here instead
+        avs_sched_del(&conn->flush_task);
+    } while (conn->unsent != flushed && ready_to_flush(conn));
+
+#    ifdef WITH_AVS_COAP_UDP
+    if (batch_coap && _anjay_connection_get_coap(conn_ref) == batch_coap) {
+        avs_coap_udp_ctx_end_batch(batch_coap);
+    }
+#    endif // WITH_AVS_COAP_UDP
+}
+
 void _anjay_observe_interrupt(anjay_connection_ref_t ref) {
     AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr =
             _anjay_observe_find_connection_state(ref);
@@ -1681,15 +2225,20 @@ int _anjay_observe_sched_flush(anjay_connection_ref_t ref) {
 
 static int
 update_notification_value(anjay_observe_connection_entry_t *conn_state,
-                          anjay_observation_t *observation) {
+                          anjay_observation_t *observation,
+                          bool pmax_trigger_reached) {
     if (is_error_value(newest_value(observation))) {
         return 0;
     }
 
     anjay_unlocked_t *anjay = _anjay_from_server(conn_state->conn_ref.server);
+    const avs_time_duration_t pmax_tolerance =
+            pmax_trigger_reached ? anjay->observe.notify_alignment
+                                 : AVS_TIME_DURATION_ZERO;
     anjay_ssid_t ssid = _anjay_server_ssid(conn_state->conn_ref.server);
     anjay_batch_t **batches = NULL;
     bool should_update_batch = false;
+    int32_t pmin = 0;
     int32_t pmax = -1;
     anjay_dm_con_attr_t con = ANJAY_DM_CON_ATTR_NONE;
 
@@ -1705,18 +2254,18 @@ update_notification_value(anjay_observe_connection_entry_t *conn_state,
     int result = 0;
     for (size_t i = 0; i < observation->paths_count; ++i) {
         anjay_dm_r_attributes_t attrs;
-        if ((result = get_effective_attrs(anjay, &attrs, &observation->paths[i],
-                                          ssid))) {
+        if ((result = get_observed_path_attrs(conn_state, &attrs,
+                                              &observation->paths[i]))) {
             anjay_log(ERROR, _("Could not get attributes of path ") "%s",
                       ANJAY_DEBUG_MAKE_PATH(&observation->paths[i]));
             goto finish;
         }
 
-        if (has_epmin_expired(newest_value(observation)->values[i],
+        if (has_epmin_expired(&newest_value(observation)->values[i],
                               &attrs.common)) {
-            if ((result = read_observation_path(anjay, &observation->paths[i],
-                                                observation->action, ssid,
-                                                &timestamp, &batches[i]))) {
+            if ((result = read_observation_path_cached(
+                         anjay, &observation->paths[i], observation->action,
+                         ssid, &timestamp, &batches[i]))) {
                 anjay_log(ERROR,
                           _("Could not read path ") "%s" _(" for notifying"),
                           ANJAY_DEBUG_MAKE_PATH(&observation->paths[i]));
@@ -1730,20 +2279,22 @@ update_notification_value(anjay_observe_connection_entry_t *conn_state,
                       ANJAY_DEBUG_MAKE_PATH(&observation->paths[i]));
             // Do not even call read_handler, just copy previous value
             if (!(batches[i] = _anjay_batch_acquire(
-                          newest_value(observation)->values[i]))) {
+                          newest_value(observation)->values[i].batch))) {
                 result = -1;
                 goto finish;
             }
         }
 
         if (!should_update_batch
-                && (has_pmax_expired(newest_value(observation), &attrs.common)
+                && (has_pmax_expired(newest_value(observation), &attrs.common,
+                                     pmax_tolerance)
                     || should_update(&observation->paths[i], &attrs,
-                                     newest_value(observation)->values[i],
+                                     newest_value(observation)->values[i].batch,
                                      batches[i]))) {
             should_update_batch = true;
         }
 
+        update_batch_pmin(&pmin, &attrs);
         update_batch_pmax(&pmax, &attrs);
 #    ifdef ANJAY_WITH_CON_ATTR
         con = AVS_MAX(con, attrs.common.con);
@@ -1765,7 +2316,8 @@ update_notification_value(anjay_observe_connection_entry_t *conn_state,
     }
 
     if (!result && pmax >= 0) {
-        schedule_trigger(conn_state, observation, pmax, SCHEDULE_PERIOD_MAX);
+        schedule_trigger(conn_state, observation, pmax, SCHEDULE_PERIOD_MAX,
+                         pmin);
     }
 
 finish:
@@ -1773,14 +2325,15 @@ finish:
     return result;
 }
 
-static void trigger_observe(avs_sched_t *sched, const void *args_) {
-    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    const trigger_observe_args_t *args = (const trigger_observe_args_t *) args_;
+static void trigger_observe(const trigger_observe_args_t *args) {
     assert(args->conn_state);
     assert(args->observation);
+    // If the pmax trigger has been reached, it is what is being handled now
+    const bool pmax_trigger_reached =
+            avs_time_real_valid(args->observation->next_pmax_trigger)
+            && !avs_time_real_before(avs_time_real_now(),
+                                     args->observation->next_pmax_trigger);
     args->observation->next_pmax_trigger = AVS_TIME_REAL_INVALID;
-    recalculate_conn_trigger_times(args->conn_state);
     bool ready_for_notifying =
             _anjay_connection_ready_for_outgoing_message(
                     args->conn_state->conn_ref)
@@ -1796,8 +2349,8 @@ static void trigger_observe(avs_sched_t *sched, const void *args_) {
     } else {
         if (ready_for_notifying
                 || notification_storing_enabled(args->conn_state->conn_ref)) {
-            int result = update_notification_value(args->conn_state,
-                                                   args->observation);
+            int result = update_notification_value(
+                    args->conn_state, args->observation, pmax_trigger_reached);
             if (result) {
                 insert_error(args->conn_state, args->observation, result);
             }
@@ -1808,12 +2361,16 @@ static void trigger_observe(avs_sched_t *sched, const void *args_) {
                                args->conn_state->notify_exchange_id)) {
                 avs_sched_del(&args->conn_state->flush_task);
                 assert(!args->conn_state->flush_task);
+                // if the socket is online, notifications are flushed by
+                // trigger_slot_job() once the whole slot is handled, so that
+                // they are sent together
                 if (_anjay_connection_get_online_socket(
                             args->conn_state->conn_ref)) {
-                    flush_next_unsent(args->conn_state);
-                } else if (_anjay_server_registration_info(
-                                   args->conn_state->conn_ref.server)
-                                   ->queue_mode) {
+                    return;
+                }
+                if (_anjay_server_registration_info(
+                            args->conn_state->conn_ref.server)
+                            ->queue_mode) {
                     _anjay_connection_bring_online(args->conn_state->conn_ref);
                     // once the connection is up, _anjay_observe_sched_flush()
                     // will be called; we're done here
@@ -1824,6 +2381,46 @@ static void trigger_observe(avs_sched_t *sched, const void *args_) {
             }
         }
     }
+}
+
+static void trigger_slot_job(avs_sched_t *sched, const void *slot_ptr) {
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_SORTED_SET_ELEM(anjay_observe_trigger_slot_t) slot =
+            *(AVS_SORTED_SET_ELEM(anjay_observe_trigger_slot_t) const *)
+                    slot_ptr;
+    // The slot is detached so that observations rescheduled for the same
+    // instant while it is being handled get a new slot and a new job
+    AVS_SORTED_SET_DETACH(anjay->observe.trigger_slots, slot);
+    slot->firing = true;
+    while (slot->first) {
+        const trigger_observe_args_t args = {
+            .conn_state = slot->first->conn,
+            .observation = AVS_CONTAINER_OF(slot->first, anjay_observation_t,
+                                            notify_trigger)
+        };
+        args.conn_state->trigger_times_outdated = true;
+        trigger_cancel(args.observation);
+        trigger_observe(&args);
+    }
+    AVS_SORTED_SET_ELEM_DELETE_DETACHED(&slot);
+
+    // Connection entries might have been deleted while handling the slot, so
+    // they are not referenced directly - only marked with a flag
+    AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr =
+            &anjay->observe.connection_entries;
+    while (*conn_ptr) {
+        AVS_LIST(anjay_observe_connection_entry_t) conn = *conn_ptr;
+        if (conn->trigger_times_outdated) {
+            conn->trigger_times_outdated = false;
+            recalculate_conn_trigger_times(conn);
+            flush_all_unsent(conn);
+        }
+        // flushing may delete the entry being flushed, but not any other one
+        if (*conn_ptr == conn) {
+            AVS_LIST_ADVANCE_PTR(&conn_ptr);
+        }
+    }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
 
@@ -1831,9 +2428,7 @@ static anjay_dm_oi_attributes_t
 get_oi_attributes(anjay_observe_connection_entry_t *connection,
                   anjay_observe_path_entry_t *path_entry) {
     anjay_dm_r_attributes_t attrs = ANJAY_DM_R_ATTRIBUTES_EMPTY;
-    if (get_effective_attrs(_anjay_from_server(connection->conn_ref.server),
-                            &attrs, &path_entry->path,
-                            _anjay_server_ssid(connection->conn_ref.server))) {
+    if (get_observed_path_attrs(connection, &attrs, &path_entry->path)) {
         return ANJAY_DM_OI_ATTRIBUTES_EMPTY;
     }
     return attrs.common;
@@ -1852,7 +2447,8 @@ static int notify_path_changed(anjay_observe_connection_entry_t *connection,
         int observation_period = period;
         _anjay_update_ret((int *) result_ptr,
                           schedule_trigger(connection, *ref, observation_period,
-                                           SCHEDULE_PERIOD_MIN));
+                                           SCHEDULE_PERIOD_MIN,
+                                           observation_period));
     }
     return 0;
 }
@@ -1862,86 +2458,60 @@ observe_for_each_matching_clb_t(anjay_observe_connection_entry_t *connection,
                                 anjay_observe_path_entry_t *path_entry,
                                 void *arg);
 
+/**
+ * Calls <c>clb()</c> on all entries in the subtree rooted at <c>node</c>, in
+ * the same order as they are sorted in <c>observed_paths</c> - i.e., children
+ * in ascending order of IDs first, and then the node itself (as the missing
+ * IDs are represented as ANJAY_ID_INVALID, which is the largest value).
+ */
 static int
-observe_for_each_in_bounds(anjay_observe_connection_entry_t *connection,
-                           const anjay_uri_path_t *lower_bound,
-                           const anjay_uri_path_t *upper_bound,
-                           observe_for_each_matching_clb_t *clb,
-                           void *clb_arg) {
-    int retval = 0;
-    AVS_SORTED_SET_ELEM(anjay_observe_path_entry_t) it =
-            AVS_SORTED_SET_LOWER_BOUND(connection->observed_paths,
-                                       path_entry_query(lower_bound));
-    AVS_SORTED_SET_ELEM(anjay_observe_path_entry_t) end =
-            AVS_SORTED_SET_UPPER_BOUND(connection->observed_paths,
-                                       path_entry_query(upper_bound));
-    // if it == NULL, end must also be NULL
-    assert(it || !end);
-
-    for (; it != end; it = AVS_SORTED_SET_ELEM_NEXT(it)) {
-        assert(it);
-        if ((retval = clb(connection, it, clb_arg))) {
+observe_for_each_in_subtree(anjay_observe_connection_entry_t *connection,
+                            anjay_observe_path_node_t *node,
+                            observe_for_each_matching_clb_t *clb,
+                            void *clb_arg) {
+    int retval;
+    for (size_t i = 0; i < node->children_count; ++i) {
+        if ((retval = observe_for_each_in_subtree(
+                     connection, node->children[i], clb, clb_arg))) {
             return retval;
         }
     }
-    return 0;
-}
-
-static int
-observe_for_each_in_wildcard(anjay_observe_connection_entry_t *connection,
-                             const anjay_uri_path_t *specimen_path,
-                             anjay_id_type_t wildcard_level,
-                             observe_for_each_matching_clb_t *clb,
-                             void *clb_arg) {
-    anjay_uri_path_t path = *specimen_path;
-    for (int i = wildcard_level; i < _ANJAY_URI_PATH_MAX_LENGTH; ++i) {
-        path.ids[i] = ANJAY_ID_INVALID;
-        path.ids[i] = ANJAY_ID_INVALID;
+    if (node->entry) {
+        return clb(connection, node->entry, clb_arg);
     }
-    return observe_for_each_in_bounds(connection, &path, &path, clb, clb_arg);
+    return 0;
 }
 
 /**
  * Calls <c>clb()</c> on all registered Observe path entries that match
  * <c>path</c>.
  *
- * This is harder than may seem at the first glance, because both
- * <c>path</c> (the query) and keys of the registered Observe path entries
- * may contain wildcards.
- *
  * An observation may be registered for either of:
  * - A whole object (OID)
  * - A whole object instance (OID+IID)
  * - A specific resource (OID+IID+RID)
  * - A specific resource instance (OID+IID+RID+RIID)
  *
- * Each of these cases needs to be addressed in a slightly different manner.
- *
- * Wildcard representation
- * -----------------------
- * A wildcard for any type of ID is represented as the number 65535. The
- * registered observation entries for any given connection are stored in a
- * sorted tree, with the sort key being (OID, IID, RID, RIID) - in
- * lexicographical order over all elements of that tuple - much like C++11's
- * <c>std::tuple</c> comparison operators.
+ * An entry matches the queried path if either of them is a prefix of the
+ * other. The registered entries for any given connection are indexed in a
+ * prefix tree (<c>observed_paths_index</c>), in which each level corresponds
+ * to a consecutive ID in the path.
  *
  * Example: querying for OID+IID
  * -----------------------------
- * When the queried path is only OID+IID, we actually perform three
- * searches:
- * - the entry for the root path, i.e. (U16_MAX, U16_MAX, U16_MAX, U16_MAX)
- * - the entry for the Object, i.e. (OID, U16_MAX, U16_MAX, U16_MAX)
- * - entries between (OID, IID, 0, 0) and (OID, IID, U16_MAX, U16_MAX), i.e.
- *   entries for the Instance or any Resources or Resource Instances under
- * that Object Instance
+ * When the queried path is only OID+IID, we walk down the tree along the
+ * queried path, visiting:
+ * - the entry for the root path, if any
+ * - the entry for the Object (OID), if any
+ * and then visit the whole subtree rooted at the (OID, IID) node, i.e.
+ * entries for the Instance or any Resources or Resource Instances under that
+ * Object Instance.
  *
- * For paths of different lengths, there will be appropriately more or less
- * wildcard searches. If the search term is the root path, only the final
- * bounded search (between (0, 0, 0, 0) and
- * (U16_MAX, U16_MAX, U16_MAX, U16_MAX)) will be performed. If the search
- * term is OID+IID+RID+RIID, there will be five searches - for parent paths
- * of all lengths up to OID+IID+RID, and the final search for the actual
- * search term path.
+ * The cost is thus proportional to the length of the path and the number of
+ * matching entries, and does not depend on the total number of observed
+ * paths. The order in which entries are visited is the same as the order in
+ * <c>observed_paths</c>: first the parent paths in order of increasing
+ * length, then the matching descendants in lexicographical order.
  */
 static int
 observe_for_each_matching(anjay_observe_connection_entry_t *connection,
@@ -1949,24 +2519,18 @@ observe_for_each_matching(anjay_observe_connection_entry_t *connection,
                           observe_for_each_matching_clb_t *clb,
                           void *clb_arg) {
     int retval = 0;
-    anjay_uri_path_t lower_bound = *path;
-    anjay_uri_path_t upper_bound = *path;
-
+    anjay_observe_path_node_t *node = &connection->observed_paths_index;
     size_t path_length = _anjay_uri_path_length(path);
-    for (size_t i = 0; i < path_length; ++i) {
-        if ((retval = observe_for_each_in_wildcard(
-                     connection, path, (anjay_id_type_t) i, clb, clb_arg))) {
+    for (size_t i = 0; node && i < path_length; ++i) {
+        if (node->entry
+                && (retval = clb(connection, node->entry, clb_arg))) {
             goto finish;
         }
+        node = path_index_find_child(node, path->ids[i]);
     }
-
-    for (size_t i = path_length; i < _ANJAY_URI_PATH_MAX_LENGTH; ++i) {
-        lower_bound.ids[i] = 0;
-        upper_bound.ids[i] = ANJAY_ID_INVALID;
+    if (node) {
+        retval = observe_for_each_in_subtree(connection, node, clb, clb_arg);
     }
-
-    retval = observe_for_each_in_bounds(connection, &lower_bound, &upper_bound,
-                                        clb, clb_arg);
 finish:
     return retval == ANJAY_FOREACH_BREAK ? 0 : retval;
 }
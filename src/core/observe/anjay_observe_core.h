@@ -11,6 +11,7 @@
 #define ANJAY_OBSERVE_CORE_H
 
 #include <avsystem/commons/avs_persistence.h>
+#include <avsystem/commons/avs_sched.h>
 #include <avsystem/commons/avs_sorted_set.h>
 
 #include "../anjay_servers_private.h"
@@ -22,20 +23,58 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 typedef struct anjay_observation_struct anjay_observation_t;
 typedef struct anjay_observe_connection_entry_struct
         anjay_observe_connection_entry_t;
+typedef struct anjay_observe_trigger_slot_struct anjay_observe_trigger_slot_t;
 
 typedef enum {
     NOTIFY_QUEUE_UNLIMITED,
     NOTIFY_QUEUE_DROP_OLDEST
 } notify_queue_limit_mode_t;
 
+/**
+ * Value read while evaluating an observation, reusable by other observations
+ * evaluated during the same scheduler run.
+ */
+typedef struct {
+    anjay_uri_path_t path;
+    anjay_request_action_t action;
+    // SSID of the server for which the value has been read if Access Control
+    // is in effect, or ANJAY_SSID_ANY if the value is valid for all servers
+    anjay_ssid_t ac_context;
+    anjay_batch_t *value;
+} anjay_observe_read_cache_entry_t;
+
 typedef struct {
     AVS_LIST(anjay_observe_connection_entry_t) connection_entries;
     bool confirmable_notifications;
+    // Alignment of pmax triggers, or zero if they are not aligned
+    avs_time_duration_t notify_alignment;
+
+    // Whether effective attributes are cached in observed path entries;
+    // cached values are valid only if their generation is equal to
+    // effective_attrs_generation
+    bool effective_attrs_cache_enabled;
+    uint64_t effective_attrs_generation;
+
+    // Observations due to be evaluated, grouped by trigger instant; created
+    // lazily when the first trigger is scheduled
+    AVS_SORTED_SET(anjay_observe_trigger_slot_t) trigger_slots;
+
+    AVS_LIST(anjay_observe_read_cache_entry_t) read_cache;
+    avs_sched_handle_t read_cache_cleanup_handle;
+    uint64_t read_cache_saved_reads;
 
     notify_queue_limit_mode_t notify_queue_limit_mode;
     size_t notify_queue_limit;
 } anjay_observe_state_t;
 
+typedef struct {
+    anjay_batch_t *batch;
+    // Shift to apply to all valid timestamps of batch entries. Non-zero if the
+    // batch has been reused from a previous value equal to the actual one, see
+    // _anjay_batch_values_shifted().
+    avs_time_duration_t timestamp_shift;
+} anjay_observation_value_element_t;
+
 typedef struct {
     anjay_observation_t *const ref;
     anjay_msg_details_t details;
@@ -47,17 +86,32 @@ typedef struct {
     // corresponding to ref->paths[i]. Note that each values[i] element might
     // contain multiple entries itself if ref->paths[i] is hierarchical (e.g.
     // Object Instance).
-    anjay_batch_t *values[];
+    anjay_observation_value_element_t values[];
 } anjay_observation_value_t;
 
 #ifdef ANJAY_WITH_OBSERVE
 
 void _anjay_observe_init(anjay_observe_state_t *observe,
                          bool confirmable_notifications,
-                         size_t stored_notification_limit);
+                         size_t stored_notification_limit,
+                         avs_time_duration_t notify_alignment,
+                         bool cache_effective_attrs);
 
 void _anjay_observe_cleanup(anjay_observe_state_t *observe);
 
+/**
+ * Drops all values cached for reuse by observations evaluated during the
+ * current scheduler run. Needs to be called whenever the data model might have
+ * changed.
+ */
+void _anjay_observe_read_cache_clear(anjay_observe_state_t *observe);
+
+/**
+ * Drops all cached effective attributes of observed paths. Needs to be called
+ * whenever attributes might have changed.
+ */
+void _anjay_observe_attrs_cache_invalidate(anjay_observe_state_t *observe);
+
 void _anjay_observe_gc(anjay_unlocked_t *anjay);
 
 int _anjay_observe_handle(anjay_connection_ref_t ref,
@@ -98,6 +152,8 @@ _anjay_observe_status(anjay_unlocked_t *anjay,
 
 #    define _anjay_observe_init(...) ((void) 0)
 #    define _anjay_observe_cleanup(...) ((void) 0)
+#    define _anjay_observe_read_cache_clear(...) ((void) 0)
+#    define _anjay_observe_attrs_cache_invalidate(...) ((void) 0)
 #    define _anjay_observe_gc(...) ((void) 0)
 #    define _anjay_observe_interrupt(...) ((void) 0)
 #    define _anjay_observe_invalidate(...) ((void) 0)
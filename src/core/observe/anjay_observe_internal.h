@@ -18,12 +18,40 @@
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
+/**
+ * Membership of an observation in one of the trigger slots. Observations that
+ * are scheduled in the same slot form a doubly linked list, in the order in
+ * which they have been scheduled.
+ */
+typedef struct anjay_observe_trigger_struct {
+    // Slot in which the observation is scheduled, or NULL if none
+    anjay_observe_trigger_slot_t *slot;
+    anjay_observe_connection_entry_t *conn;
+    struct anjay_observe_trigger_struct *prev;
+    struct anjay_observe_trigger_struct *next;
+} anjay_observe_trigger_t;
+
+/**
+ * Group of observations that are due to be evaluated at the same instant.
+ * Each slot is handled by a single scheduler job, regardless of the number of
+ * observations in it.
+ */
+struct anjay_observe_trigger_slot_struct {
+    avs_time_monotonic_t instant;
+    avs_sched_handle_t job;
+    // true while the job is being executed - the slot is then detached from
+    // anjay_observe_state_t::trigger_slots
+    bool firing;
+    anjay_observe_trigger_t *first;
+    anjay_observe_trigger_t *last;
+};
+
 struct anjay_observation_struct {
     const avs_coap_token_t token;
 
     const anjay_request_action_t action;
 
-    avs_sched_handle_t notify_task;
+    anjay_observe_trigger_t notify_trigger;
     avs_time_real_t last_confirmable;
     avs_time_real_t next_pmax_trigger;
 
@@ -49,15 +77,40 @@ typedef struct {
     // List of observations (pointers to elements inside
     // anjay_observe_connection_entry_t::observations) that include "path"
     AVS_LIST(AVS_SORTED_SET_ELEM(anjay_observation_t)) refs;
+
+    // Cached effective attributes of "path"; valid only if
+    // effective_attrs_generation is equal to
+    // anjay_observe_state_t::effective_attrs_generation
+    anjay_dm_r_attributes_t effective_attrs;
+    uint64_t effective_attrs_generation;
 } anjay_observe_path_entry_t;
 
+/**
+ * Node of the prefix tree that indexes observed_paths by consecutive IDs
+ * (OID, IID, RID, RIID). Allows finding all entries that are either prefixes
+ * or descendants of a given path in time proportional to the number of such
+ * entries, rather than to the total number of observed paths.
+ */
+typedef struct anjay_observe_path_node_struct {
+    anjay_id_t id;
+
+    // Entry for the path represented by this node, or NULL if there is none
+    // and the node only exists as an ancestor of other entries
+    anjay_observe_path_entry_t *entry;
+
+    // Child nodes, sorted by id
+    struct anjay_observe_path_node_struct **children;
+    size_t children_count;
+    size_t children_capacity;
+} anjay_observe_path_node_t;
+
 typedef struct {
-    avs_stream_t *membuf_stream;
-    anjay_unlocked_output_ctx_t *out_ctx;
-    size_t expected_offset;
-    avs_time_real_t serialization_time;
-    size_t curr_value_idx;
-    const anjay_batch_data_output_state_t *output_state;
+    // Payload of the notification being delivered, serialized once when the
+    // exchange is started; the CoAP layer may request chunks of it at
+    // arbitrary offsets (e.g. during BLOCK2 transfers with renegotiated block
+    // size), which are then just copied out of this buffer
+    char *payload;
+    size_t payload_size;
 } anjay_observation_serialization_state_t;
 
 struct anjay_observe_connection_entry_struct {
@@ -65,11 +118,18 @@ struct anjay_observe_connection_entry_struct {
 
     AVS_SORTED_SET(anjay_observation_t) observations;
     AVS_SORTED_SET(anjay_observe_path_entry_t) observed_paths;
+    // Prefix tree index of observed_paths; the root node represents the root
+    // path
+    anjay_observe_path_node_t observed_paths_index;
     avs_sched_handle_t flush_task;
     avs_coap_exchange_id_t notify_exchange_id;
     anjay_observation_serialization_state_t serialization_state;
     avs_time_real_t next_trigger;
     avs_time_real_t next_pmax_trigger;
+    // set by trigger_slot_job() for connections that had observations in the
+    // slot being handled; next_trigger and next_pmax_trigger are recalculated,
+    // and queued notifications flushed, only for such connections
+    bool trigger_times_outdated;
 
     AVS_LIST(anjay_observation_value_t) unsent;
     // pointer to the last element of unsent
@@ -94,6 +154,7 @@ int _anjay_observe_token_cmp(const avs_coap_token_t *left,
                              const avs_coap_token_t *right);
 int _anjay_observation_cmp(const void *left, const void *right);
 int _anjay_observe_path_entry_cmp(const void *left, const void *right);
+int _anjay_observe_trigger_slot_cmp(const void *left, const void *right);
 
 int _anjay_observe_add_to_observed_paths(
         anjay_observe_connection_entry_t *conn,
@@ -7,6 +7,19 @@
  * See the attached LICENSE file for details.
  */
 
+// NOTE: sendmmsg() requires _GNU_SOURCE to be defined before any system header
+// is included, so we can't use anjay_init.h first here.
+#include <anjay/anjay_config.h>
+
+#ifdef ANJAY_WITH_UDP_SENDMMSG
+#    ifndef _GNU_SOURCE
+#        define _GNU_SOURCE
+#    endif // _GNU_SOURCE
+#    include <errno.h>
+#    include <string.h>
+#    include <sys/socket.h>
+#endif // ANJAY_WITH_UDP_SENDMMSG
+
 #include <anjay_init.h>
 
 #include <avsystem/commons/avs_errno.h>
@@ -167,6 +180,50 @@ static int ensure_tcp_coap_context(anjay_unlocked_t *anjay,
 #endif // defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
 
 #ifdef WITH_AVS_COAP_UDP
+#    ifdef ANJAY_WITH_UDP_SENDMMSG
+#        define UDP_SENDMMSG_CHUNK_SIZE 16
+
+static avs_error_t send_udp_batch(avs_net_socket_t *socket,
+                                  const avs_coap_udp_datagram_t *datagrams,
+                                  size_t count,
+                                  size_t *out_sent,
+                                  void *connection_) {
+    const anjay_server_connection_t *connection =
+            (const anjay_server_connection_t *) connection_;
+    const int *fd = (const int *) avs_net_socket_get_system(socket);
+    *out_sent = 0;
+    // DTLS records can only be created by the socket layer, so only datagrams
+    // of plain UDP connections can be written to the system socket directly;
+    // everything else is left to avs_net_socket_send()
+    if (connection->stateful || !fd) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+
+    while (*out_sent < count) {
+        struct mmsghdr msgs[UDP_SENDMMSG_CHUNK_SIZE];
+        struct iovec iovecs[UDP_SENDMMSG_CHUNK_SIZE];
+        const size_t chunk_size =
+                AVS_MIN(count - *out_sent, AVS_ARRAY_SIZE(msgs));
+        memset(msgs, 0, sizeof(msgs));
+        for (size_t i = 0; i < chunk_size; ++i) {
+            const avs_coap_udp_datagram_t *datagram = &datagrams[*out_sent + i];
+            iovecs[i].iov_base = (void *) (intptr_t) datagram->data;
+            iovecs[i].iov_len = datagram->size;
+            // the socket is connected, so no destination address is needed
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int result = sendmmsg(*fd, msgs, (unsigned) chunk_size, 0);
+        if (result <= 0) {
+            anjay_log(DEBUG, _("sendmmsg() failed: ") "%d", errno);
+            return avs_errno(AVS_EIO);
+        }
+        *out_sent += (size_t) result;
+    }
+    return AVS_OK;
+}
+#    endif // ANJAY_WITH_UDP_SENDMMSG
+
 static int ensure_udp_coap_context(anjay_unlocked_t *anjay,
                                    anjay_server_connection_t *connection) {
     if (!connection->coap_ctx) {
@@ -178,6 +235,12 @@ static int ensure_udp_coap_context(anjay_unlocked_t *anjay,
             anjay_log(ERROR, _("could not create CoAP/UDP context"));
             return -1;
         }
+        avs_coap_set_incoming_packets_drain_limit(
+                connection->coap_ctx, anjay->udp_incoming_packets_drain_limit);
+#    ifdef ANJAY_WITH_UDP_SENDMMSG
+        avs_coap_udp_ctx_set_batch_send_handler(connection->coap_ctx,
+                                                send_udp_batch, connection);
+#    endif // ANJAY_WITH_UDP_SENDMMSG
     }
     return 0;
 }
@@ -363,6 +363,9 @@ avs_error_t _anjay_server_connection_internal_bring_online(
         return AVS_OK;
     }
 
+    // both outcomes below change the online state of the socket
+    _anjay_socket_set_changed(server->anjay);
+
     bool session_resumed;
     avs_error_t err = AVS_OK;
     if (avs_is_err((err = def->connect_socket(server->anjay, connection)))) {
@@ -498,6 +501,7 @@ recreate_socket(anjay_unlocked_t *anjay,
                 && connection->conn_socket_) {
             avs_net_socket_shutdown(connection->conn_socket_);
             avs_net_socket_close(connection->conn_socket_);
+            _anjay_socket_set_changed(anjay);
         }
         // defined(ANJAY_WITH_CORE_PERSISTENCE)
     }
@@ -413,6 +413,7 @@ void _anjay_connection_suspend(anjay_connection_ref_t conn_ref) {
     if (socket) {
         avs_net_socket_shutdown(socket);
         avs_net_socket_close(socket);
+        _anjay_socket_set_changed(conn_ref.server->anjay);
     }
 }
 
@@ -69,7 +69,7 @@ ac_instance_reset(anjay_unlocked_t *anjay, obj_ptr_t obj_ptr, anjay_iid_t iid) {
     inst->has_acl = false;
     inst->owner = 0;
     access_control->needs_validation = true;
-    _anjay_access_control_mark_modified(access_control);
+    _anjay_access_control_mark_instance_modified(access_control, iid);
     return 0;
 }
 
@@ -101,7 +101,7 @@ static int ac_instance_create(anjay_unlocked_t *anjay,
         AVS_LIST_CLEAR(&new_instance);
     }
     access_control->needs_validation = true;
-    _anjay_access_control_mark_modified(access_control);
+    _anjay_access_control_mark_instance_modified(access_control, iid);
     return retval;
 }
 
@@ -120,7 +120,7 @@ static int ac_instance_remove(anjay_unlocked_t *anjay,
             }
             AVS_LIST_CLEAR(&(*it)->acl);
             AVS_LIST_DELETE(it);
-            _anjay_access_control_mark_modified(access_control);
+            _anjay_access_control_mark_instance_modified(access_control, iid);
             return 0;
         } else if ((*it)->iid > iid) {
             break;
@@ -249,7 +249,7 @@ static int ac_resource_write(anjay_unlocked_t *anjay,
         }
         inst->target.oid = (anjay_oid_t) oid;
         access_control->needs_validation = true;
-        _anjay_access_control_mark_modified(access_control);
+        _anjay_access_control_mark_instance_modified(access_control, iid);
         return 0;
     }
     case ANJAY_DM_RID_ACCESS_CONTROL_OIID: {
@@ -263,7 +263,7 @@ static int ac_resource_write(anjay_unlocked_t *anjay,
         }
         inst->target.iid = (anjay_iid_t) oiid;
         access_control->needs_validation = true;
-        _anjay_access_control_mark_modified(access_control);
+        _anjay_access_control_mark_instance_modified(access_control, iid);
         return 0;
     }
     case ANJAY_DM_RID_ACCESS_CONTROL_ACL: {
@@ -271,7 +271,7 @@ static int ac_resource_write(anjay_unlocked_t *anjay,
         if (!retval) {
             inst->has_acl = true;
             access_control->needs_validation = true;
-            _anjay_access_control_mark_modified(access_control);
+            _anjay_access_control_mark_instance_modified(access_control, iid);
         }
         return retval;
     }
@@ -286,7 +286,7 @@ static int ac_resource_write(anjay_unlocked_t *anjay,
         }
         inst->owner = (anjay_ssid_t) ssid;
         access_control->needs_validation = true;
-        _anjay_access_control_mark_modified(access_control);
+        _anjay_access_control_mark_instance_modified(access_control, iid);
         return 0;
     }
     default:
@@ -312,7 +312,7 @@ static int ac_resource_reset(anjay_unlocked_t *anjay,
     AVS_LIST_CLEAR(&inst->acl);
     inst->has_acl = true;
     access_control->needs_validation = true;
-    _anjay_access_control_mark_modified(access_control);
+    _anjay_access_control_mark_instance_modified(access_control, iid);
     return 0;
 }
 
@@ -451,6 +451,10 @@ static int ac_transaction_commit(anjay_unlocked_t *anjay, obj_ptr_t obj_ptr) {
     _anjay_access_control_clear_state(&ac->saved_state);
     ac->needs_validation = false;
     ac->in_transaction = false;
+    if (_anjay_access_control_compiled_acl_update(ac)) {
+        ac_log(DEBUG, _("could not update compiled ACL, will retry on "
+                        "next lookup"));
+    }
     return 0;
 }
 
@@ -464,6 +468,7 @@ static int ac_transaction_rollback(anjay_unlocked_t *anjay, obj_ptr_t obj_ptr) {
     ac->needs_validation = false;
     ac->in_transaction = false;
     ac->last_accessed_instance = NULL;
+    _anjay_access_control_compiled_acl_invalidate(ac);
     return 0;
 }
 
@@ -471,6 +476,7 @@ static void ac_delete(void *access_control_) {
     access_control_t *access_control = (access_control_t *) access_control_;
     _anjay_access_control_clear_state(&access_control->current);
     _anjay_access_control_clear_state(&access_control->saved_state);
+    _anjay_access_control_compiled_acl_cleanup(&access_control->compiled_acl);
     // NOTE: access_control itself will be freed when cleaning the objects list
 }
 
@@ -143,6 +143,7 @@ restore(anjay_unlocked_t *anjay, access_control_t *ac, avs_stream_t *in) {
     _anjay_access_control_clear_state(&ac->current);
     ac->current = state;
     ac->last_accessed_instance = NULL;
+    _anjay_access_control_compiled_acl_invalidate(ac);
     return AVS_OK;
 }
 
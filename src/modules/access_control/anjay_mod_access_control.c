@@ -12,6 +12,12 @@
 #ifdef ANJAY_WITH_MODULE_ACCESS_CONTROL
 
 #    include <inttypes.h>
+#    include <stdlib.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_memory.h>
+
+#    include <anjay_modules/anjay_access_utils.h>
 
 #    include "anjay_mod_access_control.h"
 
@@ -69,6 +75,281 @@ error:
     return -1;
 }
 
+//// COMPILED ACL //////////////////////////////////////////////////////////////
+void _anjay_access_control_compiled_acl_cleanup(ac_compiled_acl_t *compiled) {
+    for (size_t i = 0; i < compiled->targets_count; ++i) {
+        avs_free(compiled->targets[i].acl);
+    }
+    avs_free(compiled->targets);
+    AVS_LIST_CLEAR(&compiled->dirty_iids);
+    memset(compiled, 0, sizeof(*compiled));
+}
+
+static int compiled_target_cmp(const void *left_, const void *right_) {
+    const ac_compiled_target_t *left = (const ac_compiled_target_t *) left_;
+    const ac_compiled_target_t *right = (const ac_compiled_target_t *) right_;
+    if (left->target_oid != right->target_oid) {
+        return left->target_oid < right->target_oid ? -1 : 1;
+    }
+    if (left->target_iid != right->target_iid) {
+        return left->target_iid < right->target_iid ? -1 : 1;
+    }
+    return left->ac_iid < right->ac_iid ? -1 : left->ac_iid > right->ac_iid;
+}
+
+static int acl_entry_ssid_cmp(const void *left_, const void *right_) {
+    anjay_ssid_t left = ((const acl_entry_t *) left_)->ssid;
+    anjay_ssid_t right = ((const acl_entry_t *) right_)->ssid;
+    return left < right ? -1 : left > right;
+}
+
+static int compile_target(ac_compiled_target_t *out,
+                          access_control_instance_t *inst) {
+    assert(_anjay_access_control_target_iid_valid(inst->target.iid));
+    *out = (ac_compiled_target_t) {
+        .target_oid = inst->target.oid,
+        .target_iid = (anjay_iid_t) inst->target.iid,
+        .ac_iid = inst->iid,
+        .owner = inst->owner
+    };
+    size_t acl_count = inst->has_acl ? AVS_LIST_SIZE(inst->acl) : 0;
+    if (!acl_count) {
+        return 0;
+    }
+    if (!(out->acl = (acl_entry_t *) avs_malloc(acl_count
+                                                * sizeof(*out->acl)))) {
+        ac_log(ERROR, _("out of memory"));
+        return -1;
+    }
+    AVS_LIST(acl_entry_t) entry;
+    AVS_LIST_FOREACH(entry, inst->acl) {
+        out->acl[out->acl_count++] = *entry;
+    }
+    if (out->acl_count > 1) {
+        qsort(out->acl, out->acl_count, sizeof(*out->acl), acl_entry_ssid_cmp);
+    }
+    return 0;
+}
+
+static int compiled_acl_rebuild(access_control_t *ac) {
+    size_t targets_count = 0;
+    AVS_LIST(access_control_instance_t) inst;
+    AVS_LIST_FOREACH(inst, ac->current.instances) {
+        if (!_anjay_access_control_target_iid_valid(inst->target.iid)) {
+            // such an instance would make the data model based lookup fail,
+            // so let it handle this case
+            return -1;
+        }
+        ++targets_count;
+    }
+
+    ac_compiled_acl_t compiled = {
+        .valid = true
+    };
+    if (targets_count
+            && !(compiled.targets = (ac_compiled_target_t *) avs_malloc(
+                         targets_count * sizeof(*compiled.targets)))) {
+        ac_log(ERROR, _("out of memory"));
+        return -1;
+    }
+    AVS_LIST_FOREACH(inst, ac->current.instances) {
+        if (compile_target(&compiled.targets[compiled.targets_count], inst)) {
+            _anjay_access_control_compiled_acl_cleanup(&compiled);
+            return -1;
+        }
+        ++compiled.targets_count;
+    }
+    if (targets_count > 1) {
+        qsort(compiled.targets, targets_count, sizeof(*compiled.targets),
+              compiled_target_cmp);
+    }
+
+    _anjay_access_control_compiled_acl_cleanup(&ac->compiled_acl);
+    ac->compiled_acl = compiled;
+    return 0;
+}
+
+static size_t compiled_acl_insert_position(const ac_compiled_acl_t *compiled,
+                                           const ac_compiled_target_t *target) {
+    size_t begin = 0;
+    size_t end = compiled->targets_count;
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        if (compiled_target_cmp(&compiled->targets[mid], target) < 0) {
+            begin = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    return begin;
+}
+
+static int compiled_acl_update_instance(access_control_t *ac,
+                                        anjay_iid_t ac_iid) {
+    ac_compiled_acl_t *compiled = &ac->compiled_acl;
+    AVS_LIST(access_control_instance_t) inst;
+    AVS_LIST_FOREACH(inst, ac->current.instances) {
+        if (inst->iid >= ac_iid) {
+            break;
+        }
+    }
+    if (inst && inst->iid != ac_iid) {
+        inst = NULL;
+    }
+
+    ac_compiled_target_t new_target = { 0 };
+    if (inst) {
+        if (!_anjay_access_control_target_iid_valid(inst->target.iid)
+                || compile_target(&new_target, inst)) {
+            return -1;
+        }
+        // make room for the new entry before modifying anything, so that the
+        // table stays consistent on failure
+        ac_compiled_target_t *targets = (ac_compiled_target_t *) avs_realloc(
+                compiled->targets,
+                (compiled->targets_count + 1) * sizeof(*targets));
+        if (!targets) {
+            ac_log(ERROR, _("out of memory"));
+            avs_free(new_target.acl);
+            return -1;
+        }
+        compiled->targets = targets;
+    }
+
+    for (size_t i = 0; i < compiled->targets_count; ++i) {
+        if (compiled->targets[i].ac_iid == ac_iid) {
+            avs_free(compiled->targets[i].acl);
+            memmove(&compiled->targets[i], &compiled->targets[i + 1],
+                    (compiled->targets_count - i - 1)
+                            * sizeof(*compiled->targets));
+            --compiled->targets_count;
+            break;
+        }
+    }
+
+    if (inst) {
+        size_t pos = compiled_acl_insert_position(compiled, &new_target);
+        memmove(&compiled->targets[pos + 1], &compiled->targets[pos],
+                (compiled->targets_count - pos) * sizeof(*compiled->targets));
+        compiled->targets[pos] = new_target;
+        ++compiled->targets_count;
+    }
+    return 0;
+}
+
+int _anjay_access_control_compiled_acl_update(access_control_t *ac) {
+    if (!ac->compiled_acl.valid) {
+        return compiled_acl_rebuild(ac);
+    }
+    while (ac->compiled_acl.dirty_iids) {
+        int result =
+                compiled_acl_update_instance(ac, *ac->compiled_acl.dirty_iids);
+        AVS_LIST_DELETE(&ac->compiled_acl.dirty_iids);
+        if (result) {
+            _anjay_access_control_compiled_acl_invalidate(ac);
+            return result;
+        }
+    }
+    return 0;
+}
+
+void _anjay_access_control_mark_instance_modified(access_control_t *repr,
+                                                  anjay_iid_t iid) {
+    repr->current.modified_since_persist = true;
+    if (!repr->compiled_acl.valid) {
+        // the whole table will be rebuilt anyway
+        return;
+    }
+    AVS_LIST(anjay_iid_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &repr->compiled_acl.dirty_iids) {
+        if (**it == iid) {
+            return;
+        } else if (**it > iid) {
+            break;
+        }
+    }
+    AVS_LIST(anjay_iid_t) entry = AVS_LIST_NEW_ELEMENT(anjay_iid_t);
+    if (!entry) {
+        ac_log(ERROR, _("out of memory"));
+        // the change cannot be tracked, so rebuild everything instead
+        _anjay_access_control_compiled_acl_invalidate(repr);
+        return;
+    }
+    *entry = iid;
+    AVS_LIST_INSERT(it, entry);
+}
+
+static const ac_compiled_target_t *
+compiled_acl_find_target(const ac_compiled_acl_t *compiled,
+                         anjay_oid_t target_oid,
+                         anjay_iid_t target_iid) {
+    // lower bound, so that the instance with the lowest Access Control IID
+    // wins if there are duplicates - just like in a data model walk
+    size_t begin = 0;
+    size_t end = compiled->targets_count;
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        const ac_compiled_target_t *it = &compiled->targets[mid];
+        if (it->target_oid < target_oid
+                || (it->target_oid == target_oid
+                    && it->target_iid < target_iid)) {
+            begin = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    if (begin < compiled->targets_count
+            && compiled->targets[begin].target_oid == target_oid
+            && compiled->targets[begin].target_iid == target_iid) {
+        return &compiled->targets[begin];
+    }
+    return NULL;
+}
+
+static anjay_access_mask_t
+compiled_target_mask(const ac_compiled_target_t *target, anjay_ssid_t ssid) {
+    if (!target->acl_count) {
+        // Empty ACL: the owner has full access, except for Create
+        return target->owner == ssid
+                       ? (ANJAY_ACCESS_MASK_FULL & ~ANJAY_ACCESS_MASK_CREATE)
+                       : ANJAY_ACCESS_MASK_NONE;
+    }
+    const acl_entry_t *acl = target->acl;
+    acl_entry_t key = {
+        .ssid = ssid
+    };
+    const acl_entry_t *entry =
+            (const acl_entry_t *) bsearch(&key, acl, target->acl_count,
+                                          sizeof(*acl), acl_entry_ssid_cmp);
+    if (entry) {
+        return entry->mask;
+    }
+    if (acl[0].ssid == ANJAY_SSID_ANY) {
+        // Default ACL entry
+        return acl[0].mask;
+    }
+    return ANJAY_ACCESS_MASK_NONE;
+}
+
+int _anjay_access_control_compiled_mask(anjay_unlocked_t *anjay,
+                                        anjay_oid_t target_oid,
+                                        anjay_iid_t target_iid,
+                                        anjay_ssid_t ssid,
+                                        anjay_access_mask_t *out_mask) {
+    access_control_t *ac = _anjay_access_control_get(anjay);
+    if (!ac
+            || _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_ACCESS_CONTROL)
+                           != &ac->obj_def_ptr
+            || _anjay_access_control_compiled_acl_update(ac)) {
+        return -1;
+    }
+    const ac_compiled_target_t *target =
+            compiled_acl_find_target(&ac->compiled_acl, target_oid, target_iid);
+    *out_mask = target ? compiled_target_mask(target, ssid)
+                       : ANJAY_ACCESS_MASK_NONE;
+    return 0;
+}
+
 static int add_instances_without_iids(
         access_control_t *access_control,
         AVS_LIST(access_control_instance_t) *instances_to_move,
@@ -153,7 +434,7 @@ ac_commit_new_instance(anjay_unlocked_t *anjay,
         assert(AVS_LIST_SIZE(dm_changes->instance_set_changes.known_added_iids)
                == 1);
         assert(!dm_changes->resources_changed);
-        _anjay_access_control_mark_modified(ac);
+        _anjay_access_control_mark_instance_modified(ac, ac_instance->iid);
         _anjay_notify_instance_created(
                 anjay, dm_changes->oid,
                 *dm_changes->instance_set_changes.known_added_iids);
@@ -286,7 +567,8 @@ static int set_acl(anjay_unlocked_t *anjay,
     int result = set_acl_in_instance(anjay, ac_instance, ssid, access_mask);
     if (!ac_instance_needs_inserting) {
         if (!result) {
-            _anjay_access_control_mark_modified(ac);
+            _anjay_access_control_mark_instance_modified(ac,
+                                                         ac_instance->iid);
             _anjay_notify_changed_unlocked(anjay, ANJAY_DM_OID_ACCESS_CONTROL,
                                            ac_instance->iid,
                                            ANJAY_DM_RID_ACCESS_CONTROL_ACL);
@@ -387,7 +669,7 @@ static int ac_set_owner_unlocked(anjay_unlocked_t *anjay,
     }
     int result = 0;
     if (!ac_instance_needs_inserting) {
-        _anjay_access_control_mark_modified(ac);
+        _anjay_access_control_mark_instance_modified(ac, ac_instance->iid);
         _anjay_notify_changed_unlocked(anjay, ANJAY_DM_OID_ACCESS_CONTROL,
                                        ac_instance->iid,
                                        ANJAY_DM_RID_ACCESS_CONTROL_OWNER);
@@ -47,6 +47,38 @@ typedef struct {
     bool modified_since_persist;
 } access_control_state_t;
 
+/**
+ * Flattened view of a single Access Control object instance, as used by the
+ * compiled ACL lookup table.
+ */
+typedef struct {
+    anjay_oid_t target_oid;
+    anjay_iid_t target_iid;
+    anjay_iid_t ac_iid;
+    anjay_ssid_t owner;
+    acl_entry_t *acl;
+    size_t acl_count;
+} ac_compiled_target_t;
+
+/**
+ * Lookup table mapping (target OID, target IID) pairs onto ACL entries, sorted
+ * by (target_oid, target_iid, ac_iid). Each target owns its array of ACL
+ * entries, sorted by SSID, so that it can be replaced without touching the
+ * others.
+ *
+ * The table is a cache of the <c>current</c> state. Instances modified through
+ * @ref _anjay_access_control_mark_instance_modified are recorded in
+ * @c dirty_iids, and only their targets are recompiled, either on transaction
+ * commit or lazily on the next lookup. @ref _anjay_access_control_mark_modified
+ * invalidates the whole table, which is then rebuilt from scratch.
+ */
+typedef struct {
+    bool valid;
+    ac_compiled_target_t *targets;
+    size_t targets_count;
+    AVS_LIST(anjay_iid_t) dirty_iids;
+} ac_compiled_acl_t;
+
 typedef struct {
     anjay_dm_installed_object_t obj_def_ptr;
     const anjay_unlocked_dm_object_def_t *obj_def;
@@ -56,12 +88,28 @@ typedef struct {
     access_control_instance_t *last_accessed_instance;
     bool needs_validation;
     bool sync_in_progress;
+    ac_compiled_acl_t compiled_acl;
 } access_control_t;
 
+static inline void
+_anjay_access_control_compiled_acl_invalidate(access_control_t *repr) {
+    repr->compiled_acl.valid = false;
+    AVS_LIST_CLEAR(&repr->compiled_acl.dirty_iids);
+}
+
 static inline void _anjay_access_control_mark_modified(access_control_t *repr) {
     repr->current.modified_since_persist = true;
+    _anjay_access_control_compiled_acl_invalidate(repr);
 }
 
+/**
+ * Marks the state as modified, like @ref _anjay_access_control_mark_modified,
+ * but only schedules the compiled ACL entry of the Access Control instance
+ * @p iid for an update, instead of invalidating the whole table.
+ */
+void _anjay_access_control_mark_instance_modified(access_control_t *repr,
+                                                  anjay_iid_t iid);
+
 static inline void
 _anjay_access_control_clear_modified(access_control_t *repr) {
     repr->current.modified_since_persist = false;
@@ -79,6 +127,20 @@ void _anjay_access_control_clear_state(access_control_state_t *state);
 int _anjay_access_control_clone_state(access_control_state_t *dest,
                                       const access_control_state_t *src);
 
+/**
+ * Brings the compiled ACL lookup table up to date with the <c>current</c>
+ * state - recompiles the targets of instances recorded as modified, or
+ * rebuilds the whole table if it has been invalidated.
+ *
+ * @returns 0 on success, or a negative value if the table could not be built,
+ *          either due to an out-of-memory condition, or because some instance
+ *          does not have a valid target set yet. In the latter case, the table
+ *          is left invalidated.
+ */
+int _anjay_access_control_compiled_acl_update(access_control_t *ac);
+
+void _anjay_access_control_compiled_acl_cleanup(ac_compiled_acl_t *compiled);
+
 int _anjay_access_control_validate_ssid(anjay_unlocked_t *anjay,
                                         anjay_ssid_t ssid);
 
@@ -35,24 +35,32 @@ AVS_UNIT_GLOBAL_INIT(verbose) {
 #endif
 }
 
-#define TEST_NULLABLE_STRING_EQUAL(Actual, Expected) \
-    do {                                             \
-        if (Expected != NULL) {                      \
-            ASSERT_NOT_NULL((Actual));               \
-            ASSERT_EQ_STR((Actual), (Expected));     \
-        } else {                                     \
-            ASSERT_NULL((Actual));                   \
-        }                                            \
+static string_view_t test_view(const char *str) {
+    return (string_view_t) {
+        .data = str,
+        .size = str ? strlen(str) : 0
+    };
+}
+
+#define TEST_VIEW_EQUAL(Actual, Expected)                    \
+    do {                                                     \
+        if (Expected != NULL) {                              \
+            ASSERT_NOT_NULL((Actual).data);                  \
+            ASSERT_EQ((Actual).size, strlen(Expected));      \
+            ASSERT_EQ_BYTES_SIZED((Actual).data, (Expected), \
+                                  (Actual).size);            \
+        } else {                                             \
+            ASSERT_NULL((Actual).data);                      \
+        }                                                    \
     } while (0)
 
 #define TEST_SPLIT_QUERY_STRING(QueryString, ExpectedKey, ExpectedValue) \
     do {                                                                 \
-        char buf[] = QueryString;                                        \
-        const char *key;                                                 \
-        const char *value;                                               \
-        split_query_string(buf, &key, &value);                           \
-        TEST_NULLABLE_STRING_EQUAL(key, ExpectedKey);                    \
-        TEST_NULLABLE_STRING_EQUAL(value, ExpectedValue);                \
+        string_view_t key;                                               \
+        string_view_t value;                                             \
+        split_query_string(test_view(QueryString), &key, &value);        \
+        TEST_VIEW_EQUAL(key, ExpectedKey);                               \
+        TEST_VIEW_EQUAL(value, ExpectedValue);                           \
     } while (0)
 
 AVS_UNIT_TEST(parse_headers, split_query_string) {
@@ -61,16 +69,32 @@ AVS_UNIT_TEST(parse_headers, split_query_string) {
     TEST_SPLIT_QUERY_STRING("key=", "key", "");
     TEST_SPLIT_QUERY_STRING("=value", "", "value");
     TEST_SPLIT_QUERY_STRING("key=value", "key", "value");
+    TEST_SPLIT_QUERY_STRING("key=value=more", "key", "value=more");
 }
 
 #undef TEST_SPLIT_QUERY_STRING
-#undef TEST_NULLABLE_STRING_EQUAL
+#undef TEST_VIEW_EQUAL
+
+static int parse_queries(const avs_coap_request_header_t *hdr,
+                         anjay_request_attributes_t *out_attrs) {
+    bool is_bs;
+    anjay_uri_path_t uri;
+    return parse_request_options(hdr, &is_bs, &uri, out_attrs);
+}
+
+static int parse_request_uri(const avs_coap_request_header_t *hdr,
+                             bool *out_is_bs,
+                             anjay_uri_path_t *out_uri) {
+    anjay_request_attributes_t attrs;
+    return parse_request_options(hdr, out_is_bs, out_uri, &attrs);
+}
 
-#define PARSE_QUERY_WRAPPED(OutAttrs, OutDepth, Key, Value)               \
-    ({                                                                    \
-        int parse_query_result = parse_query((OutAttrs), (Key), (Value)); \
-        *(OutDepth) = -1;                                                 \
-        parse_query_result;                                               \
+#define PARSE_QUERY_WRAPPED(OutAttrs, OutDepth, Key, Value)        \
+    ({                                                             \
+        int parse_query_result = parse_query(                      \
+                (OutAttrs), test_view((Key)), test_view((Value))); \
+        *(OutDepth) = -1;                                          \
+        parse_query_result;                                        \
     })
 #define PARSE_QUERIES_WRAPPED(Header, OutAttrs, OutDepth)               \
     ({                                                                  \
@@ -112,6 +136,10 @@ AVS_UNIT_TEST(parse_headers, parse_attribute) {
     TEST_PARSE_ATTRIBUTE_FAIL("pmin", "123.4");
     TEST_PARSE_ATTRIBUTE_FAIL("pmin", "woof");
     TEST_PARSE_ATTRIBUTE_FAIL("pmin", "");
+    TEST_PARSE_ATTRIBUTE_FAIL("pmin", "-1");
+    TEST_PARSE_ATTRIBUTE_FAIL("pmin", "2147483648");
+    TEST_PARSE_ATTRIBUTE_SUCCESS("pmin", "2147483647", common.min_period,
+                                 has_min_period, INT32_MAX);
 
     TEST_PARSE_ATTRIBUTE_SUCCESS("pmax", "234", common.max_period,
                                  has_max_period, 234);
@@ -460,6 +488,32 @@ AVS_UNIT_TEST(parse_headers, parse_uri) {
             &is_bs, &uri));
 }
 
+AVS_UNIT_TEST(parse_headers, parse_uri_and_queries) {
+    header_with_opts_storage_t header_storage;
+    avs_coap_request_header_t *header =
+            header_with_string_opts(&header_storage, AVS_COAP_OPTION_URI_QUERY,
+                                    "pmax=20", "gt=1.5", NULL);
+    ASSERT_OK(avs_coap_options_add_string(&header->options,
+                                          AVS_COAP_OPTION_URI_PATH, "3"));
+    ASSERT_OK(avs_coap_options_add_string(&header->options,
+                                          AVS_COAP_OPTION_URI_PATH, "4"));
+    ASSERT_OK(avs_coap_options_add_u16(&header->options,
+                                       AVS_COAP_OPTION_ACCEPT, 0));
+
+    bool is_bs;
+    anjay_uri_path_t uri;
+    anjay_request_attributes_t attrs;
+    ASSERT_OK(parse_request_options(header, &is_bs, &uri, &attrs));
+    ASSERT_FALSE(is_bs);
+    ASSERT_TRUE(_anjay_uri_path_equal(&uri, &MAKE_INSTANCE_PATH(3, 4)));
+    ASSERT_TRUE(attrs.has_max_period);
+    ASSERT_EQ(attrs.values.common.max_period, 20);
+    ASSERT_TRUE(attrs.has_greater_than);
+    ASSERT_EQ(attrs.values.greater_than, 1.5);
+    ASSERT_FALSE(attrs.has_min_period);
+    ASSERT_FALSE(attrs.has_less_than);
+}
+
 AVS_UNIT_TEST(parse_headers, parse_action) {
     anjay_request_t request;
     memset(&request, 0, sizeof(request));
@@ -578,34 +632,27 @@ AVS_UNIT_TEST(queue_mode, change) {
                                          ANJAY_DM_RID_SERVER_BINDING,
                                          ANJAY_ID_INVALID,
                                          ANJAY_MOCK_DM_STRING(0, "dummy"), 0);
-    // SSID will be read afterwards, twice (second time for attr_storage)
-    for (size_t i = 0; i < 2; ++i) {
-        if (i == 1) {
-            _anjay_mock_dm_expect_list_instances(
-                    anjay, &FAKE_SERVER, 0,
-                    (const anjay_iid_t[]) { 1, ANJAY_ID_INVALID });
-        }
-        _anjay_mock_dm_expect_list_resources(
-                anjay, &FAKE_SERVER, 1, 0,
-                (const anjay_mock_dm_res_entry_t[]) {
-                        { ANJAY_DM_RID_SERVER_SSID, ANJAY_DM_RES_R,
-                          ANJAY_DM_RES_PRESENT },
-                        { ANJAY_DM_RID_SERVER_LIFETIME, ANJAY_DM_RES_RW,
-                          ANJAY_DM_RES_ABSENT },
-                        { ANJAY_DM_RID_SERVER_DEFAULT_PMIN, ANJAY_DM_RES_RW,
-                          ANJAY_DM_RES_ABSENT },
-                        { ANJAY_DM_RID_SERVER_DEFAULT_PMAX, ANJAY_DM_RES_RW,
-                          ANJAY_DM_RES_ABSENT },
-                        { ANJAY_DM_RID_SERVER_NOTIFICATION_STORING,
-                          ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                        { ANJAY_DM_RID_SERVER_BINDING, ANJAY_DM_RES_RW,
-                          ANJAY_DM_RES_ABSENT },
-                        ANJAY_MOCK_DM_RES_END });
-        _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, 1,
-                                            ANJAY_DM_RID_SERVER_SSID,
-                                            ANJAY_ID_INVALID, 0,
-                                            ANJAY_MOCK_DM_INT(0, 1));
-    }
+    // SSID will be read afterwards
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &FAKE_SERVER, 1, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { ANJAY_DM_RID_SERVER_SSID, ANJAY_DM_RES_R,
+                      ANJAY_DM_RES_PRESENT },
+                    { ANJAY_DM_RID_SERVER_LIFETIME, ANJAY_DM_RES_RW,
+                      ANJAY_DM_RES_ABSENT },
+                    { ANJAY_DM_RID_SERVER_DEFAULT_PMIN, ANJAY_DM_RES_RW,
+                      ANJAY_DM_RES_ABSENT },
+                    { ANJAY_DM_RID_SERVER_DEFAULT_PMAX, ANJAY_DM_RES_RW,
+                      ANJAY_DM_RES_ABSENT },
+                    { ANJAY_DM_RID_SERVER_NOTIFICATION_STORING,
+                      ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { ANJAY_DM_RID_SERVER_BINDING, ANJAY_DM_RES_RW,
+                      ANJAY_DM_RES_ABSENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, 1,
+                                        ANJAY_DM_RID_SERVER_SSID,
+                                        ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 1));
     DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CHANGED, ID(0xFA3E), NO_PAYLOAD);
     expect_has_buffered_data_check(mocksocks[0], false);
     ASSERT_OK(anjay_serve(anjay, mocksocks[0]));
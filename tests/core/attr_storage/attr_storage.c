@@ -47,6 +47,7 @@ static const anjay_dm_object_def_t *const OBJ2 = &(
 
 #define DM_ATTR_STORAGE_TEST_FINISH                                           \
     (void) mocksocks;                                                         \
+    test_as_objects_clear();                                                  \
     AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_transaction_finish(anjay_unlocked, 0)); \
     ANJAY_MUTEX_UNLOCK(anjay);                                                \
     DM_TEST_FINISH
@@ -73,6 +74,13 @@ static const anjay_dm_object_def_t *const OBJ2 = &(
 
 #pragma GCC poison anjay_attr_storage_is_modified
 
+static void test_as_insert(anjay_unlocked_t *anjay,
+                           AVS_LIST(as_object_entry_t) objects) {
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_attr_storage_import(&anjay->attr_storage, objects));
+    _anjay_attr_storage_free_objects(&objects);
+}
+
 AVS_UNIT_TEST(attr_storage, instance_create) {
     DM_ATTR_STORAGE_TEST_INIT;
     _anjay_mock_dm_expect_instance_create(anjay, &OBJ, 42, 0);
@@ -145,8 +153,8 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_1) {
     DM_ATTR_STORAGE_TEST_INIT;
 
     // prepare initial state
-    AVS_LIST_APPEND(
-            &anjay_unlocked->attr_storage.objects,
+    test_as_insert(
+            anjay_unlocked,
             test_object_entry(
                     42,
                     NULL,
@@ -211,8 +219,8 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_1) {
                             test_resource_entry(3, NULL),
                             NULL),
                     NULL));
-    AVS_LIST_APPEND(
-            &anjay_unlocked->attr_storage.objects,
+    test_as_insert(
+            anjay_unlocked,
             test_object_entry(43,
                               NULL,
                               test_instance_entry(
@@ -307,12 +315,13 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_1) {
             anjay, &OBJ, 0,
             (const anjay_iid_t[]) { 2, 3, 7, 13, 42, ANJAY_ID_INVALID });
     AVS_UNIT_ASSERT_SUCCESS(_anjay_attr_storage_notify(anjay_unlocked, queue));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_attr_storage_gc_flush(anjay_unlocked));
     _anjay_notify_clear_queue(&queue);
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           1);
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     42,
                     NULL,
@@ -340,6 +349,7 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_1) {
     AVS_UNIT_ASSERT_SUCCESS(
             _anjay_notify_queue_instance_set_unknown_change(&queue, 2));
     AVS_UNIT_ASSERT_SUCCESS(_anjay_attr_storage_notify(anjay_unlocked, queue));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_attr_storage_gc_flush(anjay_unlocked));
     AVS_UNIT_ASSERT_FALSE(anjay_unlocked->attr_storage.modified_since_persist);
     _anjay_notify_clear_queue(&queue);
 
@@ -349,8 +359,9 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_1) {
             _anjay_notify_queue_instance_set_unknown_change(&queue, 42));
     _anjay_mock_dm_expect_list_instances(
             anjay, &OBJ, -11, (const anjay_iid_t[]) { 7, ANJAY_ID_INVALID });
-    AVS_UNIT_ASSERT_FAILED(_anjay_attr_storage_notify(anjay_unlocked, queue));
-    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_attr_storage_notify(anjay_unlocked, queue));
+    AVS_UNIT_ASSERT_FAILED(_anjay_attr_storage_gc_flush(anjay_unlocked));
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);
     AVS_UNIT_ASSERT_TRUE(anjay_unlocked->attr_storage.modified_since_persist);
     _anjay_notify_clear_queue(&queue);
 
@@ -360,8 +371,8 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_1) {
 AVS_UNIT_TEST(attr_storage, as_notify_callback_2) {
     DM_ATTR_STORAGE_TEST_INIT;
 
-    AVS_LIST_APPEND(
-            &anjay_unlocked->attr_storage.objects,
+    test_as_insert(
+            anjay_unlocked,
             test_object_entry(
                     42,
                     test_default_attrlist(
@@ -550,9 +561,7 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_2) {
                                         ANJAY_ID_INVALID, 0,
                                         ANJAY_MOCK_DM_INT(0, -5));
     AVS_UNIT_ASSERT_FALSE(anjay_unlocked->attr_storage.modified_since_persist);
-    _anjay_mock_dm_expect_list_instances(
-            anjay, &OBJ, 0,
-            (const anjay_iid_t[]) { 2, 4, 7, 21, 42, ANJAY_ID_INVALID });
+    // only Resources changed in Object 42, so Instances are not enumerated
     _anjay_mock_dm_expect_list_resources(
             anjay, &OBJ, 4, 0,
             (const anjay_mock_dm_res_entry_t[]) {
@@ -577,14 +586,15 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_2) {
                     ANJAY_MOCK_DM_RES_END });
     _anjay_mock_dm_expect_list_resources(anjay, &OBJ, 21, -11, NULL);
     _anjay_mock_dm_expect_list_resources(anjay, &OBJ, 42, -514, NULL);
-    AVS_UNIT_ASSERT_FAILED(_anjay_attr_storage_notify(anjay_unlocked, queue));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_attr_storage_notify(anjay_unlocked, queue));
+    AVS_UNIT_ASSERT_FAILED(_anjay_attr_storage_gc_flush(anjay_unlocked));
     _anjay_notify_clear_queue(&queue);
 
     AVS_UNIT_ASSERT_TRUE(anjay_unlocked->attr_storage.modified_since_persist);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           1);
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     42,
                     test_default_attrlist(
@@ -662,6 +672,94 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_2) {
     DM_ATTR_STORAGE_TEST_FINISH;
 }
 
+AVS_UNIT_TEST(attr_storage, as_notify_known_removals) {
+    DM_ATTR_STORAGE_TEST_INIT;
+
+    test_as_insert(
+            anjay_unlocked,
+            test_object_entry(
+                    42,
+                    NULL,
+                    test_instance_entry(
+                            1,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            4, 1, ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_DM_CON_ATTR_NONE),
+                                    NULL),
+                            NULL),
+                    test_instance_entry(
+                            2,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            7, 33, 888,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_DM_CON_ATTR_NONE),
+                                    NULL),
+                            NULL),
+                    test_instance_entry(
+                            3,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            7, 3, 4, ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_DM_CON_ATTR_NONE),
+                                    NULL),
+                            NULL),
+                    NULL));
+
+    // Instance 2 has been removed and then recreated
+    anjay_notify_queue_t queue = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_notify_queue_instance_removed(&queue, 42, 1));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_notify_queue_instance_removed(&queue, 42, 2));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_notify_queue_instance_created(&queue, 42, 2));
+
+    // removals are known exactly, so the data model is not queried at all
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_attr_storage_notify(anjay_unlocked, queue));
+    _anjay_notify_clear_queue(&queue);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay_unlocked->attr_storage.gc_job_handle);
+    AVS_UNIT_ASSERT_FALSE(anjay_unlocked->attr_storage.modified_since_persist);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_attr_storage_gc_flush(anjay_unlocked));
+    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.gc_job_handle);
+    AVS_UNIT_ASSERT_TRUE(anjay_unlocked->attr_storage.modified_since_persist);
+
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
+                          1);
+    assert_object_equal(
+            test_as_objects(anjay_unlocked),
+            test_object_entry(
+                    42,
+                    NULL,
+                    test_instance_entry(
+                            2,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            7, 33, 888,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_DM_CON_ATTR_NONE),
+                                    NULL),
+                            NULL),
+                    test_instance_entry(
+                            3,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            7, 3, 4, ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_DM_CON_ATTR_NONE),
+                                    NULL),
+                            NULL),
+                    NULL));
+
+    DM_ATTR_STORAGE_TEST_FINISH;
+}
+
 //// ATTRIBUTE HANDLERS ////////////////////////////////////////////////////////
 
 AVS_UNIT_TEST(attr_storage, read_object_default_attrs_proxy) {
@@ -790,7 +888,7 @@ AVS_UNIT_TEST(attr_storage, write_object_default_attrs_proxy) {
             anjay_unlocked, WRAP_OBJ_PTR(&OBJ), 11,
             &ANJAY_DM_OI_ATTRIBUTES_EMPTY));
 
-    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);
     AVS_UNIT_ASSERT_FALSE(anjay_unlocked->attr_storage.modified_since_persist);
 
     DM_ATTR_STORAGE_TEST_FINISH;
@@ -859,7 +957,7 @@ AVS_UNIT_TEST(attr_storage, object_default_attrs) {
     anjay_unlocked->attr_storage.modified_since_persist = false;
 
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     69,
                     test_default_attrlist(
@@ -1035,7 +1133,7 @@ AVS_UNIT_TEST(attr_storage, write_instance_default_attrs_proxy) {
             anjay_unlocked, WRAP_OBJ_PTR(&OBJ), 11, 11,
             &ANJAY_DM_OI_ATTRIBUTES_EMPTY));
 
-    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);
 
     AVS_UNIT_ASSERT_FALSE(anjay_unlocked->attr_storage.modified_since_persist);
     DM_ATTR_STORAGE_TEST_FINISH;
@@ -1050,7 +1148,7 @@ AVS_UNIT_TEST(attr_storage, instance_default_attrs) {
             &ANJAY_DM_OI_ATTRIBUTES_EMPTY));
     // nothing actually changed
     AVS_UNIT_ASSERT_FALSE(anjay_unlocked->attr_storage.modified_since_persist);
-    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);
     AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_call_instance_write_default_attrs(
             anjay_unlocked, WRAP_OBJ_PTR(&OBJ2), 3, 2,
             &(const anjay_dm_oi_attributes_t) {
@@ -1113,10 +1211,10 @@ AVS_UNIT_TEST(attr_storage, instance_default_attrs) {
     AVS_UNIT_ASSERT_TRUE(anjay_unlocked->attr_storage.modified_since_persist);
     anjay_unlocked->attr_storage.modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           1);
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1372,7 +1470,7 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs_proxy) {
             anjay_unlocked, WRAP_OBJ_PTR(&OBJ), 11, 11, 11,
             &ANJAY_DM_R_ATTRIBUTES_EMPTY));
 
-    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);
 
     AVS_UNIT_ASSERT_FALSE(anjay_unlocked->attr_storage.modified_since_persist);
     DM_ATTR_STORAGE_TEST_FINISH;
@@ -1381,8 +1479,8 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs_proxy) {
 AVS_UNIT_TEST(attr_storage, read_resource_attrs) {
     DM_ATTR_STORAGE_TEST_INIT;
 
-    AVS_LIST_APPEND(
-            &anjay_unlocked->attr_storage.objects,
+    test_as_insert(
+            anjay_unlocked,
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1438,7 +1536,7 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
             &ANJAY_DM_R_ATTRIBUTES_EMPTY));
     // nothing actually changed
     AVS_UNIT_ASSERT_FALSE(anjay_unlocked->attr_storage.modified_since_persist);
-    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);
     AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_call_resource_write_attrs(
             anjay_unlocked, WRAP_OBJ_PTR(&OBJ2), 2, 3, 1,
             &(const anjay_dm_r_attributes_t) {
@@ -1459,10 +1557,10 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
     AVS_UNIT_ASSERT_TRUE(anjay_unlocked->attr_storage.modified_since_persist);
     anjay_unlocked->attr_storage.modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           1);
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1520,10 +1618,10 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
     AVS_UNIT_ASSERT_TRUE(anjay_unlocked->attr_storage.modified_since_persist);
     anjay_unlocked->attr_storage.modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           1);
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1577,10 +1675,10 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
     AVS_UNIT_ASSERT_TRUE(anjay_unlocked->attr_storage.modified_since_persist);
     anjay_unlocked->attr_storage.modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           1);
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1607,10 +1705,10 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
     AVS_UNIT_ASSERT_TRUE(anjay_unlocked->attr_storage.modified_since_persist);
     anjay_unlocked->attr_storage.modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           1);
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1650,10 +1748,10 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
     AVS_UNIT_ASSERT_TRUE(anjay_unlocked->attr_storage.modified_since_persist);
     anjay_unlocked->attr_storage.modified_since_persist = false;
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           1);
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     69, NULL,
                     test_instance_entry(
@@ -1673,7 +1771,7 @@ AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
             &ANJAY_DM_R_ATTRIBUTES_EMPTY));
     AVS_UNIT_ASSERT_TRUE(anjay_unlocked->attr_storage.modified_since_persist);
     anjay_unlocked->attr_storage.modified_since_persist = false;
-    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);
 
     AVS_UNIT_ASSERT_FALSE(anjay_unlocked->attr_storage.modified_since_persist);
     DM_ATTR_STORAGE_TEST_FINISH;
@@ -1766,7 +1864,7 @@ AVS_UNIT_TEST(attr_storage, write_resource_instance_attrs_proxy) {
             anjay_unlocked, WRAP_OBJ_PTR(&OBJ), 99, 99, 99, 5,
             &ANJAY_DM_R_ATTRIBUTES_EMPTY));
 
-    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);
     AVS_UNIT_ASSERT_FALSE(anjay_unlocked->attr_storage.modified_since_persist);
 
     DM_ATTR_STORAGE_TEST_FINISH;
@@ -225,4 +225,21 @@ static void assert_object_equal(as_object_entry_t *actual,
     AVS_LIST_DELETE(&tmp_expected);
 }
 
+static AVS_LIST(as_object_entry_t) TEST_AS_OBJECTS;
+
+static void test_as_objects_clear(void) {
+    _anjay_attr_storage_free_objects(&TEST_AS_OBJECTS);
+}
+
+/**
+ * Returns hierarchical representation of the current contents of the Attribute
+ * Storage. It stays valid until the next call or test_as_objects_clear().
+ */
+static AVS_LIST(as_object_entry_t) test_as_objects(anjay_unlocked_t *anjay) {
+    test_as_objects_clear();
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_attr_storage_export(&anjay->attr_storage, &TEST_AS_OBJECTS));
+    return TEST_AS_OBJECTS;
+}
+
 #endif /* ATTR_STORAGE_TEST_H */
@@ -29,6 +29,7 @@
 
 #define PERSISTENCE_TEST_FINISH        \
     do {                               \
+        test_as_objects_clear();       \
         _anjay_mock_dm_expect_clean(); \
         _anjay_test_dm_finish(anjay);  \
     } while (0)
@@ -342,7 +343,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_no_objects) {
     AVS_UNIT_ASSERT_SUCCESS(
             anjay_attr_storage_restore(anjay, (avs_stream_t *) &inbuf));
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
-    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);
     ANJAY_MUTEX_UNLOCK(anjay);
     PERSISTENCE_TEST_FINISH;
 }
@@ -374,10 +375,10 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_one_object) {
             anjay_attr_storage_restore(anjay, (avs_stream_t *) &inbuf));
 
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           1);
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(
@@ -486,12 +487,12 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_all_objects) {
             anjay_attr_storage_restore(anjay, (avs_stream_t *) &inbuf));
 
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           3);
 
     // object 4
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     4,
                     test_default_attrlist(
@@ -507,7 +508,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_all_objects) {
 
     // object 42
     assert_object_equal(
-            AVS_LIST_NEXT(anjay_unlocked->attr_storage.objects),
+            AVS_LIST_NEXT(test_as_objects(anjay_unlocked)),
             test_object_entry(
                     42, NULL,
                     test_instance_entry(
@@ -546,7 +547,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_all_objects) {
 
     // object 517
     assert_object_equal(
-            AVS_LIST_NTH(anjay_unlocked->attr_storage.objects, 2),
+            AVS_LIST_NTH(test_as_objects(anjay_unlocked), 2),
             test_object_entry(517, NULL,
                               test_instance_entry(
                                       516,
@@ -619,7 +620,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_no_instances) {
     AVS_UNIT_ASSERT_SUCCESS(
             anjay_attr_storage_restore(anjay, (avs_stream_t *) &inbuf));
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
-    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);
     ANJAY_MUTEX_UNLOCK(anjay);
     PERSISTENCE_TEST_FINISH;
 }
@@ -660,7 +661,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_no_present_resources) {
     AVS_UNIT_ASSERT_SUCCESS(
             anjay_attr_storage_restore(anjay, (avs_stream_t *) &inbuf));
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
-    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);
     ANJAY_MUTEX_UNLOCK(anjay);
     PERSISTENCE_TEST_FINISH;
 }
@@ -733,10 +734,10 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_broken_stream) {
 
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
     // Previously set attributes should remain untouched
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           1);
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     517, NULL,
                     test_instance_entry(
@@ -836,10 +837,10 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_insane_data) {
 
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
     // Previously set attributes should remain untouched
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           1);
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     517, NULL,
                     test_instance_entry(
@@ -923,7 +924,7 @@ static const char TEST_DATA_WITH_EMPTY_RID_ATTRS[] =
                 anjay_attr_storage_restore(anjay, (avs_stream_t *) &inbuf)); \
                                                                              \
         ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);                             \
-        AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);          \
+        AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);  \
         ANJAY_MUTEX_UNLOCK(anjay);                                           \
         PERSISTENCE_TEST_FINISH;                                             \
     }
@@ -944,7 +945,7 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_data_with_bad_magic) {
             anjay_attr_storage_restore(anjay, (avs_stream_t *) &inbuf));
 
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
-    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.entry_count, 0);
     ANJAY_MUTEX_UNLOCK(anjay);
     PERSISTENCE_TEST_FINISH;
 }
@@ -992,10 +993,10 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_duplicate_oid) {
 
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
     // Previously set attributes should remain untouched
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(test_as_objects(anjay_unlocked)),
                           1);
     assert_object_equal(
-            anjay_unlocked->attr_storage.objects,
+            test_as_objects(anjay_unlocked),
             test_object_entry(
                     4, NULL,
                     test_instance_entry(
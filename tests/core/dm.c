@@ -37,6 +37,133 @@ AVS_UNIT_TEST(debug, debug_make_path_macro) {
                                  "/65534/65534/65534");
 }
 
+AVS_UNIT_TEST(dm_objects_index, find_object_by_oid) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+    enum { EXTRA_OBJECTS = 100 };
+    anjay_dm_object_def_t defs[EXTRA_OBJECTS];
+    const anjay_dm_object_def_t *def_ptrs[EXTRA_OBJECTS];
+    for (size_t i = 0; i < EXTRA_OBJECTS; ++i) {
+        memset(&defs[i], 0, sizeof(defs[i]));
+        // register Object IDs 1000, 1003, ..., in non-monotonic order
+        defs[i].oid = (anjay_oid_t) (1000 + 3 * ((i * 37) % EXTRA_OBJECTS));
+        def_ptrs[i] = &defs[i];
+        ASSERT_OK(anjay_register_object(anjay, &def_ptrs[i]));
+    }
+    // duplicate Object ID shall be rejected
+    ASSERT_FAIL(anjay_register_object(anjay, &def_ptrs[42]));
+    _anjay_test_dm_unsched_notify_clb(anjay);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    for (anjay_oid_t oid = 990; oid < 1000 + 3 * EXTRA_OBJECTS + 10; ++oid) {
+        const anjay_dm_installed_object_t *obj =
+                _anjay_dm_find_object_by_oid(anjay_unlocked, oid);
+        if (oid >= 1000 && oid < 1000 + 3 * EXTRA_OBJECTS
+                && (oid - 1000) % 3 == 0) {
+            ASSERT_NOT_NULL(obj);
+            ASSERT_EQ(_anjay_dm_installed_object_oid(obj), oid);
+        } else {
+            ASSERT_NULL(obj);
+        }
+    }
+    ASSERT_NOT_NULL(_anjay_dm_find_object_by_oid(anjay_unlocked, OBJ->oid));
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    ASSERT_OK(anjay_unregister_object(anjay, &def_ptrs[42]));
+    _anjay_test_dm_unsched_notify_clb(anjay);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    ASSERT_NULL(_anjay_dm_find_object_by_oid(anjay_unlocked, defs[42].oid));
+    for (size_t i = 0; i < EXTRA_OBJECTS; ++i) {
+        if (i != 42) {
+            ASSERT_NOT_NULL(
+                    _anjay_dm_find_object_by_oid(anjay_unlocked, defs[i].oid));
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_instance_cache, presence_checks) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+    ASSERT_OK(anjay_enable_instance_cache(anjay, OBJ->oid));
+    ASSERT_FAIL(anjay_enable_instance_cache(anjay, 4242));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(anjay_unlocked, OBJ->oid);
+    ASSERT_NOT_NULL(obj);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 3, 7, ANJAY_ID_INVALID });
+    ASSERT_EQ(_anjay_dm_instance_present(anjay_unlocked, obj, 7), 1);
+    ASSERT_EQ(_anjay_dm_instance_present(anjay_unlocked, obj, 3), 1);
+    ASSERT_EQ(_anjay_dm_instance_present(anjay_unlocked, obj, 5), 0);
+    ASSERT_EQ(_anjay_dm_verify_instance_present(anjay_unlocked, obj, 8),
+              ANJAY_ERR_NOT_FOUND);
+    ASSERT_EQ(anjay_unlocked->dm.instance_cache_saved_calls, 3);
+
+    ASSERT_OK(_anjay_notify_instances_changed_unlocked(anjay_unlocked,
+                                                       OBJ->oid));
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 5, ANJAY_ID_INVALID });
+    ASSERT_EQ(_anjay_dm_instance_present(anjay_unlocked, obj, 5), 1);
+    ASSERT_EQ(_anjay_dm_instance_present(anjay_unlocked, obj, 7), 0);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    _anjay_test_dm_unsched_notify_clb(anjay);
+    ASSERT_EQ(anjay_get_instance_cache_saved_calls(anjay), 4);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_resource_cache, kind_and_presence) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+    ASSERT_OK(anjay_enable_resource_cache(anjay, OBJ->oid));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(anjay_unlocked, OBJ->oid);
+    ASSERT_NOT_NULL(obj);
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 7, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 1, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT },
+                    { 2, ANJAY_DM_RES_RWM, ANJAY_DM_RES_ABSENT },
+                    { 4, ANJAY_DM_RES_E, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    anjay_dm_resource_kind_t kind;
+    anjay_dm_resource_presence_t presence;
+    ASSERT_OK(_anjay_dm_resource_kind_and_presence(anjay_unlocked, obj, 7, 4,
+                                                   &kind, &presence));
+    ASSERT_EQ(kind, ANJAY_DM_RES_E);
+    ASSERT_EQ(presence, ANJAY_DM_RES_PRESENT);
+    ASSERT_OK(_anjay_dm_resource_kind_and_presence(anjay_unlocked, obj, 7, 2,
+                                                   &kind, &presence));
+    ASSERT_EQ(kind, ANJAY_DM_RES_RWM);
+    ASSERT_EQ(presence, ANJAY_DM_RES_ABSENT);
+    ASSERT_EQ(_anjay_dm_resource_kind_and_presence(anjay_unlocked, obj, 7, 3,
+                                                   &kind, &presence),
+              ANJAY_ERR_NOT_FOUND);
+
+    ASSERT_OK(_anjay_notify_changed_unlocked(anjay_unlocked, OBJ->oid, 7, 2));
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 7, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 1, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT },
+                    { 2, ANJAY_DM_RES_RWM, ANJAY_DM_RES_PRESENT },
+                    { 4, ANJAY_DM_RES_E, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    ASSERT_OK(_anjay_dm_resource_kind_and_presence(anjay_unlocked, obj, 7, 2,
+                                                   NULL, &presence));
+    ASSERT_EQ(presence, ANJAY_DM_RES_PRESENT);
+    ASSERT_OK(_anjay_dm_resource_kind_and_presence(anjay_unlocked, obj, 7, 1,
+                                                   &kind, NULL));
+    ASSERT_EQ(kind, ANJAY_DM_RES_R);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    _anjay_test_dm_unsched_notify_clb(anjay);
+    DM_TEST_FINISH;
+}
+
 #ifdef ANJAY_WITH_LWM2M11
 AVS_UNIT_TEST(dm_read, resource_instance) {
     DM_TEST_INIT;
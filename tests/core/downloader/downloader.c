@@ -868,6 +868,39 @@ AVS_UNIT_TEST(downloader, abort) {
     teardown_simple();
 }
 
+AVS_UNIT_TEST(downloader, started_download_changes_socket_set) {
+    setup_simple("coap://127.0.0.1:5683");
+
+    avs_unit_mocksock_expect_connect(SIMPLE_ENV.mocksock, "127.0.0.1", "5683");
+
+    AVS_LIST(const anjay_socket_entry_t) entries =
+            _anjay_collect_socket_entries(SIMPLE_ENV.base->anjay,
+                                          /* include_offline = */ false);
+    AVS_UNIT_ASSERT_NULL(entries);
+    const uint32_t generation = SIMPLE_ENV.base->anjay->socket_set_generation;
+
+    anjay_download_handle_t handle = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_downloader_download(&SIMPLE_ENV.base->anjay->downloader,
+                                       &handle, &SIMPLE_ENV.cfg, NULL, NULL));
+    AVS_UNIT_ASSERT_NOT_NULL(handle);
+
+    // the event loop rebuilds its socket set only if the generation changes
+    AVS_UNIT_ASSERT_NOT_EQUAL(SIMPLE_ENV.base->anjay->socket_set_generation,
+                              generation);
+    entries = _anjay_collect_socket_entries(SIMPLE_ENV.base->anjay,
+                                            /* include_offline = */ false);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(entries), 1);
+    AVS_UNIT_ASSERT_TRUE(entries->socket == SIMPLE_ENV.mocksock);
+    AVS_LIST_CLEAR(&entries);
+
+    expect_download_finished(&SIMPLE_ENV.data,
+                             _anjay_download_status_aborted());
+    _anjay_downloader_cleanup(&SIMPLE_ENV.base->anjay->downloader);
+
+    teardown_simple();
+}
+
 AVS_UNIT_TEST(downloader, uri_path_query) {
     setup_simple("coap://127.0.0.1:5683/uri/path?query=string&another");
 
@@ -0,0 +1,309 @@
+/*
+ * Copyright 2017-2023 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#ifdef ANJAY_WITH_THREAD_SAFETY
+#    include <pthread.h>
+#    include <time.h>
+#endif // ANJAY_WITH_THREAD_SAFETY
+
+#define ANJAY_SERVERS_INTERNALS
+#include "src/core/servers/anjay_activate.h"
+#include "src/core/servers/anjay_server_connections.h"
+#include "src/core/servers/anjay_servers_internal.h"
+#undef ANJAY_SERVERS_INTERNALS
+
+static const anjay_configuration_t EVENT_LOOP_TEST_CONFIG = {
+    .endpoint_name = "test"
+};
+
+static const avs_time_duration_t EVENT_LOOP_TEST_MAX_WAIT = { 0, 100000000 };
+
+static anjay_t *event_loop_test_anjay_new(void) {
+    anjay_t *anjay_locked = anjay_new(&EVENT_LOOP_TEST_CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay_locked);
+    // there are no objects, so there is nothing to reload
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    avs_sched_del(&anjay->reload_servers_sched_job_handle);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return anjay_locked;
+}
+
+static int event_loop_test_status(anjay_t *anjay_locked) {
+    return atomic_load(&anjay_locked->atomic_fields.event_loop_status);
+}
+
+typedef struct {
+    anjay_event_loop_group_t *group;
+    anjay_t *first;
+    anjay_t *second;
+    bool second_job_executed;
+} add_remove_test_env_t;
+
+static void remove_first_job(avs_sched_t *sched, const void *env_ptr) {
+    (void) sched;
+    add_remove_test_env_t *env = *(add_remove_test_env_t *const *) env_ptr;
+    env->second_job_executed = true;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_event_loop_group_remove(env->group, env->first));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_interrupt(env->group));
+}
+
+static void add_second_job(avs_sched_t *sched, const void *env_ptr) {
+    (void) sched;
+    add_remove_test_env_t *env = *(add_remove_test_env_t *const *) env_ptr;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(env->group, env->second));
+    AVS_UNIT_ASSERT_EQUAL(event_loop_test_status(env->second),
+                          ANJAY_EVENT_LOOP_RUNNING);
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(anjay_get_scheduler(env->second),
+                                          NULL, remove_first_job, &env,
+                                          sizeof(env)));
+}
+
+AVS_UNIT_TEST(event_loop_group, add_and_remove_while_running) {
+    add_remove_test_env_t env = {
+        .group = anjay_event_loop_group_new(),
+        .first = event_loop_test_anjay_new(),
+        .second = event_loop_test_anjay_new()
+    };
+    AVS_UNIT_ASSERT_NOT_NULL(env.group);
+    add_remove_test_env_t *env_ptr = &env;
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(env.group, env.first));
+    // a member cannot belong to two event loops at once
+    AVS_UNIT_ASSERT_FAILED(anjay_event_loop_group_add(env.group, env.first));
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(anjay_get_scheduler(env.first), NULL,
+                                          add_second_job, &env_ptr,
+                                          sizeof(env_ptr)));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_run(
+            env.group, EVENT_LOOP_TEST_MAX_WAIT, false));
+
+    AVS_UNIT_ASSERT_TRUE(env.second_job_executed);
+    // the removed member is released, while the one that stays in the group
+    // keeps its status
+    AVS_UNIT_ASSERT_EQUAL(event_loop_test_status(env.first),
+                          ANJAY_EVENT_LOOP_IDLE);
+    AVS_UNIT_ASSERT_EQUAL(event_loop_test_status(env.second),
+                          ANJAY_EVENT_LOOP_RUNNING);
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_event_loop_group_remove(env.group, env.first));
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_event_loop_group_remove(env.group, env.second));
+    AVS_UNIT_ASSERT_EQUAL(event_loop_test_status(env.second),
+                          ANJAY_EVENT_LOOP_IDLE);
+
+    anjay_event_loop_group_delete(&env.group);
+    anjay_delete(env.first);
+    anjay_delete(env.second);
+}
+
+static void make_all_connections_failed(anjay_t *anjay_locked) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_server_info_t) server =
+            _anjay_servers_create_inactive(anjay, 1);
+    AVS_UNIT_ASSERT_NOT_NULL(server);
+    server->refresh_failed = true;
+    _anjay_servers_add(&anjay->servers, server);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    AVS_UNIT_ASSERT_TRUE(anjay_all_connections_failed(anjay_locked));
+}
+
+AVS_UNIT_TEST(event_loop_group, reconnect_when_all_connections_failed) {
+    anjay_event_loop_group_t group;
+    AVS_UNIT_ASSERT_SUCCESS(group_init(&group));
+    anjay_t *anjay = event_loop_test_anjay_new();
+    AVS_UNIT_ASSERT_SUCCESS(group_add_member(&group, anjay));
+    make_all_connections_failed(anjay);
+
+    // there are no scheduler jobs at all, so nothing else would ever wake the
+    // member up
+    avs_time_duration_t wait_time = EVENT_LOOP_TEST_MAX_WAIT;
+    AVS_UNIT_ASSERT_EQUAL(group_prepare_wait(&group, false, &wait_time),
+                          HANDLE_SOCKETS_CONTINUE);
+    AVS_UNIT_ASSERT_TRUE(
+            avs_time_duration_equal(wait_time, EVENT_LOOP_TEST_MAX_WAIT));
+    AVS_UNIT_ASSERT_TRUE(anjay_all_connections_failed(anjay));
+
+    AVS_UNIT_ASSERT_EQUAL(group_prepare_wait(&group, true, &wait_time),
+                          HANDLE_SOCKETS_CONTINUE);
+    // reactivation of the server shall be scheduled immediately
+    AVS_UNIT_ASSERT_FALSE(anjay_all_connections_failed(anjay));
+    AVS_UNIT_ASSERT_TRUE(
+            avs_time_duration_equal(wait_time, AVS_TIME_DURATION_ZERO));
+    AVS_UNIT_ASSERT_EQUAL(anjay_sched_calculate_wait_time_ms(anjay, INT_MAX),
+                          0);
+
+    group_cleanup(&group);
+    AVS_UNIT_ASSERT_EQUAL(event_loop_test_status(anjay), ANJAY_EVENT_LOOP_IDLE);
+    anjay_delete(anjay);
+}
+
+static void connect_to_peer(avs_net_socket_t *socket,
+                            avs_net_socket_t *peer) {
+    char port[16];
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_get_local_port(peer, port, sizeof(port)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_connect(socket, "127.0.0.1", port));
+}
+
+static int wait_for_event(anjay_event_loop_group_t *group,
+                          uint64_t *out_data) {
+    struct epoll_event event;
+    int count = epoll_wait(group->epoll_fd, &event, 1, 1000);
+    if (count == 1) {
+        *out_data = event.data.u64;
+    }
+    return count;
+}
+
+AVS_UNIT_TEST(event_loop_group, socket_reopened_between_passes) {
+    anjay_event_loop_group_t group;
+    AVS_UNIT_ASSERT_SUCCESS(group_init(&group));
+    anjay_t *anjay_locked = event_loop_test_anjay_new();
+    AVS_UNIT_ASSERT_SUCCESS(group_add_member(&group, anjay_locked));
+    const uint32_t member_id = group.members[0]->id;
+
+    avs_net_socket_t *socket = NULL;
+    avs_net_socket_t *peer = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_socket_create(&socket, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_socket_create(&peer, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_bind(peer, "127.0.0.1", "0"));
+    connect_to_peer(socket, peer);
+    const int fd = *(const int *) avs_net_socket_get_system(socket);
+
+    anjay_server_connection_t *connection;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_server_info_t) server =
+            _anjay_servers_create_inactive(anjay, 1);
+    AVS_UNIT_ASSERT_NOT_NULL(server);
+    _anjay_servers_add(&anjay->servers, server);
+    connection = _anjay_get_server_connection((const anjay_connection_ref_t) {
+        .server = server,
+        .conn_type = ANJAY_CONNECTION_PRIMARY
+    });
+    connection->conn_socket_ = socket;
+    _anjay_socket_set_changed(anjay);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+
+    avs_time_duration_t wait_time = EVENT_LOOP_TEST_MAX_WAIT;
+    AVS_UNIT_ASSERT_EQUAL(group_prepare_wait(&group, false, &wait_time),
+                          HANDLE_SOCKETS_CONTINUE);
+
+    // close and reopen the socket before the next pass, as when reconnecting
+    // in queue mode; the descriptor number is reused
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_close(socket));
+    connect_to_peer(socket, peer);
+    AVS_UNIT_ASSERT_EQUAL(*(const int *) avs_net_socket_get_system(socket), fd);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    _anjay_socket_set_changed(anjay);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+
+    wait_time = EVENT_LOOP_TEST_MAX_WAIT;
+    AVS_UNIT_ASSERT_EQUAL(group_prepare_wait(&group, false, &wait_time),
+                          HANDLE_SOCKETS_CONTINUE);
+
+    // incoming data is still reported for the reopened socket
+    char port[16];
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_get_local_port(socket, port, sizeof(port)));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_send_to(peer, "ping", 4, "127.0.0.1", port));
+    uint64_t data = 0;
+    AVS_UNIT_ASSERT_EQUAL(wait_for_event(&group, &data), 1);
+    AVS_UNIT_ASSERT_EQUAL(data, make_event_data(member_id, fd));
+
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    connection->conn_socket_ = NULL;
+    _anjay_socket_set_changed(anjay);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    group_cleanup(&group);
+    anjay_delete(anjay_locked);
+    avs_net_socket_cleanup(&socket);
+    avs_net_socket_cleanup(&peer);
+}
+
+#ifdef ANJAY_WITH_THREAD_SAFETY
+typedef struct {
+    anjay_event_loop_group_t *group;
+    atomic_bool second_job_executed;
+    bool first_job_saw_second;
+} two_workers_test_env_t;
+
+static void wait_for_second_job(avs_sched_t *sched, const void *env_ptr) {
+    (void) sched;
+    two_workers_test_env_t *env = *(two_workers_test_env_t *const *) env_ptr;
+    // This job blocks the worker that executes it, so the other job can only
+    // be executed by another worker
+    const avs_time_monotonic_t deadline = avs_time_monotonic_add(
+            avs_time_monotonic_now(),
+            avs_time_duration_from_scalar(5, AVS_TIME_S));
+    while (!atomic_load(&env->second_job_executed)
+           && avs_time_monotonic_before(avs_time_monotonic_now(), deadline)) {
+        nanosleep(&(const struct timespec) { 0, 1000000 }, NULL);
+    }
+    env->first_job_saw_second = atomic_load(&env->second_job_executed);
+    anjay_event_loop_group_interrupt(env->group);
+}
+
+static void set_second_job_executed(avs_sched_t *sched, const void *env_ptr) {
+    (void) sched;
+    two_workers_test_env_t *env = *(two_workers_test_env_t *const *) env_ptr;
+    atomic_store(&env->second_job_executed, true);
+}
+
+static void *event_loop_worker(void *group) {
+    // assertions cannot be used outside of the main thread
+    return (void *) (intptr_t) anjay_event_loop_group_run(
+            (anjay_event_loop_group_t *) group, EVENT_LOOP_TEST_MAX_WAIT,
+            false);
+}
+
+AVS_UNIT_TEST(event_loop_group, two_workers) {
+    two_workers_test_env_t env = {
+        .group = anjay_event_loop_group_new()
+    };
+    atomic_init(&env.second_job_executed, false);
+    AVS_UNIT_ASSERT_NOT_NULL(env.group);
+    two_workers_test_env_t *env_ptr = &env;
+
+    anjay_t *first = event_loop_test_anjay_new();
+    anjay_t *second = event_loop_test_anjay_new();
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(env.group, first));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(env.group, second));
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(anjay_get_scheduler(first), NULL,
+                                          wait_for_second_job, &env_ptr,
+                                          sizeof(env_ptr)));
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(anjay_get_scheduler(second), NULL,
+                                          set_second_job_executed, &env_ptr,
+                                          sizeof(env_ptr)));
+
+    pthread_t workers[2];
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(workers); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(pthread_create(&workers[i], NULL,
+                                               event_loop_worker, env.group));
+    }
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(workers); ++i) {
+        void *result;
+        AVS_UNIT_ASSERT_SUCCESS(pthread_join(workers[i], &result));
+        AVS_UNIT_ASSERT_SUCCESS((int) (intptr_t) result);
+    }
+    AVS_UNIT_ASSERT_TRUE(env.first_job_saw_second);
+
+    anjay_event_loop_group_delete(&env.group);
+    AVS_UNIT_ASSERT_EQUAL(event_loop_test_status(first), ANJAY_EVENT_LOOP_IDLE);
+    AVS_UNIT_ASSERT_EQUAL(event_loop_test_status(second),
+                          ANJAY_EVENT_LOOP_IDLE);
+    anjay_delete(first);
+    anjay_delete(second);
+}
+#endif // ANJAY_WITH_THREAD_SAFETY
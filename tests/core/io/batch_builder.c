@@ -52,7 +52,7 @@ AVS_UNIT_TEST(batch_builder, single_int_entry) {
     AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
             builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
             AVS_TIME_REAL_INVALID, 0));
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 1);
 
     builder_teardown(builder);
 }
@@ -66,7 +66,7 @@ AVS_UNIT_TEST(batch_builder, two_entries) {
     AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
             builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
             AVS_TIME_REAL_INVALID, 0));
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 2);
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 2);
 
     builder_teardown(builder);
 }
@@ -83,12 +83,13 @@ AVS_UNIT_TEST(batch_builder, string_copy) {
     AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_string(
             builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
             AVS_TIME_REAL_INVALID, str));
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 1);
 
     // Passed string shouldn't be required anymore.
     avs_free(str);
 
-    AVS_LIST(anjay_batch_entry_t) entry = AVS_LIST_TAIL(builder->list);
+    const anjay_batch_entry_t *entry =
+            &builder->block->entries[builder->entry_count - 1];
     AVS_UNIT_ASSERT_EQUAL_STRING(entry->data.value.string, test_string.data);
 
     builder_teardown(builder);
@@ -106,12 +107,13 @@ AVS_UNIT_TEST(batch_builder, bytes_copy) {
 
     _anjay_batch_add_bytes(builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
                            AVS_TIME_REAL_INVALID, bytes, test_bytes.size);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 1);
 
     // Passed bytes shouldn't be required anymore.
     avs_free(bytes);
 
-    AVS_LIST(anjay_batch_entry_t) entry = AVS_LIST_TAIL(builder->list);
+    const anjay_batch_entry_t *entry =
+            &builder->block->entries[builder->entry_count - 1];
     AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(entry->data.value.bytes.data,
                                       test_bytes.data, test_bytes.size);
 
@@ -123,9 +125,10 @@ AVS_UNIT_TEST(batch_builder, empty_bytes) {
 
     _anjay_batch_add_bytes(builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
                            AVS_TIME_REAL_INVALID, NULL, 0);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 1);
 
-    AVS_LIST(anjay_batch_entry_t) entry = AVS_LIST_TAIL(builder->list);
+    const anjay_batch_entry_t *entry =
+            &builder->block->entries[builder->entry_count - 1];
     AVS_UNIT_ASSERT_NULL(entry->data.value.bytes.data);
     AVS_UNIT_ASSERT_EQUAL(entry->data.value.bytes.length, 0);
 
@@ -139,14 +142,134 @@ AVS_UNIT_TEST(batch_builder, compile) {
     AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
             builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
             AVS_TIME_REAL_INVALID, 0));
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 1);
 
     anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
     AVS_UNIT_ASSERT_NULL(builder);
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(batch->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(batch->entry_count, 1);
     AVS_UNIT_ASSERT_EQUAL(batch->ref_count, 1);
 
     _anjay_batch_release(&batch);
     AVS_UNIT_ASSERT_NULL(batch);
 }
+
+AVS_UNIT_TEST(batch_builder, compile_packs_payloads) {
+    anjay_batch_builder_t *builder = builder_setup();
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_string(
+            builder, &MAKE_RESOURCE_PATH(0, 0, 0), AVS_TIME_REAL_INVALID,
+            "raz dwa trzy"));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
+            builder, &MAKE_RESOURCE_PATH(0, 0, 1), AVS_TIME_REAL_INVALID, 42));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_string(
+            builder, &MAKE_RESOURCE_PATH(0, 0, 2), AVS_TIME_REAL_INVALID, ""));
+
+    const anjay_batch_t *const block = builder->block;
+    const char *const block_end =
+            (const char *) builder->block->entries + builder->capacity;
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NULL(builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+    // the batch takes over the builder's memory without copying
+    AVS_UNIT_ASSERT_TRUE(batch == block);
+    AVS_UNIT_ASSERT_EQUAL(batch->entry_count, 3);
+
+    // values are stored at the end of the block, most recent one first
+    AVS_UNIT_ASSERT_TRUE(batch->entries[0].data.value.string
+                         == block_end - sizeof("raz dwa trzy"));
+    AVS_UNIT_ASSERT_EQUAL_STRING(batch->entries[0].data.value.string,
+                                 "raz dwa trzy");
+    AVS_UNIT_ASSERT_EQUAL(batch->entries[1].data.value.int_value, 42);
+    AVS_UNIT_ASSERT_TRUE(batch->entries[2].data.value.string
+                         == block_end - sizeof("raz dwa trzy") - sizeof(""));
+    AVS_UNIT_ASSERT_EQUAL_STRING(batch->entries[2].data.value.string, "");
+
+    anjay_batch_t *other = _anjay_batch_acquire(batch);
+    AVS_UNIT_ASSERT_TRUE(other == batch);
+    AVS_UNIT_ASSERT_EQUAL(batch->ref_count, 2);
+    AVS_UNIT_ASSERT_TRUE(_anjay_batch_values_equal(batch, other));
+    _anjay_batch_release(&other);
+    AVS_UNIT_ASSERT_EQUAL(batch->ref_count, 1);
+
+    _anjay_batch_release(&batch);
+    AVS_UNIT_ASSERT_NULL(batch);
+}
+
+AVS_UNIT_TEST(batch_builder, payloads_survive_growth) {
+    anjay_batch_builder_t *builder = builder_setup();
+
+    char str[16];
+    for (int i = 0; i < 100; ++i) {
+        AVS_UNIT_ASSERT_TRUE(avs_simple_snprintf(str, sizeof(str), "%d", i)
+                             >= 0);
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_string(
+                builder, &MAKE_RESOURCE_PATH(0, 0, (anjay_rid_t) i),
+                AVS_TIME_REAL_INVALID, str));
+    }
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 100);
+
+    // roll back the last half
+    _anjay_batch_builder_truncate(builder, 50);
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 50);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_string(
+            builder, &MAKE_RESOURCE_PATH(0, 0, 50), AVS_TIME_REAL_INVALID,
+            "foo"));
+
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+    AVS_UNIT_ASSERT_EQUAL(batch->entry_count, 51);
+    for (int i = 0; i < 50; ++i) {
+        AVS_UNIT_ASSERT_TRUE(avs_simple_snprintf(str, sizeof(str), "%d", i)
+                             >= 0);
+        AVS_UNIT_ASSERT_EQUAL_STRING(batch->entries[i].data.value.string, str);
+    }
+    AVS_UNIT_ASSERT_EQUAL_STRING(batch->entries[50].data.value.string, "foo");
+    _anjay_batch_release(&batch);
+}
+
+static anjay_batch_t *compile_single_string(const char *str,
+                                            avs_time_real_t timestamp) {
+    anjay_batch_builder_t *builder = builder_setup();
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_string(
+            builder, &MAKE_RESOURCE_PATH(0, 0, 0), timestamp, str));
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+    return batch;
+}
+
+
+AVS_UNIT_TEST(batch_builder, values_shifted) {
+    const avs_time_real_t t0 = avs_time_real_now();
+    const avs_time_real_t t1 =
+            avs_time_real_add(t0, avs_time_duration_from_scalar(5, AVS_TIME_S));
+    anjay_batch_t *first = compile_single_string("raz dwa trzy", t0);
+    anjay_batch_t *same = compile_single_string("raz dwa trzy", t1);
+    anjay_batch_t *different = compile_single_string("cztery", t1);
+    anjay_batch_t *untimed = compile_single_string("raz dwa trzy",
+                                                   AVS_TIME_REAL_INVALID);
+
+    avs_time_duration_t shift = AVS_TIME_DURATION_INVALID;
+    AVS_UNIT_ASSERT_TRUE(_anjay_batch_values_shifted(same, first, &shift));
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_equal(
+            shift, avs_time_duration_from_scalar(5, AVS_TIME_S)));
+    AVS_UNIT_ASSERT_TRUE(_anjay_batch_values_shifted(first, same, &shift));
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_equal(
+            shift, avs_time_duration_from_scalar(-5, AVS_TIME_S)));
+
+    AVS_UNIT_ASSERT_FALSE(
+            _anjay_batch_values_shifted(different, first, &shift));
+    // valid and invalid timestamps cannot be shifted into each other
+    AVS_UNIT_ASSERT_FALSE(_anjay_batch_values_shifted(untimed, first, &shift));
+
+    // without valid timestamps, compilation times are compared
+    AVS_UNIT_ASSERT_TRUE(
+            _anjay_batch_values_shifted(untimed, untimed, &shift));
+    AVS_UNIT_ASSERT_TRUE(
+            avs_time_duration_equal(shift, AVS_TIME_DURATION_ZERO));
+
+    _anjay_batch_release(&first);
+    _anjay_batch_release(&same);
+    _anjay_batch_release(&different);
+    _anjay_batch_release(&untimed);
+}
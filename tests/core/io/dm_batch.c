@@ -248,6 +248,11 @@ static bool is_entry_valid(anjay_batch_entry_t *entry,
     }
 }
 
+static anjay_batch_entry_t *last_entry(anjay_batch_builder_t *builder) {
+    AVS_UNIT_ASSERT_TRUE(builder->entry_count > 0);
+    return &builder->block->entries[builder->entry_count - 1];
+}
+
 static inline int
 add_current(anjay_batch_builder_t *builder, anjay_t *anjay, anjay_rid_t rid) {
     return anjay_send_batch_data_add_current(
@@ -259,8 +264,8 @@ AVS_UNIT_TEST(dm_batch, single_bytes) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, BYTES_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         BYTES_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -278,8 +283,8 @@ AVS_UNIT_TEST(dm_batch, single_string) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, STRING_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         STRING_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -296,8 +301,8 @@ AVS_UNIT_TEST(dm_batch, single_int) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, INT_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         INT_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -314,8 +319,8 @@ AVS_UNIT_TEST(dm_batch, single_uint) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, UINT_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         UINT_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -332,8 +337,8 @@ AVS_UNIT_TEST(dm_batch, single_double) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, DOUBLE_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         DOUBLE_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -350,8 +355,8 @@ AVS_UNIT_TEST(dm_batch, single_bool) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, BOOL_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         BOOL_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -368,8 +373,8 @@ AVS_UNIT_TEST(dm_batch, single_objlnk) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, OBJLNK_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         OBJLNK_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -386,7 +391,7 @@ AVS_UNIT_TEST(dm_batch, two_resources) {
     TEST_SETUP(MOCK_CLOCK_START_RELATIVE);
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, INT_RID));
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         INT_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -397,7 +402,7 @@ AVS_UNIT_TEST(dm_batch, two_resources) {
                                         }));
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, DOUBLE_RID));
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         DOUBLE_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -407,7 +412,7 @@ AVS_UNIT_TEST(dm_batch, two_resources) {
                                             }
                                         }));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 2);
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 2);
 
     TEST_TEARDOWN();
 }
@@ -416,18 +421,17 @@ AVS_UNIT_TEST(dm_batch, multiple_instance_resource) {
     TEST_SETUP(MOCK_CLOCK_START_RELATIVE);
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, INT_ARRAY_RID));
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), int_array_size + 1);
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, int_array_size + 1);
 
     AVS_UNIT_ASSERT_TRUE(
-            is_entry_valid(builder->list, INT_ARRAY_RID, ANJAY_ID_INVALID,
+            is_entry_valid(&builder->block->entries[0], INT_ARRAY_RID,
+                           ANJAY_ID_INVALID,
                            (anjay_batch_data_t) {
                                .type = ANJAY_BATCH_DATA_START_AGGREGATE
                            }));
 
-    anjay_batch_entry_t *entry;
-    uint16_t riid = 0;
-    AVS_LIST_FOREACH(entry, AVS_LIST_NEXT(builder->list)) {
-        AVS_UNIT_ASSERT_TRUE(is_entry_valid(entry,
+    for (anjay_riid_t riid = 0; riid < int_array_size; ++riid) {
+        AVS_UNIT_ASSERT_TRUE(is_entry_valid(&builder->block->entries[riid + 1],
                                             INT_ARRAY_RID,
                                             riid,
                                             (anjay_batch_data_t) {
@@ -436,7 +440,6 @@ AVS_UNIT_TEST(dm_batch, multiple_instance_resource) {
                                                     .int_value = int_array[riid]
                                                 }
                                             }));
-        riid++;
     }
 
     TEST_TEARDOWN();
@@ -445,13 +448,10 @@ AVS_UNIT_TEST(dm_batch, multiple_instance_resource) {
 AVS_UNIT_TEST(dm_batch, illegal_op) {
     TEST_SETUP(MOCK_CLOCK_START_RELATIVE);
 
-    AVS_LIST(anjay_batch_entry_t) *initial_append_ptr = builder->append_ptr;
-
     AVS_UNIT_ASSERT_FAILED(add_current(builder, anjay, ILLEGAL_IMPL_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 0);
-    AVS_UNIT_ASSERT_TRUE(builder->append_ptr == initial_append_ptr);
-    AVS_UNIT_ASSERT_NULL(*builder->append_ptr);
+    AVS_UNIT_ASSERT_EQUAL(builder->entry_count, 0);
+    AVS_UNIT_ASSERT_EQUAL(builder->payload_size, 0);
 
     TEST_TEARDOWN();
 }
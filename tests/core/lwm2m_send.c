@@ -708,7 +708,7 @@ AVS_UNIT_TEST(anjay_send, add_multiple_successful) {
     AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_data_add_current_multiple(
             builder, anjay, paths, AVS_ARRAY_SIZE(paths)));
     AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 2);
+            ((anjay_batch_builder_t *) builder)->entry_count, 2);
     anjay_send_batch_builder_cleanup(&builder);
     DM_TEST_FINISH;
 }
@@ -718,9 +718,6 @@ AVS_UNIT_TEST(anjay_send, add_multiple_single_resource_fail) {
     anjay_send_batch_builder_t *builder = anjay_send_batch_builder_new();
     AVS_UNIT_ASSERT_NOT_NULL(builder);
 
-    AVS_LIST(anjay_batch_entry_t) *initial_append_ptr =
-            ((anjay_batch_builder_t *) builder)->append_ptr;
-
     _anjay_mock_dm_expect_list_instances(
             anjay, &OBJ, 0, (const anjay_iid_t[]) { 1, ANJAY_ID_INVALID });
     _anjay_mock_dm_expect_list_resources(
@@ -737,10 +734,9 @@ AVS_UNIT_TEST(anjay_send, add_multiple_single_resource_fail) {
     AVS_UNIT_ASSERT_FAILED(anjay_send_batch_data_add_current_multiple(
             builder, anjay, paths, AVS_ARRAY_SIZE(paths)));
     AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 0);
-    AVS_UNIT_ASSERT_TRUE(initial_append_ptr
-                         == ((anjay_batch_builder_t *) builder)->append_ptr);
-    AVS_UNIT_ASSERT_NULL(*((anjay_batch_builder_t *) builder)->append_ptr);
+            ((anjay_batch_builder_t *) builder)->entry_count, 0);
+    AVS_UNIT_ASSERT_EQUAL(((anjay_batch_builder_t *) builder)->payload_size,
+                          0);
     anjay_send_batch_builder_cleanup(&builder);
     DM_TEST_FINISH;
 }
@@ -799,16 +795,15 @@ AVS_UNIT_TEST(anjay_send, add_multiple_twice_with_fail) {
     AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_data_add_current_multiple(
             builder, anjay, paths, AVS_ARRAY_SIZE(paths)));
 
-    AVS_LIST(anjay_batch_entry_t) *pre_fail_append_ptr =
-            ((anjay_batch_builder_t *) builder)->append_ptr;
+    const size_t pre_fail_payload_size =
+            ((anjay_batch_builder_t *) builder)->payload_size;
 
     AVS_UNIT_ASSERT_FAILED(anjay_send_batch_data_add_current_multiple(
             builder, anjay, paths, AVS_ARRAY_SIZE(paths)));
     AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 2);
-    AVS_UNIT_ASSERT_TRUE(pre_fail_append_ptr
-                         == ((anjay_batch_builder_t *) builder)->append_ptr);
-    AVS_UNIT_ASSERT_NULL(*((anjay_batch_builder_t *) builder)->append_ptr);
+            ((anjay_batch_builder_t *) builder)->entry_count, 2);
+    AVS_UNIT_ASSERT_EQUAL(((anjay_batch_builder_t *) builder)->payload_size,
+                          pre_fail_payload_size);
     anjay_send_batch_builder_cleanup(&builder);
     DM_TEST_FINISH;
 }
@@ -858,7 +853,7 @@ AVS_UNIT_TEST(anjay_send, add_multiple_ignore_not_found) {
             anjay_send_batch_data_add_current_multiple_ignore_not_found(
                     builder, anjay, paths, AVS_ARRAY_SIZE(paths)));
     AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 1);
+            ((anjay_batch_builder_t *) builder)->entry_count, 1);
 
     _anjay_mock_dm_expect_list_instances(
             anjay, &OBJ, 0, (const anjay_iid_t[]) { 1, ANJAY_ID_INVALID });
@@ -874,7 +869,7 @@ AVS_UNIT_TEST(anjay_send, add_multiple_ignore_not_found) {
             anjay_send_batch_data_add_current_multiple_ignore_not_found(
                     builder, anjay, paths, 1));
     AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 1);
+            ((anjay_batch_builder_t *) builder)->entry_count, 1);
 
     // This should not be ignored.
     _anjay_mock_dm_expect_list_instances(
@@ -890,7 +885,7 @@ AVS_UNIT_TEST(anjay_send, add_multiple_ignore_not_found) {
             anjay_send_batch_data_add_current_multiple_ignore_not_found(
                     builder, anjay, paths, 1));
     AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 1);
+            ((anjay_batch_builder_t *) builder)->entry_count, 1);
 
     _anjay_mock_dm_expect_list_instances(
             anjay, &OBJ, 0, (const anjay_iid_t[]) { 1, ANJAY_ID_INVALID });
@@ -904,7 +899,7 @@ AVS_UNIT_TEST(anjay_send, add_multiple_ignore_not_found) {
     AVS_UNIT_ASSERT_SUCCESS(
             anjay_send_batch_data_add_current(builder, anjay, 42, 1, 1));
     AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 2);
+            ((anjay_batch_builder_t *) builder)->entry_count, 2);
 
     anjay_send_batch_builder_cleanup(&builder);
     DM_TEST_FINISH;
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2017-2023 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+static void
+assert_resources_changed(AVS_LIST(anjay_notify_queue_resource_entry_t) list,
+                         const anjay_notify_queue_resource_entry_t *expected,
+                         size_t expected_count) {
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(list), expected_count);
+    for (size_t i = 0; i < expected_count; ++i) {
+        AVS_UNIT_ASSERT_EQUAL(list->iid, expected[i].iid);
+        AVS_UNIT_ASSERT_EQUAL(list->rid, expected[i].rid);
+        list = AVS_LIST_NEXT(list);
+    }
+}
+
+AVS_UNIT_TEST(notify_bitmap, merge_with_queue) {
+    AVS_LIST(anjay_notify_bitmap_t) bitmaps = NULL;
+    anjay_notify_queue_t queue = NULL;
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_bitmap_set(&bitmaps, 42, 3, 40));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_bitmap_set(&bitmaps, 42, 0, 1));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_bitmap_set(&bitmaps, 42, 3, 40));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_bitmap_set(&bitmaps, 42, 1, 31));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_bitmap_set(&bitmaps, 7, 0, 0));
+    // too large to be represented in a bitmap
+    AVS_UNIT_ASSERT_EQUAL(_anjay_notify_bitmap_set(&bitmaps, 42, 1000, 1), 1);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(bitmaps), 2);
+    AVS_UNIT_ASSERT_EQUAL(bitmaps->oid, 7);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_notify_queue_resource_change(&queue, 42, 1, 31));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_notify_queue_resource_change(&queue, 42, 2, 5));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_notify_queue_resource_change(&queue, 42, 1000, 1));
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_bitmaps_flush(bitmaps, &queue));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(queue), 2);
+    AVS_UNIT_ASSERT_EQUAL(queue->oid, 7);
+    assert_resources_changed(queue->resources_changed,
+                             (const anjay_notify_queue_resource_entry_t[]) {
+                                 { 0, 0 } },
+                             1);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_NEXT(queue)->oid, 42);
+    assert_resources_changed(AVS_LIST_NEXT(queue)->resources_changed,
+                             (const anjay_notify_queue_resource_entry_t[]) {
+                                 { 0, 1 },
+                                 { 1, 31 },
+                                 { 2, 5 },
+                                 { 3, 40 },
+                                 { 1000, 1 } },
+                             5);
+    _anjay_notify_clear_queue(&queue);
+
+    // bitmaps are retained, but cleared after flushing
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(bitmaps), 2);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_bitmaps_flush(bitmaps, &queue));
+    AVS_UNIT_ASSERT_NULL(queue);
+
+    _anjay_notify_bitmaps_remove_object(&bitmaps, 7);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(bitmaps), 1);
+    _anjay_notify_bitmaps_cleanup(&bitmaps);
+    AVS_UNIT_ASSERT_NULL(bitmaps);
+}
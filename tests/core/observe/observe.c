@@ -12,6 +12,7 @@
 #include <math.h>
 #include <stdarg.h>
 
+#include <avsystem/coap/udp.h>
 #include <avsystem/commons/avs_unit_test.h>
 
 #include "src/core/anjay_core.h"
@@ -24,6 +25,21 @@
 
 #define MSG_ID_BASE 0x0000
 
+static size_t
+count_indexed_observe_paths(const anjay_observe_path_node_t *node) {
+    size_t result = (node->entry ? 1 : 0);
+    for (size_t i = 0; i < node->children_count; ++i) {
+        if (i > 0) {
+            AVS_UNIT_ASSERT_TRUE(node->children[i - 1]->id
+                                 < node->children[i]->id);
+        }
+        AVS_UNIT_ASSERT_TRUE(node->children[i]->entry
+                             || node->children[i]->children_count);
+        result += count_indexed_observe_paths(node->children[i]);
+    }
+    return result;
+}
+
 static void assert_observe_consistency(anjay_t *anjay_locked) {
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     AVS_LIST(anjay_observe_connection_entry_t) conn;
@@ -54,8 +70,19 @@ static void assert_observe_consistency(anjay_t *anjay_locked) {
                 }
                 AVS_UNIT_ASSERT_TRUE(path_found);
             }
+
+            const anjay_observe_path_node_t *node = &conn->observed_paths_index;
+            for (size_t i = 0; i < _anjay_uri_path_length(&path_entry->path);
+                 ++i) {
+                node = path_index_find_child(node, path_entry->path.ids[i]);
+                AVS_UNIT_ASSERT_NOT_NULL(node);
+            }
+            AVS_UNIT_ASSERT_TRUE(node->entry == path_entry);
         }
         AVS_UNIT_ASSERT_EQUAL(path_refs_in_observations, path_refs);
+        AVS_UNIT_ASSERT_EQUAL(
+                count_indexed_observe_paths(&conn->observed_paths_index),
+                AVS_SORTED_SET_SIZE(conn->observed_paths));
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
@@ -115,9 +142,9 @@ static void assert_observe(anjay_t *anjay_locked,
     AVS_UNIT_ASSERT_SUCCESS(_anjay_output_dynamic_construct(
             &out_ctx, (avs_stream_t *) &out_buf_stream, uri, details->format,
             ANJAY_ACTION_READ));
-    AVS_UNIT_ASSERT_SUCCESS(
-            _anjay_batch_data_output(anjay, observation->last_sent->values[0],
-                                     ANJAY_SSID_BOOTSTRAP, out_ctx));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_data_output(
+            anjay, observation->last_sent->values[0].batch,
+            ANJAY_SSID_BOOTSTRAP, out_ctx));
     AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out_ctx));
     AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&out_buf_stream), length);
     AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, data, length);
@@ -786,7 +813,7 @@ static void notify_max_period_test(const char *con_notify_ack,
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     AVS_UNIT_ASSERT_EQUAL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
@@ -863,6 +890,131 @@ AVS_UNIT_TEST(notify, max_period) {
     notify_max_period_test("\x70\x00\x00\x01", 4, 0); // Reset
 }
 
+typedef struct {
+    size_t calls;
+    size_t datagrams;
+} batch_send_counts_t;
+
+static avs_error_t count_batch_send(avs_net_socket_t *socket,
+                                    const avs_coap_udp_datagram_t *datagrams,
+                                    size_t count,
+                                    size_t *out_sent,
+                                    void *counts_) {
+    (void) socket;
+    (void) datagrams;
+    batch_send_counts_t *counts = (batch_send_counts_t *) counts_;
+    ++counts->calls;
+    counts->datagrams += count;
+    // declined, so that the datagrams are sent through the mock socket
+    *out_sent = 0;
+    return avs_errno(AVS_ENOTSUP);
+}
+
+AVS_UNIT_TEST(notify, close_deadlines_share_trigger_slot) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 1,
+            .max_period = 10,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_WITH_SSIDS(14);
+    // Token: A, pmax reached at 1010.001 s
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_MS));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "A"), OBSERVE(0),
+                    PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 514.0));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID_TOKEN(0x69ED, "A"),
+                            CONTENT_FORMAT(PLAINTEXT), OBSERVE(0),
+                            PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    // Token: B, pmax reached at 1010.006 s
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_MS));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69EE, "B"), OBSERVE(0),
+                    PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 514.0));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID_TOKEN(0x69EE, "B"),
+                            CONTENT_FORMAT(PLAINTEXT), OBSERVE(0),
+                            PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    assert_observe_size(anjay, 2);
+
+    // both observations are handled by a single job, at 1010.010 s
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(
+            AVS_SORTED_SET_SIZE(anjay_unlocked->observe.trigger_slots), 1);
+    anjay_observe_trigger_slot_t *slot =
+            AVS_SORTED_SET_FIRST(anjay_unlocked->observe.trigger_slots);
+    AVS_UNIT_ASSERT_EQUAL(slot->instant.since_monotonic_epoch.seconds, 1010);
+    AVS_UNIT_ASSERT_EQUAL(slot->instant.since_monotonic_epoch.nanoseconds,
+                          10000000);
+    AVS_SORTED_SET_ELEM(anjay_observation_t) observation;
+    AVS_SORTED_SET_FOREACH(
+            observation,
+            anjay_unlocked->observe.connection_entries->observations) {
+        AVS_UNIT_ASSERT_TRUE(observation->notify_trigger.slot == slot);
+    }
+    batch_send_counts_t batch_counts = { 0 };
+    AVS_UNIT_ASSERT_SUCCESS(avs_coap_udp_ctx_set_batch_send_handler(
+            _anjay_connection_get_coap((anjay_connection_ref_t) {
+                .server = anjay_unlocked->servers,
+                .conn_type = ANJAY_CONNECTION_PRIMARY
+            }),
+            count_batch_send, &batch_counts));
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    ////// BEFORE THE SLOT //////
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(10003,
+                                                            AVS_TIME_MS));
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 2);
+
+    ////// NOTIFICATIONS //////
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_MS));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Hello"));
+    const coap_test_msg_t *a_notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "A"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Hello"));
+    avs_unit_mocksock_expect_output(mocksocks[0], a_notify_response->content,
+                                    a_notify_response->length);
+    // value read for the previous observation is reused
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    const coap_test_msg_t *b_notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 1, "B"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Hello"));
+    avs_unit_mocksock_expect_output(mocksocks[0], b_notify_response->content,
+                                    b_notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 2);
+    // both notifications are sent in a single batch
+    AVS_UNIT_ASSERT_EQUAL(batch_counts.calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(batch_counts.datagrams, 2);
+
+    // next triggers of both observations are in the same slot again
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(
+            AVS_SORTED_SET_SIZE(anjay_unlocked->observe.trigger_slots), 1);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->observe.connection_entries
+                                  ->next_trigger.since_real_epoch.seconds,
+                          1020);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(notify, min_period) {
     static const anjay_dm_r_attributes_t ATTRS = {
         .common = {
@@ -922,7 +1074,7 @@ AVS_UNIT_TEST(notify, min_period) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     DM_TEST_FINISH;
@@ -1090,6 +1242,64 @@ AVS_UNIT_TEST(notify, confirmable) {
     DM_TEST_FINISH;
 }
 
+AVS_UNIT_TEST(notify, cached_effective_attributes) {
+    ////// INITIALIZATION //////
+    const anjay_dm_object_def_t *const *obj_defs[] = {
+        DM_TEST_DEFAULT_OBJECTS
+    };
+    anjay_ssid_t ssids[] = { 14 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids,
+                         DM_TEST_CONFIGURATION(.cache_effective_attributes =
+                                                       true));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 514.0));
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    // attributes are not queried again when scheduling triggers
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    assert_observe_size(anjay, 1);
+
+    ////// NOTIFICATION //////
+    // change of the value itself does not invalidate the cache
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 42));
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("42"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+
+    ////// DEFAULT MINIMUM PERIOD CHANGE //////
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(
+            anjay, ANJAY_DM_OID_SERVER, 0, ANJAY_DM_RID_SERVER_DEFAULT_PMIN));
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+
+    ////// NOTIFICATION AFTER INVALIDATION //////
+    // attributes are queried once after the cache is invalidated
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 43));
+    notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 1, "Res4"),
+                     OBSERVE(2), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("43"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(notify, extremes) {
     static const anjay_dm_r_attributes_t ATTRS = {
         .common = {
@@ -1134,7 +1344,7 @@ AVS_UNIT_TEST(notify, extremes) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// EVEN LESS //////
@@ -1149,7 +1359,7 @@ AVS_UNIT_TEST(notify, extremes) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// IN BETWEEN //////
@@ -1169,7 +1379,7 @@ AVS_UNIT_TEST(notify, extremes) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// EQUAL - STILL NOT CROSSING //////
@@ -1184,7 +1394,7 @@ AVS_UNIT_TEST(notify, extremes) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// GREATER //////
@@ -1204,7 +1414,7 @@ AVS_UNIT_TEST(notify, extremes) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// STILL GREATER //////
@@ -1219,7 +1429,7 @@ AVS_UNIT_TEST(notify, extremes) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// LESS AGAIN //////
@@ -1239,7 +1449,7 @@ AVS_UNIT_TEST(notify, extremes) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     DM_TEST_FINISH;
@@ -1284,7 +1494,7 @@ AVS_UNIT_TEST(notify, greater_only) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// LESS //////
@@ -1304,7 +1514,7 @@ AVS_UNIT_TEST(notify, greater_only) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// GREATER AGAIN //////
@@ -1324,7 +1534,7 @@ AVS_UNIT_TEST(notify, greater_only) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     DM_TEST_FINISH;
@@ -1374,7 +1584,7 @@ AVS_UNIT_TEST(notify, less_only) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// STILL LESS //////
@@ -1389,7 +1599,7 @@ AVS_UNIT_TEST(notify, less_only) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// GREATER //////
@@ -1409,7 +1619,7 @@ AVS_UNIT_TEST(notify, less_only) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// LESS AGAIN //////
@@ -1429,7 +1639,7 @@ AVS_UNIT_TEST(notify, less_only) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     DM_TEST_FINISH;
@@ -1473,7 +1683,7 @@ AVS_UNIT_TEST(notify, step) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// INCREASE BY EXACTLY stp //////
@@ -1493,7 +1703,7 @@ AVS_UNIT_TEST(notify, step) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// INCREASE BY OVER stp //////
@@ -1513,7 +1723,7 @@ AVS_UNIT_TEST(notify, step) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// NON-NUMERIC VALUE //////
@@ -1533,7 +1743,7 @@ AVS_UNIT_TEST(notify, step) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// BACK TO NUMBERS //////
@@ -1553,7 +1763,7 @@ AVS_UNIT_TEST(notify, step) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// TOO LITTLE DECREASE //////
@@ -1568,7 +1778,7 @@ AVS_UNIT_TEST(notify, step) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// DECREASE BY EXACTLY stp //////
@@ -1588,7 +1798,7 @@ AVS_UNIT_TEST(notify, step) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// DECREASE BY MORE THAN stp //////
@@ -1608,7 +1818,7 @@ AVS_UNIT_TEST(notify, step) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     ////// INCREASE BY EXACTLY stp //////
@@ -1628,7 +1838,7 @@ AVS_UNIT_TEST(notify, step) {
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_SORTED_SET_FIRST(
                     anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+                    ->notify_trigger.slot);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     DM_TEST_FINISH;
@@ -1693,9 +1903,8 @@ AVS_UNIT_TEST(notify, multiple_formats) {
                      CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Hello"));
     avs_unit_mocksock_expect_output(mocksocks[0], n_notify_response->content,
                                     n_notify_response->length);
-    // plaintext
+    // plaintext - value read for the previous observation is reused
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Hello"));
     const coap_test_msg_t *p_notify_response =
             COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 1, "P"), OBSERVE(1),
                      CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Hello"));
@@ -1703,7 +1912,6 @@ AVS_UNIT_TEST(notify, multiple_formats) {
                                     p_notify_response->length);
     // TLV
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Hello"));
     const coap_test_msg_t *t_notify_response =
             COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 2, "T"), OBSERVE(1),
                      CONTENT_FORMAT(OMA_LWM2M_TLV),
@@ -1714,6 +1922,7 @@ AVS_UNIT_TEST(notify, multiple_formats) {
     anjay_sched_run(anjay);
     assert_observe_consistency(anjay);
     assert_observe_size(anjay, 3);
+    AVS_UNIT_ASSERT_EQUAL(anjay_get_observe_saved_reads(anjay), 2);
 
     ////// NOTIFICATION - FORMAT CHANGE //////
     _anjay_mock_clock_advance(avs_time_duration_from_scalar(10, AVS_TIME_S));
@@ -1728,8 +1937,6 @@ AVS_UNIT_TEST(notify, multiple_formats) {
                                     n_bytes_response->length);
     // plaintext
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    expect_read_res(anjay, &OBJ, 69, 4,
-                    ANJAY_MOCK_DM_BYTES(0, "\x12\x34\x56\x78"));
     const coap_test_msg_t *p_bytes_response =
             COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 4, "P"), OBSERVE(2),
                      CONTENT_FORMAT(PLAINTEXT), PAYLOAD("EjRWeA=="));
@@ -1737,8 +1944,6 @@ AVS_UNIT_TEST(notify, multiple_formats) {
                                     p_bytes_response->length);
     // TLV
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    expect_read_res(anjay, &OBJ, 69, 4,
-                    ANJAY_MOCK_DM_BYTES(0, "\x12\x34\x56\x78"));
     const coap_test_msg_t *t_bytes_response =
             COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 5, "T"), OBSERVE(2),
                      CONTENT_FORMAT(OMA_LWM2M_TLV),
@@ -1749,6 +1954,7 @@ AVS_UNIT_TEST(notify, multiple_formats) {
     anjay_sched_run(anjay);
     assert_observe_consistency(anjay);
     assert_observe_size(anjay, 3);
+    AVS_UNIT_ASSERT_EQUAL(anjay_get_observe_saved_reads(anjay), 4);
     DM_TEST_FINISH;
 }
 
@@ -1798,25 +2004,11 @@ AVS_UNIT_TEST(notify, storing_when_inactive) {
     _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
                                         ANJAY_MOCK_DM_STRING(0, "Rin"));
 
+    // value read for server 14 is reused
     DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
-    _anjay_mock_dm_expect_list_instances(
-            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
-    _anjay_mock_dm_expect_list_resources(
-            anjay, &OBJ, 69, 0,
-            (const anjay_mock_dm_res_entry_t[]) {
-                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
-                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    ANJAY_MOCK_DM_RES_END });
-    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
-                                        ANJAY_MOCK_DM_STRING(0, "Len"));
     const coap_test_msg_t *notify_response =
             COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "SuccsTkn"),
-                     OBSERVE(1), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Len"));
+                     OBSERVE(1), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Rin"));
     avs_unit_mocksock_expect_output(mocksocks[1], notify_response->content,
 
                                     notify_response->length);
@@ -1848,25 +2040,11 @@ AVS_UNIT_TEST(notify, storing_when_inactive) {
     _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
                                         ANJAY_MOCK_DM_STRING(0, "Miku"));
 
+    // value read for server 14 is reused
     DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
-    _anjay_mock_dm_expect_list_instances(
-            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
-    _anjay_mock_dm_expect_list_resources(
-            anjay, &OBJ, 69, 0,
-            (const anjay_mock_dm_res_entry_t[]) {
-                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
-                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    ANJAY_MOCK_DM_RES_END });
-    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
-                                        ANJAY_MOCK_DM_STRING(0, "Luka"));
     const coap_test_msg_t *notify_response2 =
             COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 1, "SuccsTkn"),
-                     OBSERVE(2), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Luka"));
+                     OBSERVE(2), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Miku"));
     avs_unit_mocksock_expect_output(mocksocks[1], notify_response2->content,
                                     notify_response2->length);
     DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
@@ -2283,3 +2461,301 @@ AVS_UNIT_TEST(notify, send_error) {
 
     DM_TEST_FINISH;
 }
+
+AVS_UNIT_TEST(notify, payload_chunks_at_arbitrary_offsets) {
+    static const char PAYLOAD[] = "0123456789";
+    anjay_observe_connection_entry_t conn = {
+        .serialization_state = {
+            .payload = (char *) (intptr_t) PAYLOAD,
+            .payload_size = sizeof(PAYLOAD) - 1
+        }
+    };
+    char buf[4];
+    size_t chunk_size;
+
+    AVS_UNIT_ASSERT_SUCCESS(write_notify_payload(4, buf, sizeof(buf),
+                                                 &chunk_size, &conn));
+    AVS_UNIT_ASSERT_EQUAL(chunk_size, 4);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "4567", 4);
+
+    // going back, e.g. after renegotiation of block size
+    AVS_UNIT_ASSERT_SUCCESS(write_notify_payload(2, buf, sizeof(buf),
+                                                 &chunk_size, &conn));
+    AVS_UNIT_ASSERT_EQUAL(chunk_size, 4);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "2345", 4);
+
+    AVS_UNIT_ASSERT_SUCCESS(write_notify_payload(8, buf, sizeof(buf),
+                                                 &chunk_size, &conn));
+    AVS_UNIT_ASSERT_EQUAL(chunk_size, 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "89", 2);
+
+    AVS_UNIT_ASSERT_SUCCESS(write_notify_payload(10, buf, sizeof(buf),
+                                                 &chunk_size, &conn));
+    AVS_UNIT_ASSERT_EQUAL(chunk_size, 0);
+
+    AVS_UNIT_ASSERT_FAILED(write_notify_payload(11, buf, sizeof(buf),
+                                                &chunk_size, &conn));
+}
+
+AVS_UNIT_TEST(observe, trigger_slot_instant) {
+    const avs_time_monotonic_t whole = avs_time_monotonic_from_scalar(
+            1000, AVS_TIME_S);
+    AVS_UNIT_ASSERT_TRUE(
+            avs_time_monotonic_equal(trigger_slot_instant(whole), whole));
+
+    const avs_time_monotonic_t rounded = avs_time_monotonic_add(
+            whole, avs_time_duration_from_scalar(10, AVS_TIME_MS));
+    AVS_UNIT_ASSERT_TRUE(avs_time_monotonic_equal(
+            trigger_slot_instant(avs_time_monotonic_add(
+                    whole, avs_time_duration_from_scalar(1, AVS_TIME_NS))),
+            rounded));
+    AVS_UNIT_ASSERT_TRUE(avs_time_monotonic_equal(
+            trigger_slot_instant(avs_time_monotonic_add(
+                    whole, avs_time_duration_from_scalar(9999, AVS_TIME_US))),
+            rounded));
+
+    AVS_UNIT_ASSERT_FALSE(avs_time_monotonic_valid(
+            trigger_slot_instant(AVS_TIME_MONOTONIC_INVALID)));
+}
+
+AVS_UNIT_TEST(observe, align_trigger_instant) {
+    const avs_time_duration_t alignment =
+            avs_time_duration_from_scalar(60, AVS_TIME_S);
+    AVS_UNIT_ASSERT_EQUAL(
+            align_trigger_instant(avs_time_real_from_scalar(1234, AVS_TIME_S),
+                                  alignment)
+                    .since_real_epoch.seconds,
+            1200);
+    AVS_UNIT_ASSERT_EQUAL(
+            align_trigger_instant(avs_time_real_from_scalar(1200, AVS_TIME_S),
+                                  alignment)
+                    .since_real_epoch.seconds,
+            1200);
+    // zero alignment means no alignment
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+            align_trigger_instant(avs_time_real_from_scalar(1234567,
+                                                            AVS_TIME_MS),
+                                  AVS_TIME_DURATION_ZERO),
+            avs_time_real_from_scalar(1234567, AVS_TIME_MS)));
+}
+
+AVS_UNIT_TEST(notify, aligned_max_period_respects_min_period) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 25,
+            .max_period = 30,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION //////
+    const anjay_dm_object_def_t *const *obj_defs[] = {
+        DM_TEST_DEFAULT_OBJECTS
+    };
+    anjay_ssid_t ssids[] = { 14 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids,
+                         DM_TEST_CONFIGURATION(.notify_alignment = {
+                                                   .seconds = 60
+                                               }));
+    // clock starts at 1000 s
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 514.0));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    assert_observe_size(anjay, 1);
+
+    ////// ALIGNED INSTANT IS BEFORE PMIN //////
+    // pmax would be reached at 1030 s, aligned back to 1020 s, but that is
+    // before pmin (1025 s)
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(20, AVS_TIME_S));
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+
+    ////// PMIN REACHED //////
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Hello"));
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Hello"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+
+    ////// NEXT PERIOD //////
+    // pmax would be reached at 1055 s, aligned back to 1020 s, so the
+    // notification is sent when pmin is reached at 1050 s
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(24, AVS_TIME_S));
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Hi!"));
+    notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 1, "Res4"),
+                     OBSERVE(2), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Hi!"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(notify, alignment_does_not_affect_value_changes) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 0,
+            .max_period = 30,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = 69.0,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION //////
+    const anjay_dm_object_def_t *const *obj_defs[] = {
+        DM_TEST_DEFAULT_OBJECTS
+    };
+    anjay_ssid_t ssids[] = { 14 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids,
+                         DM_TEST_CONFIGURATION(.notify_alignment = {
+                                                   .seconds = 60
+                                               }));
+    // clock starts at 1000 s
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 514.0));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    assert_observe_size(anjay, 1);
+
+    ////// STILL GREATER //////
+    // alignment is longer than pmax, but it shall not cause the value change
+    // to be treated as expiration of pmax
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 9001));
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+
+    ////// ALIGNED PMAX //////
+    // pmax would be reached at 1030 s, aligned back to 1020 s
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(15, AVS_TIME_S));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 9001));
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("9001"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+
+    DM_TEST_FINISH;
+}
+
+static anjay_batch_t *compile_observed_value(const char *str,
+                                             avs_time_real_t timestamp) {
+    anjay_batch_builder_t *builder = _anjay_batch_builder_new();
+    AVS_UNIT_ASSERT_NOT_NULL(builder);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_string(
+            builder, &MAKE_RESOURCE_PATH(42, 69, 4), timestamp, str));
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+    return batch;
+}
+
+AVS_UNIT_TEST(notify, unchanged_values_share_batches) {
+    const size_t paths_count = 1;
+    anjay_observation_t *observation = (anjay_observation_t *) avs_calloc(
+            1, offsetof(anjay_observation_t, paths) + sizeof(anjay_uri_path_t));
+    AVS_UNIT_ASSERT_NOT_NULL(observation);
+    memcpy((void *) (intptr_t) (const void *) &observation->paths_count,
+           &paths_count, sizeof(paths_count));
+    const anjay_msg_details_t details = {
+        .msg_code = AVS_COAP_CODE_CONTENT,
+        .format = AVS_COAP_FORMAT_PLAINTEXT
+    };
+
+    const avs_time_real_t t0 = avs_time_real_now();
+    const avs_time_real_t t1 =
+            avs_time_real_add(t0, avs_time_duration_from_scalar(5, AVS_TIME_S));
+    const avs_time_real_t t2 = avs_time_real_add(
+            t0, avs_time_duration_from_scalar(10, AVS_TIME_S));
+    anjay_batch_t *first_batch = compile_observed_value("Rin", t0);
+    anjay_batch_t *same_batch = compile_observed_value("Rin", t1);
+    anjay_batch_t *different_batch = compile_observed_value("Miku", t2);
+
+    AVS_LIST(anjay_observation_value_t) first = create_observation_value(
+            &details, AVS_COAP_NOTIFY_PREFER_NON_CONFIRMABLE, observation, &t0,
+            (const anjay_batch_t *const *) &first_batch, NULL);
+    AVS_UNIT_ASSERT_NOT_NULL(first);
+    AVS_UNIT_ASSERT_TRUE(first->values[0].batch == first_batch);
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_equal(
+            first->values[0].timestamp_shift, AVS_TIME_DURATION_ZERO));
+
+    // equal value is stored as a reference to the previous one
+    AVS_LIST(anjay_observation_value_t) same = create_observation_value(
+            &details, AVS_COAP_NOTIFY_PREFER_NON_CONFIRMABLE, observation, &t1,
+            (const anjay_batch_t *const *) &same_batch, first);
+    AVS_UNIT_ASSERT_NOT_NULL(same);
+    AVS_UNIT_ASSERT_TRUE(same->values[0].batch == first_batch);
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_equal(
+            same->values[0].timestamp_shift,
+            avs_time_duration_from_scalar(5, AVS_TIME_S)));
+    AVS_UNIT_ASSERT_EQUAL(first_batch->ref_count, 3);
+    AVS_UNIT_ASSERT_EQUAL(same_batch->ref_count, 1);
+
+    // value copied from the previous one (e.g. because of epmin) keeps its
+    // timestamps
+    AVS_LIST(anjay_observation_value_t) copied = create_observation_value(
+            &details, AVS_COAP_NOTIFY_PREFER_NON_CONFIRMABLE, observation, &t2,
+            (const anjay_batch_t *const *) &first_batch, same);
+    AVS_UNIT_ASSERT_NOT_NULL(copied);
+    AVS_UNIT_ASSERT_TRUE(copied->values[0].batch == first_batch);
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_equal(
+            copied->values[0].timestamp_shift,
+            same->values[0].timestamp_shift));
+
+    AVS_LIST(anjay_observation_value_t) different = create_observation_value(
+            &details, AVS_COAP_NOTIFY_PREFER_NON_CONFIRMABLE, observation, &t2,
+            (const anjay_batch_t *const *) &different_batch, copied);
+    AVS_UNIT_ASSERT_NOT_NULL(different);
+    AVS_UNIT_ASSERT_TRUE(different->values[0].batch == different_batch);
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_equal(
+            different->values[0].timestamp_shift, AVS_TIME_DURATION_ZERO));
+
+    _anjay_batch_release(&same_batch);
+    _anjay_batch_release(&different_batch);
+    delete_value(NULL, &different);
+    delete_value(NULL, &copied);
+    delete_value(NULL, &same);
+    AVS_UNIT_ASSERT_EQUAL(first_batch->ref_count, 2);
+    delete_value(NULL, &first);
+    _anjay_batch_release(&first_batch);
+    avs_free(observation);
+}
@@ -316,3 +316,91 @@ AVS_UNIT_TEST(access_control, set_owner) {
 
     DM_TEST_FINISH;
 }
+
+AVS_UNIT_TEST(access_control, compiled_acl) {
+    ACCESS_CONTROL_TEST_INIT;
+
+    const anjay_iid_t iid = 1;
+    const anjay_ssid_t ssid = 1;
+
+    {
+        ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+        anjay_notify_queue_t queue = NULL;
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_notify_queue_instance_created(&queue, TEST->oid, iid));
+
+        // transaction validation
+        _anjay_mock_dm_expect_list_instances(
+                anjay, &TEST, 0, (anjay_iid_t[]){ iid, ANJAY_ID_INVALID });
+        _anjay_mock_dm_expect_list_instances(
+                anjay, &FAKE_SERVER, 0,
+                (const anjay_iid_t[]) { 0, ANJAY_ID_INVALID });
+        _anjay_mock_dm_expect_list_resources(
+                anjay, &FAKE_SERVER, 0, 0,
+                (const anjay_mock_dm_res_entry_t[]) {
+                        { ANJAY_DM_RID_SERVER_SSID, ANJAY_DM_RES_R,
+                          ANJAY_DM_RES_PRESENT },
+                        ANJAY_MOCK_DM_RES_END });
+        _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, 0,
+                                            ANJAY_DM_RID_SERVER_SSID,
+                                            ANJAY_ID_INVALID, 0,
+                                            ANJAY_MOCK_DM_INT(0, ssid));
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_notify_flush(anjay_unlocked, ssid, &queue));
+        ANJAY_MUTEX_UNLOCK(anjay);
+    }
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_access_control_set_acl(anjay, TEST->oid, iid, ssid,
+                                         ANJAY_ACCESS_MASK_READ
+                                                 | ANJAY_ACCESS_MASK_WRITE));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    access_control_t *ac = _anjay_access_control_get(anjay_unlocked);
+    AVS_UNIT_ASSERT_FALSE(ac->compiled_acl.valid);
+
+    anjay_access_mask_t mask;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_access_control_compiled_mask(
+            anjay_unlocked, TEST->oid, iid, ssid, &mask));
+    AVS_UNIT_ASSERT_TRUE(ac->compiled_acl.valid);
+    AVS_UNIT_ASSERT_EQUAL(mask,
+                          ANJAY_ACCESS_MASK_READ | ANJAY_ACCESS_MASK_WRITE);
+
+    // no default ACL entry yet
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_access_control_compiled_mask(
+            anjay_unlocked, TEST->oid, iid, 2, &mask));
+    AVS_UNIT_ASSERT_EQUAL(mask, ANJAY_ACCESS_MASK_NONE);
+
+    // no Access Control instance for the target
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_access_control_compiled_mask(
+            anjay_unlocked, TEST->oid, (anjay_iid_t) (iid + 1), ssid, &mask));
+    AVS_UNIT_ASSERT_EQUAL(mask, ANJAY_ACCESS_MASK_NONE);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    // adding the default ACL entry only schedules an update of its target
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_access_control_set_acl(anjay, TEST->oid, iid, ANJAY_SSID_ANY,
+                                         ANJAY_ACCESS_MASK_EXECUTE));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    access_control_t *ac = _anjay_access_control_get(anjay_unlocked);
+    AVS_UNIT_ASSERT_TRUE(ac->compiled_acl.valid);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(ac->compiled_acl.dirty_iids), 1);
+    AVS_UNIT_ASSERT_EQUAL(*ac->compiled_acl.dirty_iids,
+                          ac->current.instances->iid);
+
+    anjay_access_mask_t mask;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_access_control_compiled_mask(
+            anjay_unlocked, TEST->oid, iid, 2, &mask));
+    AVS_UNIT_ASSERT_TRUE(ac->compiled_acl.valid);
+    AVS_UNIT_ASSERT_NULL(ac->compiled_acl.dirty_iids);
+    AVS_UNIT_ASSERT_EQUAL(ac->compiled_acl.targets_count, 1);
+    AVS_UNIT_ASSERT_EQUAL(mask, ANJAY_ACCESS_MASK_EXECUTE);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_access_control_compiled_mask(
+            anjay_unlocked, TEST->oid, iid, ssid, &mask));
+    AVS_UNIT_ASSERT_EQUAL(mask,
+                          ANJAY_ACCESS_MASK_READ | ANJAY_ACCESS_MASK_WRITE);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_FINISH;
+}
@@ -38,6 +38,7 @@ anjay_t *_anjay_test_dm_init(const anjay_configuration_t *config) {
 void _anjay_test_dm_unsched_notify_clb(anjay_t *anjay_locked) {
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     _anjay_notify_clear_queue(&anjay->scheduled_notify.queue);
+    _anjay_notify_bitmaps_cleanup(&anjay->scheduled_notify.bitmaps);
     avs_sched_del(&anjay->scheduled_notify.handle);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }